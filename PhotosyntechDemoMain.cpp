@@ -1021,6 +1021,38 @@ void viewSystemStatus()
     cout << "Total plants in inventory: " << mainInventory->getPlants()->size() << endl;
     cout << "Total inventory value: $" << mainInventory->getPrice() << endl;
 
+    cout << "\n" << BHYEL << "=== Tick Statistics ===" << CRESET << endl;
+    TickStats stats = inventory->getTickStats();
+    if (stats.getTickCount() == 0)
+    {
+        cout << "No ticks recorded yet" << endl;
+    }
+    else
+    {
+        const LatencyHistogram& tickLatency = stats.getLatency(TickPhase::Total);
+        const TickRecord& lastTick = stats.getLastTick();
+        const TickRecord& totals = stats.getTotals();
+        double periodMs = std::chrono::duration<double, std::milli>(Inventory::getTicker()->getPeriod()).count();
+        double p99Ms = tickLatency.getValueAtPercentile(99.0) / 1e6;
+
+        cout << "Ticks recorded: " << stats.getTickCount() << endl;
+        cout << "Tick time (ms): mean " << tickLatency.getMean() / 1e6
+             << ", p50 " << tickLatency.getValueAtPercentile(50.0) / 1e6
+             << ", p99 " << p99Ms
+             << ", max " << tickLatency.getMax() / 1e6 << endl;
+        cout << "Last tick: " << lastTick.phaseNanos[static_cast<int>(TickPhase::Total)] / 1e6 << " ms, "
+             << lastTick.plantsVisited << " plants visited, "
+             << lastTick.commandsApplied << " commands applied" << endl;
+        cout << "grow() calls: Seed " << totals.growCalls[1] << ", Vegetative " << totals.growCalls[2]
+             << ", Mature " << totals.growCalls[3] << ", Dead " << totals.growCalls[4]
+             << ", other " << totals.growCalls[0] << endl;
+        cout << "Notifications: water " << totals.waterNotifications << ", sunlight " << totals.sunNotifications
+             << ", state " << totals.stateNotifications << endl;
+        cout << "Season changes: " << totals.seasonChanges << ", commands applied: " << totals.commandsApplied << endl;
+        cout << "NFR-1 (tick within one day cycle): " << (p99Ms <= periodMs ? "met" : "NOT met")
+             << " at p99 (period " << periodMs << " ms)" << endl;
+    }
+
     cout << "\n" << BHYEL << "=== Flyweight Factory Statistics ===" << CRESET << endl;
     cout << "Water strategies cached: 4 (Low, Mid, High, Alternating)" << endl;
     cout << "Sun strategies cached: 4 (Low, Mid, High, Alternating)" << endl;
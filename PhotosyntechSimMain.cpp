@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+// Builder Pattern
+#include "builder/Director.h"
+#include "builder/RoseBuilder.h"
+#include "builder/SunflowerBuilder.h"
+#include "builder/CactusBuilder.h"
+#include "builder/PineBuilder.h"
+#include "builder/MapleBuilder.h"
+#include "builder/JadePlantBuilder.h"
+#include "builder/LavenderBuilder.h"
+#include "builder/CherryBlossomBuilder.h"
+
+// Singleton, Composite and Prototype Patterns
+#include "singleton/Singleton.h"
+#include "composite/PlantGroup.h"
+#include "prototype/LivingPlant.h"
+
+// State and Observer Patterns
+#include "state/Dead.h"
+#include "mediator/Staff.h"
+
+// Multi-process runs
+#include "simulation/ShardCoordinator.h"
+#include "simulation/InventoryImage.h"
+
+using namespace std;
+
+/**
+ * @brief Headless batch run of the nursery simulation.
+ *
+ * Builds N plants of every species with the existing builders, advances the
+ * inventory M days back to back and prints throughput, peak memory and deaths
+ * per species. Used for capacity planning and to check a build against NFR-1
+ * (10,000 plants cared for within one day cycle) and NFR-4 (5,000 plants
+ * without memory exhaustion).
+ *
+ * With --shards K the plants are split across K worker processes instead,
+ * each species spread evenly over the shards, and the run reports combined
+ * tick statistics and the largest worker's peak memory.
+ *
+ * --save-image FILE writes the built nursery to an InventoryImage before the
+ * run; --load-image FILE restores one instead of building, and the build time
+ * then reports the load.
+ *
+ * The run ends with the inventory's flyweight sharing report (NFR-4);
+ * --flyweight-report FILE also writes it as JSON for nightly runs to compare.
+ * Sharded runs do not produce it.
+ *
+ * Usage: photosyntech_sim [--plants N] [--days M] [--threads T] [--staff S] [--shards K] [--event-driven]
+ *                         [--save-image FILE] [--load-image FILE] [--flyweight-report FILE]
+ */
+
+namespace
+{
+    struct SimOptions
+    {
+        int plantsPerSpecies;
+        int days;
+        unsigned int threads;
+        int staff;
+        unsigned int shards;
+        bool eventDriven;
+        string saveImage;
+        string loadImage;
+        string flyweightReport;
+    };
+
+    // Type names accepted by the shard workers, one per builder below
+    const char *const SPECIES_TYPES[] = {"Rose", "Sunflower", "Cactus", "Pine", "Maple", "Jade Plant", "Lavender", "Cherry Blossom"};
+    // Names the builders give their plants, so both modes report species alike
+    const char *const SPECIES_NAMES[] = {"Rose", "Sunflower", "Cactus", "Pine Tree", "Maple Tree", "Jade", "Lavender", "Cherry Blossom"};
+    const int SPECIES_COUNT = 8;
+
+    void printUsage()
+    {
+        cout << "Usage: photosyntech_sim [--plants N] [--days M] [--threads T] [--staff S] [--shards K] [--event-driven]" << endl;
+        cout << "                        [--save-image FILE] [--load-image FILE] [--flyweight-report FILE]" << endl;
+        cout << "  --plants N   plants built per species (default 1250, 10,000 in total)" << endl;
+        cout << "  --days M     simulated days to run (default 365)" << endl;
+        cout << "  --threads T  tick threads, 0 for one per core (default 1)" << endl;
+        cout << "  --staff S    staff members observing the inventory (default 1)" << endl;
+        cout << "  --shards K   split the plants across K worker processes (default 0, one process)" << endl;
+        cout << "  --event-driven  only evaluate plants that are due each day" << endl;
+        cout << "  --save-image FILE  save the built nursery before running" << endl;
+        cout << "  --load-image FILE  load a saved nursery instead of building one" << endl;
+        cout << "  --flyweight-report FILE  write the flyweight sharing report as JSON" << endl;
+    }
+
+    bool parseOptions(int argc, char **argv, SimOptions &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+                return false;
+            if (strcmp(argv[i], "--event-driven") == 0)
+            {
+                options.eventDriven = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                cerr << "Missing value for " << argv[i] << endl;
+                return false;
+            }
+            if (strcmp(argv[i], "--save-image") == 0)
+            {
+                options.saveImage = argv[++i];
+                continue;
+            }
+            if (strcmp(argv[i], "--load-image") == 0)
+            {
+                options.loadImage = argv[++i];
+                continue;
+            }
+            if (strcmp(argv[i], "--flyweight-report") == 0)
+            {
+                options.flyweightReport = argv[++i];
+                continue;
+            }
+
+            long value = strtol(argv[i + 1], nullptr, 10);
+            if (value < 0)
+            {
+                cerr << "Negative value for " << argv[i] << endl;
+                return false;
+            }
+
+            if (strcmp(argv[i], "--plants") == 0)
+                options.plantsPerSpecies = static_cast<int>(value);
+            else if (strcmp(argv[i], "--days") == 0)
+                options.days = static_cast<int>(value);
+            else if (strcmp(argv[i], "--threads") == 0)
+                options.threads = static_cast<unsigned int>(value);
+            else if (strcmp(argv[i], "--staff") == 0)
+                options.staff = static_cast<int>(value);
+            else if (strcmp(argv[i], "--shards") == 0)
+                options.shards = static_cast<unsigned int>(value);
+            else
+            {
+                cerr << "Unknown option " << argv[i] << endl;
+                return false;
+            }
+            i++;
+        }
+        return true;
+    }
+
+    // Peak resident set size in kilobytes; RUSAGE_CHILDREN gives the largest waited-for child
+    long peakRssKb(int who = RUSAGE_SELF)
+    {
+        struct rusage usage;
+        if (getrusage(who, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    // Same batch run split across worker processes; staff are not sharded
+    int runSharded(const SimOptions &options)
+    {
+        ShardCoordinator *coordinator;
+        try
+        {
+            coordinator = new ShardCoordinator(options.shards);
+        }
+        catch (const runtime_error &error)
+        {
+            cerr << error.what() << endl;
+            return 1;
+        }
+
+        unsigned int shards = coordinator->getShardCount();
+        long plantCount = 0;
+        double buildSeconds = 0;
+        double runSeconds = 0;
+        map<string, unsigned long> deaths;
+
+        try
+        {
+            coordinator->configure(options.threads, options.eventDriven);
+
+            // Group species * shards + shard holds that shard's share of one species
+            chrono::steady_clock::time_point buildStart = chrono::steady_clock::now();
+            for (int b = 0; b < SPECIES_COUNT; b++)
+            {
+                for (unsigned int shard = 0; shard < shards; shard++)
+                {
+                    unsigned int share = options.plantsPerSpecies / shards + (shard < options.plantsPerSpecies % shards ? 1 : 0);
+                    plantCount += coordinator->createPlants(b * shards + shard, SPECIES_TYPES[b], share);
+                }
+            }
+            buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - buildStart).count();
+
+            chrono::steady_clock::time_point runStart = chrono::steady_clock::now();
+            coordinator->advanceDays(options.days);
+            runSeconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+
+            for (int b = 0; b < SPECIES_COUNT; b++)
+            {
+                for (unsigned int shard = 0; shard < shards; shard++)
+                    deaths[SPECIES_NAMES[b]] += coordinator->getCensus(b * shards + shard).byState[Dead::getID()];
+            }
+        }
+        catch (const runtime_error &error)
+        {
+            cerr << error.what() << endl;
+            delete coordinator;
+            return 1;
+        }
+
+        // Copied, since the coordinator and its stats are deleted below
+        TickStats stats = coordinator->getTickStats();
+        unsigned long long p99 = coordinator->getDayLatency().getValueAtPercentile(99.0);
+        unsigned long long slowestTotal = stats.getLatency(TickPhase::Total).getMax();
+        // Workers have exited once the coordinator is gone, so their peak RSS is final
+        delete coordinator;
+
+        double ticksPerSecond = runSeconds > 0 ? options.days / runSeconds : 0;
+        double msPerDay = options.days > 0 ? runSeconds * 1000.0 / options.days : 0;
+        double dayBudgetMs = chrono::duration<double, milli>(Inventory::getTicker()->getPeriod()).count();
+        long workerRssKb = peakRssKb(RUSAGE_CHILDREN);
+
+        cout << fixed << setprecision(2);
+        cout << "Photosyntech headless simulation (sharded)" << endl;
+        cout << "  plants:            " << plantCount << " (" << options.plantsPerSpecies << " x " << SPECIES_COUNT << " species)" << endl;
+        cout << "  shards:            " << shards << " worker processes" << endl;
+        cout << "  days:              " << options.days << endl;
+        cout << "  tick threads:      " << options.threads << " per shard" << endl;
+        cout << "  tick mode:         " << (options.eventDriven ? "event-driven" : "sweep") << endl;
+        cout << "  staff:             0 (not used with --shards)" << endl;
+        cout << "  build time:        " << buildSeconds << " s" << endl;
+        cout << "  run time:          " << runSeconds << " s" << endl;
+        cout << "  ticks/sec:         " << ticksPerSecond << endl;
+        cout << "  plant-ticks/sec:   " << ticksPerSecond * plantCount << endl;
+        cout << "  mean day:          " << msPerDay << " ms (ticker period " << dayBudgetMs << " ms)" << endl;
+        cout << "  day p99:           " << p99 / 1e6 << " ms (slowest shard tick " << slowestTotal / 1e6 << " ms)" << endl;
+        cout << "  plants visited:    " << stats.getTotals().plantsVisited << endl;
+        cout << "  peak worker RSS:   " << workerRssKb << " KB";
+        if (plantCount > 0)
+            cout << " (" << (workerRssKb * 1024.0 * shards / plantCount) << " bytes/plant)";
+        cout << endl;
+
+        cout << "Deaths per species:" << endl;
+        for (int b = 0; b < SPECIES_COUNT; b++)
+            cout << "  " << left << setw(18) << SPECIES_NAMES[b] << right << deaths[SPECIES_NAMES[b]] << " / " << options.plantsPerSpecies << endl;
+
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    SimOptions options = {1250, 365, 1, 1, 0, false, "", "", ""};
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (options.shards > 0)
+    {
+        if (!options.flyweightReport.empty())
+            cerr << "--flyweight-report is ignored with --shards" << endl;
+        return runSharded(options);
+    }
+
+    Inventory *inventory = Inventory::getInstance();
+    PlantGroup *root = inventory->getInventory();
+    inventory->setTickThreads(options.threads);
+    // Nothing reads snapshots in a batch run
+    inventory->setSnapshotPublishing(false);
+
+    // A loaded image brings its own staff
+    for (int i = 0; options.loadImage.empty() && i < options.staff; i++)
+    {
+        Staff *staff = new Staff("Sim Staff " + to_string(i + 1));
+        inventory->addStaff(staff);
+        root->attach(staff);
+    }
+
+    vector<Builder *> builders;
+    builders.push_back(new RoseBuilder());
+    builders.push_back(new SunflowerBuilder());
+    builders.push_back(new CactusBuilder());
+    builders.push_back(new PineBuilder());
+    builders.push_back(new MapleBuilder());
+    builders.push_back(new JadePlantBuilder());
+    builders.push_back(new LavenderBuilder());
+    builders.push_back(new CherryBlossomBuilder());
+
+    vector<string> species;
+    vector<LivingPlant *> plants;
+
+    chrono::steady_clock::time_point buildStart = chrono::steady_clock::now();
+    if (!options.loadImage.empty())
+    {
+        string error;
+        if (!InventoryImage::load(inventory, options.loadImage, error))
+        {
+            cerr << error << endl;
+            return 1;
+        }
+        for (PlantComponent *component : root->getChildren())
+        {
+            LivingPlant *plant = dynamic_cast<LivingPlant *>(component);
+            if (!plant)
+                continue;
+            plants.push_back(plant);
+            if (find(species.begin(), species.end(), plant->getName()) == species.end())
+                species.push_back(plant->getName());
+        }
+    }
+    for (size_t b = 0; options.loadImage.empty() && b < builders.size(); b++)
+    {
+        Director director(builders[b]);
+        director.construct();
+
+        for (int i = 0; i < options.plantsPerSpecies; i++)
+        {
+            PlantComponent *component = director.getPlant();
+            root->addComponent(component);
+
+            LivingPlant *plant = dynamic_cast<LivingPlant *>(component);
+            if (plant)
+            {
+                plants.push_back(plant);
+                if (i == 0)
+                    species.push_back(plant->getName());
+            }
+        }
+    }
+    double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - buildStart).count();
+
+    if (!options.saveImage.empty())
+    {
+        string error;
+        if (!InventoryImage::save(inventory, options.saveImage, error))
+        {
+            cerr << error << endl;
+            return 1;
+        }
+    }
+
+    inventory->setEventDriven(options.eventDriven);
+
+    chrono::steady_clock::time_point runStart = chrono::steady_clock::now();
+    for (int day = 0; day < options.days; day++)
+        inventory->advanceDay();
+    double runSeconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+
+    map<string, int> deaths;
+    map<string, int> perSpecies;
+    for (size_t i = 0; i < species.size(); i++)
+        deaths[species[i]] = 0;
+    Flyweight<MaturityState *> *dead = inventory->getStates(Dead::getID());
+    for (size_t i = 0; i < plants.size(); i++)
+    {
+        perSpecies[plants[i]->getName()]++;
+        if (plants[i]->getMaturityState() == dead)
+            deaths[plants[i]->getName()]++;
+    }
+
+    long plantCount = static_cast<long>(plants.size());
+    double ticksPerSecond = runSeconds > 0 ? options.days / runSeconds : 0;
+    double plantTicksPerSecond = ticksPerSecond * plantCount;
+    double msPerDay = options.days > 0 ? runSeconds * 1000.0 / options.days : 0;
+    double dayBudgetMs = chrono::duration<double, milli>(Inventory::getTicker()->getPeriod()).count();
+    long rssKb = peakRssKb();
+
+    cout << fixed << setprecision(2);
+    cout << "Photosyntech headless simulation" << endl;
+    if (options.loadImage.empty())
+        cout << "  plants:            " << plantCount << " (" << options.plantsPerSpecies << " x " << species.size() << " species)" << endl;
+    else
+        cout << "  plants:            " << plantCount << " (" << species.size() << " species from " << options.loadImage << ")" << endl;
+    cout << "  days:              " << options.days << endl;
+    cout << "  tick threads:      " << inventory->getTickThreads() << endl;
+    cout << "  tick mode:         " << (options.eventDriven ? "event-driven" : "sweep") << endl;
+    cout << "  staff:             " << options.staff << endl;
+    cout << (options.loadImage.empty() ? "  build time:        " : "  image load time:   ") << buildSeconds << " s" << endl;
+    cout << "  run time:          " << runSeconds << " s" << endl;
+    cout << "  ticks/sec:         " << ticksPerSecond << endl;
+    cout << "  plant-ticks/sec:   " << plantTicksPerSecond << endl;
+    cout << "  mean day:          " << msPerDay << " ms (ticker period " << dayBudgetMs << " ms)" << endl;
+    cout << "  peak RSS:          " << rssKb << " KB";
+    if (plantCount > 0)
+        cout << " (" << (rssKb * 1024.0 / plantCount) << " bytes/plant)";
+    cout << endl;
+
+    cout << "Deaths per species:" << endl;
+    for (size_t i = 0; i < species.size(); i++)
+        cout << "  " << left << setw(18) << species[i] << right << deaths[species[i]] << " / " << perSpecies[species[i]] << endl;
+
+    cout << "NFR-1 (one day cycle for up to 10,000 plants): "
+         << ((plantCount >= 10000 && msPerDay <= dayBudgetMs) ? "PASS" : (plantCount < 10000 ? "NOT MEASURED" : "FAIL")) << endl;
+    cout << "NFR-4 (5,000 plants without memory exhaustion): "
+         << (plantCount >= 5000 ? "PASS" : "NOT MEASURED") << endl;
+
+    FlyweightReport sharing = inventory->getFlyweightReport();
+    cout << sharing.toText();
+    if (!options.flyweightReport.empty())
+    {
+        ofstream out(options.flyweightReport.c_str());
+        out << sharing.toJson();
+        if (!out)
+        {
+            cerr << "Could not write " << options.flyweightReport << endl;
+            return 1;
+        }
+    }
+
+    for (size_t b = 0; b < builders.size(); b++)
+        delete builders[b];
+    delete inventory;
+
+    return 0;
+}
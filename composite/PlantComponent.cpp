@@ -1,5 +1,22 @@
 #include "PlantComponent.h"
+#include "PlantGroup.h"
 
 PlantComponent::PlantComponent(double price, int waterAffect, int sunAffect)
-    : price(price), affectWaterValue(waterAffect), affectSunValue(sunAffect)
-{}
\ No newline at end of file
+    : price(price), affectWaterValue(waterAffect), affectSunValue(sunAffect), parent(nullptr), slot(0)
+{}
+
+PlantComponent::PlantComponent(const PlantComponent &other)
+    : price(other.price), affectWaterValue(other.affectWaterValue), affectSunValue(other.affectSunValue),
+      parent(nullptr), slot(0), deleted(other.deleted)
+{}
+
+PlantComponent &PlantComponent::operator=(const PlantComponent &other)
+{
+    price = other.price;
+    affectWaterValue = other.affectWaterValue;
+    affectSunValue = other.affectSunValue;
+    deleted = other.deleted;
+    if (parent)
+        parent->markTotalsDirty();
+    return *this;
+}
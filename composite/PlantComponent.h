@@ -1,10 +1,12 @@
 #ifndef PlantComponent_h
 #define PlantComponent_h
 
+#include <cstdint>
 #include <string>
 
 #include <list>
 class PlantAttributes;
+class PlantGroup;
 
 template <typename T>
 class Flyweight;
@@ -59,10 +61,20 @@ enum class ComponentType
  */
 class PlantComponent
 {
+	friend class PlantGroup;
+
 protected:
 	double price;
 	int affectWaterValue;
 	int affectSunValue;
+
+private:
+	// Group holding this component and its index there, maintained by PlantGroup
+	PlantGroup *parent;
+	std::uint32_t slot;
+
+protected:
+	// Last so that derived members can use the padding after it
 	bool deleted = false;
 
 public:
@@ -74,6 +86,20 @@ public:
 	 * @param sunAffect Sun affection value.
 	 */
 	PlantComponent(double price, int waterAffect, int sunAffect);
+
+	/**
+	 * @brief Copies a component's attributes; the copy belongs to no group.
+	 * @param other Component to copy.
+	 */
+	PlantComponent(const PlantComponent &other);
+
+	/**
+	 * @brief Copies a component's attributes, keeping this one's group.
+	 * @param other Component to copy.
+	 * @return This component.
+	 */
+	PlantComponent &operator=(const PlantComponent &other);
+
 	/**
 	 * @brief Clones the plant component (Prototype pattern).
 	 * @return Pointer to a new plant object that is a copy of this one.
@@ -162,6 +188,12 @@ public:
 
 	virtual Flyweight<std::string *> *getNameFlyweight() = 0;
 	virtual int getHealth() { return 0; };
+
+	/**
+	 * @brief Gets the group this component was last added to.
+	 * @return The group, or nullptr if it is in none.
+	 */
+	PlantGroup *getParent() const { return parent; }
 };
 
 #endif
\ No newline at end of file
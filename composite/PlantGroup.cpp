@@ -1,63 +1,98 @@
 #include "PlantGroup.h"
 #include "../observer/Observer.h"
 #include "../prototype/LivingPlant.h"
+#include "../prototype/PlantStateTable.h"
+#include "../singleton/Singleton.h"
+#include "../simulation/WorkStealingPool.h"
 #include <sstream>
-#include <algorithm>
+#include <memory>
+
+namespace
+{
+    // Children handled by one task in the parallel observer pass
+    const std::size_t PARALLEL_TICK_GRAIN = 256;
+
+    // Removal compacts a group once half its entries are cleared and there are at least this many
+    const std::size_t COMPACT_MIN_REMOVED = 8;
+
+    // Table of the active inventory, which a new group belongs to like a new plant does
+    PlantStateTable *activeTable()
+    {
+        return Inventory::getInstance()->getPlantStates();
+    }
+}
 
 PlantGroup::PlantGroup()
-    : PlantComponent(0.0, 0, 0) {};
+    : PlantComponent(0.0, 0, 0), removedCount(0), plantList(nullptr), table(activeTable()),
+      cachedPrice(0.0), cachedAffectWater(0), cachedAffectSun(0), totalsDirty(true),
+      cachedWater(0), cachedSun(0), cachedLevelsEpoch(0), levelsDirty(true)
+{
+    table->addGroup();
+}
+
+PlantGroup::PlantGroup(PlantStateTable *table)
+    : PlantComponent(0.0, 0, 0), removedCount(0), plantList(nullptr), table(table),
+      cachedPrice(0.0), cachedAffectWater(0), cachedAffectSun(0), totalsDirty(true),
+      cachedWater(0), cachedSun(0), cachedLevelsEpoch(0), levelsDirty(true)
+{
+    table->addGroup();
+}
 
 PlantGroup::~PlantGroup()
 {
-    std::list<PlantComponent *>::iterator itr = plants.begin();
-    while (itr != plants.end())
+    table->markStructureChanged();
+    for (PlantComponent *component : children)
     {
+        if (component == nullptr)
+            continue;
 
-        if ((*itr)->getDecorator() != nullptr)
-            delete (*itr)->getDecorator();
+        if (component->getDecorator() != nullptr)
+            delete component->getDecorator();
         else
-            delete *itr;
-
-        itr++;
-        // should work.
+            delete component;
     }
+    delete plantList;
+    // Last, as it may free a retired table
+    table->releaseGroup();
 }
 
 PlantGroup::PlantGroup(std::string groupName)
-    : PlantComponent(0.0, 0, 0), groupName(groupName)
+    : PlantComponent(0.0, 0, 0), removedCount(0), plantList(nullptr), groupName(groupName), table(activeTable()),
+      cachedPrice(0.0), cachedAffectWater(0), cachedAffectSun(0), totalsDirty(true),
+      cachedWater(0), cachedSun(0), cachedLevelsEpoch(0), levelsDirty(true)
 {
+    table->addGroup();
 }
 
 PlantGroup::PlantGroup(const PlantGroup &other)
-    : PlantComponent(other)
+    : PlantComponent(other), removedCount(0), plantList(nullptr), table(activeTable()),
+      cachedPrice(0.0), cachedAffectWater(0), cachedAffectSun(0), totalsDirty(true),
+      cachedWater(0), cachedSun(0), cachedLevelsEpoch(0), levelsDirty(true)
 {
-
-    for (PlantComponent *component : other.plants)
+    table->addGroup();
+    children.reserve(other.getChildCount());
+    for (PlantComponent *component : other.children)
     {
-        PlantComponent *clonedComponent = component->clone();
-        this->plants.push_back(clonedComponent);
+        if (component != nullptr)
+            adopt(component->clone());
     }
 }
 
 void PlantGroup::setOutside()
 {
-    if (!plants.empty())
+    for (PlantComponent *component : children)
     {
-        for (PlantComponent *component : plants)
-        {
+        if (component != nullptr)
             component->setOutside();
-        }
     }
 };
 
 void PlantGroup::water()
 {
-    if (!plants.empty())
+    for (PlantComponent *component : children)
     {
-        for (PlantComponent *component : plants)
-        {
+        if (component != nullptr)
             component->water();
-        }
     }
 };
 
@@ -68,8 +103,10 @@ std::string PlantGroup::getInfo()
     ss << "\n*** Plant Group ***" << std::endl;
     ss << "---------------------------------" << std::endl;
     int counter = 0;
-    for (PlantComponent *component : plants)
+    for (PlantComponent *component : children)
     {
+        if (component == nullptr)
+            continue;
         counter++;
         ss << component->getDecorator()->getInfo();
 
@@ -82,9 +119,17 @@ std::string PlantGroup::getInfo()
 
 std::list<PlantComponent *> *PlantGroup::getPlants()
 {
-    return &plants;
+    if (plantList == nullptr)
+    {
+        plantList = new std::list<PlantComponent *>();
+        plantListNodes.reserve(children.size());
+        for (PlantComponent *component : children)
+            plantListNodes.push_back(component ? plantList->insert(plantList->end(), component) : plantList->end());
+    }
+    return plantList;
 }
 
+
 ComponentType PlantGroup::getType() const
 {
     return ComponentType::PLANT_GROUP;
@@ -106,104 +151,263 @@ std::string PlantGroup::getGroupName()
 
 void PlantGroup::update()
 {
-
-    for (PlantComponent *component : plants)
+    // Indexed, as observers may add children while being notified
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-
-     
-
-        if (component->getType() != ComponentType::PLANT_GROUP)
-        {
-            if (component->getWaterValue() <= 50)
-                waterNeeded(component);
-            if (component->getSunlightValue() <= 50)
-                sunlightNeeded(component);
-        }
+        PlantComponent *component = children[i];
+        if (component != nullptr && component->getType() != ComponentType::PLANT_GROUP)
+            notifyCareNeeds(component);
     }
 };
 
+void PlantGroup::notifyCareNeeds(PlantComponent *component)
+{
+    if (component->getWaterValue() <= 50)
+        waterNeeded(component);
+    if (component->getSunlightValue() <= 50)
+        sunlightNeeded(component);
+}
+
 int PlantGroup::affectWater()
 {
-    int totalAffected = 0;
+    refreshTotals();
+    return cachedAffectWater;
+};
+
+int PlantGroup::affectSunlight()
+{
+    refreshTotals();
+    return cachedAffectSun;
+};
+
+double PlantGroup::getPrice()
+{
+    refreshTotals();
+    return cachedPrice;
+};
 
-    for (PlantComponent *component : plants)
+void PlantGroup::refreshTotals()
+{
+    if (!totalsDirty.load(std::memory_order_acquire))
+        return;
+
+    double totalPrice = this->price;
+    int totalWater = 0;
+    int totalSun = 0;
+    for (PlantComponent *component : children)
     {
-        totalAffected += component->affectWater();
+        if (component == nullptr)
+            continue;
+        totalPrice += component->getPrice();
+        totalWater += component->affectWater();
+        totalSun += component->affectSunlight();
     }
 
-    return totalAffected;
-};
+    cachedPrice = totalPrice;
+    cachedAffectWater = totalWater;
+    cachedAffectSun = totalSun;
+    totalsDirty.store(false, std::memory_order_release);
+}
 
-int PlantGroup::affectSunlight()
+void PlantGroup::refreshLevels()
 {
-    int totalAffected = 0;
+    unsigned long epoch = table->getLevelsEpoch();
+    if (!levelsDirty.load(std::memory_order_acquire) && cachedLevelsEpoch == epoch)
+        return;
 
-    for (PlantComponent *component : plants)
+    int totalWater = 0;
+    int totalSun = 0;
+    for (PlantComponent *component : children)
     {
-        totalAffected += component->affectSunlight();
+        if (component == nullptr)
+            continue;
+        totalWater += component->getWaterValue();
+        totalSun += component->getSunlightValue();
     }
 
-    return totalAffected;
-};
+    cachedWater = totalWater;
+    cachedSun = totalSun;
+    cachedLevelsEpoch = epoch;
+    levelsDirty.store(false, std::memory_order_release);
+}
 
-double PlantGroup::getPrice()
+void PlantGroup::markTotalsDirty()
 {
-    double totalPrice = this->price;
-    for (PlantComponent *component : plants)
+    // A marked group's ancestors are marked too, so the walk can stop at the first one
+    for (PlantGroup *group = this; group; group = group->getParent())
     {
-        totalPrice += component->getPrice();
+        if (group->totalsDirty.load(std::memory_order_relaxed))
+            break;
+        group->totalsDirty.store(true, std::memory_order_release);
     }
-    return totalPrice;
-};
+}
+
+void PlantGroup::markLevelsDirty()
+{
+    // Loaded before storing so parallel workers marking one group do not contend on it
+    for (PlantGroup *group = this; group; group = group->getParent())
+    {
+        if (group->levelsDirty.load(std::memory_order_relaxed))
+            break;
+        group->levelsDirty.store(true, std::memory_order_release);
+    }
+}
 
 void PlantGroup::addAttribute(PlantComponent *attribute)
 {
-    for (PlantComponent *component : plants)
+    for (PlantComponent *component : children)
     {
+        if (component == nullptr)
+            continue;
         PlantComponent *clonedAttribute = attribute->clone();
         component->addAttribute(clonedAttribute);
     }
+    markTotalsDirty();
 };
 
+void PlantGroup::adopt(PlantComponent *component)
+{
+    component->parent = this;
+    component->slot = static_cast<std::uint32_t>(children.size());
+    children.push_back(component);
+    if (plantList)
+        plantListNodes.push_back(plantList->insert(plantList->end(), component));
+}
+
+void PlantGroup::unlink(std::size_t slot)
+{
+    PlantComponent *component = children[slot];
+    if (component->parent == this && component->slot == slot)
+        component->parent = nullptr;
+    children[slot] = nullptr;
+    removedCount++;
+    if (plantList)
+        plantList->erase(plantListNodes[slot]);
+}
+
+void PlantGroup::compact()
+{
+    if (removedCount == 0)
+        return;
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < children.size(); i++)
+    {
+        PlantComponent *component = children[i];
+        if (component == nullptr)
+            continue;
+        if (component->parent == this && component->slot == i)
+            component->slot = static_cast<std::uint32_t>(kept);
+        children[kept] = component;
+        if (plantList)
+            plantListNodes[kept] = plantListNodes[i];
+        kept++;
+    }
+    children.resize(kept);
+    if (plantList)
+        plantListNodes.resize(kept);
+    removedCount = 0;
+}
+
 void PlantGroup::addComponent(PlantComponent *component)
 {
-    plants.push_back(component);
+    if (component == nullptr)
+        return;
+    adopt(component);
+    markTotalsDirty();
+    markLevelsDirty();
+    table->markStructureChanged();
 }
 
 bool PlantGroup::removeComponent(PlantComponent *component)
 {
-    std::list<PlantComponent *>::iterator it =
-        std::find(plants.begin(), plants.end(), component);
+    if (component == nullptr)
+        return false;
 
-    if (it != plants.end())
+    // The back-pointer names the group holding it; it only has to be inside this one
+    PlantGroup *owner = component->parent;
+    if (owner && component->slot < owner->children.size() && owner->children[component->slot] == component)
     {
-        plants.erase(it);
-        return true;
+        for (PlantComponent *group = owner; group; group = group->parent)
+        {
+            if (group != this)
+                continue;
+
+            owner->unlink(component->slot);
+            if (owner->removedCount >= COMPACT_MIN_REMOVED && owner->removedCount * 2 >= owner->children.size())
+                owner->compact();
+            owner->markTotalsDirty();
+            owner->markLevelsDirty();
+            table->markStructureChanged();
+            return true;
+        }
     }
 
-    for (PlantComponent *child : plants)
+    // Not where its back-pointer says, e.g. added to a second group since
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-        if (child->getType() == ComponentType::PLANT_GROUP)
+        if (children[i] == component)
         {
-            PlantGroup *childGroup = static_cast<PlantGroup *>(child);
-            if (childGroup && childGroup->removeComponent(component))
-            {
-                return true;
-            }
+            unlink(i);
+            markTotalsDirty();
+            markLevelsDirty();
+            table->markStructureChanged();
+            return true;
         }
     }
 
+    for (PlantComponent *child : children)
+    {
+        if (child != nullptr && child->getType() == ComponentType::PLANT_GROUP &&
+            static_cast<PlantGroup *>(child)->removeComponent(component))
+            return true;
+    }
+
     return false;
 }
 
+void PlantGroup::removePlantsInState(Flyweight<MaturityState *> *state, std::vector<LivingPlant *> &removed)
+{
+    bool changed = false;
+
+    for (std::size_t i = 0; i < children.size(); i++)
+    {
+        PlantComponent *component = children[i];
+        if (component == nullptr)
+            continue;
+
+        if (component->getType() == ComponentType::PLANT_GROUP)
+        {
+            static_cast<PlantGroup *>(component)->removePlantsInState(state, removed);
+        }
+        else if (component->getType() == ComponentType::LIVING_PLANT &&
+                 static_cast<LivingPlant *>(component)->getMaturityState() == state)
+        {
+            removed.push_back(static_cast<LivingPlant *>(component));
+            unlink(i);
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        compact();
+        markTotalsDirty();
+        markLevelsDirty();
+        table->markStructureChanged();
+    }
+}
+
 std::string PlantGroup::getName()
 {
     std::stringstream ss;
     ss << "Plant Group: ";
 
     int count = 0;
-    for (PlantComponent *component : plants)
+    for (PlantComponent *component : children)
     {
+        if (component == nullptr)
+            continue;
         if (count < 3)
         {
             ss << component->getName() << ", ";
@@ -244,6 +448,7 @@ void PlantGroup::attach(Observer *careTaker)
     if (!exists)
     {
         observers.push_back(careTaker);
+        table->markStructureChanged();
     }
 }
 
@@ -252,6 +457,7 @@ void PlantGroup::detach(Observer *careTaker)
     if (!careTaker)
         return;
     observers.remove(careTaker);
+    table->markStructureChanged();
 }
 
 /**
@@ -259,6 +465,8 @@ void PlantGroup::detach(Observer *careTaker)
  */
 void PlantGroup::waterNeeded(PlantComponent *updatedPlant)
 {
+    if (!observers.empty())
+        table->addNotifications(observers.size(), 0, 0);
     for (Observer *obs : observers)
     {
         obs->getWaterUpdate(updatedPlant);
@@ -270,6 +478,8 @@ void PlantGroup::waterNeeded(PlantComponent *updatedPlant)
  */
 void PlantGroup::sunlightNeeded(PlantComponent *updatedPlant)
 {
+    if (!observers.empty())
+        table->addNotifications(0, observers.size(), 0);
     for (Observer *obs : observers)
     {
         obs->getSunUpdate(updatedPlant);
@@ -281,6 +491,8 @@ void PlantGroup::sunlightNeeded(PlantComponent *updatedPlant)
  */
 void PlantGroup::stateUpdated(PlantComponent *updatedPlant)
 {
+    if (!observers.empty())
+        table->addNotifications(0, 0, observers.size());
     for (Observer *obs : observers)
     {
         obs->getStateUpdate(updatedPlant);
@@ -289,57 +501,105 @@ void PlantGroup::stateUpdated(PlantComponent *updatedPlant)
 
 void PlantGroup::checkWater()
 {
-    for (PlantComponent *plant : plants)
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-        if (plant->getWaterValue() <= 20)
+        PlantComponent *plant = children[i];
+        if (plant != nullptr && plant->getWaterValue() <= 20)
             waterNeeded(plant);
     }
 }
 void PlantGroup::checkSunlight()
 {
-    for (PlantComponent *plant : plants)
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-
-        if (plant->getSunlightValue() <= 20)
+        PlantComponent *plant = children[i];
+        if (plant != nullptr && plant->getSunlightValue() <= 20)
             waterNeeded(plant);
     }
 }
 void PlantGroup::checkState()
 {
-    for (PlantComponent *plant : plants)
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-        stateUpdated(plant);
+        if (children[i] != nullptr)
+            stateUpdated(children[i]);
     }
 }
 
 int PlantGroup::getWaterValue()
 {
-    int sum = 0;
-
-    for (PlantComponent *plant : plants)
-    {
-        sum += plant->getWaterValue();
-    }
-    return sum;
+    refreshLevels();
+    return cachedWater;
 };
 int PlantGroup::getSunlightValue()
 {
-    int sum = 0;
+    refreshLevels();
+    return cachedSun;
+}
 
-    for (PlantComponent *plant : plants)
+void PlantGroup::tick()
+{
+    this->update();
+
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-        sum += plant->getSunlightValue();
+        if (children[i] != nullptr)
+            children[i]->tick();
     }
-    return sum;
 }
 
-void PlantGroup::tick()
+void PlantGroup::prepareTick()
 {
     this->update();
-    
-    for (PlantComponent *component : plants)
+
+    for (std::size_t i = 0; i < children.size(); i++)
     {
-        component->tick();
+        PlantComponent *component = children[i];
+        if (component == nullptr)
+            continue;
+        if (component->getType() == ComponentType::PLANT_GROUP)
+            static_cast<PlantGroup *>(component)->prepareTick();
+        else if (component->getType() == ComponentType::LIVING_PLANT)
+            static_cast<LivingPlant *>(component)->markForTick();
+        else
+            component->tick();
+    }
+}
+
+void PlantGroup::prepareTick(WorkStealingPool *pool)
+{
+    // Tasks work on a copy, so observers adding children cannot move the array under them
+    std::shared_ptr<const std::vector<PlantComponent *> > snapshot =
+        std::make_shared<const std::vector<PlantComponent *> >(children);
+    PlantGroup *group = this;
+
+    pool->parallelFor(0, snapshot->size(), PARALLEL_TICK_GRAIN,
+                      [group, snapshot, pool](std::size_t begin, std::size_t end)
+                      { group->prepareTickRange(*snapshot, begin, end, pool); });
+}
+
+void PlantGroup::prepareTickRange(const std::vector<PlantComponent *> &snapshot,
+                                  std::size_t begin, std::size_t end, WorkStealingPool *pool)
+{
+    for (std::size_t i = begin; i < end; i++)
+    {
+        PlantComponent *component = snapshot[i];
+        if (component == nullptr)
+            continue;
+
+        if (component->getType() == ComponentType::PLANT_GROUP)
+        {
+            PlantGroup *subgroup = static_cast<PlantGroup *>(component);
+            pool->spawn([subgroup, pool]()
+                        { subgroup->prepareTick(pool); });
+            continue;
+        }
+
+        notifyCareNeeds(component);
+        if (component->getType() == ComponentType::LIVING_PLANT)
+            static_cast<LivingPlant *>(component)->markForTick();
+        else
+            component->tick();
     }
 }
 
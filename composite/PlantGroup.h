@@ -3,10 +3,17 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <atomic>
 #include "PlantComponent.h"
 #include "../observer/Subject.h"
 #include "../decorator/PlantAttributes.h"
 
+class WorkStealingPool;
+class LivingPlant;
+class MaturityState;
+class PlantStateTable;
+
 /**
  * @brief Represents a group of plants in the Composite pattern.
  *
@@ -14,16 +21,63 @@
  * (both individual plants and other groups). Implements operations to traverse
  * and manipulate entire plant collections uniformly. Also acts as a Subject
  * in the Observer pattern, notifying staff of plant care needs.
+ *
+ * **Child storage:**
+ * Children are kept in insertion order in one contiguous array, and each
+ * child records its group and index there (PlantComponent::getParent()).
+ * Removing a child follows that back-pointer and clears its entry in O(1)
+ * instead of searching the group and every subgroup, so the order of the
+ * others is kept. Cleared entries are squeezed out by a later removal once
+ * they make up half the array. getPlants() still offers the children as a
+ * std::list for the iterators and older callers.
+ *
+ * **Aggregate cache:**
+ * getPrice(), affectWater(), affectSunlight(), getWaterValue() and
+ * getSunlightValue() return subtree sums cached in the group. A change to a
+ * child (added, removed, decorated, watered, moved into the sun) marks its
+ * group and every group above it dirty, stopping at the first one already
+ * marked, and only dirty groups sum their children again, reusing the
+ * cached sums of clean subgroups. A day of growth changes every plant at
+ * once, so it invalidates all water and sun sums through one counter
+ * instead (PlantStateTable::markAllLevelsDirty()). Reading an unchanged
+ * total, including the root inventory's, is O(1).
+ *
+ * **Inventory counters:**
+ * Like a LivingPlant, a group is tied to the PlantStateTable of the
+ * inventory active when it is constructed. The structure version, levels
+ * epoch and notification counts it bumps live in that table, so they only
+ * concern the one inventory.
  */
 class PlantGroup : public PlantComponent, public Subject
 {
 private:
-	std::list<PlantComponent *> plants;
+	// Children in insertion order; removed ones leave nullptr until compact()
+	std::vector<PlantComponent *> children;
+	std::size_t removedCount;
+
+	// getPlants() view, built on first use and then kept in step with children
+	std::list<PlantComponent *> *plantList;
+	// Node of each child in plantList, by slot
+	std::vector<std::list<PlantComponent *>::iterator> plantListNodes;
+
 	// This is the list of observers
 	std::list<Observer *> observers;
 
 	std::string groupName = "";
 
+	// Table of the inventory the group belongs to; holds the counters below
+	PlantStateTable *table;
+
+	// Subtree sums behind the aggregate getters, valid while the matching flag is clear
+	double cachedPrice;
+	int cachedAffectWater;
+	int cachedAffectSun;
+	std::atomic<bool> totalsDirty;
+	int cachedWater;
+	int cachedSun;
+	unsigned long cachedLevelsEpoch;
+	std::atomic<bool> levelsDirty;
+
 	/**
 	 * @brief Notifies observers that plants in this group need water.
 	 */
@@ -39,6 +93,37 @@ private:
 	 */
 	void stateUpdated(PlantComponent *updatedPlant);
 
+	/**
+	 * @brief Appends a child and points it back at this group.
+	 */
+	void adopt(PlantComponent *component);
+
+	/**
+	 * @brief Clears a child's entry, leaving nullptr, without compacting.
+	 */
+	void unlink(std::size_t slot);
+
+	/**
+	 * @brief Squeezes out cleared entries and renumbers the children's slots.
+	 */
+	void compact();
+
+	/**
+	 * @brief Sums price and care affects over the children if they are stale.
+	 */
+	void refreshTotals();
+
+	/**
+	 * @brief Sums water and sun levels over the children if they are stale.
+	 */
+	void refreshLevels();
+
+	/**
+	 * @brief Parallel prepareTick() body for children [begin, end) of a snapshot.
+	 */
+	void prepareTickRange(const std::vector<PlantComponent *> &snapshot,
+						  std::size_t begin, std::size_t end, WorkStealingPool *pool);
+
 public:
 	/**
 	 * @brief Constructs a PlantGroup with 0 attributes.
@@ -50,6 +135,16 @@ public:
 	 */
 	PlantGroup(std::string groupName);
 
+	/**
+	 * @brief Constructs an unnamed group tied to a given table.
+	 *
+	 * For an inventory's root group, built before the inventory can be the
+	 * active one.
+	 *
+	 * @param table Table of the inventory the group belongs to.
+	 */
+	explicit PlantGroup(PlantStateTable *table);
+
 	/**
 	 * @brief Copy constructor for deep copying the group hierarchy.
 	 * @param other The PlantGroup object to copy.
@@ -140,19 +235,49 @@ public:
 	ComponentType getType() const;
 
 	/**
-	 * @brief Gets direct access to the internal plants list.
+	 * @brief Gets the children as a list, for the iterators and older callers.
 	 *
-	 * Enables iterators to recursively traverse plant hierarchies without
-	 * needing friend access to private members.
+	 * The list is built on the first call and from then on updated with every
+	 * add and remove (in O(1)), so iterators into it stay valid as they did
+	 * when the group stored a list. It is a view: change the group through
+	 * addComponent() and removeComponent(), not through the list.
 	 *
-	 * @return Pointer to the list of PlantComponent pointers.
+	 * @return Pointer to the list of PlantComponent pointers, owned by the group.
 	 */
 	std::list<PlantComponent *> *getPlants();
+
+	/**
+	 * @brief Gets the children in insertion order.
+	 *
+	 * Entries of removed children read as nullptr until the group is next
+	 * compacted, so callers skip those. The reference is invalidated by the
+	 * next add or remove.
+	 *
+	 * @return The contiguous child array.
+	 */
+	const std::vector<PlantComponent *> &getChildren() const { return children; }
+
+	/**
+	 * @brief Gets the number of direct children.
+	 * @return Child count.
+	 */
+	std::size_t getChildCount() const { return children.size() - removedCount; }
+
+	/**
+	 * @brief Adds a child; it records this group as its parent.
+	 * @param component Component to add; nullptr is ignored.
+	 */
 	void addComponent(PlantComponent *component);
 	virtual PlantComponent *correctShape(PlantComponent *);
 
 	/**
 	 * @brief Removes a component from this group or its subgroups.
+	 *
+	 * A component whose parent is this group or one of its subgroups is found
+	 * through its back-pointer and removed in O(1) plus the depth of the
+	 * nesting. Only a component that is not where its back-pointer says, such
+	 * as one added to two groups, falls back to searching the subtree.
+	 *
 	 * @param component The component to remove.
 	 * @return true if the component was found and removed, false otherwise.
 	 */
@@ -165,8 +290,76 @@ public:
 	virtual int getSunlightValue();
 
 	virtual void tick();
+
+	/**
+	 * @brief Runs the observer pass for this group and all subgroups and marks
+	 * every living plant reached for the next PlantStateTable sweep.
+	 *
+	 * Inventory::tick() uses this in place of tick(): observers are notified in
+	 * the same order as before, while the per-plant grow step is left to a single
+	 * linear sweep over the state table.
+	 */
+	void prepareTick();
+
+	/**
+	 * @brief Parallel form of prepareTick() used by Inventory's parallel tick mode.
+	 *
+	 * The children are split into ranges on the pool and every subgroup becomes
+	 * a task of its own, so one huge group and many small ones balance out by
+	 * work stealing. Observers may be notified from several threads at once.
+	 *
+	 * @param pool Pool the calling task is running on.
+	 */
+	void prepareTick(WorkStealingPool *pool);
 	virtual Flyweight<std::string *> *getNameFlyweight() { return nullptr; };
 
+	/**
+	 * @brief Sends the water/sunlight notifications update() sends for one child.
+	 *
+	 * Public so the event-driven TickScheduler can notify for a single plant
+	 * on the day it is due instead of running update() over the whole group.
+	 */
+	void notifyCareNeeds(PlantComponent *component);
+
+	/**
+	 * @brief Takes every plant in a given state out of this group and its subgroups.
+	 *
+	 * Used by the dead-plant reaper. The plants are only unlinked; the caller
+	 * owns them afterwards.
+	 *
+	 * @param state Maturity state flyweight to match, normally the Dead state.
+	 * @param removed Receives the unlinked plants.
+	 */
+	void removePlantsInState(Flyweight<MaturityState *> *state, std::vector<LivingPlant *> &removed);
+
+	/**
+	 * @brief Checks whether any observer is attached to this group.
+	 * @return True if update() would notify someone.
+	 */
+	bool hasObservers() const { return !observers.empty(); }
+
+	/**
+	 * @brief Gets the table of the inventory the group belongs to.
+	 * @return Table holding the group's structure version, levels epoch and notification counts.
+	 */
+	PlantStateTable *getStateTable() const { return table; }
+
+	/**
+	 * @brief Marks the cached price and care affects of this group and every group above it stale.
+	 *
+	 * Called when a child's price or affects change, e.g. on decoration.
+	 * Stops at the first group already marked, so repeated marks cost O(1).
+	 */
+	void markTotalsDirty();
+
+	/**
+	 * @brief Marks the cached water and sun sums of this group and every group above it stale.
+	 *
+	 * Called when a child's water level or sun exposure changes. Safe to call
+	 * from several tick workers at once.
+	 */
+	void markLevelsDirty();
+
 	void setGroupName(std::string newGroupName);
 	std::string getGroupName();
 	std::list<Observer *> getObservers();
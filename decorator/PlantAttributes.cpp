@@ -1,19 +1,21 @@
 #include "PlantAttributes.h"
+#include "../composite/PlantGroup.h"
+#include "../flyweight/StringInterner.h"
 #include <sstream>
 #include <iomanip>
 
 PlantAttributes::PlantAttributes(std::string name, double price, int waterAffect, int sunAffect)
     : PlantComponent(price, waterAffect, sunAffect),
 
-      nextComponent(nullptr),
-      name(Inventory::getInstance()->getString(name)) {
+      name(StringHandle::of(Inventory::getInstance()->getString(name))),
+      nextComponent(nullptr) {
 
       };
 
 PlantAttributes::PlantAttributes(const PlantAttributes &other)
     : PlantComponent(other),
-      nextComponent(other.nextComponent->clone()),
-      name(other.name) {};
+      name(other.name),
+      nextComponent(other.nextComponent->clone()) {};
 
 void PlantAttributes::water()
 {
@@ -38,7 +40,7 @@ std::string PlantAttributes::getInfo()
     std::string baseInfo = (nextComponent != nullptr) ? nextComponent->getInfo() : "";
     std::stringstream ss;
     ss << baseInfo;
-    ss<< *name->getState() << "\t Price R" << this->price<<std::setprecision(2) << "\t Affect on water\t[" + to_string(this->affectWaterValue) << "]" << "\t Affect on sunlight\t[" + to_string(this->affectSunValue) << "]" << "\n";
+    ss<< *StringInterner::shared().at(name)->getState() << "\t Price R" << this->price<<std::setprecision(2) << "\t Affect on water\t[" + to_string(this->affectWaterValue) << "]" << "\t Affect on sunlight\t[" + to_string(this->affectSunValue) << "]" << "\n";
     return ss.str();
 };
 
@@ -50,9 +52,14 @@ double PlantAttributes::getPrice()
 
 std::string PlantAttributes::getName()
 {
-    return *name->getState();
+    return *StringInterner::shared().at(name)->getState();
 };
 
+Flyweight<std::string *> *PlantAttributes::getNameFlyweight()
+{
+    return StringInterner::shared().at(name);
+}
+
 int PlantAttributes::affectSunlight()
 {
     int baseAffect = (nextComponent) ? nextComponent->affectSunlight() : 0;
@@ -74,6 +81,9 @@ void PlantAttributes::addAttribute(PlantComponent *attribute)
         attribute->addAttribute(nextComponent);
         this->nextComponent = attribute;
     }
+
+    if (getParent())
+        getParent()->markTotalsDirty();
 };
 PlantComponent *PlantAttributes::correctShape(PlantComponent *mainDecorator)
 {
@@ -4,6 +4,7 @@
 #include <string>
 #include "../composite/PlantComponent.h"
 #include "../flyweight/Flyweight.h"
+#include "../flyweight/FlyweightHandle.h"
 #include "../singleton/Singleton.h"
 
 /**
@@ -42,11 +43,13 @@
  */
 class PlantAttributes : public PlantComponent
 {
+	friend class InventoryImage;
+
 protected:
-	PlantComponent *nextComponent;
+	// Name of the attribute, in StringInterner::shared(); declared first to fit in the base's tail padding
+	StringHandle name;
 
-	// Name of the attribute
-	Flyweight<std::string *> *name;
+	PlantComponent *nextComponent;
 
 public:
 	/**
@@ -176,7 +179,7 @@ public:
 	 */
 	virtual void tick();
 
-	virtual Flyweight<std::string *> *getNameFlyweight() { return this->name; };
+	virtual Flyweight<std::string *> *getNameFlyweight();
 };
 
 #endif
@@ -1,9 +1,13 @@
 #include "NurseryFacade.h"
+#include "../simulation/InventorySnapshot.h"
+#include "../simulation/InventoryImage.h"
+#include <stdexcept>
 
 NurseryFacade::NurseryFacade()
 {
 
     director = nullptr;
+    journal = nullptr;
     sales = new SalesFloor();
     suggestionFloor = new SuggestionFloor();
 }
@@ -11,12 +15,26 @@ NurseryFacade::NurseryFacade()
 NurseryFacade::~NurseryFacade()
 {
     delete director;
+    delete journal;
 
     delete sales;
     delete suggestionFloor;
 }
 
 PlantComponent *NurseryFacade::createPlant(const std::string &type)
+{
+    PlantComponent *plant = Inventory::getInstance()->waitForCommand(createPlantAsync(type));
+    waitForJournal();
+    return plant;
+}
+
+std::future<PlantComponent *> NurseryFacade::createPlantAsync(const std::string &type)
+{
+    return Inventory::getInstance()->submit<PlantComponent *>([this, type]()
+                                                              { return buildPlant(type); });
+}
+
+PlantComponent *NurseryFacade::buildPlant(const std::string &type)
 {
     Builder *selectedBuilder = nullptr;
 
@@ -50,6 +68,8 @@ PlantComponent *NurseryFacade::createPlant(const std::string &type)
     plants.push_back(plant);
 
     Inventory::getInstance()->getInventory()->addComponent(plant);
+    if (journal)
+        journal->recordCreated(JournalOp::CreatePlant, plant, type);
     delete selectedBuilder;
     return plant;
 }
@@ -57,18 +77,46 @@ PlantComponent *NurseryFacade::createPlant(const std::string &type)
 void NurseryFacade::waterPlant(PlantComponent *plant)
 {
     if (plant)
-        plant->water();
+        Inventory::getInstance()->waitForCommand(waterPlantAsync(plant));
+}
+
+std::future<void> NurseryFacade::waterPlantAsync(PlantComponent *plant)
+{
+    return Inventory::getInstance()->submit<void>([plant]()
+                                                  {
+                                                      if (plant)
+                                                          plant->water(); });
 }
 
 void NurseryFacade::addSunlight(PlantComponent *plant)
 {
     if (plant)
-        plant->setOutside();
+        Inventory::getInstance()->waitForCommand(addSunlightAsync(plant));
+}
+
+std::future<void> NurseryFacade::addSunlightAsync(PlantComponent *plant)
+{
+    return Inventory::getInstance()->submit<void>([plant]()
+                                                  {
+                                                      if (plant)
+                                                          plant->setOutside(); });
 }
 
 std::string NurseryFacade::getPlantInfo(PlantComponent *plant)
 {
-    return plant ? plant->getInfo() : "No plant selected";
+    if (!plant)
+        return "No plant selected";
+
+    if (plant->getType() == ComponentType::LIVING_PLANT)
+    {
+        SnapshotReader snapshot(Inventory::getInstance()->getSnapshots());
+        const PlantSnapshotEntry *entry = snapshot->findPlant(plant);
+        if (entry)
+            return LivingPlant::formatInfo(entry->values);
+    }
+
+    // Plants outside the inventory (such as in a basket) are not ticked, so are read live
+    return plant->getInfo();
 }
 
 PlantComponent *NurseryFacade::getPlantFromBasket(Customer *customer, int index)
@@ -127,34 +175,58 @@ std::list<PlantComponent *> NurseryFacade::getGroupContents(PlantComponent *grou
 
 PlantGroup *NurseryFacade::createPlantGroup()
 {
-    PlantGroup *newGroup = new PlantGroup();
-    return newGroup;
+    return createPlantGroup("");
 }
 
 PlantGroup *NurseryFacade::createPlantGroup(const std::string &name)
 {
-    PlantGroup *newGroup = new PlantGroup(name);
+    PlantGroup *newGroup = name.empty() ? new PlantGroup() : new PlantGroup(name);
+    if (journal)
+    {
+        journal->recordCreated(JournalOp::CreateGroup, newGroup, name);
+        waitForJournal();
+    }
     return newGroup;
 }
 
 void NurseryFacade::addComponentToGroup(PlantComponent *parent, PlantComponent *child)
 {
-    PlantGroup *group = dynamic_cast<PlantGroup *>(parent);
-    if (group)
-    {
-        group->addComponent(child);
-    }
+    Inventory::getInstance()->waitForCommand(addComponentToGroupAsync(parent, child));
+    waitForJournal();
+}
+
+std::future<void> NurseryFacade::addComponentToGroupAsync(PlantComponent *parent, PlantComponent *child)
+{
+    return Inventory::getInstance()->submit<void>([this, parent, child]()
+                                                  {
+                                                      PlantGroup *group = dynamic_cast<PlantGroup *>(parent);
+                                                      if (group)
+                                                      {
+                                                          group->addComponent(child);
+                                                          if (journal)
+                                                              journal->record(JournalOp::AddToGroup, parent, child);
+                                                      } });
 }
 
 void NurseryFacade::removeComponentFromInventory(PlantComponent *component)
 {
-    PlantComponent *root = Inventory::getInstance()->getInventory();
-    PlantGroup *rootGroup = dynamic_cast<PlantGroup *>(root);
+    Inventory::getInstance()->waitForCommand(removeComponentFromInventoryAsync(component));
+    waitForJournal();
+}
 
-    if (rootGroup)
-    {
-        rootGroup->removeComponent(component);
-    }
+std::future<void> NurseryFacade::removeComponentFromInventoryAsync(PlantComponent *component)
+{
+    return Inventory::getInstance()->submit<void>([this, component]()
+                                                  {
+                                                      PlantComponent *root = Inventory::getInstance()->getInventory();
+                                                      PlantGroup *rootGroup = dynamic_cast<PlantGroup *>(root);
+
+                                                      if (rootGroup)
+                                                      {
+                                                          rootGroup->removeComponent(component);
+                                                          if (journal)
+                                                              journal->record(JournalOp::RemoveFromInventory, component, nullptr);
+                                                      } });
 }
 
 bool NurseryFacade::startNurseryTick()
@@ -169,24 +241,35 @@ bool NurseryFacade::stopNurseryTick()
 
 Customer *NurseryFacade::addCustomer(string name)
 {
-    if (name.empty() != false)
-    {
-        return nullptr;
-    }
-    std::vector<Customer *> *list = Inventory::getInstance()->getCustomers();
-    for (size_t i = 0; i < list->size(); i++)
-    {
-        if ((*list)[i]->getName() == name)
-        {
-            return (*list)[i];
-        }
-    }
-
-    Customer *nCust = new Customer(name);
-    Inventory::getInstance()->addCustomer(nCust);
-    nCust->setSalesFloor(sales);
-    nCust->setSuggestionFloor(suggestionFloor);
-    return nCust;
+    Customer *customer = Inventory::getInstance()->waitForCommand(addCustomerAsync(name));
+    waitForJournal();
+    return customer;
+}
+
+std::future<Customer *> NurseryFacade::addCustomerAsync(string name)
+{
+    return Inventory::getInstance()->submit<Customer *>([this, name]() -> Customer *
+                                                        {
+                                                            if (name.empty() != false)
+                                                            {
+                                                                return nullptr;
+                                                            }
+                                                            std::vector<Customer *> *list = Inventory::getInstance()->getCustomers();
+                                                            for (size_t i = 0; i < list->size(); i++)
+                                                            {
+                                                                if ((*list)[i]->getName() == name)
+                                                                {
+                                                                    return (*list)[i];
+                                                                }
+                                                            }
+
+                                                            Customer *nCust = new Customer(name);
+                                                            nCust->setSalesFloor(sales);
+                                                            nCust->setSuggestionFloor(suggestionFloor);
+                                                            Inventory::getInstance()->addCustomer(nCust);
+                                                            if (journal)
+                                                                journal->recordCreated(nCust);
+                                                            return nCust; });
 }
 
 string NurseryFacade::askForSuggestion(Customer *customer)
@@ -198,46 +281,90 @@ string NurseryFacade::askForSuggestion(Customer *customer)
 }
 bool NurseryFacade::addToCustomerBasket(Customer *customer, PlantComponent *nPlant)
 {
-    if (customer && nPlant)
-    {
-        customer->addPlant(nPlant);
-        Inventory::getInstance()->getInventory()->removeComponent(nPlant);
-        return true;
-    }
-    return false;
+    bool added = Inventory::getInstance()->waitForCommand(addToCustomerBasketAsync(customer, nPlant));
+    waitForJournal();
+    return added;
+}
+std::future<bool> NurseryFacade::addToCustomerBasketAsync(Customer *customer, PlantComponent *nPlant)
+{
+    return Inventory::getInstance()->submit<bool>([this, customer, nPlant]()
+                                                  {
+                                                      if (customer && nPlant)
+                                                      {
+                                                          // Removed first, while its back-pointer still names its inventory group
+                                                          Inventory::getInstance()->getInventory()->removeComponent(nPlant);
+                                                          customer->addPlant(nPlant);
+                                                          if (journal)
+                                                              journal->record(JournalOp::AddToBasket, customer, nPlant);
+                                                          return true;
+                                                      }
+                                                      return false; });
 }
 string NurseryFacade::customerPurchase(Customer *customer)
 {
-    if (customer)
-        return customer->purchasePlants();
-    return "";
+    if (!customer)
+        return "";
+
+    string receipt = Inventory::getInstance()->waitForCommand(customerPurchaseAsync(customer));
+    waitForJournal();
+    return receipt;
+}
+
+std::future<string> NurseryFacade::customerPurchaseAsync(Customer *customer)
+{
+    // The sale deletes the basket and its plants, which must not happen while a tick walks them
+    return Inventory::getInstance()->submit<string>([this, customer]() -> string
+                                                    {
+                                                        if (!customer)
+                                                            return "";
+
+                                                        PlantGroup *basket = customer->getBasket();
+
+                                                        // The basket and its plants are deleted by the sale, so the journal lets go of them first
+                                                        if (journal && basket)
+                                                            journal->forget(basket);
+                                                        string receipt = customer->purchasePlants();
+                                                        if (journal && basket)
+                                                            journal->record(JournalOp::Purchase, customer, nullptr);
+                                                        return receipt; });
 }
 
 Staff *NurseryFacade::addStaff(string name)
+{
+    Staff *staff = Inventory::getInstance()->waitForCommand(addStaffAsync(name));
+    waitForJournal();
+    return staff;
+}
+
+std::future<Staff *> NurseryFacade::addStaffAsync(string name)
 {
     if (name.empty() != false)
     {
         name = "Staff";
     }
 
-    std::vector<Staff *> *list = Inventory::getInstance()->getStaff();
-    for (size_t i = 0; i < list->size(); i++)
-    {
-        if ((*list)[i]->getName() == name)
-        {
-            return (*list)[i];
-        }
-    }
-    Staff *nStaff = new Staff(name);
-    Inventory::getInstance()->addStaff(nStaff);
-    nStaff->setSalesFloor(sales);
-    nStaff->setSuggestionFloor(suggestionFloor);
-    return nStaff;
+    return Inventory::getInstance()->submit<Staff *>([this, name]() -> Staff *
+                                                     {
+                                                         std::vector<Staff *> *list = Inventory::getInstance()->getStaff();
+                                                         for (size_t i = 0; i < list->size(); i++)
+                                                         {
+                                                             if ((*list)[i]->getName() == name)
+                                                             {
+                                                                 return (*list)[i];
+                                                             }
+                                                         }
+                                                         Staff *nStaff = new Staff(name);
+                                                         nStaff->setSalesFloor(sales);
+                                                         nStaff->setSuggestionFloor(suggestionFloor);
+                                                         Inventory::getInstance()->addStaff(nStaff);
+                                                         if (journal)
+                                                             journal->recordCreated(nStaff);
+                                                         return nStaff; });
 }
 
 void NurseryFacade::setObserver(Staff *staff, PlantGroup *plants)
 {
-    plants->attach(staff);
+    setAsObserver(staff, plants);
 }
 
 std::list<PlantComponent *> NurseryFacade::getCustomerPlants(Customer *customer)
@@ -269,36 +396,32 @@ std::vector<string> NurseryFacade::getCustomerBasketString(Customer *customer)
 
 std::vector<string> NurseryFacade::getMenuString()
 {
-    AggPlant *agg = new AggPlant(Inventory::getInstance()->getInventory()->getPlants());
+    SnapshotReader snapshot(Inventory::getInstance()->getSnapshots());
     std::vector<string> plantNames;
-    Iterator *itr = agg->createIterator();
-    while (!itr->isDone())
+    for (size_t i = 0; i < snapshot->getPlantCount(); i++)
     {
-        plantNames.push_back(itr->currentItem()->getName());
-        itr->next();
+        plantNames.push_back(*snapshot->getPlant(i).values.name);
     }
-    delete agg;
-    delete itr;
     return plantNames;
 }
 PlantComponent *NurseryFacade::findPlant(int index)
 {
-    AggPlant *agg = new AggPlant(Inventory::getInstance()->getInventory()->getPlants());
-    Iterator *itr = agg->createIterator();
-    int count = 0;
-    while (!itr->isDone() && count != index)
-    {
-
-        itr->next();
-        count++;
-    }
-    PlantComponent *curr = itr->currentItem();
-    delete agg;
-    delete itr;
-    return curr;
+    SnapshotReader snapshot(Inventory::getInstance()->getSnapshots());
+    if (index < 0 || static_cast<size_t>(index) >= snapshot->getPlantCount())
+        return nullptr;
+    return snapshot->getPlant(index).plant;
 }
 
 PlantComponent *NurseryFacade::removeFromCustomer(Customer *customer, int index)
+{
+    std::future<PlantComponent *> result = Inventory::getInstance()->submit<PlantComponent *>([this, customer, index]()
+                                                                                             { return returnToInventory(customer, index); });
+    PlantComponent *plant = Inventory::getInstance()->waitForCommand(std::move(result));
+    waitForJournal();
+    return plant;
+}
+
+PlantComponent *NurseryFacade::returnToInventory(Customer *customer, int index)
 {
     if (customer && customer->getBasket())
     {
@@ -311,9 +434,11 @@ PlantComponent *NurseryFacade::removeFromCustomer(Customer *customer, int index)
             itr->next();
             count++;
         }
-        customer->getBasket()->getPlants()->remove(itr->currentItem());
         PlantComponent *curr = itr->currentItem();
+        customer->getBasket()->removeComponent(curr);
         Inventory::getInstance()->getInventory()->addComponent(curr);
+        if (journal)
+            journal->record(JournalOp::ReturnFromBasket, customer, nullptr, static_cast<std::uint32_t>(index));
         delete agg;
         delete itr;
         return curr;
@@ -357,42 +482,32 @@ Staff *NurseryFacade::findStaff(int index)
 
 std::vector<string> NurseryFacade::getAllPlantGroups()
 {
-
-    std::list<PlantComponent *> groups = *Inventory::getInstance()->getInventory()->getPlants();
+    SnapshotReader snapshot(Inventory::getInstance()->getSnapshots());
     std::vector<string> groupNames;
     int count = 0;
-    auto itr = groups.begin();
-    while (itr != groups.end())
+    for (size_t i = 0; i < snapshot->getGroupCount(); i++)
     {
-        if (*itr && (*itr)->getType() == ComponentType::PLANT_GROUP)
+        if (snapshot->getGroup(i).topLevel)
         {
             groupNames.push_back("Plant Group " + to_string(count++));
         }
-        itr++;
     }
     return groupNames;
 }
 
 PlantGroup *NurseryFacade::findPlantGroup(int index)
 {
-
-    std::list<PlantComponent *> groups = *Inventory::getInstance()->getInventory()->getPlants();
+    SnapshotReader snapshot(Inventory::getInstance()->getSnapshots());
     int count = 0;
-    auto itr = groups.begin();
-    while (itr != groups.end() && count < index)
-    {
-        if ((*itr)->getType() == ComponentType::PLANT_GROUP)
-        {
-            count++;
-        }
-        itr++;
-    }
-    if (*itr && (*itr)->getType() == ComponentType::PLANT_GROUP)
+    for (size_t i = 0; i < snapshot->getGroupCount(); i++)
     {
-        return static_cast<PlantGroup *>(*itr);
+        if (!snapshot->getGroup(i).topLevel)
+            continue;
+        if (count == index)
+            return snapshot->getGroup(i).group;
+        count++;
     }
-    else
-        return nullptr;
+    return nullptr;
 }
 vector<string> NurseryFacade::getPlantGroupContents(PlantGroup *PlantGroup)
 {
@@ -400,6 +515,18 @@ vector<string> NurseryFacade::getPlantGroupContents(PlantGroup *PlantGroup)
         return {};
 
     vector<string> names;
+    {
+        SnapshotReader snapshot(Inventory::getInstance()->getSnapshots());
+        const GroupSnapshotEntry *entry = snapshot->findGroup(PlantGroup);
+        if (entry)
+        {
+            for (size_t i = entry->begin; i < entry->end; i++)
+                names.push_back(*snapshot->getPlant(i).values.name);
+            return names;
+        }
+    }
+
+    // Groups not yet added to the inventory are not ticked, so are read live
     AggPlant *agg = new AggPlant(PlantGroup->getPlants());
     Iterator *itr = agg->createIterator();
 
@@ -418,21 +545,49 @@ bool NurseryFacade::setAsObserver(Staff *staff, PlantGroup *PG)
 {
     if (PG)
     {
-        PG->attach(staff);
+        Inventory::getInstance()->waitForCommand(setAsObserverAsync(staff, PG));
+        waitForJournal();
         return true;
     }
     return false;
 }
+
+std::future<void> NurseryFacade::setAsObserverAsync(Staff *staff, PlantGroup *PG)
+{
+    // The ticker walks a group's observer list while it notifies
+    return Inventory::getInstance()->submit<void>([this, staff, PG]()
+                                                  {
+                                                      if (PG)
+                                                      {
+                                                          PG->attach(staff);
+                                                          if (journal)
+                                                              journal->record(JournalOp::AttachObserver, staff, PG);
+                                                      } });
+}
+
 bool NurseryFacade::RemoveObserver(Staff *staff, PlantGroup *PG)
 {
     if (PG)
     {
-        PG->detach(staff);
+        Inventory::getInstance()->waitForCommand(RemoveObserverAsync(staff, PG));
+        waitForJournal();
         return true;
     }
     return false;
 }
 
+std::future<void> NurseryFacade::RemoveObserverAsync(Staff *staff, PlantGroup *PG)
+{
+    return Inventory::getInstance()->submit<void>([this, staff, PG]()
+                                                  {
+                                                      if (PG)
+                                                      {
+                                                          PG->detach(staff);
+                                                          if (journal)
+                                                              journal->record(JournalOp::DetachObserver, staff, PG);
+                                                      } });
+}
+
  vector<string> NurseryFacade::getObservers(PlantGroup* pg)
  {
     if (pg)
@@ -453,4 +608,163 @@ bool NurseryFacade::RemoveObserver(Staff *staff, PlantGroup *PG)
     {
         return {};
     }
- }
\ No newline at end of file
+ }
+bool NurseryFacade::openJournal(const std::string &directory, std::string &error)
+{
+    closeJournal();
+
+    InventoryJournal *opened = new InventoryJournal();
+    Inventory *inventory = Inventory::getInstance();
+    std::string image;
+    if (!opened->open(directory, error) ||
+        (!(image = opened->getBaseImage()).empty() && !InventoryImage::load(inventory, image, error)))
+    {
+        delete opened;
+        return false;
+    }
+
+    // The image does not know about floors; loaded staff and customers use this facade's
+    for (size_t i = 0; i < inventory->getStaff()->size(); i++)
+    {
+        (*inventory->getStaff())[i]->setSalesFloor(sales);
+        (*inventory->getStaff())[i]->setSuggestionFloor(suggestionFloor);
+    }
+    for (size_t i = 0; i < inventory->getCustomers()->size(); i++)
+    {
+        (*inventory->getCustomers())[i]->setSalesFloor(sales);
+        (*inventory->getCustomers())[i]->setSuggestionFloor(suggestionFloor);
+    }
+
+    // Replayed calls hand out the same object IDs as the originals but append nothing
+    opened->registerInventory(inventory);
+    opened->setReplaying(true);
+    journal = opened;
+    bool replayed = replayJournal(error);
+    opened->setReplaying(false);
+
+    if (!replayed || !compactJournal(error))
+    {
+        journal = nullptr;
+        delete opened;
+        return false;
+    }
+    return true;
+}
+
+bool NurseryFacade::replayJournal(std::string &error)
+{
+    const std::vector<JournalRecord> &records = journal->getRecovered();
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const JournalRecord &record = records[i];
+        bool applied = true;
+
+        switch (record.op)
+        {
+        case JournalOp::CreatePlant:
+            applied = createPlant(record.text) != nullptr;
+            break;
+        case JournalOp::CreateGroup:
+            createPlantGroup(record.text);
+            break;
+        case JournalOp::AddToGroup:
+        {
+            PlantComponent *parent = journal->getComponent(record.first);
+            PlantComponent *child = journal->getComponent(record.second);
+            applied = parent && child;
+            if (applied)
+                addComponentToGroup(parent, child);
+            break;
+        }
+        case JournalOp::RemoveFromInventory:
+        {
+            PlantComponent *component = journal->getComponent(record.first);
+            applied = component != nullptr;
+            if (applied)
+                removeComponentFromInventory(component);
+            break;
+        }
+        case JournalOp::AddStaff:
+            addStaff(record.text);
+            break;
+        case JournalOp::AddCustomer:
+            applied = addCustomer(record.text) != nullptr;
+            break;
+        case JournalOp::AttachObserver:
+        case JournalOp::DetachObserver:
+        {
+            Staff *staff = journal->getStaff(record.first);
+            PlantGroup *group = dynamic_cast<PlantGroup *>(journal->getComponent(record.second));
+            applied = staff && group;
+            if (applied && record.op == JournalOp::AttachObserver)
+                setAsObserver(staff, group);
+            else if (applied)
+                RemoveObserver(staff, group);
+            break;
+        }
+        case JournalOp::AddToBasket:
+        {
+            Customer *customer = journal->getCustomer(record.first);
+            PlantComponent *plant = journal->getComponent(record.second);
+            applied = customer && plant;
+            if (applied)
+                addToCustomerBasket(customer, plant);
+            break;
+        }
+        case JournalOp::ReturnFromBasket:
+        {
+            Customer *customer = journal->getCustomer(record.first);
+            applied = customer && customer->getBasket() && record.second < customer->getBasket()->getPlants()->size();
+            if (applied)
+                removeFromCustomer(customer, static_cast<int>(record.second));
+            break;
+        }
+        case JournalOp::Purchase:
+        {
+            Customer *customer = journal->getCustomer(record.first);
+            applied = customer != nullptr;
+            if (applied)
+                customerPurchase(customer);
+            break;
+        }
+        }
+
+        if (!applied)
+        {
+            error = "Journal record " + to_string(i + 1) + " does not match the recovered inventory";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NurseryFacade::compactJournal(std::string &error)
+{
+    if (!journal)
+    {
+        error = "No journal is open";
+        return false;
+    }
+
+    InventoryJournal *target = journal;
+    std::string reason;
+    // Run as a command, so no other change lands between the image and the new journal
+    std::future<bool> result = Inventory::getInstance()->submit<bool>([target, &reason]()
+                                                                      { return target->compact(Inventory::getInstance(), reason); });
+    bool compacted = Inventory::getInstance()->waitForCommand(std::move(result));
+    if (!compacted)
+        error = reason;
+    return compacted;
+}
+
+void NurseryFacade::closeJournal()
+{
+    delete journal;
+    journal = nullptr;
+}
+
+void NurseryFacade::waitForJournal()
+{
+    if (journal && !journal->sync())
+        throw std::runtime_error("The change was made but not journaled: " + journal->getFailure());
+}
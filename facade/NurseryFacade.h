@@ -8,6 +8,7 @@
 #include "../composite/PlantComponent.h"
 #include <string>
 #include <vector>
+#include <future>
 #include "../builder/Director.h"
 #include "../builder/SunflowerBuilder.h"
 #include "../builder/RoseBuilder.h"
@@ -39,6 +40,7 @@
 #include "../mediator/SalesFloor.h"
 #include "../mediator/SuggestionFloor.h"
 #include "../iterator/AggPlant.h"
+#include "../simulation/InventoryJournal.h"
 
 /**
  * @brief Unified facade interface for the nursery management system.
@@ -79,6 +81,16 @@
  * - All resource access goes through singleton instance
  * - Staff-customer interactions coordinated via mediators
  * - Plant filtering delegated to iterator factories
+ * - Inventory listings and plant details are read from the latest
+ *   InventorySnapshot, so they never race with the ticker thread; methods that
+ *   change the inventory publish a fresh snapshot before returning
+ * - Methods that change the inventory are queued as commands on the
+ *   Inventory and applied between ticks; the ...Async variants return a
+ *   future instead of waiting, so any number of threads can submit
+ * - With a journal open (openJournal()), every change to stock, groups,
+ *   staff, customers, baskets and observers is also appended to an
+ *   InventoryJournal; the waiting methods return once it is on disk, and
+ *   throw std::runtime_error if the journal has failed to write it
  *
  * @see Singleton (resource hub accessed by facade)
  * @see Builder (plant creation via director)
@@ -94,16 +106,40 @@ private:
     SalesFloor *sales;
     SuggestionFloor *suggestionFloor;
 
+    // Write-ahead journal, nullptr when none is open
+    InventoryJournal *journal;
+
+    PlantComponent *buildPlant(const std::string &type);
+    PlantComponent *returnToInventory(Customer *customer, int index);
+    bool replayJournal(std::string &error);
+    void waitForJournal();
+
 public:
     NurseryFacade();
     ~NurseryFacade();
 
     PlantComponent *createPlant(const std::string &type);
 
+    /**
+     * @brief Queues createPlant() without waiting for it.
+     * @return Future for the new plant, nullptr for an unknown type.
+     */
+    std::future<PlantComponent *> createPlantAsync(const std::string &type);
+
     void waterPlant(PlantComponent *plant);
 
+    /**
+     * @brief Queues waterPlant() without waiting for it.
+     */
+    std::future<void> waterPlantAsync(PlantComponent *plant);
+
     void addSunlight(PlantComponent *plant);
 
+    /**
+     * @brief Queues addSunlight() without waiting for it.
+     */
+    std::future<void> addSunlightAsync(PlantComponent *plant);
+
     std::string getPlantInfo(PlantComponent *plant);
 
     std::vector<std::string> getAvailablePlantTypes();
@@ -118,6 +154,11 @@ public:
 
     void addComponentToGroup(PlantComponent *parent, PlantComponent *child);
 
+    /**
+     * @brief Queues addComponentToGroup() without waiting for it.
+     */
+    std::future<void> addComponentToGroupAsync(PlantComponent *parent, PlantComponent *child);
+
     bool startNurseryTick();
 
     bool stopNurseryTick();
@@ -127,12 +168,23 @@ public:
      */
     Customer *addCustomer(string);
 
+    /**
+     * @brief Queues addCustomer() without waiting for it.
+     * @return Future for the same customer addCustomer() returns.
+     */
+    std::future<Customer *> addCustomerAsync(string);
+
     /**
      * @brief Removes a component from anywhere in the inventory tree.
      * @param component The component to remove.
      */
     void removeComponentFromInventory(PlantComponent *component); // <-- ADD THIS
 
+    /**
+     * @brief Queues removeComponentFromInventory() without waiting for it.
+     */
+    std::future<void> removeComponentFromInventoryAsync(PlantComponent *component);
+
     /**
      * @brief performs the communication of customer to staff member
      */
@@ -143,16 +195,34 @@ public:
      */
     bool addToCustomerBasket(Customer *, PlantComponent *);
 
+    /**
+     * @brief Queues addToCustomerBasket() without waiting for it.
+     * @return Future for the same result addToCustomerBasket() returns.
+     */
+    std::future<bool> addToCustomerBasketAsync(Customer *, PlantComponent *);
+
     /**
      * @brief adds a plant to a customers basket
      */
     string customerPurchase(Customer *);
 
+    /**
+     * @brief Queues customerPurchase() without waiting for it.
+     * @return Future for the receipt.
+     */
+    std::future<string> customerPurchaseAsync(Customer *);
+
     /**
      * @brief adds a Staff member singleton for memory management
      */
     Staff *addStaff(string);
 
+    /**
+     * @brief Queues addStaff() without waiting for it.
+     * @return Future for the same staff member addStaff() returns.
+     */
+    std::future<Staff *> addStaffAsync(string);
+
     /**
      * @brief adds staff as an observer to plantGroup
      */
@@ -183,9 +253,69 @@ PlantComponent* getPlantFromBasket(Customer* customer, int index);
 
     bool setAsObserver(Staff* staff,PlantGroup * PG);
 
+    /**
+     * @brief Queues setAsObserver() without waiting for it.
+     */
+    std::future<void> setAsObserverAsync(Staff *staff, PlantGroup *PG);
+
     bool RemoveObserver(Staff *staff, PlantGroup *PG);
 
+    /**
+     * @brief Queues RemoveObserver() without waiting for it.
+     */
+    std::future<void> RemoveObserverAsync(Staff *staff, PlantGroup *PG);
+
     vector<string> getObservers(PlantGroup* pg);
+
+    /**
+     * @brief Recovers the inventory from a journal directory and starts journaling to it.
+     *
+     * Loads the directory's base image (if any) into the inventory, replays
+     * the journal recorded since, and then compacts, so the directory holds a
+     * single image of the recovered inventory and an empty journal. Call on a
+     * fresh inventory that is not ticking; staff and customers loaded from the
+     * image are connected to this facade's sales and suggestion floors.
+     *
+     * From then on changes made through this facade are journaled. The
+     * waiting methods return once their change is durable, and the ...Async
+     * variants do not wait (see InventoryJournal::sync()). Changes made
+     * directly on the composite, and plant growth, are not journaled.
+     *
+     * If the journal fails to write, every waiting method throws
+     * std::runtime_error after making its change in memory, until
+     * compactJournal() succeeds. Callers of the ...Async variants check
+     * getJournal()->isFailed() themselves.
+     *
+     * @param directory Directory for the base image and journal; created if missing.
+     * @param error Receives the reason on failure.
+     * @return False if the directory cannot be used or a record cannot be replayed.
+     */
+    bool openJournal(const std::string &directory, std::string &error);
+
+    /**
+     * @brief Replaces the journal with a base image of the inventory as it is now.
+     *
+     * Runs as a queued command, so it never overlaps a tick or another queued
+     * change. Groups created but not yet added to the inventory or a basket
+     * are not part of the image, so later changes to them are not journaled.
+     *
+     * @param error Receives the reason on failure.
+     * @return True if the new base image and journal are on disk.
+     */
+    bool compactJournal(std::string &error);
+
+    /**
+     * @brief Syncs and closes the journal; later changes are not journaled.
+     *
+     * Must not run while other threads use the facade.
+     */
+    void closeJournal();
+
+    /**
+     * @brief Gets the open journal.
+     * @return The journal, or nullptr if none is open.
+     */
+    InventoryJournal *getJournal() { return journal; }
     
 };
 
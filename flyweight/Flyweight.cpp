@@ -1,8 +1,9 @@
 #include "Flyweight.h"
 template <class T>
-Flyweight<T>::Flyweight(T data)
+Flyweight<T>::Flyweight(T data, std::uint32_t index)
 {
     this->data = data;
+    this->index = index;
 }
 template <class T>
 T Flyweight<T>::getState()
@@ -1,6 +1,8 @@
 #ifndef Flyweight_h
 #define Flyweight_h
 
+#include <cstdint>
+
 /**
  * @brief Template class for sharing immutable data objects.
  *
@@ -41,13 +43,18 @@ class Flyweight
 {
 	private:
 		T data;
+		std::uint32_t index;
 
 	public:
+		/** Index of a flyweight that was not created by a FlyweightFactory. */
+		static const std::uint32_t UNINDEXED = 0xffffffffu;
+
 		/**
 		 * @brief Constructs a Flyweight with the given data.
 		 * @param data Pointer to the shared data object.
+		 * @param index Slot in the creating factory's dense table.
 		 */
-		Flyweight(T data);
+		Flyweight(T data, std::uint32_t index = UNINDEXED);
 
 		/**
 		 * @brief Gets the shared state data.
@@ -55,6 +62,17 @@ class Flyweight
 		 */
 		T getState();
 
+		/**
+		 * @brief Gets the slot this flyweight occupies in its factory.
+		 *
+		 * Factories number their flyweights 0, 1, 2... in creation order and a
+		 * FlyweightRegistry uses the type's ID, so the index can stand in for
+		 * the pointer (see FlyweightHandle).
+		 *
+		 * @return Dense index, or UNINDEXED if no factory created it.
+		 */
+		std::uint32_t getIndex() const { return index; }
+
 		/**
 		 * @brief Destructor for cleanup.
 		 */
@@ -2,47 +2,219 @@
 template <class ID, class T>
 FlyweightFactory<ID, T>::FlyweightFactory()
 {
-    cache = new unordered_map<ID, Flyweight<T> *>;
+    shards = new Shard[SHARD_COUNT];
+    for (std::size_t i = 0; i < SHARD_COUNT; i++)
+    {
+        shards[i].table.store(newTable(INITIAL_BUCKETS), std::memory_order_relaxed);
+        shards[i].count = 0;
+        shards[i].hits.store(0, std::memory_order_relaxed);
+        shards[i].bytes.store(0, std::memory_order_relaxed);
+    }
+    flyweightCount.store(0, std::memory_order_relaxed);
+    for (unsigned i = 0; i < CHUNK_COUNT; i++)
+        chunks[i].store(nullptr, std::memory_order_relaxed);
 }
 
 template <class ID, class T>
-Flyweight<T> *FlyweightFactory<ID, T>::getFlyweight(ID id, T data)
+unsigned FlyweightFactory<ID, T>::chunkOf(std::uint32_t index, std::uint32_t &offset)
 {
+    if (index < FIRST_CHUNK)
+    {
+        offset = index;
+        return 0;
+    }
+
+    // Chunk k starts at index (FIRST_CHUNK << k) - FIRST_CHUNK
+    std::uint64_t position = static_cast<std::uint64_t>(index) + FIRST_CHUNK;
+    unsigned bit = 0;
+    while ((position >> (bit + 1)) != 0)
+        bit++;
+    offset = static_cast<std::uint32_t>(position - (std::uint64_t(1) << bit));
+    return bit - FIRST_CHUNK_BITS;
+}
 
-    if (cache->find(id) != cache->end())
+template <class ID, class T>
+void FlyweightFactory<ID, T>::publish(Flyweight<T> *flyweight)
+{
+    std::uint32_t offset;
+    unsigned chunk = chunkOf(flyweight->getIndex(), offset);
+    std::atomic<Flyweight<T> *> *slots = chunks[chunk].load(std::memory_order_acquire);
+    if (slots == nullptr)
     {
-        return (*cache)[id];
+        // Shards insert concurrently, so two of them may allocate the same chunk
+        std::size_t size = static_cast<std::size_t>(FIRST_CHUNK) << chunk;
+        std::atomic<Flyweight<T> *> *fresh = new std::atomic<Flyweight<T> *>[size];
+        for (std::size_t i = 0; i < size; i++)
+            fresh[i].store(nullptr, std::memory_order_relaxed);
+        if (chunks[chunk].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel))
+            slots = fresh;
+        else
+            delete[] fresh;
     }
-    else
+    slots[offset].store(flyweight, std::memory_order_release);
+}
+
+template <class ID, class T>
+std::size_t FlyweightFactory<ID, T>::hashOf(const ID &id)
+{
+    // std::hash of an int is the int itself, so spread it before taking bits from it
+    std::uint64_t hash = static_cast<std::uint64_t>(std::hash<ID>()(id));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return static_cast<std::size_t>(hash);
+}
+
+template <class ID, class T>
+typename FlyweightFactory<ID, T>::Table *FlyweightFactory<ID, T>::newTable(std::size_t buckets)
+{
+    Table *table = new Table;
+    table->mask = buckets - 1;
+    table->buckets = new std::atomic<Node *>[buckets];
+    for (std::size_t i = 0; i < buckets; i++)
+        table->buckets[i].store(nullptr, std::memory_order_relaxed);
+    return table;
+}
+
+template <class ID, class T>
+Flyweight<T> *FlyweightFactory<ID, T>::search(Table *table, const ID &id, std::size_t hash)
+{
+    // The low bits chose the shard, so buckets use the bits above them
+    Node *node = table->buckets[(hash / SHARD_COUNT) & table->mask].load(std::memory_order_acquire);
+    while (node)
     {
+        if (node->id == id)
+            return node->flyweight;
+        node = node->next;
+    }
+    return nullptr;
+}
 
-        if (data == NULL)
-        {
+template <class ID, class T>
+Flyweight<T> *FlyweightFactory<ID, T>::find(const ID &id) const
+{
+    std::size_t hash = hashOf(id);
+    Shard &shard = shards[hash % SHARD_COUNT];
+    Flyweight<T> *found = search(shard.table.load(std::memory_order_acquire), id, hash);
+    if (found)
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
 
-            throw "Data given for flyweight is NULL";
-            return nullptr;
-        }
-        else
+template <class ID, class T>
+FlyweightStats FlyweightFactory<ID, T>::getStats() const
+{
+    FlyweightStats stats = FlyweightStats();
+    for (std::size_t i = 0; i < SHARD_COUNT; i++)
+    {
+        stats.hits += shards[i].hits.load(std::memory_order_relaxed);
+        stats.entryBytes += shards[i].bytes.load(std::memory_order_relaxed);
+    }
+    // Nothing is ever evicted, so every miss is still an entry
+    stats.entries = flyweightCount.load(std::memory_order_relaxed);
+    stats.misses = stats.entries;
+    return stats;
+}
+
+template <class ID, class T>
+void FlyweightFactory<ID, T>::grow(Shard &shard)
+{
+    Table *old = shard.table.load(std::memory_order_relaxed);
+    Table *table = newTable((old->mask + 1) * 2);
+
+    // Readers may still be walking the old chains, so they are copied rather than relinked
+    for (std::size_t i = 0; i <= old->mask; i++)
+    {
+        for (Node *node = old->buckets[i].load(std::memory_order_relaxed); node; node = node->next)
         {
-            (*cache)[id] = new Flyweight<T>(data);
+            std::atomic<Node *> &bucket = table->buckets[(hashOf(node->id) / SHARD_COUNT) & table->mask];
+            Node *copy = new Node{node->id, node->flyweight, bucket.load(std::memory_order_relaxed)};
+            bucket.store(copy, std::memory_order_relaxed);
         }
+    }
+
+    shard.table.store(table, std::memory_order_release);
+    shard.retired.push_back(old);
+}
+
+template <class ID, class T>
+Flyweight<T> *FlyweightFactory<ID, T>::getFlyweight(ID id, T data)
+{
+    // Lookups of existing ids take no lock, so the tick workers can share the factory
+    std::size_t hash = hashOf(id);
+    Shard &shard = shards[hash % SHARD_COUNT];
+    Flyweight<T> *found = search(shard.table.load(std::memory_order_acquire), id, hash);
+    if (found)
+    {
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return found;
+    }
+
+    if (data == NULL)
+    {
 
-        return (*cache)[id];
+        throw "Data given for flyweight is NULL";
+        return nullptr;
     }
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+
+    // Another thread may have created it since the lookup above
+    Table *table = shard.table.load(std::memory_order_relaxed);
+    found = search(table, id, hash);
+    if (found)
+    {
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return found;
+    }
+
+    if (shard.count > table->mask)
+    {
+        grow(shard);
+        table = shard.table.load(std::memory_order_relaxed);
+    }
+
+    // The slot is filled before the node is visible, so at() works for anyone who found the flyweight
+    std::uint32_t index = static_cast<std::uint32_t>(flyweightCount.fetch_add(1, std::memory_order_relaxed));
+    Flyweight<T> *flyweight = new Flyweight<T>(data, index);
+    publish(flyweight);
+
+    std::atomic<Node *> &bucket = table->buckets[(hash / SHARD_COUNT) & table->mask];
+    Node *node = new Node{id, flyweight, bucket.load(std::memory_order_relaxed)};
+    bucket.store(node, std::memory_order_release);
+    shard.count++;
+    shard.bytes.fetch_add(sizeof(Flyweight<T>) + sizeof(Node) + flyweightDataBytes(data), std::memory_order_relaxed);
+    return flyweight;
 }
 
 template <class ID, class T>
 FlyweightFactory<ID, T>::~FlyweightFactory()
 {
-    auto itr = cache->begin();
-    while (itr != cache->end())
+    for (std::size_t i = 0; i < SHARD_COUNT; i++)
     {
-        if (itr->second)
+        // Every flyweight has exactly one node in the current table
+        std::vector<Table *> &tables = shards[i].retired;
+        tables.push_back(shards[i].table.load(std::memory_order_relaxed));
+        for (std::size_t t = 0; t < tables.size(); t++)
         {
-            delete itr->second;
+            bool current = t + 1 == tables.size();
+            for (std::size_t b = 0; b <= tables[t]->mask; b++)
+            {
+                Node *node = tables[t]->buckets[b].load(std::memory_order_relaxed);
+                while (node)
+                {
+                    Node *next = node->next;
+                    if (current && node->flyweight)
+                        delete node->flyweight;
+                    delete node;
+                    node = next;
+                }
+            }
+            delete[] tables[t]->buckets;
+            delete tables[t];
         }
-        itr++;
     }
-    cache->clear();
-    delete cache;
-}
\ No newline at end of file
+    delete[] shards;
+    for (unsigned i = 0; i < CHUNK_COUNT; i++)
+        delete[] chunks[i].load(std::memory_order_relaxed);
+}
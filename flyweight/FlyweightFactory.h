@@ -1,8 +1,14 @@
 #ifndef FlyweightFactory_h
 #define FlyweightFactory_h
 
-#include <unordered_map>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
 #include "Flyweight.h"
+#include "FlyweightStats.h"
 #include <iostream>
 using namespace std;
 
@@ -15,48 +21,169 @@ using namespace std;
  *
  * **System Role:**
  * This template factory class is the creator and manager of flyweight instances.
- * Three instances (managed by Singleton) handle caching of water strategies,
- * sun strategies, and season names. Cache lookups are O(log n), enabling efficient
- * access to shared data across thousands of plant instances.
+ * Its only user is StringInterner, which keys it by the text of each interned
+ * string (plant names and season names). Water strategies, sun strategies and
+ * maturity states live in FlyweightRegistry instead. Cache lookups are O(1),
+ * enabling efficient access to shared data across thousands of plant instances.
+ *
+ * **Ownership:**
+ * The factory owns the data of every flyweight it creates. When getFlyweight()
+ * finds the id already cached it does not use `data`; the caller still owns it
+ * and must delete it, as StringInterner::intern() does when it loses a race.
+ *
+ * **Concurrency:**
+ * The cache is split into shards by hash. Each shard is a chained hash table
+ * whose chains are only ever prepended to, so looking up an existing id reads
+ * two atomics and a short chain without taking any lock. Creating a flyweight
+ * locks only its shard, and a shard that fills up is rehashed into a new table
+ * while readers finish on the old one. Flyweights are never moved or freed
+ * before the factory is, so a returned pointer stays valid for its lifetime.
+ * Builders, decorators, parallel plant creation and tick workers can therefore
+ * intern through the same factory at the same time.
+ *
+ * **Dense indices:**
+ * Every flyweight is also numbered 0, 1, 2... in creation order and stored in
+ * a slot table that at() reads with one index. The table is a list of chunks
+ * that double in size and are never moved, so it too is read without a lock.
+ * Plants keep these indices (FlyweightHandle) instead of pointers.
  *
  * **Pattern Role:** Factory (creates and manages Flyweight instances)
  *
  * **Related Patterns:**
  * - Flyweight: Creates instances of this template
- * - Singleton: Three FlyweightFactory instances managed by singleton
- * - Builder: Requests strategy instances during plant construction
- * - Strategy: Factories cache WaterStrategy and SunStrategy instances
- * - Iterator: Season name factories used for filtering
+ * - Singleton: Interns through the process-wide StringInterner::shared()
+ * - Builder: Interns plant names during plant construction
+ * - Iterator: Season names from the factory are used for filtering
  *
  * **System Interactions:**
  * - getFlyweight(ID id) checks cache, returns existing or creates new
  * - Cache prevents duplicate object creation
- * - Singleton manages factory lifetime and global access
+ * - StringInterner owns the factory; Inventory reaches it through getString()
  * - Immutability allows safe sharing across all plants
- * - Memory savings: 5000 plants with 2 strategies = 9998 fewer objects
+ * - Memory savings: 5000 plants named from 8 kinds share 8 name strings
  *
  * @see Flyweight (instances created by factory)
- * @see Singleton (owns factory instances)
- * @see Strategy (flyweight-managed strategies)
+ * @see StringInterner (the factory's user)
  *
- * @tparam T The type of data being shared (e.g., string, WaterStrategy, SunStrategy).
- * @tparam ID The type of identifier used to key the cache (e.g., string, int).
+ * @tparam T The type of data being shared (StringInterner uses std::string*).
+ * @tparam ID The type of identifier used to key the cache (StringInterner uses StringRef).
  */
 template <class ID, class T>
 class FlyweightFactory
 {
 private:
-	unordered_map<ID, Flyweight<T> *> * cache;
+	// Immutable once published: readers follow next without locking
+	struct Node
+	{
+		ID id;
+		Flyweight<T> *flyweight;
+		Node *next;
+	};
+
+	struct Table
+	{
+		std::size_t mask;
+		std::atomic<Node *> *buckets;
+	};
+
+	// Each shard has its own lock; tables it outgrew are kept until destruction
+	struct Shard
+	{
+		std::atomic<Table *> table;
+		std::size_t count;
+		std::mutex lock;
+		std::vector<Table *> retired;
+		// Counted per shard so lookups on different shards do not share a counter
+		std::atomic<unsigned long long> hits;
+		std::atomic<unsigned long long> bytes;
+	};
+
+	static const std::size_t SHARD_COUNT = 16;
+	static const std::size_t INITIAL_BUCKETS = 8;
+
+	// Slot chunk k holds FIRST_CHUNK << k flyweights; 26 chunks cover every 32-bit index
+	static const unsigned FIRST_CHUNK_BITS = 6;
+	static const std::uint32_t FIRST_CHUNK = 1u << FIRST_CHUNK_BITS;
+	static const unsigned CHUNK_COUNT = 32 - FIRST_CHUNK_BITS;
+
+	Shard *shards;
+	std::atomic<std::size_t> flyweightCount;
+	std::atomic<std::atomic<Flyweight<T> *> *> chunks[CHUNK_COUNT];
+
+	FlyweightFactory(const FlyweightFactory &);
+	FlyweightFactory &operator=(const FlyweightFactory &);
+
+	static std::size_t hashOf(const ID &id);
+	static Table *newTable(std::size_t buckets);
+	static Flyweight<T> *search(Table *table, const ID &id, std::size_t hash);
+	static void grow(Shard &shard);
+	static unsigned chunkOf(std::uint32_t index, std::uint32_t &offset);
+	void publish(Flyweight<T> *flyweight);
 
 public:
 	FlyweightFactory();
 	/**
 	 * @brief Gets or creates a flyweight for the given identifier.
+	 *
+	 * If the id is already cached, its flyweight is returned and data is not
+	 * used: the caller still owns it and must delete it, which it can detect by
+	 * comparing the result's getState() with data. Safe to call from any number
+	 * of threads at once.
+	 *
 	 * @param id The identifier for the requested flyweight.
+	 * @param data Shared data for a new flyweight; the factory owns it only if it creates the flyweight.
 	 * @return Pointer to the Flyweight instance (either cached or newly created).
+	 * @throws const char* if the id is not cached and data is NULL.
 	 */
 	Flyweight<T> *getFlyweight(ID id, T data = NULL);
 
+	/**
+	 * @brief Looks up a cached flyweight without creating one.
+	 *
+	 * Wait-free: never takes a lock, so it never waits for an insertion in
+	 * progress.
+	 *
+	 * @param id The identifier to look up.
+	 * @return The cached flyweight, or nullptr if there is none yet.
+	 */
+	Flyweight<T> *find(const ID &id) const;
+
+	/**
+	 * @brief Gets a flyweight by its dense index.
+	 *
+	 * Wait-free, like find(). An index is valid once the flyweight it came
+	 * from (via Flyweight::getIndex()) has been seen.
+	 *
+	 * @param index Value of Flyweight::getIndex() for a flyweight of this factory.
+	 * @return The flyweight, or nullptr if no flyweight has that index.
+	 */
+	Flyweight<T> *at(std::uint32_t index) const
+	{
+		std::uint32_t offset;
+		unsigned chunk = chunkOf(index, offset);
+		if (chunk >= CHUNK_COUNT)
+			return nullptr;
+		std::atomic<Flyweight<T> *> *slots = chunks[chunk].load(std::memory_order_acquire);
+		return slots ? slots[offset].load(std::memory_order_acquire) : nullptr;
+	}
+
+	/**
+	 * @brief Gets the hit, miss and size counters.
+	 *
+	 * find() and getFlyweight() count a hit when the id is cached; a miss is
+	 * a getFlyweight() that created the flyweight. Bytes cover the flyweights,
+	 * their cache nodes and flyweightDataBytes() of their data.
+	 *
+	 * @return Counters since construction.
+	 */
+	FlyweightStats getStats() const;
+
+	/**
+	 * @brief Gets the number of cached flyweights.
+	 * @return Count of distinct ids created so far.
+	 */
+	std::size_t getSize() const { return flyweightCount.load(std::memory_order_relaxed); }
+
 	/**
 	 * @brief Destructor that cleans up cached flyweights.
 	 */
@@ -0,0 +1,78 @@
+#ifndef FlyweightHandle_h
+#define FlyweightHandle_h
+
+#include <cstdint>
+#include <string>
+#include "Flyweight.h"
+
+class WaterStrategy;
+class SunStrategy;
+
+/**
+ * @brief Compact typed reference to a flyweight: its dense index in a factory.
+ *
+ * Stands in for a Flyweight<T> pointer where many objects hold one, such as
+ * the name, season and strategies of every LivingPlant. The handle is only as
+ * wide as Index (8 bits for the four strategies of a kind, 32 bits for
+ * interned strings) and is turned back into the flyweight with
+ * FlyweightFactory::at(), a single array index. T keeps handles of different
+ * kinds from being mixed up.
+ *
+ * The all-ones value is reserved for "no flyweight", the handle form of
+ * nullptr.
+ *
+ * @tparam T Data type of the flyweight referred to.
+ * @tparam Index Unsigned integer type holding the index.
+ *
+ * @see FlyweightFactory::at(), Flyweight::getIndex()
+ */
+template <class T, class Index>
+struct FlyweightHandle
+{
+	Index index;
+
+	/** Index of the empty handle. */
+	static const Index NONE = static_cast<Index>(~static_cast<Index>(0));
+
+	/**
+	 * @brief Gets the empty handle.
+	 * @return Handle referring to no flyweight.
+	 */
+	static FlyweightHandle none()
+	{
+		FlyweightHandle handle;
+		handle.index = NONE;
+		return handle;
+	}
+
+	/**
+	 * @brief Gets the handle of a factory-created flyweight.
+	 * @param flyweight Flyweight to refer to, or nullptr.
+	 * @return Handle holding its index; none() for nullptr or an index that does not fit.
+	 */
+	static FlyweightHandle of(Flyweight<T> *flyweight)
+	{
+		FlyweightHandle handle = none();
+		if (flyweight && flyweight->getIndex() < static_cast<std::uint32_t>(NONE))
+			handle.index = static_cast<Index>(flyweight->getIndex());
+		return handle;
+	}
+
+	/**
+	 * @brief Checks for the empty handle.
+	 * @return True if the handle refers to no flyweight.
+	 */
+	bool isNone() const { return index == NONE; }
+
+	bool operator==(const FlyweightHandle &other) const { return index == other.index; }
+	bool operator!=(const FlyweightHandle &other) const { return index != other.index; }
+};
+
+/** Interned string (plant, season and decorator names). */
+typedef FlyweightHandle<std::string *, std::uint32_t> StringHandle;
+/** One of an inventory's water strategies. */
+typedef FlyweightHandle<WaterStrategy *, std::uint8_t> WaterHandle;
+/** One of an inventory's sun strategies. */
+typedef FlyweightHandle<SunStrategy *, std::uint8_t> SunHandle;
+
+#endif
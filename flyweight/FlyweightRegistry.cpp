@@ -0,0 +1,40 @@
+#include "FlyweightRegistry.h"
+template <class T, std::size_t SIZE>
+FlyweightRegistry<T, SIZE>::FlyweightRegistry()
+    : entries(0), entryBytes(0), hits(0), misses(0)
+{
+    for (std::size_t i = 0; i < SIZE; i++)
+        slots[i] = nullptr;
+}
+
+template <class T, std::size_t SIZE>
+template <class Type>
+bool FlyweightRegistry<T, SIZE>::add()
+{
+    int id = Type::getID();
+    if (id < 0 || static_cast<std::size_t>(id) >= SIZE || slots[id] != nullptr)
+        return false;
+
+    slots[id] = new Flyweight<T>(new Type(), static_cast<std::uint32_t>(id));
+    entries++;
+    entryBytes += sizeof(Flyweight<T>) + sizeof(Type);
+    return true;
+}
+
+template <class T, std::size_t SIZE>
+FlyweightStats FlyweightRegistry<T, SIZE>::getStats() const
+{
+    FlyweightStats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.entries = entries;
+    stats.entryBytes = entryBytes;
+    return stats;
+}
+
+template <class T, std::size_t SIZE>
+FlyweightRegistry<T, SIZE>::~FlyweightRegistry()
+{
+    for (std::size_t i = 0; i < SIZE; i++)
+        delete slots[i];
+}
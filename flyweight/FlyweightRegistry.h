@@ -0,0 +1,119 @@
+#ifndef FlyweightRegistry_h
+#define FlyweightRegistry_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Flyweight.h"
+#include "FlyweightStats.h"
+
+/**
+ * @brief Fixed-size table of flyweights indexed directly by their type's ID.
+ *
+ * Holds the few flyweights of a closed family, such as the water strategies
+ * or the maturity states, in an array whose size is fixed at compile time.
+ * Looking one up is a bounds check and an array read: there is no hashing,
+ * no lock and no exception on a miss. Each flyweight's index (see
+ * Flyweight::getIndex()) is its ID, so a FlyweightHandle of a registered
+ * flyweight is simply the ID.
+ *
+ * **Adding a type:**
+ * A new strategy or state is registered with one add<Type>() call next to
+ * the others in the Inventory constructor, plus the include of its header.
+ * Its ID must be below SIZE. Together with the new class's own files this
+ * keeps a new care routine within NFR-2's two modified files.
+ *
+ * **System Role:**
+ * Inventory keeps one registry each for water strategies, sun strategies
+ * and maturity states; getWaterFly(), getSunFly() and getStates() read them.
+ *
+ * @tparam T Shared data type (e.g. WaterStrategy *).
+ * @tparam SIZE Number of ID slots; IDs run from 0 to SIZE - 1.
+ *
+ * @see Inventory, FlyweightHandle
+ */
+template <class T, std::size_t SIZE>
+class FlyweightRegistry
+{
+private:
+	Flyweight<T> *slots[SIZE];
+	std::size_t entries;
+	std::size_t entryBytes;
+	mutable std::atomic<unsigned long long> hits;
+	mutable std::atomic<unsigned long long> misses;
+
+	FlyweightRegistry(const FlyweightRegistry &);
+	FlyweightRegistry &operator=(const FlyweightRegistry &);
+
+public:
+	/** Number of ID slots. */
+	static const std::size_t CAPACITY = SIZE;
+
+	/**
+	 * @brief Creates a registry with every slot empty.
+	 */
+	FlyweightRegistry();
+
+	/**
+	 * @brief Deletes the registered flyweights and their data.
+	 */
+	~FlyweightRegistry();
+
+	/**
+	 * @brief Registers a new instance of Type under Type::getID().
+	 * @tparam Type Concrete class with a static getID() and a default constructor.
+	 * @return False, and nothing is created, if the ID is out of range or already taken.
+	 */
+	template <class Type>
+	bool add();
+
+	/**
+	 * @brief Looks up a registered flyweight.
+	 *
+	 * Not counted in getStats(), so the tick and other internal lookups do
+	 * not pass for sharing; see share().
+	 *
+	 * @param id ID of the type, any value.
+	 * @return The flyweight, or nullptr if nothing is registered under id.
+	 */
+	Flyweight<T> *find(int id) const
+	{
+		return (id >= 0 && static_cast<std::size_t>(id) < SIZE) ? slots[id] : nullptr;
+	}
+
+	/**
+	 * @brief Looks up a flyweight that a plant is about to keep a handle to.
+	 *
+	 * Counted in getStats(): a hit is one more reference sharing the
+	 * flyweight, a miss an ID nothing is registered under.
+	 *
+	 * @param id ID of the type, any value.
+	 * @return The flyweight, or nullptr if nothing is registered under id.
+	 */
+	Flyweight<T> *share(int id) const
+	{
+		Flyweight<T> *found = find(id);
+		(found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+		return found;
+	}
+
+	/**
+	 * @brief Looks up a flyweight by index, the form a FlyweightHandle holds.
+	 * @param index Flyweight::getIndex() of a registered flyweight.
+	 * @return The flyweight, or nullptr if nothing is registered there.
+	 */
+	Flyweight<T> *at(std::uint32_t index) const
+	{
+		return index < SIZE ? slots[index] : nullptr;
+	}
+
+	/**
+	 * @brief Gets the sharing and size counters.
+	 * @return Counters of share() since construction; bytes use sizeof each registered type.
+	 */
+	FlyweightStats getStats() const;
+};
+
+#include "FlyweightRegistry.cpp"
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef FlyweightStats_h
+#define FlyweightStats_h
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Sharing counters of one flyweight factory or registry.
+ *
+ * A hit is a handle given out to an existing flyweight, a miss one that had
+ * to create it (or, for a FlyweightRegistry, named an unknown ID). Lookups
+ * that do not hand a flyweight to a holder are not counted.
+ *
+ * @see FlyweightFactory::getStats(), FlyweightRegistry::getStats()
+ */
+struct FlyweightStats
+{
+	unsigned long long hits;
+	unsigned long long misses;
+	/** Flyweights currently held. */
+	unsigned long long entries;
+	/** Estimated heap bytes of those flyweights and the data they share. */
+	unsigned long long entryBytes;
+
+	/**
+	 * @brief Estimates the bytes sharing saves over giving every holder its own copy.
+	 *
+	 * Unshared, each reference would carry a copy of an average entry; shared,
+	 * the entries exist once and each reference carries only a handle.
+	 *
+	 * @param references Number of holders referring to the flyweights.
+	 * @param handleBytes Size of the handle or pointer each holder keeps.
+	 * @return Copies minus entries and handles; negative if sharing costs more.
+	 */
+	long long bytesSaved(unsigned long long references, unsigned long long handleBytes) const
+	{
+		if (entries == 0)
+			return 0;
+		double copies = static_cast<double>(references) * entryBytes / entries;
+		return static_cast<long long>(copies) - static_cast<long long>(entryBytes + references * handleBytes);
+	}
+};
+
+/**
+ * @brief Estimates the bytes a flyweight's shared data occupies.
+ * @param data Shared object.
+ * @return sizeof the object; its dynamic type is not known here.
+ */
+template <class D>
+std::size_t flyweightDataBytes(const D *data)
+{
+	return data ? sizeof(D) : 0;
+}
+
+/**
+ * @brief Estimates the bytes a shared string occupies, including its heap buffer.
+ * @param data Shared string.
+ * @return sizeof(std::string), plus the buffer unless it is stored inline.
+ */
+inline std::size_t flyweightDataBytes(const std::string *data)
+{
+	if (!data)
+		return 0;
+	const char *buffer = data->data();
+	const char *object = reinterpret_cast<const char *>(data);
+	bool inlineBuffer = buffer >= object && buffer < object + sizeof(std::string);
+	return sizeof(std::string) + (inlineBuffer ? 0 : data->capacity() + 1);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include "StringInterner.h"
+
+StringInterner::StringInterner()
+    : blockUsed(0), blockSize(0), arenaBytes(0)
+{
+}
+
+StringInterner::~StringInterner()
+{
+    for (std::size_t i = 0; i < blocks.size(); i++)
+        delete[] blocks[i];
+}
+
+const char *StringInterner::store(const char *text, std::size_t length)
+{
+    std::lock_guard<std::mutex> guard(arenaLock);
+    arenaBytes += length;
+
+    if (length > BLOCK_SIZE / 4)
+    {
+        // Kept out of the shared blocks so one long string does not waste the rest of a block
+        char *own = new char[length];
+        std::memcpy(own, text, length);
+        blocks.insert(blocks.begin(), own);
+        return own;
+    }
+
+    if (blocks.empty() || blockSize - blockUsed < length)
+    {
+        blocks.push_back(new char[BLOCK_SIZE]);
+        blockSize = BLOCK_SIZE;
+        blockUsed = 0;
+    }
+    char *stored = blocks.back() + blockUsed;
+    std::memcpy(stored, text, length);
+    blockUsed += length;
+    return stored;
+}
+
+Flyweight<std::string *> *StringInterner::find(const char *text, std::size_t length) const
+{
+    return table.find(StringRef(text, length));
+}
+
+Flyweight<std::string *> *StringInterner::intern(const char *text, std::size_t length)
+{
+    Flyweight<std::string *> *existing = table.find(StringRef(text, length));
+    if (existing)
+        return existing;
+
+    // Two threads may both get here; the loser's copy stays unused in the arena
+    StringRef key(store(text, length), length);
+    std::string *data = new std::string(text, length);
+    Flyweight<std::string *> *fly = table.getFlyweight(key, data);
+    if (fly->getState() != data)
+        delete data;
+    return fly;
+}
+
+StringHandle StringInterner::handleOf(Flyweight<std::string *> *flyweight)
+{
+    if (flyweight == nullptr)
+        return StringHandle::none();
+    if (table.at(flyweight->getIndex()) == flyweight)
+        return StringHandle::of(flyweight);
+
+    const std::string *text = flyweight->getState();
+    return StringHandle::of(intern(text->data(), text->size()));
+}
+
+FlyweightStats StringInterner::getStats()
+{
+    FlyweightStats stats = table.getStats();
+    stats.entryBytes += getArenaBytes();
+    return stats;
+}
+
+StringInterner &StringInterner::shared()
+{
+    static StringInterner interner;
+    return interner;
+}
+
+std::size_t StringInterner::getArenaBytes()
+{
+    std::lock_guard<std::mutex> guard(arenaLock);
+    return arenaBytes;
+}
@@ -0,0 +1,175 @@
+#ifndef StringInterner_h
+#define StringInterner_h
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "FlyweightFactory.h"
+#include "FlyweightHandle.h"
+
+/**
+ * @brief Non-owning view of a run of characters, used as an intern table key.
+ *
+ * Compared by content, so a view of the caller's characters finds the entry
+ * whose key is a view into the interner's arena.
+ */
+struct StringRef
+{
+	const char *data;
+	std::size_t length;
+
+	StringRef(const char *data, std::size_t length) : data(data), length(length) {}
+
+	bool operator==(const StringRef &other) const
+	{
+		return length == other.length && std::memcmp(data, other.data, length) == 0;
+	}
+};
+
+namespace std
+{
+	template <>
+	struct hash<StringRef>
+	{
+		std::size_t operator()(const StringRef &text) const
+		{
+			// FNV-1a; FlyweightFactory mixes the result further
+			std::uint64_t hash = 14695981039346656037ull;
+			for (std::size_t i = 0; i < text.length; i++)
+			{
+				hash ^= static_cast<unsigned char>(text.data[i]);
+				hash *= 1099511628211ull;
+			}
+			return static_cast<std::size_t>(hash);
+		}
+	};
+}
+
+/**
+ * @brief Intern table of shared strings whose lookups never allocate.
+ *
+ * Keys are StringRefs into an append-only arena of character data, so a
+ * lookup only hashes and compares the caller's characters: no std::string is
+ * built, and an existing string is returned without taking a lock (the table
+ * is a FlyweightFactory). Only the first intern() of a string allocates: its
+ * characters are appended to the arena and a std::string is created for the
+ * flyweight. Arena blocks are never moved or freed before the interner, so
+ * keys, flyweights and the strings they hold stay valid for its lifetime.
+ *
+ * Each string's flyweight also has a dense index, so holders can keep a
+ * 32-bit StringHandle instead of a pointer and resolve it with at().
+ *
+ * **System Role:**
+ * shared() backs Inventory::getString(), which every LivingPlant and
+ * PlantAttributes constructor calls for its name. It is one table for the
+ * whole process, so a StringHandle means the same string whichever inventory
+ * is active when it is resolved.
+ *
+ * @see FlyweightFactory, Inventory::getString()
+ */
+class StringInterner
+{
+private:
+	FlyweightFactory<StringRef, std::string *> table;
+
+	// Character data of every key, in blocks that never move
+	std::mutex arenaLock;
+	std::vector<char *> blocks;
+	std::size_t blockUsed;
+	std::size_t blockSize;
+	std::size_t arenaBytes;
+
+	StringInterner(const StringInterner &);
+	StringInterner &operator=(const StringInterner &);
+
+	const char *store(const char *text, std::size_t length);
+
+public:
+	/** Size of a regular arena block; longer strings get a block of their own. */
+	static const std::size_t BLOCK_SIZE = 4096;
+
+	/**
+	 * @brief Creates an empty interner.
+	 */
+	StringInterner();
+
+	/**
+	 * @brief Frees the flyweights, their strings and the arena.
+	 */
+	~StringInterner();
+
+	/**
+	 * @brief Gets the shared flyweight for a string, creating it on first use.
+	 *
+	 * Safe to call from any number of threads at once.
+	 *
+	 * @param text First character; need not be null-terminated.
+	 * @param length Number of characters.
+	 * @return Flyweight whose state holds a copy of the characters.
+	 */
+	Flyweight<std::string *> *intern(const char *text, std::size_t length);
+
+	/**
+	 * @brief Gets the shared flyweight for a string, creating it on first use.
+	 * @param text String to intern.
+	 * @return Flyweight whose state equals text.
+	 */
+	Flyweight<std::string *> *intern(const std::string &text) { return intern(text.data(), text.size()); }
+
+	/**
+	 * @brief Looks up a string without interning it.
+	 * @param text First character.
+	 * @param length Number of characters.
+	 * @return The flyweight, or nullptr if the string has not been interned.
+	 */
+	Flyweight<std::string *> *find(const char *text, std::size_t length) const;
+
+	/**
+	 * @brief Gets the flyweight a handle refers to.
+	 * @param handle Handle from handleOf() on this interner.
+	 * @return The flyweight, or nullptr for StringHandle::none().
+	 */
+	Flyweight<std::string *> *at(StringHandle handle) const
+	{
+		return handle.isNone() ? nullptr : table.at(handle.index);
+	}
+
+	/**
+	 * @brief Gets the handle of a string flyweight.
+	 *
+	 * A flyweight from another factory is interned by content first.
+	 *
+	 * @param flyweight Flyweight to refer to, or nullptr.
+	 * @return Handle resolving to this interner's flyweight for the same string.
+	 */
+	StringHandle handleOf(Flyweight<std::string *> *flyweight);
+
+	/**
+	 * @brief Gets the interner shared by every Inventory.
+	 * @return Process-wide interner, created on first use.
+	 */
+	static StringInterner &shared();
+
+	/**
+	 * @brief Gets the interner's hit, miss and size counters.
+	 * @return The table's counters, with the arena's key characters added to the bytes.
+	 */
+	FlyweightStats getStats();
+
+	/**
+	 * @brief Gets the number of distinct strings interned.
+	 * @return String count.
+	 */
+	std::size_t getSize() const { return table.getSize(); }
+
+	/**
+	 * @brief Gets the character data held by the arena.
+	 * @return Bytes of keys stored, excluding unused block space.
+	 */
+	std::size_t getArenaBytes();
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "Mediator.h"
 #include "../singleton/Singleton.h"
+#include "../simulation/FastRandom.h"
 #include <iostream>
 
 /**
@@ -10,3 +11,7 @@
  * lists directly from the Singleton instance.
  */
 
+std::size_t Mediator::pickStaff(std::size_t count)
+{
+    return FastRandom::local().below(static_cast<std::uint32_t>(count));
+}
@@ -1,6 +1,7 @@
 #ifndef Mediator_h
 #define Mediator_h
 
+#include <cstddef>
 #include <vector>
 #include "User.h"
 #include "Staff.h"
@@ -42,6 +43,13 @@ class Mediator
 		std::vector<User*> customerList;
 		std::vector<Staff*> staffList;
 
+		/**
+		 * @brief Picks a staff member at random with the calling thread's FastRandom.
+		 * @param count Number of staff to choose from; must be at least 1.
+		 * @return Index in [0, count).
+		 */
+		static std::size_t pickStaff(std::size_t count);
+
 	public:
 	
 		/**
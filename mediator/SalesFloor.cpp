@@ -3,15 +3,12 @@
 #include "Customer.h"
 #include "../singleton/Singleton.h"
 #include <iostream>
-#include <cstdlib>
-#include <ctime>
 
 /**
  * @brief Constructs a new SalesFloor mediator.
  */
 SalesFloor::SalesFloor()
 {
-    std::srand(std::time(0));
     std::cout << "SalesFloor: Sales floor mediator initialized" << std::endl;
 }
 
@@ -40,7 +37,7 @@ string SalesFloor::getAssistance(User *customer)
     }
 
     // random staff selection
-    int randomIndex = std::rand() % staffList.size();
+    std::size_t randomIndex = pickStaff(staffList.size());
     Staff *availableStaff = staffList[randomIndex];
 
     std::cout << "SalesFloor: Assigning customer to staff member " << randomIndex << std::endl;
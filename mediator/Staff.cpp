@@ -1,8 +1,7 @@
 #include "Staff.h"
 #include "../composite/PlantGroup.h"
 #include "../singleton/Singleton.h"
-#include <cstdlib>
-#include <ctime>
+#include "../simulation/FastRandom.h"
 #include <sstream>
 #include <iostream>
 
@@ -44,14 +43,12 @@ string Staff::assistSuggestion()
     }
 
     PlantGroup* currentInventory = inventory->getInventory();
-    if (!currentInventory || currentInventory->getPlants()->empty()) {
+    if (!currentInventory || currentInventory->getChildCount() == 0) {
         return "I'm sorry, but our inventory is currently empty. Please check back later when we have new plants in stock.\n";
     }
 
-    auto plants = currentInventory->getPlants();
-    
     std::vector<PlantComponent*> availablePlants;
-    for (auto plant : *plants) {
+    for (auto plant : currentInventory->getChildren()) {
         if (plant) {
             availablePlants.push_back(plant);
         }
@@ -61,8 +58,8 @@ string Staff::assistSuggestion()
         return "We have plants in inventory, but none are available for recommendations at the moment.\n";
     }
 
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-    int idx = std::rand() % availablePlants.size();
+    FastRandom &random = FastRandom::local();
+    std::size_t idx = random.below(static_cast<std::uint32_t>(availablePlants.size()));
     PlantComponent* selectedPlant = availablePlants[idx];
     std::string plantType = selectedPlant->getName();
 
@@ -121,7 +118,7 @@ string Staff::assistSuggestion()
         "This variety has been particularly popular with our customers lately."
     };
     
-    int commentIdx = std::rand() % expertiseComments.size();
+    std::size_t commentIdx = random.below(static_cast<std::uint32_t>(expertiseComments.size()));
     recommendation += expertiseComments[commentIdx] + " Would you like me to show you where we keep them?\n";
     
     return recommendation;
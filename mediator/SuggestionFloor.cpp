@@ -3,15 +3,12 @@
 #include "Customer.h"
 #include "../singleton/Singleton.h"
 #include <iostream>
-#include <cstdlib>
-#include <ctime>
 
 /**
  * @brief Constructs a new SuggestionFloor mediator.
  */
 SuggestionFloor::SuggestionFloor()
 {
-    std::srand(std::time(0));
     std::cout << "SuggestionFloor: Suggestion floor mediator initialized" << std::endl;
 }
 
@@ -30,7 +27,7 @@ string SuggestionFloor::getAssistance(User *customer)
     }
 
     // Random staff selection
-    int randomIndex = std::rand() % staffList.size();
+    std::size_t randomIndex = pickStaff(staffList.size());
     Staff *availableStaff = staffList[randomIndex];
 
     // Use the existing assistSuggestion() method
@@ -59,6 +59,12 @@ public:
 	 * @return Pointer to a new Herb object that is a copy of this one.
 	 */
 	PlantComponent *clone();
+
+	/**
+	 * @brief Gets the base plant type.
+	 * @return PlantSpecies::Herb
+	 */
+	PlantSpecies getSpecies() const;
 };
 
 #endif
@@ -5,122 +5,139 @@
 #include "Succulent.h"
 #include "Tree.h"
 #include "../composite/PlantComponent.h"
+#include "../composite/PlantGroup.h"
 #include "../singleton/Singleton.h"
+#include "../flyweight/StringInterner.h"
 #include "../state/MaturityState.h"
 
 
 LivingPlant::LivingPlant(std::string name, double price, int waterAffect, int sunAffect)
-    : PlantComponent(price, waterAffect, sunAffect), age(0),
-      health(0),
-      waterLevel(0),
-      sunExposure(0),
-      maturityState(nullptr),
-      waterStrategy(nullptr),
-      sunStrategy(nullptr),
+    : PlantComponent(price, waterAffect, sunAffect),
+      waterStrategy(WaterHandle::none()),
+      sunStrategy(SunHandle::none()),
+      waterSlot(0),
+      sunSlot(0),
       decorator(nullptr)
 {
     // remember to change to getString() after Wilmar fixes getSeason()
-    this->name = Inventory::getInstance()->getString(name);
-    this->season = nullptr;
+    Inventory *inv = Inventory::getInstance();
+    this->name = StringHandle::of(inv->getString(name));
+    this->season = StringHandle::none();
+    this->stateTable = inv->getPlantStates();
+    this->handle = stateTable->allocate(this);
 };
 
 LivingPlant::LivingPlant(const LivingPlant &other)
         : PlantComponent(other),
 
-            name(other.name),
-            age(other.age),
-            health(other.health),
-            waterLevel(other.waterLevel),
-            sunExposure(other.sunExposure),
-            season(other.season),
-
-            maturityState(other.maturityState),
             waterStrategy(other.waterStrategy),
             sunStrategy(other.sunStrategy),
+            waterSlot(other.waterSlot),
+            sunSlot(other.sunSlot),
+            name(other.name),
+            season(other.season),
             decorator(nullptr)
 {
-        health = std::max(0, std::min(100, health));
-        waterLevel = std::max(0, std::min(100, waterLevel));
-        sunExposure = std::max(0, std::min(100, sunExposure));
+        this->stateTable = Inventory::getInstance()->getPlantStates();
+        this->handle = stateTable->allocate(this);
+
+        PlantStateTable *source = other.stateTable;
+        stateTable->age(handle) = source->age(other.handle);
+        stateTable->health(handle) = std::max(0, std::min(100, source->health(other.handle)));
+        stateTable->waterLevel(handle) = std::max(0, std::min(100, source->waterLevel(other.handle)));
+        stateTable->sunExposure(handle) = std::max(0, std::min(100, source->sunExposure(other.handle)));
+        stateTable->maturityState(handle) = source->maturityState(other.handle);
+        stateTable->season(handle) = source->season(other.handle);
 };
 
 
 
 void LivingPlant::setAge(int age)
 {
-    this->age = age;
+    stateTable->age(handle) = age;
+    stateTable->touch(handle);
 };
 
 void LivingPlant::setHealth(int health)
 {
-    this->health = health;
-    this->health = std::max(0, std::min(100, this->health));
+    stateTable->health(handle) = std::max(0, std::min(100, health));
+    stateTable->touch(handle);
 };
 
 
 void LivingPlant::setWaterLevel(int waterLevel)
 {
-    this->waterLevel = waterLevel;
-    this->waterLevel = std::max(0, std::min(100, this->waterLevel));
+    stateTable->waterLevel(handle) = std::max(0, std::min(100, waterLevel));
+    stateTable->touch(handle);
+    markLevelsDirty();
 };
 
 
 void LivingPlant::setSunExposure(int sunExposure)
 {
-    this->sunExposure = sunExposure;
-    this->sunExposure = std::max(0, std::min(100, this->sunExposure));
+    stateTable->sunExposure(handle) = std::max(0, std::min(100, sunExposure));
+    stateTable->touch(handle);
+    markLevelsDirty();
 };
 
 void LivingPlant::setWaterStrategy(int strategy)
 {
     Inventory *inv = Inventory::getInstance();
 
-    Flyweight<WaterStrategy *> *newStrategy = inv->getWaterFly(strategy);
-
-    this->waterStrategy = newStrategy;
+    this->waterStrategy = inv->shareWaterFly(strategy);
+    this->waterSlot = 0;
 };
 
 void LivingPlant::setSunStrategy(int strategy)
 {
     Inventory *inv = Inventory::getInstance();
 
-    Flyweight<SunStrategy *> *newStrategy = inv->getSunFly(strategy);
-
-    this->sunStrategy = newStrategy;
+    this->sunStrategy = inv->shareSunFly(strategy);
+    this->sunSlot = 0;
 };
 
 void LivingPlant::setMaturity(int state)
 {
     Inventory *inv = Inventory::getInstance();
 
-    Flyweight<MaturityState *> *newState = inv->getStates(state);
+    Flyweight<MaturityState *> *newState = inv->shareState(state);
 
-    this->maturityState = newState;
+    stateTable->maturityState(handle) = newState;
+    stateTable->touch(handle);
 };
 
 void LivingPlant::setSeason(Flyweight<std::string *> *season)
 {
-    this->season = season;
+    this->season = StringInterner::shared().handleOf(season);
+    stateTable->season(handle) = Inventory::getInstance()->getSeasonId(season);
+    stateTable->touch(handle);
+}
+
+void LivingPlant::setSeason(SeasonId season)
+{
+    this->season = StringInterner::shared().handleOf(Inventory::getInstance()->getSeasonString(season));
+    stateTable->season(handle) = season;
+    stateTable->touch(handle);
 }
 
 int LivingPlant::getAge()
 {
-    return this->age;
+    return stateTable->age(handle);
 };
 
 int LivingPlant::getHealth()
 {
-    return this->health;
+    return stateTable->health(handle);
 };
 
 int LivingPlant::getSunExposure()
 {
-    return this->sunExposure;
+    return stateTable->sunExposure(handle);
 };
 
 std::string LivingPlant::getName()
 {
-    return *name->getState();
+    return *StringInterner::shared().at(name)->getState();
 };
 
 double LivingPlant::getPrice()
@@ -129,21 +146,50 @@ double LivingPlant::getPrice()
 };
 
 std::string LivingPlant::getInfo()
+{
+    return formatInfo(getInfoValues());
+}
+
+PlantInfoValues LivingPlant::getInfoValues()
+{
+    PlantInfoValues values;
+    Flyweight<MaturityState *> *maturityState = getMaturityState();
+
+    values.name = StringInterner::shared().at(name)->getState();
+    values.state = maturityState ? maturityState->getState() : nullptr;
+    values.age = getAge();
+    values.health = getHealth();
+    values.waterLevel = getWaterLevel();
+    values.sunExposure = getSunExposure();
+    values.price = price;
+    values.decorated = decorator != nullptr;
+    values.totalPrice = decorator ? decorator->getPrice() : price;
+    values.waterAffection = decorator ? decorator->affectWater() : affectWaterValue;
+    values.sunAffection = decorator ? decorator->affectSunlight() : affectSunValue;
+    return values;
+}
+
+std::string LivingPlant::formatInfo(const PlantInfoValues &values)
 {
     std::ostringstream stream;
     stream << std::fixed << std::setprecision(2);
     string stateStr = "";
-    std::string plantName = *name->getState();
+    std::string plantName = *values.name;
+    int age = values.age;
+    int health = values.health;
+    int waterLevel = values.waterLevel;
+    int sunExposure = values.sunExposure;
+    double price = values.price;
 
-    if (this->maturityState)
-        stateStr = this->maturityState->getState()->getName();
+    if (values.state)
+        stateStr = values.state->getName();
 
     stream << "-------------------------------\n";
 
     stream << "| " << std::left << std::setw(15) << "Name:" << std::setw(13) << plantName << "|\n";
     stream << "| " << std::left << std::setw(15) << "Health:" << std::setw(13) << health << "|\n";
     stream << "| " << std::left << std::setw(15) << "Age:" << std::setw(13) << (std::to_string(age) + " days") << "|\n";
-    if (this->maturityState)
+    if (values.state)
         stream << "| " << std::left << std::setw(15) << "State:" << std::setw(13) << stateStr << "|\n";
 
     stream << "| " << std::left << std::setw(15) << "Age:" << std::setw(13) << (std::to_string(age) + " days") << "|\n";
@@ -153,14 +199,14 @@ std::string LivingPlant::getInfo()
 
     stream << "-------------------------------\n";
 
-    if (decorator)
+    if (values.decorated)
     {
         stream << "\n";
         stream << "Total:\n";
         stream << "-------------------------------\n";
-        stream << "| " << std::left << std::setw(20) << "Total Price:" << "R" << std::setw(7) << decorator->getPrice() << "|\n";
-        stream << "| " << std::left << std::setw(20) << "Water Affection:" << std::setw(8) << decorator->affectWater() << "|\n";
-        stream << "| " << std::left << std::setw(20) << "Sun Affection:" << std::setw(8) << decorator->affectSunlight() << "|\n";
+        stream << "| " << std::left << std::setw(20) << "Total Price:" << "R" << std::setw(7) << values.totalPrice << "|\n";
+        stream << "| " << std::left << std::setw(20) << "Water Affection:" << std::setw(8) << values.waterAffection << "|\n";
+        stream << "| " << std::left << std::setw(20) << "Sun Affection:" << std::setw(8) << values.sunAffection << "|\n";
         stream << "-------------------------------\n";
     }
 
@@ -169,7 +215,17 @@ std::string LivingPlant::getInfo()
 
 Flyweight<std::string *> *LivingPlant::getSeason()
 {
-    return this->season;
+    return StringInterner::shared().at(season);
+}
+
+Flyweight<std::string *> *LivingPlant::getNameFlyweight()
+{
+    return StringInterner::shared().at(name);
+}
+
+SeasonId LivingPlant::getSeasonId()
+{
+    return stateTable->season(handle);
 }
 
 ComponentType LivingPlant::getType() const
@@ -184,15 +240,13 @@ PlantComponent *LivingPlant::clone()
 
 void LivingPlant::water()
 {
-    if (this->waterStrategy != nullptr)
+    if (!this->waterStrategy.isNone())
     {
 
-        WaterStrategy *strategy = this->waterStrategy->getState();
+        WaterStrategy *strategy = stateTable->getInventory()->getWaterFly(waterStrategy)->getState();
 
         int waterApplied = strategy->water(this);
-    this->health = std::max(0, std::min(100, this->health));
-    this->waterLevel = std::max(0, std::min(100, this->waterLevel));
-    this->sunExposure = std::max(0, std::min(100, this->sunExposure));
+        clampState();
     }
 }
 
@@ -208,40 +262,39 @@ int LivingPlant::affectSunlight()
 
 void LivingPlant::update()
 {
+    int &waterLevel = stateTable->waterLevel(handle);
+    int &sunExposure = stateTable->sunExposure(handle);
+
     // added null checks
     if (this->decorator != nullptr)
     {
-        this->waterLevel -= this->decorator->affectWater();
+        waterLevel -= this->decorator->affectWater();
 
-        this->sunExposure -= this->decorator->affectSunlight();
+        sunExposure -= this->decorator->affectSunlight();
     }
     else
     {
-        this->waterLevel -= this->affectWater();
-        this->sunExposure -= this->affectSunlight();
+        waterLevel -= this->affectWater();
+        sunExposure -= this->affectSunlight();
     }
-    this->health = std::max(0, std::min(100, this->health));
-    this->waterLevel = std::max(0, std::min(100, this->waterLevel));
-    this->sunExposure = std::max(0, std::min(100, this->sunExposure));
+    clampState();
 };
 
 void LivingPlant::setOutside()
 {
-    if (this->sunStrategy != nullptr)
+    if (!this->sunStrategy.isNone())
     {
 
-        SunStrategy *strategy = this->sunStrategy->getState();
+        SunStrategy *strategy = stateTable->getInventory()->getSunFly(sunStrategy)->getState();
 
         int sunApplied = strategy->addSun(this);
-    this->health = std::max(0, std::min(100, this->health));
-    this->waterLevel = std::max(0, std::min(100, this->waterLevel));
-    this->sunExposure = std::max(0, std::min(100, this->sunExposure));
+        clampState();
     }
 }
 
 int LivingPlant::getWaterLevel()
 {
-    return this->waterLevel;
+    return stateTable->waterLevel(handle);
 }
 
 void LivingPlant::addAttribute(PlantComponent *attribute)
@@ -255,6 +308,11 @@ void LivingPlant::addAttribute(PlantComponent *attribute)
         this->decorator = attribute;
         attribute->addAttribute(this);
     }
+
+    if (getParent())
+        getParent()->markTotalsDirty();
+    if (decorator->getParent())
+        decorator->getParent()->markTotalsDirty();
 }
 
 Herb::Herb()
@@ -271,6 +329,11 @@ PlantComponent *Herb::clone()
     return new Herb(*this);
 }
 
+PlantSpecies Herb::getSpecies() const
+{
+    return PlantSpecies::Herb;
+}
+
 Shrub::Shrub()
     : LivingPlant("Shrub", 75.00, 4, 4) {};
 
@@ -285,6 +348,11 @@ PlantComponent *Shrub::clone()
     return new Shrub(*this);
 }
 
+PlantSpecies Shrub::getSpecies() const
+{
+    return PlantSpecies::Shrub;
+}
+
 Succulent::Succulent()
     : LivingPlant("Succulent", 45.00, 1, 5) {};
 
@@ -299,6 +367,11 @@ PlantComponent *Succulent::clone()
     return new Succulent(*this);
 }
 
+PlantSpecies Succulent::getSpecies() const
+{
+    return PlantSpecies::Succulent;
+}
+
 Tree::Tree()
     : LivingPlant("Tree", 150.00, 5, 5) {};
 
@@ -312,6 +385,11 @@ PlantComponent *Tree::clone()
 {
     return new Tree(*this);
 }
+
+PlantSpecies Tree::getSpecies() const
+{
+    return PlantSpecies::Tree;
+}
 PlantComponent *LivingPlant::getDecorator()
 {
     return this->decorator;
@@ -329,20 +407,50 @@ LivingPlant::~LivingPlant()
         if (decorator)
             delete decorator;
     }
+    stateTable->release(handle);
 }
 int LivingPlant::getWaterValue()
 {
-    return this->waterLevel;
+    return stateTable->waterLevel(handle);
 }
 int LivingPlant::getSunlightValue()
 {
-    return this->sunExposure;
+    return stateTable->sunExposure(handle);
 }
 void LivingPlant::tick()
 {
 
-    this->maturityState->getState()->grow(this);
-    this->health = std::max(0, std::min(100, this->health));
-    this->waterLevel = std::max(0, std::min(100, this->waterLevel));
-    this->sunExposure = std::max(0, std::min(100, this->sunExposure));
+    getMaturityState()->getState()->grow(this);
+    clampState();
+}
+
+Flyweight<MaturityState *> *LivingPlant::getMaturityState()
+{
+    return stateTable->maturityState(handle);
+}
+
+void LivingPlant::markForTick()
+{
+    stateTable->markForTick(handle);
+}
+
+void LivingPlant::clampState()
+{
+    int &health = stateTable->health(handle);
+    int &waterLevel = stateTable->waterLevel(handle);
+    int &sunExposure = stateTable->sunExposure(handle);
+    health = std::max(0, std::min(100, health));
+    waterLevel = std::max(0, std::min(100, waterLevel));
+    sunExposure = std::max(0, std::min(100, sunExposure));
+    stateTable->touch(handle);
+    markLevelsDirty();
+}
+
+void LivingPlant::markLevelsDirty()
+{
+    // Groups may hold the plant itself or its outermost decorator
+    if (getParent())
+        getParent()->markLevelsDirty();
+    if (decorator && decorator->getParent())
+        decorator->getParent()->markLevelsDirty();
 }
\ No newline at end of file
@@ -4,12 +4,52 @@
 #include <string>
 #include "../composite/PlantComponent.h"
 #include "../flyweight/Flyweight.h"
+#include "../flyweight/FlyweightHandle.h"
 
 #include <sstream>
 #include <iomanip>
 #include "../strategy/WaterStrategy.h"
 #include "../strategy/SunStrategy.h"
 #include "../decorator/PlantAttributes.h"
+#include "PlantStateTable.h"
+
+class MaturityState;
+
+/**
+ * @brief The values LivingPlant::getInfo() prints, copied out of the plant.
+ *
+ * Lets a plant be formatted later from a copy, e.g. from an InventorySnapshot
+ * while the ticker keeps changing the live plant.
+ */
+struct PlantInfoValues
+{
+	/** Shared name string from the name flyweight. */
+	const std::string *name;
+	/** Current maturity state, nullptr if none is set. */
+	MaturityState *state;
+	int age;
+	int health;
+	int waterLevel;
+	int sunExposure;
+	double price;
+	/** True if the plant has decorations; the totals below are then filled in. */
+	bool decorated;
+	double totalPrice;
+	int waterAffection;
+	int sunAffection;
+};
+
+/**
+ * @brief The four base plant types, for records that outlive the plant object.
+ */
+enum class PlantSpecies : unsigned char
+{
+	Unknown = 0,
+	Herb,
+	Shrub,
+	Succulent,
+	Tree
+};
 
 /**
  * @brief Base class for all living plant objects in the Prototype pattern.
@@ -55,27 +95,47 @@
 
 class LivingPlant : public PlantComponent
 {
+	friend class InventoryImage;
+
 protected:
+	// Flyweights are held as dense indices, not pointers. The one-byte strategy
+	// handles and the strings come first so they can share the base's tail padding.
+	WaterHandle waterStrategy;
+	SunHandle sunStrategy;
+
+	// What the (stateless, shared) strategies remember about this plant,
+	// e.g. where AlternatingWater is in its cycle; reset when a strategy is set
+	std::uint8_t waterSlot : 4;
+	std::uint8_t sunSlot : 4;
+
+	/**
+	 * Name of the plant, in StringInterner::shared().
+	 */
+	StringHandle name;
+
 	/**
-	 * Name of the plant.
+	 * Growing season for the plant, in StringInterner::shared().
 	 */
-	Flyweight<std::string *> *name;
+	StringHandle season;
 
 	PlantComponent *decorator;
-	int age;
-	int health;
-	int waterLevel;
-	int sunExposure;
 
 	/**
-	 * Growing season for the plant.
+	 * Row in the Inventory's PlantStateTable holding age, health, water level,
+	 * sun exposure and maturity state.
 	 */
-	Flyweight<std::string *> *season;
+	PlantStateTable *stateTable;
+	PlantHandle handle;
 
-	Flyweight<MaturityState *> *maturityState;
-	Flyweight<WaterStrategy *> *waterStrategy;
-	Flyweight<SunStrategy *> *sunStrategy;
-    
+	/**
+	 * @brief Clamps health, water level and sun exposure in the table row to 0..100.
+	 */
+	void clampState();
+
+	/**
+	 * @brief Marks the water and sun sums cached by the groups holding this plant stale.
+	 */
+	void markLevelsDirty();
 
 public:
 	/**
@@ -115,6 +175,12 @@ public:
 	 */
 	void setSeason(Flyweight<std::string *> *season);
 
+	/**
+	 * @brief Sets the season for this plant by ID.
+	 * @param season Season ID; the season flyweight is set to the inventory's matching one.
+	 */
+	void setSeason(SeasonId season);
+
 	/**
 	 * @brief Sets the season for this plant.
 	 * @param waterLevel Integer waterLevel for the new waterLevel of the plant.
@@ -158,6 +224,12 @@ public:
 	 */
 	Flyweight<std::string *> *getSeason();
 
+	/**
+	 * @brief Gets the season of the plant as an ID.
+	 * @return Season ID kept in step with getSeason().
+	 */
+	SeasonId getSeasonId();
+
 	/**
 	 * @brief Gets the component type (LIVING_PLANT).
 	 *
@@ -226,6 +298,19 @@ public:
 	 */
 	std::string getInfo() ;
 
+	/**
+	 * @brief Copies the values getInfo() prints.
+	 * @return Current values of this plant and its decorations.
+	 */
+	PlantInfoValues getInfoValues();
+
+	/**
+	 * @brief Formats plant values exactly as getInfo() does.
+	 * @param values Values from getInfoValues().
+	 * @return Plant details table.
+	 */
+	static std::string formatInfo(const PlantInfoValues &values);
+
 	/**
 	 * @brief Clones the plant creating a deep copy (Prototype pattern).
 	 * @return Pointer to a new plant object that is a copy of this one.
@@ -247,6 +332,12 @@ public:
 	 */
 	virtual PlantComponent *getDecorator() ;
 
+	/**
+	 * @brief Gets the base plant type this plant was created as.
+	 * @return Herb, Shrub, Succulent or Tree; Unknown for other subclasses.
+	 */
+	virtual PlantSpecies getSpecies() const { return PlantSpecies::Unknown; }
+
 /**
  * @brief Virtual destructor for LivingPlant.
  *
@@ -294,8 +385,75 @@ virtual int getSunlightValue();
  */
 virtual void tick();
 
-	virtual Flyweight<std::string *> *getNameFlyweight() { return this->name; };
+	virtual Flyweight<std::string *> *getNameFlyweight();
+
+	/**
+	 * @brief Gets the compact handle of the plant's name.
+	 * @return Handle into StringInterner::shared().
+	 */
+	StringHandle getNameHandle() const { return name; }
+
+	/**
+	 * @brief Gets the compact handle of the plant's season.
+	 * @return Handle into StringInterner::shared(), none() if no season is set.
+	 */
+	StringHandle getSeasonHandle() const { return season; }
+
+	/**
+	 * @brief Gets the compact handle of the plant's water strategy.
+	 * @return Handle into the owning inventory's water flyweights, none() if unset.
+	 */
+	WaterHandle getWaterHandle() const { return waterStrategy; }
 
+	/**
+	 * @brief Gets the compact handle of the plant's sun strategy.
+	 * @return Handle into the owning inventory's sun flyweights, none() if unset.
+	 */
+	SunHandle getSunHandle() const { return sunStrategy; }
+
+	/** Number of distinct values a water or sun slot can hold. */
+	static const unsigned CARE_SLOT_VALUES = 16;
+
+	/**
+	 * @brief Gets the state the water strategy keeps for this plant.
+	 * @return Value below CARE_SLOT_VALUES; 0 after setWaterStrategy().
+	 */
+	unsigned getWaterSlot() const { return waterSlot; }
+
+	/**
+	 * @brief Stores the state the water strategy keeps for this plant.
+	 * @param value Value below CARE_SLOT_VALUES; higher bits are dropped.
+	 */
+	void setWaterSlot(unsigned value) { waterSlot = value % CARE_SLOT_VALUES; }
+
+	/**
+	 * @brief Gets the state the sun strategy keeps for this plant.
+	 * @return Value below CARE_SLOT_VALUES; 0 after setSunStrategy().
+	 */
+	unsigned getSunSlot() const { return sunSlot; }
+
+	/**
+	 * @brief Stores the state the sun strategy keeps for this plant.
+	 * @param value Value below CARE_SLOT_VALUES; higher bits are dropped.
+	 */
+	void setSunSlot(unsigned value) { sunSlot = value % CARE_SLOT_VALUES; }
+
+	/**
+	 * @brief Gets the maturity state flyweight stored in this plant's table row.
+	 * @return Flyweight of the current maturity state, or nullptr if unset.
+	 */
+	Flyweight<MaturityState *> *getMaturityState();
+
+	/**
+	 * @brief Gets this plant's handle into its PlantStateTable.
+	 * @return Index and generation of the plant's row.
+	 */
+	PlantHandle getHandle() const { return handle; }
+
+	/**
+	 * @brief Marks this plant to be grown by the next PlantStateTable::sweep().
+	 */
+	void markForTick();
 
 
 };
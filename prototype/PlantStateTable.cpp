@@ -0,0 +1,363 @@
+#include "PlantStateTable.h"
+#include "LivingPlant.h"
+#include "../state/MaturityState.h"
+#include "../state/GrowKernel.h"
+#include "../state/Seed.h"
+#include "../state/Vegetative.h"
+#include "../state/Mature.h"
+#include "../state/Dead.h"
+#include "../singleton/Singleton.h"
+#include <algorithm>
+
+namespace
+{
+    // Rows gathered into one kernel call; sized to keep the lane buffers on the stack
+    const std::size_t SWEEP_BLOCK = 512;
+}
+
+PlantStateTable::PlantStateTable(Inventory *inventory)
+    : inventory(inventory), liveRows(0), retired(false), lazy(false), currentDay(0),
+      liveGroups(0), structureVersion(0), levelsEpoch(0),
+      waterNotifications(0), sunNotifications(0), stateNotifications(0)
+{
+    for (int i = 0; i < 4; i++)
+        lazyStates[i] = nullptr;
+    for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+        growCounts[code] = 0;
+}
+
+PlantHandle PlantStateTable::allocate(LivingPlant *owner)
+{
+    PlantHandle handle;
+
+    if (!freeRows.empty())
+    {
+        handle.index = freeRows.back();
+        freeRows.pop_back();
+    }
+    else
+    {
+        handle.index = static_cast<unsigned int>(owners.size());
+        ages.push_back(0);
+        healths.push_back(0);
+        waterLevels.push_back(0);
+        sunExposures.push_back(0);
+        maturityStates.push_back(nullptr);
+        seasons.push_back(SeasonId::None);
+        lastDays.push_back(0);
+        lazyMembers.push_back(0);
+        touchedFlags.push_back(0);
+        owners.push_back(nullptr);
+        generations.push_back(0);
+        tickMarks.push_back(0);
+    }
+
+    handle.generation = generations[handle.index];
+    owners[handle.index] = owner;
+    lastDays[handle.index] = currentDay;
+    liveRows++;
+    return handle;
+}
+
+void PlantStateTable::release(PlantHandle handle)
+{
+    if (!isValid(handle))
+        return;
+
+    unsigned int row = handle.index;
+    ages[row] = 0;
+    healths[row] = 0;
+    waterLevels[row] = 0;
+    sunExposures[row] = 0;
+    maturityStates[row] = nullptr;
+    seasons[row] = SeasonId::None;
+    lazyMembers[row] = 0;
+    owners[row] = nullptr;
+    tickMarks[row] = 0;
+    generations[row]++;
+    freeRows.push_back(row);
+    liveRows--;
+
+    if (retired && liveRows == 0 && liveGroups.load(std::memory_order_acquire) == 0)
+        delete this;
+}
+
+void PlantStateTable::releaseGroup()
+{
+    if (liveGroups.fetch_sub(1, std::memory_order_acq_rel) == 1 && retired && liveRows == 0)
+        delete this;
+}
+
+bool PlantStateTable::isValid(PlantHandle handle) const
+{
+    return handle.index < owners.size() && owners[handle.index] != nullptr &&
+           generations[handle.index] == handle.generation;
+}
+
+void PlantStateTable::reserve(std::size_t rows)
+{
+    rows += owners.size();
+    ages.reserve(rows);
+    healths.reserve(rows);
+    waterLevels.reserve(rows);
+    sunExposures.reserve(rows);
+    maturityStates.reserve(rows);
+    seasons.reserve(rows);
+    lastDays.reserve(rows);
+    lazyMembers.reserve(rows);
+    touchedFlags.reserve(rows);
+    owners.reserve(rows);
+    generations.reserve(rows);
+    tickMarks.reserve(rows);
+}
+
+void PlantStateTable::retire()
+{
+    retired = true;
+    if (liveRows == 0 && liveGroups.load(std::memory_order_acquire) == 0)
+        delete this;
+}
+
+std::size_t PlantStateTable::sweep()
+{
+    return sweepRange(0, owners.size());
+}
+
+std::size_t PlantStateTable::sweepRange(std::size_t begin, std::size_t end)
+{
+    Inventory *inv = Inventory::getInstance();
+    Flyweight<MaturityState *> *seed = inv->getStates(Seed::getID());
+    Flyweight<MaturityState *> *vegetative = inv->getStates(Vegetative::getID());
+    Flyweight<MaturityState *> *mature = inv->getStates(Mature::getID());
+    Flyweight<MaturityState *> *dead = inv->getStates(Dead::getID());
+
+    // Integer water usage for every state and plant season under the current season
+    int usageTable[GrowKernel::DEAD + 1][SEASON_ID_COUNT];
+    for (int code = GrowKernel::SKIP; code <= GrowKernel::DEAD; code++)
+    {
+        for (int season = 0; season < SEASON_ID_COUNT; season++)
+            usageTable[code][season] = GrowKernel::waterUsage(code, inv->getSeasonId(), static_cast<SeasonId>(season));
+    }
+
+    int codes[SWEEP_BLOCK];
+    int usages[SWEEP_BLOCK];
+    std::size_t grown = 0;
+    unsigned long grownByCode[GROW_COUNTER_COUNT] = {0, 0, 0, 0, 0};
+
+    for (std::size_t blockBegin = begin; blockBegin < end; blockBegin += SWEEP_BLOCK)
+    {
+        std::size_t count = std::min(SWEEP_BLOCK, end - blockBegin);
+        std::size_t lanes = 0;
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::size_t row = blockBegin + i;
+            codes[i] = GrowKernel::SKIP;
+            usages[i] = 0;
+
+            if (!tickMarks[row])
+                continue;
+            tickMarks[row] = 0;
+
+            Flyweight<MaturityState *> *state = maturityStates[row];
+            if (state == nullptr || owners[row] == nullptr)
+                continue;
+
+            int code = (state == seed) ? GrowKernel::SEED : (state == vegetative) ? GrowKernel::VEGETATIVE
+                                                        : (state == mature)       ? GrowKernel::MATURE
+                                                        : (state == dead)         ? GrowKernel::DEAD
+                                                                                  : GrowKernel::SKIP;
+            if (code == GrowKernel::SKIP)
+            {
+                // Not one of the inventory's states: grow it through the state object
+                state->getState()->grow(owners[row]);
+                healths[row] = std::max(0, std::min(100, healths[row]));
+                waterLevels[row] = std::max(0, std::min(100, waterLevels[row]));
+                sunExposures[row] = std::max(0, std::min(100, sunExposures[row]));
+                grown++;
+                grownByCode[0]++;
+                continue;
+            }
+
+            grownByCode[code]++;
+            codes[i] = code;
+            usages[i] = usageTable[code][static_cast<int>(seasons[row])];
+            lanes++;
+        }
+
+        if (lanes == 0)
+            continue;
+
+        GrowKernel::grow(&ages[blockBegin], &healths[blockBegin], &waterLevels[blockBegin],
+                         &sunExposures[blockBegin], codes, usages, count);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            switch (codes[i])
+            {
+            case GrowKernel::VEGETATIVE:
+                maturityStates[blockBegin + i] = vegetative;
+                break;
+            case GrowKernel::MATURE:
+                maturityStates[blockBegin + i] = mature;
+                break;
+            case GrowKernel::DEAD:
+                maturityStates[blockBegin + i] = dead;
+                break;
+            default:
+                break;
+            }
+        }
+        grown += lanes;
+    }
+
+    for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+    {
+        if (grownByCode[code])
+            growCounts[code].fetch_add(grownByCode[code], std::memory_order_relaxed);
+    }
+    if (grown)
+        markAllLevelsDirty();
+    return grown;
+}
+
+void PlantStateTable::getGrowCounts(unsigned long counts[GROW_COUNTER_COUNT]) const
+{
+    for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+        counts[code] = growCounts[code].load(std::memory_order_relaxed);
+}
+
+namespace
+{
+    // GrowKernel code for a row's state, or -1 for a state the kernel does not know
+    int codeFor(Flyweight<MaturityState *> *state, Flyweight<MaturityState *> *const states[4])
+    {
+        if (state == nullptr)
+            return GrowKernel::SKIP;
+        for (int id = 0; id < 4; id++)
+        {
+            if (state == states[id])
+                return id + 1;
+        }
+        return -1;
+    }
+}
+
+void PlantStateTable::beginLazy(Flyweight<MaturityState *> *states[4])
+{
+    for (int i = 0; i < 4; i++)
+        lazyStates[i] = states[i];
+
+    currentDay = 0;
+    dayLog.assign(1, SeasonId::None);
+    std::fill(lastDays.begin(), lastDays.end(), 0);
+    std::fill(lazyMembers.begin(), lazyMembers.end(), 0);
+    std::fill(touchedFlags.begin(), touchedFlags.end(), 0);
+    touchedRows.clear();
+    lazy = true;
+}
+
+void PlantStateTable::endLazy()
+{
+    if (!lazy)
+        return;
+
+    for (unsigned int row = 0; row < owners.size(); row++)
+        sync(row);
+
+    lazy = false;
+    markAllLevelsDirty();
+    std::fill(lazyMembers.begin(), lazyMembers.end(), 0);
+    std::fill(touchedFlags.begin(), touchedFlags.end(), 0);
+    touchedRows.clear();
+    dayLog.clear();
+}
+
+void PlantStateTable::setLazyMember(unsigned int row, bool member)
+{
+    if (member && !lazyMembers[row])
+        lastDays[row] = currentDay;
+    lazyMembers[row] = member ? 1 : 0;
+}
+
+void PlantStateTable::beginDay(SeasonId season)
+{
+    dayLog.push_back(season);
+}
+
+void PlantStateTable::endDay()
+{
+    currentDay++;
+    markAllLevelsDirty();
+}
+
+void PlantStateTable::growRowToday(unsigned int row)
+{
+    growRow(row, dayLog[currentDay + 1]);
+    lastDays[row] = currentDay + 1;
+}
+
+void PlantStateTable::takeTouchedRows(std::vector<unsigned int> &rows)
+{
+    rows.swap(touchedRows);
+    touchedRows.clear();
+    for (std::size_t i = 0; i < rows.size(); i++)
+        touchedFlags[rows[i]] = 0;
+}
+
+std::size_t PlantStateTable::getRowBytes() const
+{
+    // One element in each array allocate() appends to
+    return sizeof(int) * 4 + sizeof(Flyweight<MaturityState *> *) + sizeof(SeasonId) +
+           sizeof(unsigned long) + sizeof(unsigned char) * 2 +
+           sizeof(LivingPlant *) + sizeof(unsigned int) + sizeof(unsigned char);
+}
+
+void PlantStateTable::peekRow(unsigned int row, int &age, int &health, int &water, int &sun, int &stateCode) const
+{
+    age = ages[row];
+    health = healths[row];
+    water = waterLevels[row];
+    sun = sunExposures[row];
+    stateCode = codeFor(maturityStates[row], lazyStates);
+}
+
+void PlantStateTable::catchUp(unsigned int row)
+{
+    unsigned long from = lastDays[row];
+    lastDays[row] = currentDay;
+
+    // Dead plants only age, so their missed days collapse into one step
+    if (codeFor(maturityStates[row], lazyStates) == GrowKernel::DEAD)
+    {
+        ages[row] += static_cast<int>(currentDay - from);
+        healths[row] = std::max(0, std::min(100, healths[row]));
+        waterLevels[row] = std::max(0, std::min(100, waterLevels[row]));
+        sunExposures[row] = std::max(0, std::min(100, sunExposures[row]));
+        return;
+    }
+
+    for (unsigned long day = from + 1; day <= currentDay; day++)
+        growRow(row, dayLog[day]);
+}
+
+void PlantStateTable::growRow(unsigned int row, SeasonId season)
+{
+    int code = codeFor(maturityStates[row], lazyStates);
+    if (code == GrowKernel::SKIP || owners[row] == nullptr)
+        return;
+
+    growCounts[code < 0 ? 0 : code].fetch_add(1, std::memory_order_relaxed);
+    if (code < 0)
+    {
+        maturityStates[row]->getState()->grow(owners[row]);
+        healths[row] = std::max(0, std::min(100, healths[row]));
+        waterLevels[row] = std::max(0, std::min(100, waterLevels[row]));
+        sunExposures[row] = std::max(0, std::min(100, sunExposures[row]));
+        return;
+    }
+
+    int usage = GrowKernel::waterUsage(code, season, seasons[row]);
+    GrowKernel::grow(&ages[row], &healths[row], &waterLevels[row], &sunExposures[row], &code, &usage, 1);
+    maturityStates[row] = lazyStates[code - 1];
+}
@@ -0,0 +1,438 @@
+#ifndef PlantStateTable_h
+#define PlantStateTable_h
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include "../state/Season.h"
+#include "../simulation/TickStats.h"
+
+class LivingPlant;
+class MaturityState;
+class Inventory;
+
+template <typename T>
+class Flyweight;
+
+/**
+ * @brief Stable reference to one row of a PlantStateTable.
+ *
+ * A handle is an index into the table's per-field arrays plus the generation
+ * the row had when it was handed out. Rows are recycled once released, so the
+ * generation is what tells a live handle apart from a stale one.
+ */
+struct PlantHandle
+{
+	unsigned int index;
+	unsigned int generation;
+};
+
+/**
+ * @brief Struct-of-arrays storage for the mutable state of every LivingPlant.
+ *
+ * Each LivingPlant keeps only a PlantHandle into this table; its age, health,
+ * water level, sun exposure, maturity state and season ID live in contiguous per-field
+ * arrays owned by the Inventory. The daily tick can then grow every plant with
+ * one linear sweep over the table instead of chasing plant objects through the
+ * composite's list nodes.
+ *
+ * **System Role:**
+ * Backing store for LivingPlant. Inventory owns one table and hands it to every
+ * plant constructed while it is the active instance. PlantGroup::prepareTick()
+ * marks the rows that belong to the inventory and sweep() grows the marked rows.
+ *
+ * **Pattern Role:** Storage behind the Prototype (LivingPlant) and State contexts
+ *
+ * **Composite counters:**
+ * The table also keeps the counters of the PlantGroups built while its
+ * inventory is active: the structure version TickScheduler rebuilds on, the
+ * levels epoch behind the groups' cached water and sun sums, and the observer
+ * notification counts TickStats reads. Keeping them here rather than in
+ * process-wide statics keeps nurseries in one process from disturbing each
+ * other's schedules, caches and tick records.
+ *
+ * **Lifetime:**
+ * Plants and groups may outlive the Inventory that created them (tests delete
+ * the singleton while plants are still around). retire() therefore only frees
+ * the table once its last row has been released and its last group destroyed.
+ *
+ * @see LivingPlant (thin handle into this table)
+ * @see Inventory (owns the table and drives sweep())
+ */
+class PlantStateTable
+{
+private:
+	std::vector<int> ages;
+	std::vector<int> healths;
+	std::vector<int> waterLevels;
+	std::vector<int> sunExposures;
+	std::vector<Flyweight<MaturityState *> *> maturityStates;
+	std::vector<SeasonId> seasons;
+
+	std::vector<LivingPlant *> owners;
+	std::vector<unsigned int> generations;
+	std::vector<unsigned char> tickMarks;
+	std::vector<unsigned int> freeRows;
+
+	Inventory *inventory;
+	std::size_t liveRows;
+	bool retired;
+
+	// Lazy mode (event-driven ticks): member rows are only brought up to date when read
+	bool lazy;
+	unsigned long currentDay;
+	std::vector<unsigned long> lastDays;
+	std::vector<unsigned char> lazyMembers;
+	std::vector<SeasonId> dayLog;
+	std::vector<unsigned int> touchedRows;
+	std::vector<unsigned char> touchedFlags;
+	Flyweight<MaturityState *> *lazyStates[4];
+
+	// Rows grown since construction, by GrowKernel code; index 0 counts states outside the kernel
+	std::atomic<unsigned long> growCounts[GROW_COUNTER_COUNT];
+
+	// PlantGroups built against the table, which keep it alive like rows do
+	std::atomic<std::size_t> liveGroups;
+
+	// Bumped whenever one of those groups' children or observers change
+	std::atomic<unsigned long> structureVersion;
+
+	// Bumped whenever plants grow, making every cached water and sun sum stale
+	std::atomic<unsigned long> levelsEpoch;
+
+	// Observer callbacks made by those groups since construction
+	std::atomic<unsigned long> waterNotifications;
+	std::atomic<unsigned long> sunNotifications;
+	std::atomic<unsigned long> stateNotifications;
+
+	/**
+	 * @brief Brings a lazy member row up to the current day if it is behind.
+	 */
+	void sync(unsigned int row)
+	{
+		if (lazy && lastDays[row] < currentDay && lazyMembers[row])
+			catchUp(row);
+	}
+
+	void catchUp(unsigned int row);
+	void growRow(unsigned int row, SeasonId season);
+
+	/**
+	 * @brief Destructor is private; the table frees itself through retire()/release().
+	 */
+	~PlantStateTable() {}
+
+public:
+	/**
+	 * @brief Constructs an empty table.
+	 * @param inventory Inventory that owns the table.
+	 */
+	explicit PlantStateTable(Inventory *inventory);
+
+	/**
+	 * @brief Gets the inventory that owns the table.
+	 *
+	 * Plants resolve their strategy handles through it. Only valid until the
+	 * inventory is destroyed, even if the table lives on.
+	 *
+	 * @return Owning inventory.
+	 */
+	Inventory *getInventory() const { return inventory; }
+
+	/**
+	 * @brief Reserves a zeroed row for a plant.
+	 * @param owner The plant that will use the row.
+	 * @return Handle to the new row.
+	 */
+	PlantHandle allocate(LivingPlant *owner);
+
+	/**
+	 * @brief Returns a row to the free list and invalidates all handles to it.
+	 * @param handle Handle previously returned by allocate().
+	 */
+	void release(PlantHandle handle);
+
+	/**
+	 * @brief Checks whether a handle still refers to a live row.
+	 * @param handle Handle to check.
+	 * @return True if the row has not been released since the handle was issued.
+	 */
+	bool isValid(PlantHandle handle) const;
+
+	/**
+	 * @brief Makes room for more rows so bulk loads do not regrow every column.
+	 * @param rows Rows about to be allocated on top of those in use.
+	 */
+	void reserve(std::size_t rows);
+
+	/**
+	 * @brief Called by the owning Inventory when it is destroyed.
+	 *
+	 * Frees the table immediately if no rows are in use, otherwise defers the
+	 * free to the release() of the last row.
+	 */
+	void retire();
+
+	// Field accessors. In lazy mode they first replay any days the row has missed.
+	int &age(PlantHandle handle) { sync(handle.index); return ages[handle.index]; }
+	int &health(PlantHandle handle) { sync(handle.index); return healths[handle.index]; }
+	int &waterLevel(PlantHandle handle) { sync(handle.index); return waterLevels[handle.index]; }
+	int &sunExposure(PlantHandle handle) { sync(handle.index); return sunExposures[handle.index]; }
+	Flyweight<MaturityState *> *&maturityState(PlantHandle handle) { sync(handle.index); return maturityStates[handle.index]; }
+	SeasonId &season(PlantHandle handle) { sync(handle.index); return seasons[handle.index]; }
+
+	/**
+	 * @brief Gets the plant that owns a row.
+	 * @param handle Row to look up.
+	 * @return The owner, or nullptr if the handle is stale.
+	 */
+	LivingPlant *owner(PlantHandle handle) const { return isValid(handle) ? owners[handle.index] : nullptr; }
+
+	/**
+	 * @brief Marks a row to be grown by the next sweep().
+	 * @param handle Row to mark. Marking twice in one tick grows it once.
+	 */
+	void markForTick(PlantHandle handle) { tickMarks[handle.index] = 1; }
+
+	/**
+	 * @brief Grows every marked row in index order and clears the marks.
+	 *
+	 * Rows in the inventory's Seed, Vegetative, Mature and Dead states are grown
+	 * in blocks by GrowKernel; any other state is dispatched through its grow().
+	 * Either way a sweep is equivalent to ticking the marked plants one by one.
+	 *
+	 * @return Number of rows grown.
+	 */
+	std::size_t sweep();
+
+	/**
+	 * @brief Grows the marked rows in [begin, end) and clears their marks.
+	 *
+	 * Rows are independent of each other, so disjoint ranges may be swept
+	 * concurrently (Inventory's parallel tick mode does this).
+	 *
+	 * @param begin First row.
+	 * @param end One past the last row.
+	 * @return Number of rows grown.
+	 */
+	std::size_t sweepRange(std::size_t begin, std::size_t end);
+
+	/**
+	 * @brief Gets how many rows have been grown in each state since the table was created.
+	 *
+	 * Counts sweeps and event-driven growth alike, including days replayed
+	 * when a lazy row is caught up. Inventory takes the difference around each
+	 * tick for TickStats.
+	 *
+	 * @param counts Receives GROW_COUNTER_COUNT counters, indexed by GrowKernel
+	 * state code; index 0 counts states grown through their own grow().
+	 */
+	void getGrowCounts(unsigned long counts[GROW_COUNTER_COUNT]) const;
+
+	/**
+	 * @brief Registers a PlantGroup that uses the table's composite counters.
+	 */
+	void addGroup() { liveGroups.fetch_add(1, std::memory_order_relaxed); }
+
+	/**
+	 * @brief Unregisters a destroyed PlantGroup; frees a retired table once nothing uses it.
+	 */
+	void releaseGroup();
+
+	/**
+	 * @brief Gets a counter that changes whenever the membership or observers of a group change.
+	 *
+	 * PlantGroup::addComponent(), removeComponent(), attach(), detach() and
+	 * group destruction bump it, so caches of the composite's layout
+	 * (TickScheduler) know when to rebuild.
+	 *
+	 * @return Current structure version.
+	 */
+	unsigned long getStructureVersion() const { return structureVersion.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Bumps the structure version.
+	 */
+	void markStructureChanged() { structureVersion.fetch_add(1, std::memory_order_acq_rel); }
+
+	/**
+	 * @brief Gets the epoch the groups' cached water and sun sums are checked against.
+	 * @return Current levels epoch.
+	 */
+	unsigned long getLevelsEpoch() const { return levelsEpoch.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Makes the cached water and sun sums of every group on this table stale at once.
+	 *
+	 * Used after growth that changes every plant, such as a sweep, where
+	 * marking each plant's groups would cost more than it saves.
+	 */
+	void markAllLevelsDirty() { levelsEpoch.fetch_add(1, std::memory_order_acq_rel); }
+
+	/**
+	 * @brief Counts observer callbacks made by a group.
+	 * @param water getWaterUpdate() calls.
+	 * @param sun getSunUpdate() calls.
+	 * @param state getStateUpdate() calls.
+	 */
+	void addNotifications(unsigned long water, unsigned long sun, unsigned long state)
+	{
+		if (water)
+			waterNotifications.fetch_add(water, std::memory_order_relaxed);
+		if (sun)
+			sunNotifications.fetch_add(sun, std::memory_order_relaxed);
+		if (state)
+			stateNotifications.fetch_add(state, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Gets how many observer callbacks the table's groups have made since it was created.
+	 *
+	 * Each call to an observer counts once, so one notification on a group
+	 * with two observers adds two. Inventory takes the difference around each
+	 * tick for TickStats.
+	 *
+	 * @param water Receives the getWaterUpdate() count.
+	 * @param sun Receives the getSunUpdate() count.
+	 * @param state Receives the getStateUpdate() count.
+	 */
+	void getNotificationCounts(unsigned long &water, unsigned long &sun, unsigned long &state) const
+	{
+		water = waterNotifications.load(std::memory_order_relaxed);
+		sun = sunNotifications.load(std::memory_order_relaxed);
+		state = stateNotifications.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Gets the number of rows, including released ones awaiting reuse.
+	 * @return Row count of the per-field arrays.
+	 */
+	std::size_t size() const { return owners.size(); }
+
+	/**
+	 * @brief Gets the number of rows currently owned by a plant.
+	 * @return Live row count.
+	 */
+	std::size_t getLiveCount() const { return liveRows; }
+
+	/**
+	 * @brief Gets a row's maturity state without replaying missed days.
+	 * @param row Row index below size().
+	 * @return The state flyweight, or nullptr if none is set.
+	 */
+	Flyweight<MaturityState *> *peekMaturityState(unsigned int row) const { return maturityStates[row]; }
+
+	/**
+	 * @brief Gets the bytes one row takes across the per-field arrays.
+	 * @return Sum of the element sizes of every per-row array, lazy-mode ones included.
+	 */
+	std::size_t getRowBytes() const;
+
+	/**
+	 * @brief Switches the table to lazy mode for event-driven ticks.
+	 *
+	 * Rows flagged with setLazyMember() then stop being grown every day; the
+	 * days they miss are replayed, with the season logged for each day, the
+	 * next time one of their fields is accessed. The day counter restarts at 0.
+	 *
+	 * @param states The inventory's Seed, Vegetative, Mature and Dead flyweights,
+	 * indexed by maturity state ID.
+	 */
+	void beginLazy(Flyweight<MaturityState *> *states[4]);
+
+	/**
+	 * @brief Brings every member row up to date and leaves lazy mode.
+	 */
+	void endLazy();
+
+	/**
+	 * @brief Checks whether the table is in lazy mode.
+	 * @return True between beginLazy() and endLazy().
+	 */
+	bool isLazy() const { return lazy; }
+
+	/**
+	 * @brief Adds a row to or removes it from the set of lazily grown rows.
+	 *
+	 * A row joining is treated as up to date on the current day; a row leaving
+	 * should be brought up to date first with syncRow().
+	 *
+	 * @param row Row index.
+	 * @param member True if the row belongs to the ticking inventory.
+	 */
+	void setLazyMember(unsigned int row, bool member);
+
+	/**
+	 * @brief Checks whether a row is grown by the lazy tick.
+	 * @param row Row index.
+	 * @return True if the row is a lazy member.
+	 */
+	bool isLazyMember(unsigned int row) const { return row < lazyMembers.size() && lazyMembers[row]; }
+
+	/**
+	 * @brief Replays any days a row has missed.
+	 * @param row Row index.
+	 */
+	void syncRow(unsigned int row) { sync(row); }
+
+	/**
+	 * @brief Starts the next day, recording the season it is grown under.
+	 * @param season The inventory's season for the day.
+	 */
+	void beginDay(SeasonId season);
+
+	/**
+	 * @brief Grows one row through the day started by beginDay(), exactly as the sweep would.
+	 * @param row Row index; must be up to date with the previous day.
+	 */
+	void growRowToday(unsigned int row);
+
+	/**
+	 * @brief Finishes the day started by beginDay().
+	 */
+	void endDay();
+
+	/**
+	 * @brief Gets the number of days completed since beginLazy().
+	 * @return Day counter.
+	 */
+	unsigned long getCurrentDay() const { return currentDay; }
+
+	/**
+	 * @brief Gets the day a row has been grown up to.
+	 * @param row Row index.
+	 * @return Last day applied to the row.
+	 */
+	unsigned long getLastDay(unsigned int row) const { return lastDays[row]; }
+
+	/**
+	 * @brief Records that a plant's fields were changed outside the tick.
+	 *
+	 * In lazy mode the scheduler re-predicts touched rows before the next day.
+	 *
+	 * @param handle Row that changed.
+	 */
+	void touch(PlantHandle handle)
+	{
+		if (lazy && !touchedFlags[handle.index])
+		{
+			touchedFlags[handle.index] = 1;
+			touchedRows.push_back(handle.index);
+		}
+	}
+
+	/**
+	 * @brief Hands over the rows touched since the last call.
+	 * @param rows Receives the touched row indices.
+	 */
+	void takeTouchedRows(std::vector<unsigned int> &rows);
+
+	/**
+	 * @brief Reads a row's fields without replaying missed days.
+	 * @param row Row index.
+	 * @param stateCode Receives the GrowKernel state code.
+	 */
+	void peekRow(unsigned int row, int &age, int &health, int &water, int &sun, int &stateCode) const;
+};
+
+#endif
@@ -59,6 +59,12 @@ public:
 	 * @return Pointer to a new Shrub object that is a copy of this one.
 	 */
 	PlantComponent *clone();
+
+	/**
+	 * @brief Gets the base plant type.
+	 * @return PlantSpecies::Shrub
+	 */
+	PlantSpecies getSpecies() const;
 };
 
 #endif
@@ -59,6 +59,12 @@ class Succulent : public LivingPlant
 		 * @return Pointer to a new Succulent object that is a copy of this one.
 		 */
 		PlantComponent* clone();
+
+		/**
+		 * @brief Gets the base plant type.
+		 * @return PlantSpecies::Succulent
+		 */
+		PlantSpecies getSpecies() const;
 };
 
 #endif
@@ -59,6 +59,12 @@ class Tree : public LivingPlant
 		 * @return Pointer to a new Tree object that is a copy of this one.
 		 */
 		PlantComponent* clone();
+
+		/**
+		 * @brief Gets the base plant type.
+		 * @return PlantSpecies::Tree
+		 */
+		PlantSpecies getSpecies() const;
 };
 
 #endif
@@ -0,0 +1,75 @@
+#include "CommandQueue.h"
+
+CommandQueue::CommandQueue()
+    : head(&stub), tail(&stub)
+{
+}
+
+CommandQueue::~CommandQueue()
+{
+    InventoryCommand *command;
+    while ((command = pop()) != nullptr)
+        delete command;
+}
+
+void CommandQueue::push(InventoryCommand *command)
+{
+    command->next.store(nullptr, std::memory_order_relaxed);
+    link(command);
+}
+
+void CommandQueue::link(InventoryCommand *command)
+{
+    InventoryCommand *previous = head.exchange(command, std::memory_order_acq_rel);
+    previous->next.store(command, std::memory_order_release);
+}
+
+InventoryCommand *CommandQueue::pop()
+{
+    InventoryCommand *first = tail;
+    InventoryCommand *next = first->next.load(std::memory_order_acquire);
+
+    if (first == &stub)
+    {
+        if (next == nullptr)
+            return nullptr;
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr)
+    {
+        tail = next;
+        return first;
+    }
+
+    // first is the last linked node; a producer may be between its exchange and its link
+    if (first != head.load(std::memory_order_acquire))
+        return nullptr;
+
+    // Put the stub behind first so first can be handed out
+    stub.next.store(nullptr, std::memory_order_relaxed);
+    link(&stub);
+
+    next = first->next.load(std::memory_order_acquire);
+    if (next != nullptr)
+    {
+        tail = next;
+        return first;
+    }
+    return nullptr;
+}
+
+std::size_t CommandQueue::drain()
+{
+    std::size_t applied = 0;
+    InventoryCommand *command;
+    while ((command = pop()) != nullptr)
+    {
+        command->apply();
+        delete command;
+        applied++;
+    }
+    return applied;
+}
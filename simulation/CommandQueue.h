@@ -0,0 +1,167 @@
+#ifndef CommandQueue_h
+#define CommandQueue_h
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+
+/**
+ * @brief A change to the inventory waiting to be applied between ticks.
+ *
+ * Commands are allocated by the submitting thread, linked into a CommandQueue
+ * and deleted by the consumer once applied.
+ */
+class InventoryCommand
+{
+	friend class CommandQueue;
+
+private:
+	std::atomic<InventoryCommand *> next;
+
+public:
+	InventoryCommand() : next(nullptr) {}
+
+	/**
+	 * @brief Performs the change. Runs on the consuming thread.
+	 */
+	virtual void apply() = 0;
+
+	virtual ~InventoryCommand() {}
+};
+
+/**
+ * @brief Command that runs a function and hands its result to a future.
+ *
+ * If the function throws, the exception is stored in the future. A command
+ * deleted without being applied leaves the future with a broken_promise error.
+ *
+ * @tparam Result Type the function returns.
+ */
+template <typename Result>
+class FunctionCommand : public InventoryCommand
+{
+private:
+	std::function<Result()> action;
+	std::promise<Result> result;
+
+public:
+	explicit FunctionCommand(const std::function<Result()> &action) : action(action) {}
+
+	/**
+	 * @brief Gets the future for this command's result. Call once, before queueing.
+	 * @return Future that becomes ready once the command has been applied.
+	 */
+	std::future<Result> getFuture() { return result.get_future(); }
+
+	void apply()
+	{
+		try
+		{
+			result.set_value(action());
+		}
+		catch (...)
+		{
+			result.set_exception(std::current_exception());
+		}
+	}
+};
+
+/**
+ * @brief FunctionCommand for functions without a result.
+ */
+template <>
+class FunctionCommand<void> : public InventoryCommand
+{
+private:
+	std::function<void()> action;
+	std::promise<void> result;
+
+public:
+	explicit FunctionCommand(const std::function<void()> &action) : action(action) {}
+
+	std::future<void> getFuture() { return result.get_future(); }
+
+	void apply()
+	{
+		try
+		{
+			action();
+			result.set_value();
+		}
+		catch (...)
+		{
+			result.set_exception(std::current_exception());
+		}
+	}
+};
+
+/**
+ * @brief Lock-free multi-producer, single-consumer queue of InventoryCommand.
+ *
+ * An intrusive linked list with a stub node (Vyukov's MPSC queue). push() is
+ * one atomic exchange and one store, so any number of threads can submit
+ * without ever waiting on each other or on the consumer. Commands come out in
+ * the order their exchanges happened.
+ *
+ * A producer that has exchanged but not yet linked its node briefly hides the
+ * nodes behind it; pop() then reports the queue as empty and those commands
+ * are returned by a later pop().
+ *
+ * **System Role:**
+ * Owned by Inventory. Facade and other UI threads push; whichever thread holds
+ * the tick lock pops, at the start of Inventory::tick() or in
+ * Inventory::applyCommands().
+ *
+ * @see Inventory::submit()
+ */
+class CommandQueue
+{
+private:
+	std::atomic<InventoryCommand *> head;
+	InventoryCommand *tail;
+
+	// Placeholder that is never applied; keeps the list non-empty
+	class Stub : public InventoryCommand
+	{
+	public:
+		void apply() {}
+	} stub;
+
+	void link(InventoryCommand *command);
+
+	CommandQueue(const CommandQueue &);
+	CommandQueue &operator=(const CommandQueue &);
+
+public:
+	/**
+	 * @brief Constructs an empty queue.
+	 */
+	CommandQueue();
+
+	/**
+	 * @brief Deletes every command still queued without applying it.
+	 */
+	~CommandQueue();
+
+	/**
+	 * @brief Queues a command. Safe to call from any number of threads.
+	 * @param command Command to queue; the queue takes ownership.
+	 */
+	void push(InventoryCommand *command);
+
+	/**
+	 * @brief Takes the oldest command. Only one thread may pop at a time.
+	 * @return The command, now owned by the caller, or nullptr if none is ready.
+	 */
+	InventoryCommand *pop();
+
+	/**
+	 * @brief Applies and deletes every command that is ready.
+	 * @return Number of commands applied.
+	 */
+	std::size_t drain();
+};
+
+#endif
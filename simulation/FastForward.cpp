@@ -0,0 +1,144 @@
+#include "FastForward.h"
+#include "../state/GrowKernel.h"
+#include <algorithm>
+
+namespace
+{
+    // Levels at or below which PlantGroup::notifyCareNeeds() calls the observers
+    const int CARE_WATER = 50, CARE_SUN = 50;
+
+    // The grow() rules of one living state, as in GrowKernel
+    struct GrowRule
+    {
+        int healthWater, healthSun;
+        int upAge, upHealth, upWater, upSun;
+        int setWater, setHealth, setSun;
+    };
+
+    const GrowRule SEED_RULE = {40, 20, 7, 50, 50, 30, 25, 50, 50};
+    const GrowRule VEG_RULE = {30, 40, 30, 60, 40, 50, 40, 60, 60};
+    const GrowRule MATURE_RULE = {30, 40, 0, 0, 0, 0, 0, 0, 0};
+    const int DEATH_AGE = 120;
+
+    const long NEVER = -1;
+
+    // Notifications sent before each of the next days while water drops by usage a day
+    void countNotifications(long water, int sun, int usage, long days, AdvanceSummary &summary)
+    {
+        if (sun <= CARE_SUN)
+            summary.sunNotifications += days;
+
+        if (water <= CARE_WATER)
+            summary.waterNotifications += days;
+        else if (usage > 0)
+        {
+            long first = 1 + (water - CARE_WATER + usage - 1) / usage;
+            if (first <= days)
+                summary.waterNotifications += days - first + 1;
+        }
+    }
+
+    // First day on which the state's transition rule holds, or NEVER
+    long transitionDay(int code, const GrowRule &rule, int age, int health, long water, int sun, int usage, long gainDays)
+    {
+        if (code == GrowKernel::MATURE)
+        {
+            // Health never drops, so it only stays at 0 if the first day brings no gain
+            if (health <= 0 && gainDays == 0)
+                return 1;
+            return std::max(1, DEATH_AGE - age);
+        }
+
+        if (sun < rule.upSun || water - usage < rule.upWater)
+            return NEVER;
+
+        long lastWaterDay = (water - rule.upWater) / usage;
+        long ageDay = std::max(1, rule.upAge - age);
+        long healthDay = 1;
+        if (health < rule.upHealth)
+        {
+            long needed = rule.upHealth - health;
+            if (gainDays < needed)
+                return NEVER;
+            healthDay = needed;
+        }
+
+        long day = std::max(ageDay, healthDay);
+        return day <= lastWaterDay ? day : NEVER;
+    }
+}
+
+void FastForward::advance(int &age, int &health, int &water, int &sun, int &code,
+                          SeasonId currentSeason, SeasonId plantSeason, long days,
+                          bool observed, AdvanceSummary &summary)
+{
+    if (days <= 0)
+        return;
+
+    if (code == GrowKernel::SKIP)
+    {
+        if (observed)
+            countNotifications(water, sun, 0, days, summary);
+        return;
+    }
+
+    // The first day goes through the kernel, which also clamps anything set out of range
+    int usage = GrowKernel::waterUsage(code, currentSeason, plantSeason);
+    if (observed)
+        countNotifications(water, sun, usage, 1, summary);
+    int before = code;
+    GrowKernel::grow(&age, &health, &water, &sun, &code, &usage, 1);
+    if (code != before)
+        (code == GrowKernel::DEAD ? summary.deaths : summary.transitions)++;
+    days--;
+
+    while (days > 0)
+    {
+        if (code == GrowKernel::DEAD)
+        {
+            if (observed)
+                countNotifications(water, sun, 0, days, summary);
+            age += static_cast<int>(days);
+            return;
+        }
+
+        const GrowRule &rule = code == GrowKernel::SEED ? SEED_RULE : (code == GrowKernel::VEGETATIVE ? VEG_RULE : MATURE_RULE);
+        usage = GrowKernel::waterUsage(code, currentSeason, plantSeason);
+
+        // Health rises on exactly the first gainDays days, while water stays above the threshold
+        long gainDays = 0;
+        if (sun >= rule.healthSun && water >= rule.healthWater)
+            gainDays = (water - rule.healthWater) / usage;
+
+        long transition = transitionDay(code, rule, age, health, water, sun, usage, gainDays);
+        long span = (transition == NEVER || transition > days) ? days : transition;
+
+        if (observed)
+            countNotifications(water, sun, usage, span, summary);
+
+        age += static_cast<int>(span);
+        health = static_cast<int>(std::min(100L, health + std::min(span, gainDays)));
+        water = static_cast<int>(std::max(0L, water - span * usage));
+        days -= span;
+
+        if (span != transition)
+            continue;
+
+        if (code == GrowKernel::MATURE)
+        {
+            water = 0;
+            health = 0;
+            sun = 0;
+            code = GrowKernel::DEAD;
+            summary.deaths++;
+        }
+        else
+        {
+            water = rule.setWater;
+            health = std::max(health, rule.setHealth);
+            sun = rule.setSun;
+            code = code == GrowKernel::SEED ? GrowKernel::VEGETATIVE : GrowKernel::MATURE;
+            summary.transitions++;
+        }
+    }
+}
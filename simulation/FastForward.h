@@ -0,0 +1,68 @@
+#ifndef FastForward_h
+#define FastForward_h
+
+#include "../state/Season.h"
+
+/**
+ * @brief What happened during Inventory::advanceDays().
+ *
+ * Observers are not called while days are skipped; the notifications the
+ * daily tick would have sent are counted here instead.
+ */
+struct AdvanceSummary
+{
+	/** Days advanced. */
+	long days;
+	/** waterNeeded() notifications the daily ticks would have sent. */
+	long waterNotifications;
+	/** sunlightNeeded() notifications the daily ticks would have sent. */
+	long sunNotifications;
+	/** Seed to Vegetative and Vegetative to Mature transitions. */
+	long transitions;
+	/** Mature plants that died. */
+	long deaths;
+};
+
+/**
+ * @brief Closed-form growth of one plant over many days with a fixed season.
+ *
+ * While a plant stays in one maturity state under one season, every day of
+ * grow() does the same thing: age goes up by one, water drops by the same
+ * integer usage and health goes up by one for as long as water and sun stay
+ * above the state's thresholds. Those days can be applied in one step. The
+ * only day that needs care is the first one on which the state's transition
+ * rule holds; it is found directly from the thresholds, applied, and the rest
+ * of the stretch continues in the new state.
+ *
+ * Results are identical to running GrowKernel::grow() (and so the states'
+ * grow()) once per day.
+ *
+ * **System Role:**
+ * Used by Inventory::advanceDays() for each stretch between season changes.
+ *
+ * @see GrowKernel
+ */
+class FastForward
+{
+public:
+	/**
+	 * @brief Advances one plant by a number of days under one season.
+	 *
+	 * @param age Plant age, updated in place.
+	 * @param health Plant health, updated in place.
+	 * @param water Plant water level, updated in place.
+	 * @param sun Plant sun exposure, updated in place.
+	 * @param code GrowKernel state code, updated with the state after the last day.
+	 * @param currentSeason The inventory's season for every one of the days.
+	 * @param plantSeason The plant's own season.
+	 * @param days Number of days to apply.
+	 * @param observed True if the plant's group would notify observers; the
+	 * notifications are then added to summary.
+	 * @param summary Receives notification, transition and death counts.
+	 */
+	static void advance(int &age, int &health, int &water, int &sun, int &code,
+						SeasonId currentSeason, SeasonId plantSeason, long days,
+						bool observed, AdvanceSummary &summary);
+};
+
+#endif
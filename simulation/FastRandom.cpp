@@ -0,0 +1,65 @@
+#include "FastRandom.h"
+
+#include <atomic>
+#include <random>
+
+namespace
+{
+    std::uint64_t splitMix(std::uint64_t &value)
+    {
+        std::uint64_t mixed = (value += 0x9e3779b97f4a7c15ull);
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ull;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebull;
+        return mixed ^ (mixed >> 31);
+    }
+
+    std::uint64_t startupSeed()
+    {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) | device();
+    }
+
+    std::atomic<std::uint64_t> defaultSeed(startupSeed());
+
+    // Gives every thread's generator a different stream from the same default seed
+    std::atomic<std::uint64_t> threadCounter(0);
+}
+
+FastRandom::FastRandom(std::uint64_t value)
+{
+    seed(value);
+}
+
+void FastRandom::seed(std::uint64_t value)
+{
+    // SplitMix64 never yields four zero words, which xoshiro cannot leave
+    for (int i = 0; i < 4; i++)
+        state[i] = splitMix(value);
+}
+
+std::uint32_t FastRandom::below(std::uint32_t bound)
+{
+    std::uint64_t product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(next() >> 32)) * bound;
+    std::uint32_t low = static_cast<std::uint32_t>(product);
+    if (low < bound)
+    {
+        std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+        while (low < threshold)
+        {
+            product = static_cast<std::uint64_t>(static_cast<std::uint32_t>(next() >> 32)) * bound;
+            low = static_cast<std::uint32_t>(product);
+        }
+    }
+    return static_cast<std::uint32_t>(product >> 32);
+}
+
+FastRandom &FastRandom::local()
+{
+    static thread_local FastRandom generator(defaultSeed.load() ^ (threadCounter.fetch_add(1) * 0xd1b54a32d192ed03ull));
+    return generator;
+}
+
+void FastRandom::setDefaultSeed(std::uint64_t seed)
+{
+    defaultSeed.store(seed);
+}
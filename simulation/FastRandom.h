@@ -0,0 +1,92 @@
+#ifndef FastRandom_h
+#define FastRandom_h
+
+#include <cstdint>
+
+/**
+ * @brief Small seedable random number generator (xoshiro256**).
+ *
+ * Each thread has its own generator, reached through local(), so threads never
+ * share RNG state: there is no lock and no contention, unlike std::rand(). A
+ * thread's generator is seeded on first use from the default seed and a
+ * per-thread counter; seedThread() gives the calling thread a fixed sequence
+ * instead, which makes runs that pick staff or recommendations reproducible.
+ *
+ * Seeds are expanded with SplitMix64, so nearby seeds (0, 1, 2...) still give
+ * unrelated sequences.
+ *
+ * **System Role:**
+ * Source of randomness for the mediator layer (SalesFloor, SuggestionFloor
+ * and Staff).
+ */
+class FastRandom
+{
+private:
+	std::uint64_t state[4];
+
+	static std::uint64_t rotate(std::uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+public:
+	/**
+	 * @brief Creates a generator with a fixed seed.
+	 * @param seed Any value, zero included.
+	 */
+	explicit FastRandom(std::uint64_t seed);
+
+	/**
+	 * @brief Restarts the sequence from a seed.
+	 * @param seed Any value, zero included.
+	 */
+	void seed(std::uint64_t seed);
+
+	/**
+	 * @brief Gets the next 64 random bits.
+	 * @return Uniformly distributed value.
+	 */
+	std::uint64_t next()
+	{
+		std::uint64_t result = rotate(state[1] * 5, 7) * 9;
+		std::uint64_t shifted = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = rotate(state[3], 45);
+		return result;
+	}
+
+	/**
+	 * @brief Gets a uniformly distributed index.
+	 *
+	 * Uses Lemire's multiply-and-reject method, so there is no modulo bias.
+	 *
+	 * @param bound Number of possible results; must be at least 1.
+	 * @return Value in [0, bound).
+	 */
+	std::uint32_t below(std::uint32_t bound);
+
+	/**
+	 * @brief Gets the calling thread's generator.
+	 * @return Generator owned by this thread.
+	 */
+	static FastRandom &local();
+
+	/**
+	 * @brief Seeds the calling thread's generator.
+	 * @param seed Seed for local() on this thread.
+	 */
+	static void seedThread(std::uint64_t seed) { local().seed(seed); }
+
+	/**
+	 * @brief Sets the seed that threads without seedThread() derive theirs from.
+	 *
+	 * Only affects generators first used after the call. Without it the
+	 * default seed is taken from std::random_device at start-up.
+	 *
+	 * @param seed Base seed.
+	 */
+	static void setDefaultSeed(std::uint64_t seed);
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "FlyweightReport.h"
+#include <iomanip>
+#include <sstream>
+
+FlyweightReport::FlyweightReport()
+    : plants(0), plantBytes(0)
+{
+    for (int i = 0; i < FLYWEIGHT_POOL_COUNT; i++)
+        pools[i] = FlyweightPoolReport();
+}
+
+const char *FlyweightReport::getPoolName(FlyweightPool pool)
+{
+    switch (pool)
+    {
+    case FlyweightPool::Strings:
+        return "strings";
+    case FlyweightPool::Water:
+        return "water";
+    case FlyweightPool::Sun:
+        return "sun";
+    case FlyweightPool::States:
+        return "states";
+    }
+    return "unknown";
+}
+
+void FlyweightReport::setPool(FlyweightPool pool, const FlyweightStats &stats, unsigned long long handleBytes, bool processWide)
+{
+    FlyweightPoolReport &entry = pools[static_cast<int>(pool)];
+    entry.stats = stats;
+    entry.handleBytes = handleBytes;
+    entry.processWide = processWide;
+}
+
+long long FlyweightReport::getBytesSaved(FlyweightPool pool) const
+{
+    const FlyweightPoolReport &entry = pools[static_cast<int>(pool)];
+    return entry.stats.bytesSaved(entry.references, entry.handleBytes);
+}
+
+long long FlyweightReport::getTotalBytesSaved() const
+{
+    long long total = 0;
+    for (int i = 0; i < FLYWEIGHT_POOL_COUNT; i++)
+        total += getBytesSaved(static_cast<FlyweightPool>(i));
+    return total;
+}
+
+double FlyweightReport::getBytesPerPlant() const
+{
+    if (plants == 0)
+        return 0.0;
+
+    unsigned long long shared = 0;
+    for (int i = 0; i < FLYWEIGHT_POOL_COUNT; i++)
+        shared += pools[i].stats.entryBytes;
+    return plantBytes + static_cast<double>(shared) / plants;
+}
+
+std::string FlyweightReport::toJson() const
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "{\n";
+    out << "  \"plants\": " << plants << ",\n";
+    out << "  \"plantBytes\": " << plantBytes << ",\n";
+    out << "  \"bytesPerPlant\": " << getBytesPerPlant() << ",\n";
+    out << "  \"bytesSaved\": " << getTotalBytesSaved() << ",\n";
+    out << "  \"pools\": {\n";
+    for (int i = 0; i < FLYWEIGHT_POOL_COUNT; i++)
+    {
+        FlyweightPool pool = static_cast<FlyweightPool>(i);
+        const FlyweightPoolReport &entry = pools[i];
+        out << "    \"" << getPoolName(pool) << "\": {"
+            << "\"hits\": " << entry.stats.hits
+            << ", \"misses\": " << entry.stats.misses
+            << ", \"entries\": " << entry.stats.entries
+            << ", \"entryBytes\": " << entry.stats.entryBytes
+            << ", \"references\": " << entry.references
+            << ", \"handleBytes\": " << entry.handleBytes
+            << ", \"bytesSaved\": " << getBytesSaved(pool)
+            << ", \"processWide\": " << (entry.processWide ? "true" : "false") << "}"
+            << (i + 1 < FLYWEIGHT_POOL_COUNT ? ",\n" : "\n");
+    }
+    out << "  }\n";
+    out << "}\n";
+    return out.str();
+}
+
+std::string FlyweightReport::toText() const
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "Flyweight sharing (" << plants << " plants, " << getBytesPerPlant() << " bytes/plant, "
+        << getTotalBytesSaved() << " bytes saved):\n";
+    for (int i = 0; i < FLYWEIGHT_POOL_COUNT; i++)
+    {
+        FlyweightPool pool = static_cast<FlyweightPool>(i);
+        const FlyweightPoolReport &entry = pools[i];
+        out << "  " << std::left << std::setw(9) << getPoolName(pool) << std::right
+            << "entries " << entry.stats.entries
+            << ", hits " << entry.stats.hits
+            << ", misses " << entry.stats.misses
+            << ", refs " << entry.references
+            << ", bytes " << entry.stats.entryBytes
+            << ", saved " << getBytesSaved(pool)
+            << (entry.processWide ? " (process-wide)" : "") << "\n";
+    }
+    return out.str();
+}
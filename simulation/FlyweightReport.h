@@ -0,0 +1,149 @@
+#ifndef FlyweightReport_h
+#define FlyweightReport_h
+
+#include <string>
+#include "../flyweight/FlyweightStats.h"
+
+/**
+ * @brief The flyweight pools of an Inventory that FlyweightReport covers.
+ */
+enum class FlyweightPool
+{
+	Strings = 0, ///< Interned plant names and seasons (StringInterner::shared())
+	Water,		 ///< Water strategies
+	Sun,		 ///< Sun strategies
+	States		 ///< Maturity states
+};
+
+/** Number of FlyweightPool values. */
+const int FLYWEIGHT_POOL_COUNT = 4;
+
+/**
+ * @brief Counters of one pool and the references live plants hold into it.
+ */
+struct FlyweightPoolReport
+{
+	/** Lookups, entries and entry bytes of the pool. */
+	FlyweightStats stats;
+	/** References to the pool's flyweights held by live plants. */
+	unsigned long long references;
+	/** Bytes each of those references takes in a plant. */
+	unsigned long long handleBytes;
+	/** True if the pool is shared by every inventory in the process, so its stats are not this inventory's alone. */
+	bool processWide;
+};
+
+/**
+ * @brief How well an inventory's flyweights are shared, for NFR-4.
+ *
+ * One FlyweightPoolReport per FlyweightPool plus the plant count and the
+ * per-plant footprint, so the cost of a plant can be told apart from the
+ * cost of what it shares. The string pool is process-wide and marked so in
+ * both formats: its entries, hits and misses include other inventories'
+ * strings, while its references count only this inventory's plants.
+ *
+ * toJson() gives the machine-readable form that scale runs keep and compare;
+ * toText() the summary printed by photosyntech_sim.
+ *
+ * @see Inventory::getFlyweightReport()
+ */
+class FlyweightReport
+{
+private:
+	FlyweightPoolReport pools[FLYWEIGHT_POOL_COUNT];
+	unsigned long long plants;
+	unsigned long long plantBytes;
+
+public:
+	/**
+	 * @brief Constructs an empty report.
+	 */
+	FlyweightReport();
+
+	/**
+	 * @brief Gets the name a pool is reported under.
+	 * @param pool Pool to name.
+	 * @return "strings", "water", "sun" or "states".
+	 */
+	static const char *getPoolName(FlyweightPool pool);
+
+	/**
+	 * @brief Records a pool's counters.
+	 * @param pool Pool the counters belong to.
+	 * @param stats The pool's getStats().
+	 * @param handleBytes Size of the handle or pointer a plant keeps into the pool.
+	 * @param processWide True if every inventory in the process shares the pool.
+	 */
+	void setPool(FlyweightPool pool, const FlyweightStats &stats, unsigned long long handleBytes, bool processWide = false);
+
+	/**
+	 * @brief Counts references a plant holds into a pool.
+	 * @param pool Pool referred to.
+	 * @param count Number of references.
+	 */
+	void addReferences(FlyweightPool pool, unsigned long long count) { pools[static_cast<int>(pool)].references += count; }
+
+	/**
+	 * @brief Counts one live plant.
+	 */
+	void addPlant() { plants++; }
+
+	/**
+	 * @brief Sets the bytes a plant takes outside its flyweights.
+	 * @param bytes Size of the plant object and its state-table row.
+	 */
+	void setPlantBytes(unsigned long long bytes) { plantBytes = bytes; }
+
+	/**
+	 * @brief Gets one pool's figures.
+	 * @param pool Pool to look up.
+	 * @return Counters, references and handle size of that pool.
+	 */
+	const FlyweightPoolReport &getPool(FlyweightPool pool) const { return pools[static_cast<int>(pool)]; }
+
+	/**
+	 * @brief Estimates the bytes a pool saves over unshared copies.
+	 * @param pool Pool to look up.
+	 * @return FlyweightStats::bytesSaved() for the plants' references.
+	 */
+	long long getBytesSaved(FlyweightPool pool) const;
+
+	/**
+	 * @brief Estimates the bytes all pools together save.
+	 * @return Sum of getBytesSaved() over every pool.
+	 */
+	long long getTotalBytesSaved() const;
+
+	/**
+	 * @brief Gets the number of live plants counted.
+	 * @return Plant count.
+	 */
+	unsigned long long getPlantCount() const { return plants; }
+
+	/**
+	 * @brief Gets the bytes a plant takes outside its flyweights.
+	 * @return Size of the plant object and its state-table row.
+	 */
+	unsigned long long getPlantBytes() const { return plantBytes; }
+
+	/**
+	 * @brief Gets the memory per plant with the shared entries spread over the plants.
+	 * @return getPlantBytes() plus every pool's entry bytes divided by the plant count;
+	 * 0 without plants.
+	 */
+	double getBytesPerPlant() const;
+
+	/**
+	 * @brief Formats the report as a JSON object.
+	 * @return One object with the plant figures and a "pools" object keyed by pool name.
+	 */
+	std::string toJson() const;
+
+	/**
+	 * @brief Formats the report as an indented table for console output.
+	 * @return One line per pool after a heading line, each ending in a newline.
+	 */
+	std::string toText() const;
+};
+
+#endif
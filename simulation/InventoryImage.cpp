@@ -0,0 +1,765 @@
+#include "InventoryImage.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../singleton/Singleton.h"
+#include "../composite/PlantGroup.h"
+#include "../prototype/LivingPlant.h"
+#include "../prototype/Herb.h"
+#include "../prototype/Shrub.h"
+#include "../prototype/Succulent.h"
+#include "../prototype/Tree.h"
+#include "../decorator/PlantAttributes.h"
+#include "../decorator/customerDecorator/LargePot.h"
+#include "../decorator/customerDecorator/PlantCharm.h"
+#include "../decorator/customerDecorator/RedPot.h"
+#include "../decorator/customerDecorator/ShopThemedCharm.h"
+#include "../decorator/plantDecorator/Autumn.h"
+#include "../decorator/plantDecorator/LargeFlowers.h"
+#include "../decorator/plantDecorator/LargeLeaf.h"
+#include "../decorator/plantDecorator/LargeStem.h"
+#include "../decorator/plantDecorator/SmallFlowers.h"
+#include "../decorator/plantDecorator/SmallLeaf.h"
+#include "../decorator/plantDecorator/SmallStem.h"
+#include "../decorator/plantDecorator/Spring.h"
+#include "../decorator/plantDecorator/Summer.h"
+#include "../decorator/plantDecorator/Thorns.h"
+#include "../decorator/plantDecorator/Winter.h"
+#include "../mediator/Staff.h"
+#include "../mediator/Customer.h"
+
+namespace
+{
+    const char IMAGE_MAGIC[8] = {'P', 'S', 'Y', 'N', 'T', 'E', 'C', 'H'};
+    const std::uint32_t NONE = 0xffffffffu;
+    // Set in a child reference when it names a group rather than a plant
+    const std::uint32_t GROUP_BIT = 0x80000000u;
+    const std::uint8_t NO_ID = 0xff;
+
+    enum Section
+    {
+        STRING_OFFSETS = 0, // uint32 per string plus one end offset
+        STRING_DATA,        // bytes
+        PLANTS,             // ImagePlant
+        DECORATORS,         // uint32 string index
+        GROUPS,             // ImageGroup
+        CHILDREN,           // uint32 plant index, or group index | GROUP_BIT
+        OBSERVERS,          // uint32 staff index
+        STAFF,              // uint32 string index
+        CUSTOMERS,          // ImageCustomer
+        SECTION_COUNT
+    };
+
+    struct ImageSection
+    {
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    struct ImageHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        std::uint64_t fileSize;
+        std::uint32_t seasonId;
+        std::int32_t ticksSinceSeason;
+        ImageSection sections[SECTION_COUNT];
+    };
+
+    struct ImagePlant
+    {
+        std::uint32_t name;
+        std::uint32_t season;
+        std::int32_t age;
+        std::int32_t health;
+        std::int32_t waterLevel;
+        std::int32_t sunExposure;
+        double price;
+        std::int32_t waterAffect;
+        std::int32_t sunAffect;
+        std::uint32_t firstDecorator;
+        std::uint32_t decoratorCount;
+        std::uint8_t species;
+        std::uint8_t state;
+        std::uint8_t waterStrategy;
+        std::uint8_t sunStrategy;
+        // Water slot in the low four bits, sun slot in the high four; zero in older images
+        std::uint8_t careSlots;
+        std::uint8_t reserved[3];
+    };
+
+    struct ImageGroup
+    {
+        std::uint32_t name;
+        std::uint32_t firstChild;
+        std::uint32_t childCount;
+        std::uint32_t firstObserver;
+        std::uint32_t observerCount;
+    };
+
+    struct ImageCustomer
+    {
+        std::uint32_t name;
+        std::uint32_t basket;
+    };
+
+    const std::size_t RECORD_SIZES[SECTION_COUNT] = {
+        sizeof(std::uint32_t), 1, sizeof(ImagePlant), sizeof(std::uint32_t), sizeof(ImageGroup),
+        sizeof(std::uint32_t), sizeof(std::uint32_t), sizeof(std::uint32_t), sizeof(ImageCustomer)};
+
+    // Decorators are identified by their (unique) attribute name
+    PlantAttributes *newDecorator(const std::string &name)
+    {
+        if (name == "Large Pot")
+            return new LargePot();
+        if (name == "Standard Plant Charm")
+            return new PlantCharm();
+        if (name == "Red Clay Pot")
+            return new RedPot();
+        if (name == "Cute Charm")
+            return new ShopThemedCharm();
+        if (name == "Autumn Season")
+            return new Autumn();
+        if (name == "Large Flowers")
+            return new LargeFlowers();
+        if (name == "Large Leaves")
+            return new LargeLeaf();
+        if (name == "Large Stem")
+            return new LargeStem();
+        if (name == "Small Flowers")
+            return new SmallFlowers();
+        if (name == "Small Leaves")
+            return new SmallLeaf();
+        if (name == "Small Stem")
+            return new SmallStem();
+        if (name == "Spring Season")
+            return new Spring();
+        if (name == "Summer Season")
+            return new Summer();
+        if (name == "Thorns/Spikes")
+            return new Thorns();
+        if (name == "Winter Season")
+            return new Winter();
+        return nullptr;
+    }
+
+    LivingPlant *newPlant(PlantSpecies species, const std::string &name, const ImagePlant &record)
+    {
+        switch (species)
+        {
+        case PlantSpecies::Herb:
+            return new Herb(name);
+        case PlantSpecies::Shrub:
+            return new Shrub(name);
+        case PlantSpecies::Succulent:
+            return new Succulent(name);
+        case PlantSpecies::Tree:
+            return new Tree(name);
+        default:
+            return new LivingPlant(name, record.price, record.waterAffect, record.sunAffect);
+        }
+    }
+
+    class StringTable
+    {
+    private:
+        std::map<std::string, std::uint32_t> ids;
+
+    public:
+        std::vector<std::string> strings;
+
+        std::uint32_t intern(const std::string &value)
+        {
+            std::map<std::string, std::uint32_t>::iterator it = ids.find(value);
+            if (it != ids.end())
+                return it->second;
+            std::uint32_t id = static_cast<std::uint32_t>(strings.size());
+            strings.push_back(value);
+            ids[value] = id;
+            return id;
+        }
+    };
+
+    std::size_t alignUp(std::size_t value)
+    {
+        return (value + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    // Read-only mapping of a whole file, unmapped on destruction
+    class MappedFile
+    {
+    private:
+        void *data;
+        std::size_t size;
+
+    public:
+        MappedFile() : data(MAP_FAILED), size(0) {}
+        ~MappedFile()
+        {
+            if (data != MAP_FAILED)
+                munmap(data, size);
+        }
+
+        bool open(const std::string &path, std::string &error)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                error = "Cannot open " + path + ": " + std::strerror(errno);
+                return false;
+            }
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ImageHeader)))
+            {
+                close(fd);
+                error = path + " is not an inventory image";
+                return false;
+            }
+            size = static_cast<std::size_t>(info.st_size);
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED)
+            {
+                error = "Cannot map " + path + ": " + std::strerror(errno);
+                return false;
+            }
+            // The loader walks every record once, front to back
+            madvise(data, size, MADV_SEQUENTIAL);
+            return true;
+        }
+
+        const char *bytes() const { return static_cast<const char *>(data); }
+        std::size_t length() const { return size; }
+    };
+}
+
+bool InventoryImage::save(Inventory *inventory, const std::string &path, std::string &error)
+{
+    StringTable strings;
+    std::vector<ImagePlant> plants;
+    std::vector<std::uint32_t> decorators;
+    std::vector<ImageGroup> groupRecords;
+    std::vector<std::uint32_t> children;
+    std::vector<std::uint32_t> observers;
+    std::vector<std::uint32_t> staffRecords;
+    std::vector<ImageCustomer> customerRecords;
+
+    std::unordered_map<LivingPlant *, std::uint32_t> plantIds;
+    std::unordered_map<Staff *, std::uint32_t> staffIds;
+    std::vector<PlantGroup *> groups;
+
+    std::vector<Staff *> *staff = inventory->getStaff();
+    for (std::size_t i = 0; i < staff->size(); i++)
+    {
+        staffIds[(*staff)[i]] = static_cast<std::uint32_t>(i);
+        staffRecords.push_back(strings.intern((*staff)[i]->getName()));
+    }
+
+    Flyweight<MaturityState *> *states[4];
+    for (int id = 0; id < 4; id++)
+        states[id] = inventory->getStates(id);
+
+    // Groups are numbered in the order they are reached; each group's children are stored contiguously
+    groups.push_back(inventory->getInventory());
+    std::vector<Customer *> *customers = inventory->getCustomers();
+    std::size_t next = 0;
+    std::size_t customer = 0;
+    while (true)
+    {
+        if (next == groups.size())
+        {
+            // Root tree done: continue with the next customer basket
+            while (customer < customers->size() && (*customers)[customer]->getBasket() == nullptr)
+                customer++;
+            if (customer == customers->size())
+                break;
+            groups.push_back((*customers)[customer++]->getBasket());
+        }
+
+        PlantGroup *group = groups[next++];
+        ImageGroup record = {strings.intern(group->getGroupName()), static_cast<std::uint32_t>(children.size()), 0,
+                             static_cast<std::uint32_t>(observers.size()), 0};
+
+        for (PlantComponent *component : group->getChildren())
+        {
+            if (component == nullptr)
+                continue;
+            if (component->getType() == ComponentType::PLANT_GROUP)
+            {
+                children.push_back(static_cast<std::uint32_t>(groups.size()) | GROUP_BIT);
+                groups.push_back(static_cast<PlantGroup *>(component));
+                continue;
+            }
+            if (component->getType() != ComponentType::LIVING_PLANT)
+            {
+                error = "Group '" + group->getGroupName() + "' holds a component that is neither a plant nor a group";
+                return false;
+            }
+
+            LivingPlant *plant = static_cast<LivingPlant *>(component);
+            std::unordered_map<LivingPlant *, std::uint32_t>::iterator known = plantIds.find(plant);
+            if (known != plantIds.end())
+            {
+                children.push_back(known->second);
+                continue;
+            }
+
+            ImagePlant saved = ImagePlant();
+            saved.name = strings.intern(plant->getName());
+            saved.season = plant->getSeason() ? strings.intern(*plant->getSeason()->getState()) : NONE;
+            saved.age = plant->getAge();
+            saved.health = plant->getHealth();
+            saved.waterLevel = plant->getWaterLevel();
+            saved.sunExposure = plant->getSunExposure();
+            saved.price = plant->getPrice();
+            saved.waterAffect = plant->affectWater();
+            saved.sunAffect = plant->affectSunlight();
+            saved.species = static_cast<std::uint8_t>(plant->getSpecies());
+
+            saved.state = NO_ID;
+            Flyweight<MaturityState *> *state = plant->getMaturityState();
+            for (int id = 0; id < 4; id++)
+            {
+                if (state == states[id])
+                    saved.state = static_cast<std::uint8_t>(id);
+            }
+            saved.waterStrategy = 0;
+            saved.sunStrategy = 0;
+            for (int id = 1; id <= 4; id++)
+            {
+                if (!plant->waterStrategy.isNone() && plant->waterStrategy == WaterHandle::of(inventory->getWaterFly(id)))
+                    saved.waterStrategy = static_cast<std::uint8_t>(id);
+                if (!plant->sunStrategy.isNone() && plant->sunStrategy == SunHandle::of(inventory->getSunFly(id)))
+                    saved.sunStrategy = static_cast<std::uint8_t>(id);
+            }
+
+            saved.careSlots = static_cast<std::uint8_t>(plant->getWaterSlot() | (plant->getSunSlot() << 4));
+
+            saved.firstDecorator = static_cast<std::uint32_t>(decorators.size());
+            PlantComponent *link = plant->getDecorator();
+            while (link && link != plant && link->getType() == ComponentType::PLANT_COMPONENT)
+            {
+                PlantAttributes *attribute = static_cast<PlantAttributes *>(link);
+                decorators.push_back(strings.intern(*attribute->getNameFlyweight()->getState()));
+                link = attribute->nextComponent;
+            }
+            saved.decoratorCount = static_cast<std::uint32_t>(decorators.size()) - saved.firstDecorator;
+
+            std::uint32_t id = static_cast<std::uint32_t>(plants.size());
+            plantIds[plant] = id;
+            plants.push_back(saved);
+            children.push_back(id);
+        }
+
+        for (Observer *observer : group->getObservers())
+        {
+            std::unordered_map<Staff *, std::uint32_t>::iterator known = staffIds.find(dynamic_cast<Staff *>(observer));
+            if (known != staffIds.end())
+                observers.push_back(known->second);
+        }
+
+        record.childCount = static_cast<std::uint32_t>(children.size()) - record.firstChild;
+        record.observerCount = static_cast<std::uint32_t>(observers.size()) - record.firstObserver;
+        groupRecords.push_back(record);
+    }
+
+    std::unordered_map<PlantGroup *, std::uint32_t> basketIds;
+    for (std::size_t i = 0; i < groups.size(); i++)
+        basketIds[groups[i]] = static_cast<std::uint32_t>(i);
+    for (std::size_t i = 0; i < customers->size(); i++)
+    {
+        PlantGroup *basket = (*customers)[i]->getBasket();
+        ImageCustomer record = {strings.intern((*customers)[i]->getName()), basket ? basketIds[basket] : NONE};
+        customerRecords.push_back(record);
+    }
+
+    std::vector<std::uint32_t> stringOffsets;
+    std::string stringData;
+    for (std::size_t i = 0; i < strings.strings.size(); i++)
+    {
+        stringOffsets.push_back(static_cast<std::uint32_t>(stringData.size()));
+        stringData += strings.strings[i];
+    }
+    stringOffsets.push_back(static_cast<std::uint32_t>(stringData.size()));
+
+    const void *sectionData[SECTION_COUNT] = {
+        stringOffsets.data(), stringData.data(), plants.data(), decorators.data(), groupRecords.data(),
+        children.data(), observers.data(), staffRecords.data(), customerRecords.data()};
+    std::size_t sectionCounts[SECTION_COUNT] = {
+        stringOffsets.size(), stringData.size(), plants.size(), decorators.size(), groupRecords.size(),
+        children.size(), observers.size(), staffRecords.size(), customerRecords.size()};
+
+    ImageHeader header = ImageHeader();
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(ImageHeader);
+    header.seasonId = static_cast<std::uint32_t>(inventory->currentSeasonId);
+    header.ticksSinceSeason = inventory->ticksSinceSeason;
+
+    std::size_t offset = alignUp(sizeof(ImageHeader));
+    for (int section = 0; section < SECTION_COUNT; section++)
+    {
+        header.sections[section].offset = offset;
+        header.sections[section].count = sectionCounts[section];
+        offset = alignUp(offset + sectionCounts[section] * RECORD_SIZES[section]);
+    }
+    header.fileSize = offset;
+
+    std::vector<char> image(offset, 0);
+    std::memcpy(&image[0], &header, sizeof(header));
+    for (int section = 0; section < SECTION_COUNT; section++)
+    {
+        if (sectionCounts[section] > 0)
+            std::memcpy(&image[header.sections[section].offset], sectionData[section], sectionCounts[section] * RECORD_SIZES[section]);
+    }
+
+    std::string temporary = path + ".tmp";
+    FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        error = "Cannot create " + temporary + ": " + std::strerror(errno);
+        return false;
+    }
+    // Flushed to disk before the rename, so a crash never leaves a renamed but empty image
+    bool written = std::fwrite(&image[0], 1, image.size(), file) == image.size();
+    written = std::fflush(file) == 0 && fsync(fileno(file)) == 0 && written;
+    written = std::fclose(file) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        error = "Cannot write " + path + ": " + std::strerror(errno);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool InventoryImage::load(Inventory *inventory, const std::string &path, std::string &error)
+{
+    MappedFile file;
+    if (!file.open(path, error))
+        return false;
+
+    ImageHeader header;
+    std::memcpy(&header, file.bytes(), sizeof(header));
+    if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0)
+    {
+        error = path + " is not an inventory image";
+        return false;
+    }
+    if (header.version != VERSION || header.headerSize != sizeof(ImageHeader))
+    {
+        error = path + " has image version " + std::to_string(header.version) + ", expected " + std::to_string(VERSION);
+        return false;
+    }
+    if (header.fileSize != file.length())
+    {
+        error = path + " is truncated";
+        return false;
+    }
+
+    const char *sections[SECTION_COUNT];
+    for (int section = 0; section < SECTION_COUNT; section++)
+    {
+        std::uint64_t offset = header.sections[section].offset;
+        std::uint64_t count = header.sections[section].count;
+        if (offset % 8 != 0 || offset > file.length() || count > (file.length() - offset) / RECORD_SIZES[section])
+        {
+            error = path + " is corrupt: section " + std::to_string(section) + " lies outside the file";
+            return false;
+        }
+        sections[section] = file.bytes() + offset;
+    }
+
+    const std::uint32_t *stringOffsets = reinterpret_cast<const std::uint32_t *>(sections[STRING_OFFSETS]);
+    const ImagePlant *plants = reinterpret_cast<const ImagePlant *>(sections[PLANTS]);
+    const std::uint32_t *decorators = reinterpret_cast<const std::uint32_t *>(sections[DECORATORS]);
+    const ImageGroup *groups = reinterpret_cast<const ImageGroup *>(sections[GROUPS]);
+    const std::uint32_t *children = reinterpret_cast<const std::uint32_t *>(sections[CHILDREN]);
+    const std::uint32_t *observers = reinterpret_cast<const std::uint32_t *>(sections[OBSERVERS]);
+    const std::uint32_t *staffNames = reinterpret_cast<const std::uint32_t *>(sections[STAFF]);
+    const ImageCustomer *customers = reinterpret_cast<const ImageCustomer *>(sections[CUSTOMERS]);
+
+    std::size_t stringCount = header.sections[STRING_OFFSETS].count;
+    std::size_t plantCount = header.sections[PLANTS].count;
+    std::size_t decoratorCount = header.sections[DECORATORS].count;
+    std::size_t groupCount = header.sections[GROUPS].count;
+    std::size_t childCount = header.sections[CHILDREN].count;
+    std::size_t observerCount = header.sections[OBSERVERS].count;
+    std::size_t staffCount = header.sections[STAFF].count;
+    std::size_t customerCount = header.sections[CUSTOMERS].count;
+
+    // Validate everything first, so a bad image never leaves a partly built inventory
+    std::string corrupt = path + " is corrupt: ";
+    if (stringCount == 0 || groupCount == 0)
+    {
+        error = corrupt + "missing string table or root group";
+        return false;
+    }
+    stringCount--;
+    for (std::size_t i = 0; i < stringCount; i++)
+    {
+        if (stringOffsets[i] > stringOffsets[i + 1])
+        {
+            error = corrupt + "bad string table";
+            return false;
+        }
+    }
+    if (stringOffsets[stringCount] > header.sections[STRING_DATA].count)
+    {
+        error = corrupt + "bad string table";
+        return false;
+    }
+    if (header.seasonId < static_cast<std::uint32_t>(SeasonId::Spring) ||
+        header.seasonId > static_cast<std::uint32_t>(SeasonId::Winter))
+    {
+        error = corrupt + "unknown season";
+        return false;
+    }
+    // advanceDay() changes season when the count reaches 8, so it never holds more
+    if (header.ticksSinceSeason < 0 || header.ticksSinceSeason > 8)
+    {
+        error = corrupt + "bad day count within the season";
+        return false;
+    }
+
+    std::vector<std::string> strings(stringCount);
+    for (std::size_t i = 0; i < stringCount; i++)
+        strings[i].assign(sections[STRING_DATA] + stringOffsets[i], stringOffsets[i + 1] - stringOffsets[i]);
+
+    for (std::size_t i = 0; i < plantCount; i++)
+    {
+        const ImagePlant &plant = plants[i];
+        if (plant.name >= stringCount || (plant.season != NONE && plant.season >= stringCount) ||
+            plant.species > static_cast<std::uint8_t>(PlantSpecies::Tree) ||
+            (plant.state != NO_ID && plant.state > 3) || plant.waterStrategy > 4 || plant.sunStrategy > 4 ||
+            plant.firstDecorator > decoratorCount || plant.decoratorCount > decoratorCount - plant.firstDecorator)
+        {
+            error = corrupt + "bad plant record " + std::to_string(i);
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < decoratorCount; i++)
+    {
+        if (decorators[i] >= stringCount)
+        {
+            error = corrupt + "bad decorator record " + std::to_string(i);
+            return false;
+        }
+    }
+
+    // Every group but the root must be reached exactly once, from the root or a basket
+    std::vector<unsigned char> reached(groupCount, 0);
+    std::vector<unsigned char> plantUsed(plantCount, 0);
+    std::vector<std::uint32_t> order(1, 0);
+    reached[0] = 1;
+    for (std::size_t i = 0; i < customerCount; i++)
+    {
+        std::uint32_t basket = customers[i].basket;
+        if (customers[i].name >= stringCount || (basket != NONE && (basket == 0 || basket >= groupCount || reached[basket])))
+        {
+            error = corrupt + "bad customer record " + std::to_string(i);
+            return false;
+        }
+        if (basket != NONE)
+        {
+            reached[basket] = 1;
+            order.push_back(basket);
+        }
+    }
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        const ImageGroup &group = groups[order[i]];
+        if (group.name >= stringCount || group.firstChild > childCount || group.childCount > childCount - group.firstChild ||
+            group.firstObserver > observerCount || group.observerCount > observerCount - group.firstObserver)
+        {
+            error = corrupt + "bad group record " + std::to_string(order[i]);
+            return false;
+        }
+        for (std::uint32_t c = 0; c < group.childCount; c++)
+        {
+            std::uint32_t child = children[group.firstChild + c];
+            std::uint32_t index = child & ~GROUP_BIT;
+            bool bad = (child & GROUP_BIT) ? (index >= groupCount || reached[index]) : index >= plantCount;
+            if (bad)
+            {
+                error = corrupt + "bad child of group " + std::to_string(order[i]);
+                return false;
+            }
+            if (child & GROUP_BIT)
+            {
+                reached[index] = 1;
+                order.push_back(index);
+            }
+            else
+            {
+                plantUsed[index] = 1;
+            }
+        }
+        for (std::uint32_t o = 0; o < group.observerCount; o++)
+        {
+            if (observers[group.firstObserver + o] >= staffCount)
+            {
+                error = corrupt + "bad observer of group " + std::to_string(order[i]);
+                return false;
+            }
+        }
+    }
+    if (order.size() != groupCount)
+    {
+        error = corrupt + "unreachable groups";
+        return false;
+    }
+    for (std::size_t i = 0; i < plantCount; i++)
+    {
+        if (!plantUsed[i])
+        {
+            error = corrupt + "plant " + std::to_string(i) + " is in no group";
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < staffCount; i++)
+    {
+        if (staffNames[i] >= stringCount)
+        {
+            error = corrupt + "bad staff record " + std::to_string(i);
+            return false;
+        }
+    }
+    // Check each distinct decorator name once
+    std::vector<unsigned char> decoratorNameChecked(stringCount, 0);
+    for (std::size_t i = 0; i < decoratorCount; i++)
+    {
+        if (decoratorNameChecked[decorators[i]])
+            continue;
+        PlantAttributes *probe = newDecorator(strings[decorators[i]]);
+        if (!probe)
+        {
+            error = path + " uses unknown decorator '" + strings[decorators[i]] + "'";
+            return false;
+        }
+        delete probe;
+        decoratorNameChecked[decorators[i]] = 1;
+    }
+
+    // Build: plants and decorators are created in the target inventory
+    Inventory::Binding binding(inventory);
+
+    std::vector<Flyweight<std::string *> *> flyweights(stringCount, nullptr);
+    for (std::size_t i = 0; i < stringCount; i++)
+        flyweights[i] = inventory->getString(strings[i]);
+
+    inventory->getPlantStates()->reserve(plantCount);
+    std::vector<LivingPlant *> built(plantCount);
+    std::vector<PlantAttributes *> chain;
+    for (std::size_t i = 0; i < plantCount; i++)
+    {
+        const ImagePlant &record = plants[i];
+        LivingPlant *plant = newPlant(static_cast<PlantSpecies>(record.species), strings[record.name], record);
+        plant->price = record.price;
+        plant->affectWaterValue = record.waterAffect;
+        plant->affectSunValue = record.sunAffect;
+        plant->waterStrategy = record.waterStrategy ? inventory->shareWaterFly(record.waterStrategy) : WaterHandle::none();
+        plant->sunStrategy = record.sunStrategy ? inventory->shareSunFly(record.sunStrategy) : SunHandle::none();
+        plant->setWaterSlot(record.careSlots & 15);
+        plant->setSunSlot(record.careSlots >> 4);
+        if (record.season != NONE)
+            plant->setSeason(flyweights[record.season]);
+        plant->setAge(record.age);
+        plant->setHealth(record.health);
+        plant->setWaterLevel(record.waterLevel);
+        plant->setSunExposure(record.sunExposure);
+        if (record.state != NO_ID)
+            plant->setMaturity(record.state);
+
+        // The first attribute added stays outermost and later ones go directly beneath it
+        if (record.decoratorCount > 0)
+        {
+            chain.clear();
+            for (std::uint32_t d = 0; d < record.decoratorCount; d++)
+                chain.push_back(newDecorator(strings[decorators[record.firstDecorator + d]]));
+            plant->addAttribute(chain[0]);
+            for (std::size_t d = chain.size() - 1; d > 0; d--)
+                plant->addAttribute(chain[d]);
+        }
+        built[i] = plant;
+    }
+
+    std::vector<Staff *> staff(staffCount);
+    for (std::size_t i = 0; i < staffCount; i++)
+    {
+        staff[i] = new Staff(strings[staffNames[i]]);
+        inventory->addStaff(staff[i]);
+    }
+
+    // Baskets are not rebuilt as groups: each customer creates its own basket
+    std::vector<unsigned char> isBasket(groupCount, 0);
+    for (std::size_t i = 0; i < customerCount; i++)
+    {
+        if (customers[i].basket != NONE)
+            isBasket[customers[i].basket] = 1;
+    }
+
+    std::vector<PlantGroup *> builtGroups(groupCount, nullptr);
+    builtGroups[0] = inventory->getInventory();
+    for (std::size_t i = 1; i < groupCount; i++)
+    {
+        if (!isBasket[i])
+            builtGroups[i] = new PlantGroup(strings[groups[i].name]);
+    }
+
+    for (std::size_t g = 0; g < groupCount; g++)
+    {
+        if (isBasket[g])
+            continue;
+        const ImageGroup &group = groups[g];
+        for (std::uint32_t c = 0; c < group.childCount; c++)
+        {
+            std::uint32_t child = children[group.firstChild + c];
+            if (child & GROUP_BIT)
+                builtGroups[g]->addComponent(builtGroups[child & ~GROUP_BIT]);
+            else
+                builtGroups[g]->addComponent(built[child]);
+        }
+        for (std::uint32_t o = 0; o < group.observerCount; o++)
+            builtGroups[g]->attach(staff[observers[group.firstObserver + o]]);
+    }
+
+    for (std::size_t i = 0; i < customerCount; i++)
+    {
+        Customer *customer = new Customer(strings[customers[i].name]);
+        inventory->addCustomer(customer);
+        if (customers[i].basket == NONE)
+            continue;
+
+        const ImageGroup &group = groups[customers[i].basket];
+        for (std::uint32_t c = 0; c < group.childCount; c++)
+        {
+            std::uint32_t child = children[group.firstChild + c];
+            if (child & GROUP_BIT)
+                customer->addPlant(builtGroups[child & ~GROUP_BIT]);
+            else
+                customer->addPlant(built[child]);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(inventory->tickLock);
+        inventory->currentSeasonId = static_cast<SeasonId>(header.seasonId);
+        inventory->currentSeason = inventory->seasonStrings[header.seasonId];
+        inventory->ticksSinceSeason = header.ticksSinceSeason;
+    }
+    if (inventory->snapshotPublishing)
+        inventory->publishSnapshot();
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef InventoryImage_h
+#define InventoryImage_h
+
+#include <cstdint>
+#include <string>
+
+class Inventory;
+
+/**
+ * @brief Versioned binary file holding a whole Inventory, loaded through mmap.
+ *
+ * The file is a fixed header followed by flat arrays of fixed-size records,
+ * each array 8-byte aligned, so the loader reads them in place from the
+ * mapping instead of parsing:
+ * - an interned string table (plant, group, decorator, staff, customer and
+ *   season names are each stored once and referred to by index);
+ * - one record per plant: species, name, season, price and affect values,
+ *   strategy and maturity state IDs and the strategies' per-plant slots, age,
+ *   health, water and sun levels, and a run of decorator records naming its
+ *   decorator chain, outermost first;
+ * - one record per group with a run of child references (plants or groups)
+ *   and a run of observer references; group 0 is the inventory root, and
+ *   customer baskets are stored as further groups;
+ * - staff and customers, each customer pointing at its basket group;
+ * - the current season and the day count within it.
+ *
+ * Everything in the file is validated before the first object is created, so
+ * a truncated or corrupt file never leaves a half-loaded inventory behind.
+ * Loading then allocates the plant rows in one go and builds every plant
+ * directly from its record, which is much cheaper than running a Builder per
+ * plant.
+ *
+ * Not stored: the dead-plant archive, tick statistics, queued commands, the
+ * ticker settings and observers that are not the inventory's own Staff.
+ *
+ * **System Role:**
+ * Lets the nursery persist between runs and start large inventories quickly.
+ * Neither call may run while the inventory is ticking.
+ *
+ * @see Inventory
+ */
+class InventoryImage
+{
+public:
+	/** Format version written by save(); load() rejects any other version. */
+	static const std::uint32_t VERSION = 1;
+
+	/**
+	 * @brief Writes an inventory to a file.
+	 *
+	 * The image is written to a temporary file next to path and renamed over
+	 * it, so an existing image is only replaced by a complete one.
+	 *
+	 * @param inventory Inventory to save.
+	 * @param path File to write.
+	 * @param error Receives the reason on failure.
+	 * @return True if the file was written.
+	 */
+	static bool save(Inventory *inventory, const std::string &path, std::string &error);
+
+	/**
+	 * @brief Adds the contents of an image to an inventory.
+	 *
+	 * The image's top-level components are appended to the inventory's root
+	 * group, its staff and customers are added to the inventory's lists, and
+	 * the inventory's season and day count are replaced. Normally used on a
+	 * fresh inventory.
+	 *
+	 * @param inventory Inventory to fill.
+	 * @param path File to read.
+	 * @param error Receives the reason on failure.
+	 * @return True if the image was loaded; on failure the inventory is unchanged.
+	 */
+	static bool load(Inventory *inventory, const std::string &path, std::string &error);
+};
+
+#endif
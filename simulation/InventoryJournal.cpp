@@ -0,0 +1,590 @@
+#include "InventoryJournal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "InventoryImage.h"
+#include "../singleton/Singleton.h"
+#include "../composite/PlantGroup.h"
+#include "../mediator/Staff.h"
+#include "../mediator/Customer.h"
+
+namespace
+{
+    const char MAGIC[8] = {'P', 'S', 'Y', 'J', 'R', 'N', 'L', '\0'};
+
+    // Magic, version and generation
+    const std::size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+
+    // Payload size and checksum in front of every record
+    const std::size_t FRAME_SIZE = 2 * sizeof(std::uint32_t);
+
+    // Op, both operands and the text length
+    const std::size_t RECORD_FIXED_SIZE = 1 + 3 * sizeof(std::uint32_t);
+
+    const std::uint32_t MAX_TEXT = 1u << 16;
+
+    // A batch this large is written without waiting for the flush interval
+    const std::size_t FLUSH_BYTES = 64 * 1024;
+
+    // FNV-1a: cheap, and catches the torn and zero-filled tails a crash leaves
+    std::uint32_t checksum(const char *data, std::size_t size)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void putWord(std::string &out, std::uint32_t value)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    std::uint32_t getWord(const std::string &in, std::size_t offset)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, in.data() + offset, sizeof(value));
+        return value;
+    }
+
+    bool writeAll(int fd, const std::string &data)
+    {
+        std::size_t done = 0;
+        while (done < data.size())
+        {
+            ssize_t written = write(fd, data.data() + done, data.size() - done);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            done += static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    bool syncDirectory(const std::string &directory)
+    {
+        int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir < 0)
+            return false;
+        bool synced = fsync(dir) == 0;
+        ::close(dir);
+        return synced;
+    }
+
+    // Matches journal-N.log and extracts N
+    bool parseJournalName(const std::string &name, unsigned int &number)
+    {
+        const std::string prefix = "journal-";
+        const std::string suffix = ".log";
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            return false;
+
+        std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        number = static_cast<unsigned int>(std::stoul(digits));
+        return true;
+    }
+
+    bool fileExists(const std::string &path)
+    {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0;
+    }
+}
+
+InventoryJournal::InventoryJournal()
+    : generation(0), fd(-1), replaying(false), appended(0), durable(0), waiters(0),
+      flushing(false), stopping(false), failed(false), syncCount(0), flushInterval(5)
+{
+}
+
+InventoryJournal::~InventoryJournal()
+{
+    close();
+}
+
+std::string InventoryJournal::pathOf(const char *kind, unsigned int number) const
+{
+    const char *extension = std::strcmp(kind, "base") == 0 ? ".img" : ".log";
+    return directory + "/" + kind + "-" + std::to_string(number) + extension;
+}
+
+bool InventoryJournal::open(const std::string &path, std::string &error)
+{
+    close();
+    directory = path;
+    generation = 0;
+    recovered.clear();
+
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        error = "Cannot create " + directory + ": " + std::strerror(errno);
+        return false;
+    }
+
+    DIR *dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        error = "Cannot read " + directory + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // The newest journal wins: it is only created once its base image is on disk
+    bool found = false;
+    while (struct dirent *entry = readdir(dir))
+    {
+        unsigned int number;
+        if (parseJournalName(entry->d_name, number) && (!found || number > generation))
+        {
+            generation = number;
+            found = true;
+        }
+    }
+    closedir(dir);
+
+    if (found && !readJournal(pathOf("journal", generation), error))
+        return false;
+    return true;
+}
+
+bool InventoryJournal::readJournal(const std::string &path, std::string &error)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        error = "Cannot open " + path;
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = path + " is not a journal";
+        return false;
+    }
+    if (getWord(data, sizeof(MAGIC)) != VERSION)
+    {
+        error = path + " has an unsupported version";
+        return false;
+    }
+
+    // Everything from the first incomplete or damaged record on was never committed
+    std::size_t offset = HEADER_SIZE;
+    while (offset + FRAME_SIZE <= data.size())
+    {
+        std::uint32_t size = getWord(data, offset);
+        std::uint32_t sum = getWord(data, offset + sizeof(std::uint32_t));
+        std::size_t payload = offset + FRAME_SIZE;
+        if (size < RECORD_FIXED_SIZE || size > RECORD_FIXED_SIZE + MAX_TEXT || payload + size > data.size() ||
+            checksum(data.data() + payload, size) != sum)
+            break;
+
+        JournalRecord record;
+        std::uint8_t op = static_cast<std::uint8_t>(data[payload]);
+        record.first = getWord(data, payload + 1);
+        record.second = getWord(data, payload + 1 + sizeof(std::uint32_t));
+        std::uint32_t textSize = getWord(data, payload + 1 + 2 * sizeof(std::uint32_t));
+        if (op < static_cast<std::uint8_t>(JournalOp::CreatePlant) || op > static_cast<std::uint8_t>(JournalOp::Purchase) ||
+            RECORD_FIXED_SIZE + textSize != size)
+            break;
+        record.op = static_cast<JournalOp>(op);
+        record.text.assign(data, payload + RECORD_FIXED_SIZE, textSize);
+        recovered.push_back(record);
+
+        offset = payload + size;
+    }
+    return true;
+}
+
+std::string InventoryJournal::getBaseImage() const
+{
+    std::string path = pathOf("base", generation);
+    return generation > 0 && fileExists(path) ? path : std::string();
+}
+
+bool InventoryJournal::startGeneration(unsigned int next, std::string &error)
+{
+    // The journal appears under its final name complete with header, or not at all
+    std::string path = pathOf("journal", next);
+    std::string temporary = path + ".tmp";
+    int file = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        error = "Cannot create " + temporary + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::string header(MAGIC, sizeof(MAGIC));
+    putWord(header, VERSION);
+    putWord(header, next);
+    if (!writeAll(file, header) || fsync(file) != 0 || std::rename(temporary.c_str(), path.c_str()) != 0 ||
+        !syncDirectory(directory))
+    {
+        error = "Cannot write " + path + ": " + std::strerror(errno);
+        ::close(file);
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        durableChanged.wait(lock, [this]()
+                            { return !flushing; });
+        if (fd >= 0)
+            ::close(fd);
+        fd = file;
+        pending.clear();
+        durable = appended;
+        failed = false;
+        failure.clear();
+    }
+
+    if (!writer.joinable())
+    {
+        stopping = false;
+        writer = std::thread(&InventoryJournal::flushLoop, this);
+    }
+    return true;
+}
+
+bool InventoryJournal::compact(Inventory *inventory, std::string &error)
+{
+    if (directory.empty())
+    {
+        error = "The journal is not open";
+        return false;
+    }
+    // After a failure the new base image holds every change the journal lost
+    sync();
+
+    unsigned int previous = generation;
+    unsigned int next = generation + 1;
+    if (!InventoryImage::save(inventory, pathOf("base", next), error) || !startGeneration(next, error))
+    {
+        std::remove(pathOf("base", next).c_str());
+        return false;
+    }
+    generation = next;
+
+    // Only now is the old generation no longer needed for recovery
+    std::remove(pathOf("journal", previous).c_str());
+    std::remove(pathOf("base", previous).c_str());
+
+    registerInventory(inventory);
+    return true;
+}
+
+void InventoryJournal::close()
+{
+    if (writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    pending.clear();
+    objects.clear();
+    ids.clear();
+}
+
+void InventoryJournal::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait_for(lock, flushInterval, [this]()
+                      { return stopping || (!pending.empty() && (waiters > 0 || pending.size() >= FLUSH_BYTES)); });
+
+        if (!pending.empty() && !failed)
+        {
+            // Records appended while this batch syncs form the next batch
+            std::string batch;
+            batch.swap(pending);
+            std::uint64_t upTo = appended;
+            int target = fd;
+            flushing = true;
+            lock.unlock();
+
+            bool written = writeAll(target, batch) && fdatasync(target) == 0;
+            int reason = errno;
+
+            lock.lock();
+            flushing = false;
+            syncCount++;
+            if (written)
+                durable = upTo;
+            else
+            {
+                failed = true;
+                failure = std::string("Cannot write the journal: ") + std::strerror(reason);
+            }
+            durableChanged.notify_all();
+        }
+
+        if (stopping)
+            break;
+    }
+}
+
+bool InventoryJournal::sync()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    std::uint64_t target = appended;
+    if (durable >= target || failed)
+        return !failed;
+
+    waiters++;
+    wake.notify_one();
+    durableChanged.wait(lock, [this, target]()
+                        { return durable >= target || failed; });
+    waiters--;
+    return !failed;
+}
+
+bool InventoryJournal::isFailed()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+std::string InventoryJournal::getFailure()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return failure;
+}
+
+void InventoryJournal::setFlushInterval(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    flushInterval = interval;
+}
+
+std::uint64_t InventoryJournal::getAppendedCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return appended;
+}
+
+std::uint64_t InventoryJournal::getSyncCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return syncCount;
+}
+
+void InventoryJournal::setReplaying(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    replaying = enabled;
+}
+
+void InventoryJournal::append(JournalOp op, std::uint32_t first, std::uint32_t second, const std::string &text)
+{
+    // While replaying, or before the first generation starts, recording only hands out IDs
+    if (replaying || fd < 0 || failed)
+        return;
+
+    std::string payload;
+    payload.push_back(static_cast<char>(op));
+    putWord(payload, first);
+    putWord(payload, second);
+    std::uint32_t textSize = static_cast<std::uint32_t>(std::min<std::size_t>(text.size(), MAX_TEXT));
+    putWord(payload, textSize);
+    payload.append(text, 0, textSize);
+
+    putWord(pending, static_cast<std::uint32_t>(payload.size()));
+    putWord(pending, checksum(payload.data(), payload.size()));
+    pending += payload;
+    appended++;
+
+    if (pending.size() >= FLUSH_BYTES)
+        wake.notify_one();
+}
+
+std::uint32_t InventoryJournal::assign(const void *pointer, ObjectKind kind)
+{
+    // A new object may reuse the address of a deleted one, so the newest wins
+    std::uint32_t id = static_cast<std::uint32_t>(objects.size());
+    JournalObject object = {pointer, kind};
+    objects.push_back(object);
+    ids[pointer] = id;
+    return id;
+}
+
+std::uint32_t InventoryJournal::find(const void *pointer, ObjectKind kind) const
+{
+    std::unordered_map<const void *, std::uint32_t>::const_iterator known = ids.find(pointer);
+    if (!pointer || known == ids.end() || objects[known->second].kind != kind)
+        return UNKNOWN;
+    return known->second;
+}
+
+const void *InventoryJournal::lookup(std::uint32_t id, ObjectKind kind) const
+{
+    if (id >= objects.size() || objects[id].kind != kind)
+        return nullptr;
+    return objects[id].pointer;
+}
+
+void InventoryJournal::registerTree(PlantComponent *component)
+{
+    if (ids.find(component) == ids.end())
+        assign(component, ObjectKind::Component);
+
+    if (component->getType() == ComponentType::PLANT_GROUP)
+    {
+        for (PlantComponent *child : static_cast<PlantGroup *>(component)->getChildren())
+        {
+            if (child != nullptr)
+                registerTree(child);
+        }
+    }
+}
+
+void InventoryJournal::forgetTree(PlantComponent *component)
+{
+    std::unordered_map<const void *, std::uint32_t>::iterator known = ids.find(component);
+    if (known != ids.end())
+    {
+        objects[known->second].pointer = nullptr;
+        objects[known->second].kind = ObjectKind::Forgotten;
+        ids.erase(known);
+    }
+
+    if (component->getType() == ComponentType::PLANT_GROUP)
+    {
+        for (PlantComponent *child : static_cast<PlantGroup *>(component)->getChildren())
+        {
+            if (child != nullptr)
+                forgetTree(child);
+        }
+    }
+}
+
+void InventoryJournal::registerInventory(Inventory *inventory)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    objects.clear();
+    ids.clear();
+
+    registerTree(inventory->getInventory());
+
+    std::vector<Staff *> *staff = inventory->getStaff();
+    for (std::size_t i = 0; i < staff->size(); i++)
+        assign((*staff)[i], ObjectKind::Staff);
+
+    std::vector<Customer *> *customers = inventory->getCustomers();
+    for (std::size_t i = 0; i < customers->size(); i++)
+    {
+        assign((*customers)[i], ObjectKind::Customer);
+        PlantGroup *basket = (*customers)[i]->getBasket();
+        if (basket)
+        {
+            for (PlantComponent *plant : basket->getChildren())
+            {
+                if (plant != nullptr)
+                    registerTree(plant);
+            }
+        }
+    }
+}
+
+void InventoryJournal::recordCreated(JournalOp op, PlantComponent *component, const std::string &text)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    assign(component, ObjectKind::Component);
+    append(op, 0, 0, text);
+}
+
+void InventoryJournal::recordCreated(Staff *staff)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    assign(staff, ObjectKind::Staff);
+    append(JournalOp::AddStaff, 0, 0, staff->getName());
+}
+
+void InventoryJournal::recordCreated(Customer *customer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    assign(customer, ObjectKind::Customer);
+    append(JournalOp::AddCustomer, 0, 0, customer->getName());
+}
+
+bool InventoryJournal::record(JournalOp op, PlantComponent *first, PlantComponent *second)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint32_t firstId = find(first, ObjectKind::Component);
+    std::uint32_t secondId = second ? find(second, ObjectKind::Component) : 0;
+    if (firstId == UNKNOWN || secondId == UNKNOWN)
+        return false;
+    append(op, firstId, secondId, std::string());
+    return true;
+}
+
+bool InventoryJournal::record(JournalOp op, Staff *staff, PlantGroup *group)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint32_t staffId = find(staff, ObjectKind::Staff);
+    std::uint32_t groupId = find(static_cast<PlantComponent *>(group), ObjectKind::Component);
+    if (staffId == UNKNOWN || groupId == UNKNOWN)
+        return false;
+    append(op, staffId, groupId, std::string());
+    return true;
+}
+
+bool InventoryJournal::record(JournalOp op, Customer *customer, PlantComponent *plant, std::uint32_t index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint32_t customerId = find(customer, ObjectKind::Customer);
+    std::uint32_t second = plant ? find(plant, ObjectKind::Component) : index;
+    if (customerId == UNKNOWN || second == UNKNOWN)
+        return false;
+    append(op, customerId, second, std::string());
+    return true;
+}
+
+void InventoryJournal::forget(PlantComponent *component)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (component)
+        forgetTree(component);
+}
+
+PlantComponent *InventoryJournal::getComponent(std::uint32_t id) const
+{
+    return static_cast<PlantComponent *>(const_cast<void *>(lookup(id, ObjectKind::Component)));
+}
+
+Staff *InventoryJournal::getStaff(std::uint32_t id) const
+{
+    return static_cast<Staff *>(const_cast<void *>(lookup(id, ObjectKind::Staff)));
+}
+
+Customer *InventoryJournal::getCustomer(std::uint32_t id) const
+{
+    return static_cast<Customer *>(const_cast<void *>(lookup(id, ObjectKind::Customer)));
+}
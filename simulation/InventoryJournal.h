@@ -0,0 +1,339 @@
+#ifndef InventoryJournal_h
+#define InventoryJournal_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Inventory;
+class PlantComponent;
+class PlantGroup;
+class Staff;
+class Customer;
+
+/**
+ * @brief Kinds of inventory change recorded in an InventoryJournal.
+ *
+ * Each names the NurseryFacade call that made the change and that replays it.
+ */
+enum class JournalOp : std::uint8_t
+{
+	CreatePlant = 1,	///< text: plant type; creates object
+	CreateGroup,		///< text: group name; creates object
+	AddToGroup,			///< first: parent group, second: child component
+	RemoveFromInventory, ///< first: component
+	AddStaff,			///< text: name; creates object
+	AddCustomer,		///< text: name; creates object
+	AttachObserver,		///< first: staff, second: group
+	DetachObserver,		///< first: staff, second: group
+	AddToBasket,		///< first: customer, second: plant
+	ReturnFromBasket,	///< first: customer, second: basket index
+	Purchase			///< first: customer
+};
+
+/**
+ * @brief One change read back from a journal file.
+ */
+struct JournalRecord
+{
+	JournalOp op;
+	/** Object ID (or, for ReturnFromBasket, the first operand). */
+	std::uint32_t first;
+	/** Second object ID or value; unused operands are zero. */
+	std::uint32_t second;
+	/** Plant type or name for the records that create an object. */
+	std::string text;
+};
+
+/**
+ * @brief Write-ahead log of inventory changes, made durable by group commit.
+ *
+ * The journal lives in a directory holding one generation at a time: an
+ * optional base image `base-N.img` (an InventoryImage) and the journal
+ * `journal-N.log` of every change made since that image was written. A
+ * journal file is a short header followed by records, each framed by its
+ * length and a checksum so that a record torn by a crash is recognised and
+ * ignored along with everything after it.
+ *
+ * Records refer to plants, groups, staff and customers by object ID rather
+ * than by pointer. IDs are handed out in order: first to everything already in
+ * the inventory when the generation starts (see registerInventory()), then to
+ * each object as its creation is recorded. Replaying the same records against
+ * the same base image therefore hands out the same IDs, which is what lets a
+ * later record name an object an earlier one created.
+ *
+ * Appending only copies the record into memory. A writer thread takes whatever
+ * has accumulated, writes it with one write() and makes it durable with one
+ * fdatasync(): as soon as anyone is waiting in sync(), when a batch reaches
+ * 64 KiB, or after the flush interval otherwise. Callers that arrive while a
+ * batch is being synced are committed together by the next one, so a burst of
+ * changes costs a handful of syncs however many threads wait on it.
+ *
+ * Only the composite, staff and customers are journaled: plant growth and
+ * reaping since the base image are not, so a recovered inventory holds every
+ * plant in the right place with the state it was created (or last compacted)
+ * with. compact() bounds both this and the replay time.
+ *
+ * **System Role:**
+ * Gives NurseryFacade crash durability for stock and sales changes. The
+ * facade records a change after making it, and its waiting calls return once
+ * the record is durable.
+ *
+ * **Failure:**
+ * Once a write or fdatasync() fails the journal stops writing: sync() returns
+ * false, isFailed() reports it with the reason in getFailure(), and records
+ * appended afterwards are discarded. compact() starts a new generation from
+ * the inventory as it is, which clears the failure.
+ *
+ * **Threading:**
+ * Every method may be called from any thread, apart from registerInventory()
+ * and compact(), which must not run alongside changes to the inventory.
+ *
+ * @see NurseryFacade::openJournal(), InventoryImage
+ */
+class InventoryJournal
+{
+private:
+	enum class ObjectKind : std::uint8_t
+	{
+		Forgotten,
+		Component,
+		Staff,
+		Customer
+	};
+
+	struct JournalObject
+	{
+		const void *pointer;
+		ObjectKind kind;
+	};
+
+	std::string directory;
+	unsigned int generation;
+	int fd;
+	std::vector<JournalRecord> recovered;
+
+	std::vector<JournalObject> objects;
+	std::unordered_map<const void *, std::uint32_t> ids;
+	bool replaying;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable durableChanged;
+	std::thread writer;
+	std::string pending;
+	std::uint64_t appended;
+	std::uint64_t durable;
+	unsigned int waiters;
+	bool flushing;
+	bool stopping;
+	bool failed;
+	std::string failure;
+	std::uint64_t syncCount;
+	std::chrono::milliseconds flushInterval;
+
+	InventoryJournal(const InventoryJournal &);
+	InventoryJournal &operator=(const InventoryJournal &);
+
+	std::string pathOf(const char *kind, unsigned int generation) const;
+	bool readJournal(const std::string &path, std::string &error);
+	bool startGeneration(unsigned int next, std::string &error);
+	void flushLoop();
+
+	std::uint32_t assign(const void *pointer, ObjectKind kind);
+	std::uint32_t find(const void *pointer, ObjectKind kind) const;
+	const void *lookup(std::uint32_t id, ObjectKind kind) const;
+	void registerTree(PlantComponent *component);
+	void forgetTree(PlantComponent *component);
+	void append(JournalOp op, std::uint32_t first, std::uint32_t second, const std::string &text);
+
+public:
+	/** Format version written in every journal header. */
+	static const std::uint32_t VERSION = 1;
+
+	/** ID of an object the journal does not know. */
+	static const std::uint32_t UNKNOWN = 0xffffffffu;
+
+	/**
+	 * @brief Creates a closed journal.
+	 */
+	InventoryJournal();
+
+	/**
+	 * @brief Syncs everything appended and closes the file.
+	 */
+	~InventoryJournal();
+
+	/**
+	 * @brief Opens a journal directory and reads back its latest generation.
+	 *
+	 * Creates the directory if needed. Afterwards getBaseImage() and
+	 * getRecovered() describe what has to be replayed; new records are not
+	 * accepted until compact() has started a fresh generation.
+	 *
+	 * @param directory Directory holding the journal.
+	 * @param error Receives the reason on failure.
+	 * @return True if the directory could be read.
+	 */
+	bool open(const std::string &directory, std::string &error);
+
+	/**
+	 * @brief Syncs, stops the writer thread and closes the file.
+	 */
+	void close();
+
+	/**
+	 * @brief Gets the base image of the generation read by open().
+	 * @return Path of the image, or an empty string if the generation has none.
+	 */
+	std::string getBaseImage() const;
+
+	/**
+	 * @brief Gets the complete records read by open(), oldest first.
+	 * @return Records to replay after loading the base image.
+	 */
+	const std::vector<JournalRecord> &getRecovered() const { return recovered; }
+
+	/**
+	 * @brief Gives IDs to everything in an inventory, discarding all previous IDs.
+	 *
+	 * Walks the root group depth first, then the staff list, then each
+	 * customer and the contents of their basket.
+	 *
+	 * @param inventory Inventory the journal records.
+	 */
+	void registerInventory(Inventory *inventory);
+
+	/**
+	 * @brief Starts a new generation from an image of the inventory as it is now.
+	 *
+	 * Writes the base image and an empty journal, makes both durable, and only
+	 * then deletes the previous generation, so a crash at any point recovers
+	 * either the old generation or the new one. Also re-registers the inventory.
+	 *
+	 * @param inventory Inventory to save; must not change during the call.
+	 * @param error Receives the reason on failure.
+	 * @return True if the new generation was started.
+	 */
+	bool compact(Inventory *inventory, std::string &error);
+
+	/**
+	 * @brief Switches replay mode, in which recording only hands out IDs.
+	 * @param enabled True while replaying recovered records.
+	 */
+	void setReplaying(bool enabled);
+
+	/**
+	 * @brief Records a change that creates an object and gives the object the next ID.
+	 * @param op CreatePlant or CreateGroup.
+	 * @param component New plant or group.
+	 * @param text Plant type or group name.
+	 */
+	void recordCreated(JournalOp op, PlantComponent *component, const std::string &text);
+
+	/**
+	 * @brief Records a new staff member and gives them the next ID.
+	 */
+	void recordCreated(Staff *staff);
+
+	/**
+	 * @brief Records a new customer and gives them the next ID.
+	 */
+	void recordCreated(Customer *customer);
+
+	/**
+	 * @brief Records a change to a group.
+	 * @param op AddToGroup or RemoveFromInventory.
+	 * @param first Parent group for AddToGroup, the component removed for RemoveFromInventory.
+	 * @param second Child added for AddToGroup, nullptr for RemoveFromInventory.
+	 * @return False if an object is unknown, in which case nothing is recorded.
+	 */
+	bool record(JournalOp op, PlantComponent *first, PlantComponent *second);
+
+	/**
+	 * @brief Records an observer being attached to or detached from a group.
+	 * @return False if an object is unknown, in which case nothing is recorded.
+	 */
+	bool record(JournalOp op, Staff *staff, PlantGroup *group);
+
+	/**
+	 * @brief Records a change to a customer's basket.
+	 * @param op AddToBasket, ReturnFromBasket or Purchase.
+	 * @param customer Customer whose basket changed.
+	 * @param plant Plant added, nullptr otherwise.
+	 * @param index Basket index for ReturnFromBasket.
+	 * @return False if an object is unknown, in which case nothing is recorded.
+	 */
+	bool record(JournalOp op, Customer *customer, PlantComponent *plant, std::uint32_t index = 0);
+
+	/**
+	 * @brief Forgets every object in a tree, before it is deleted.
+	 * @param component Plant or group about to be deleted, may be nullptr.
+	 */
+	void forget(PlantComponent *component);
+
+	/**
+	 * @brief Gets a plant or group by ID.
+	 * @return The object, or nullptr if the ID does not name a live component.
+	 */
+	PlantComponent *getComponent(std::uint32_t id) const;
+
+	/**
+	 * @brief Gets a staff member by ID.
+	 * @return The staff member, or nullptr if the ID does not name one.
+	 */
+	Staff *getStaff(std::uint32_t id) const;
+
+	/**
+	 * @brief Gets a customer by ID.
+	 * @return The customer, or nullptr if the ID does not name one.
+	 */
+	Customer *getCustomer(std::uint32_t id) const;
+
+	/**
+	 * @brief Waits until every record appended so far is on disk.
+	 * @return False if a write or sync has failed; the journal then stops writing.
+	 */
+	bool sync();
+
+	/**
+	 * @brief Checks whether a write or sync has failed since the current generation started.
+	 * @return True if records are being discarded until the next compact().
+	 */
+	bool isFailed();
+
+	/**
+	 * @brief Gets why the journal stopped writing.
+	 * @return Description of the failed write or sync, or an empty string if none failed.
+	 */
+	std::string getFailure();
+
+	/**
+	 * @brief Sets how long a record may wait for a batch when nobody calls sync().
+	 * @param interval Longest delay before an unrequested flush; 5 ms by default.
+	 */
+	void setFlushInterval(std::chrono::milliseconds interval);
+
+	/**
+	 * @brief Gets the number of records appended since open().
+	 */
+	std::uint64_t getAppendedCount();
+
+	/**
+	 * @brief Gets the number of fdatasync() calls made for batches since open().
+	 */
+	std::uint64_t getSyncCount();
+
+	/**
+	 * @brief Gets the generation records are appended to.
+	 * @return Generation number, 0 before the first compact().
+	 */
+	unsigned int getGeneration() const { return generation; }
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "InventorySnapshot.h"
+#include "../composite/PlantGroup.h"
+#include <thread>
+
+InventorySnapshot::InventorySnapshot()
+    : version(0)
+{
+}
+
+void InventorySnapshot::capture(PlantGroup *root, unsigned long version)
+{
+    plants.clear();
+    groups.clear();
+    this->version = version;
+    if (root)
+        collect(root, true);
+}
+
+void InventorySnapshot::collect(PlantGroup *group, bool topLevel)
+{
+    for (PlantComponent *component : group->getChildren())
+    {
+        if (component == nullptr)
+            continue;
+        if (component->getType() == ComponentType::LIVING_PLANT)
+        {
+            LivingPlant *plant = static_cast<LivingPlant *>(component);
+            PlantSnapshotEntry entry = {plant, plant->getInfoValues()};
+            plants.push_back(entry);
+        }
+        else if (component->getType() == ComponentType::PLANT_GROUP)
+        {
+            // The range is filled in once the group's plants have been collected
+            std::size_t index = groups.size();
+            GroupSnapshotEntry entry = {static_cast<PlantGroup *>(component), plants.size(), 0, topLevel};
+            groups.push_back(entry);
+            collect(static_cast<PlantGroup *>(component), false);
+            groups[index].end = plants.size();
+        }
+    }
+}
+
+const PlantSnapshotEntry *InventorySnapshot::findPlant(const PlantComponent *plant) const
+{
+    for (std::size_t i = 0; i < plants.size(); i++)
+    {
+        if (plants[i].plant == plant)
+            return &plants[i];
+    }
+    return nullptr;
+}
+
+const GroupSnapshotEntry *InventorySnapshot::findGroup(const PlantGroup *group) const
+{
+    for (std::size_t i = 0; i < groups.size(); i++)
+    {
+        if (groups[i].group == group)
+            return &groups[i];
+    }
+    return nullptr;
+}
+
+SnapshotBuffer::SnapshotBuffer()
+    : front(0), published(0)
+{
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+// All counter and front accesses are sequentially consistent: a reader's
+// increment followed by its re-check of front, against the writer's check of
+// the counter, must not be reordered past each other.
+void SnapshotBuffer::publish(PlantGroup *root)
+{
+    int back = 1 - front.load();
+
+    // Readers that pinned this slot before the last swap may still be using it
+    while (readers[back].load() != 0)
+        std::this_thread::yield();
+
+    slots[back].capture(root, ++published);
+    front.store(back);
+}
+
+const InventorySnapshot *SnapshotBuffer::acquire(int &slot)
+{
+    while (true)
+    {
+        slot = front.load();
+        readers[slot]++;
+
+        // If the writer swapped in between, the slot may already be under capture
+        if (front.load() == slot)
+            return &slots[slot];
+
+        readers[slot]--;
+    }
+}
+
+void SnapshotBuffer::release(int slot)
+{
+    readers[slot]--;
+}
+
+SnapshotReader::SnapshotReader(SnapshotBuffer *buffer)
+    : buffer(buffer)
+{
+    snapshot = buffer->acquire(slot);
+}
+
+SnapshotReader::~SnapshotReader()
+{
+    buffer->release(slot);
+}
@@ -0,0 +1,213 @@
+#ifndef InventorySnapshot_h
+#define InventorySnapshot_h
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "../prototype/LivingPlant.h"
+
+class PlantGroup;
+
+/**
+ * @brief One living plant as it was when the snapshot was captured.
+ */
+struct PlantSnapshotEntry
+{
+	/** The live plant, for identity only; readers must not dereference it. */
+	LivingPlant *plant;
+	/** Everything getInfo() prints, copied at capture time. */
+	PlantInfoValues values;
+};
+
+/**
+ * @brief One plant group and the plants inside it, as a range of snapshot entries.
+ */
+struct GroupSnapshotEntry
+{
+	/** The live group, for identity only. */
+	PlantGroup *group;
+	/** First plant entry inside the group. */
+	std::size_t begin;
+	/** One past the last plant entry inside the group, nested groups included. */
+	std::size_t end;
+	/** True for groups listed directly in the inventory root. */
+	bool topLevel;
+};
+
+/**
+ * @brief Immutable copy of the inventory that readers can use without locks.
+ *
+ * Plants are stored in the order PlantIterator visits them (each group's
+ * children in list order, nested groups expanded in place), so a group's plants
+ * are always one contiguous range and index N here is index N of an AggPlant
+ * iterator over the same composite.
+ *
+ * **System Role:**
+ * Filled by SnapshotBuffer at the end of each Inventory::tick() and after
+ * facade mutations; read by NurseryFacade through a SnapshotReader.
+ *
+ * @see SnapshotBuffer
+ */
+class InventorySnapshot
+{
+private:
+	std::vector<PlantSnapshotEntry> plants;
+	std::vector<GroupSnapshotEntry> groups;
+	unsigned long version;
+
+	void collect(PlantGroup *group, bool topLevel);
+
+public:
+	/**
+	 * @brief Constructs an empty snapshot.
+	 */
+	InventorySnapshot();
+
+	/**
+	 * @brief Replaces the contents with the current state of a composite.
+	 *
+	 * Reuses the existing storage, so capturing a composite of the same size
+	 * again does not allocate.
+	 *
+	 * @param root Composite to copy.
+	 * @param version Publication number to record.
+	 */
+	void capture(PlantGroup *root, unsigned long version);
+
+	/**
+	 * @brief Gets the publication number this snapshot was captured with.
+	 * @return 0 for a snapshot that was never captured.
+	 */
+	unsigned long getVersion() const { return version; }
+
+	/**
+	 * @brief Gets the number of living plants.
+	 * @return Plant entry count.
+	 */
+	std::size_t getPlantCount() const { return plants.size(); }
+
+	/**
+	 * @brief Gets one plant entry.
+	 * @param index Position in iterator order.
+	 * @return The entry.
+	 */
+	const PlantSnapshotEntry &getPlant(std::size_t index) const { return plants[index]; }
+
+	/**
+	 * @brief Gets the number of plant groups, nested ones included.
+	 * @return Group entry count.
+	 */
+	std::size_t getGroupCount() const { return groups.size(); }
+
+	/**
+	 * @brief Gets one group entry.
+	 * @param index Position in depth-first order.
+	 * @return The entry.
+	 */
+	const GroupSnapshotEntry &getGroup(std::size_t index) const { return groups[index]; }
+
+	/**
+	 * @brief Finds the first entry for a plant.
+	 * @param plant Plant to look for.
+	 * @return The entry, or nullptr if the plant was not in the inventory.
+	 */
+	const PlantSnapshotEntry *findPlant(const PlantComponent *plant) const;
+
+	/**
+	 * @brief Finds the first entry for a group.
+	 * @param group Group to look for.
+	 * @return The entry, or nullptr if the group was not in the inventory.
+	 */
+	const GroupSnapshotEntry *findGroup(const PlantGroup *group) const;
+};
+
+/**
+ * @brief Two InventorySnapshot slots swapped RCU-style between one writer and many readers.
+ *
+ * Readers pin the front slot with a per-slot counter and never block. The
+ * writer captures into the back slot and then makes it the front with a single
+ * atomic store. Before reusing the back slot it waits for readers still
+ * pinning it from an earlier swap; readers only hold a slot for the length of
+ * one facade call, so that wait is short.
+ *
+ * Publishing must be serialised by the caller (Inventory does it under its tick
+ * lock), and a thread must not publish while it holds a SnapshotReader.
+ *
+ * @see SnapshotReader
+ */
+class SnapshotBuffer
+{
+private:
+	InventorySnapshot slots[2];
+	std::atomic<int> front;
+	std::atomic<int> readers[2];
+	std::atomic<unsigned long> published;
+
+public:
+	/**
+	 * @brief Constructs a buffer whose front slot is an empty snapshot.
+	 */
+	SnapshotBuffer();
+
+	/**
+	 * @brief Captures a composite into the back slot and swaps it to the front.
+	 * @param root Composite to copy.
+	 */
+	void publish(PlantGroup *root);
+
+	/**
+	 * @brief Gets how many snapshots have been published.
+	 * @return Version of the latest snapshot.
+	 */
+	unsigned long getPublishCount() const { return published.load(); }
+
+	/**
+	 * @brief Pins the current front slot for reading.
+	 * @param slot Receives the slot to pass to release().
+	 * @return The pinned snapshot, valid until release().
+	 */
+	const InventorySnapshot *acquire(int &slot);
+
+	/**
+	 * @brief Unpins a slot returned by acquire().
+	 * @param slot Slot from acquire().
+	 */
+	void release(int slot);
+};
+
+/**
+ * @brief Pins the latest published snapshot for the lifetime of the guard.
+ */
+class SnapshotReader
+{
+private:
+	SnapshotBuffer *buffer;
+	const InventorySnapshot *snapshot;
+	int slot;
+
+	SnapshotReader(const SnapshotReader &);
+	SnapshotReader &operator=(const SnapshotReader &);
+
+public:
+	/**
+	 * @brief Pins the buffer's front slot.
+	 * @param buffer Buffer to read from.
+	 */
+	explicit SnapshotReader(SnapshotBuffer *buffer);
+
+	/**
+	 * @brief Unpins the slot.
+	 */
+	~SnapshotReader();
+
+	/**
+	 * @brief Gets the pinned snapshot.
+	 * @return Snapshot that stays unchanged while this guard exists.
+	 */
+	const InventorySnapshot &get() const { return *snapshot; }
+
+	const InventorySnapshot *operator->() const { return snapshot; }
+};
+
+#endif
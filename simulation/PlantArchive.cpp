@@ -0,0 +1,64 @@
+#include "PlantArchive.h"
+
+PlantArchive::PlantArchive()
+    : totalPrice(0.0)
+{
+}
+
+void PlantArchive::add(LivingPlant *plant, double price)
+{
+    std::string name = plant->getName();
+    std::map<std::string, unsigned int>::iterator it = nameIds.find(name);
+    unsigned int nameId;
+    if (it == nameIds.end())
+    {
+        nameId = static_cast<unsigned int>(names.size());
+        names.push_back(name);
+        nameIds[name] = nameId;
+    }
+    else
+    {
+        nameId = it->second;
+    }
+
+    ArchivedPlant record = {nameId, plant->getAge(), price, plant->getSpecies()};
+    records.push_back(record);
+    totalPrice += price;
+}
+
+std::size_t PlantArchive::countSpecies(PlantSpecies species) const
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].species == species)
+            count++;
+    }
+    return count;
+}
+
+std::size_t PlantArchive::countName(const std::string &name) const
+{
+    std::map<std::string, unsigned int>::const_iterator it = nameIds.find(name);
+    if (it == nameIds.end())
+        return 0;
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].nameId == it->second)
+            count++;
+    }
+    return count;
+}
+
+double PlantArchive::getAverageAge() const
+{
+    if (records.empty())
+        return 0.0;
+
+    double total = 0.0;
+    for (std::size_t i = 0; i < records.size(); i++)
+        total += records[i].ageAtDeath;
+    return total / records.size();
+}
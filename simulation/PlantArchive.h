@@ -0,0 +1,107 @@
+#ifndef PlantArchive_h
+#define PlantArchive_h
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "../prototype/LivingPlant.h"
+
+/**
+ * @brief Compact record of a plant that died and was reaped from the inventory.
+ */
+struct ArchivedPlant
+{
+	/** Index of the plant's name in PlantArchive::getName(). */
+	unsigned int nameId;
+	/** Age in days when the plant was reaped. */
+	int ageAtDeath;
+	/** Price including decorations. */
+	double price;
+	/** Base plant type. */
+	PlantSpecies species;
+};
+
+/**
+ * @brief Cold storage for dead plants removed from the active composite.
+ *
+ * Dead plants never change again, yet while they sit in a PlantGroup every
+ * tick visits them and staff keep being told they need water. The reaper
+ * (Inventory::reapDeadPlants()) deletes them from the composite and keeps one
+ * ArchivedPlant per plant here, with names interned once, so reporting still
+ * sees every plant that ever died while ticks no longer pay for them.
+ *
+ * **System Role:**
+ * Owned by Inventory. Only reporting code reads it.
+ *
+ * @see Inventory::reapDeadPlants()
+ */
+class PlantArchive
+{
+private:
+	std::vector<ArchivedPlant> records;
+	std::vector<std::string> names;
+	std::map<std::string, unsigned int> nameIds;
+	double totalPrice;
+
+public:
+	/**
+	 * @brief Constructs an empty archive.
+	 */
+	PlantArchive();
+
+	/**
+	 * @brief Records a plant. The plant itself is not kept or deleted.
+	 * @param plant Plant to record.
+	 * @param price Price to record, normally the decorated total.
+	 */
+	void add(LivingPlant *plant, double price);
+
+	/**
+	 * @brief Gets the number of archived plants.
+	 * @return Record count.
+	 */
+	std::size_t size() const { return records.size(); }
+
+	/**
+	 * @brief Gets one record.
+	 * @param index Record index, in the order plants were archived.
+	 * @return The record.
+	 */
+	const ArchivedPlant &get(std::size_t index) const { return records[index]; }
+
+	/**
+	 * @brief Gets the name a record's nameId refers to.
+	 * @param nameId ID from an ArchivedPlant.
+	 * @return Plant name.
+	 */
+	const std::string &getName(unsigned int nameId) const { return names[nameId]; }
+
+	/**
+	 * @brief Counts archived plants of one species.
+	 * @param species Species to count.
+	 * @return Number of records.
+	 */
+	std::size_t countSpecies(PlantSpecies species) const;
+
+	/**
+	 * @brief Counts archived plants with a given name.
+	 * @param name Plant name such as "Rose".
+	 * @return Number of records, 0 for names never archived.
+	 */
+	std::size_t countName(const std::string &name) const;
+
+	/**
+	 * @brief Gets the summed price of all archived plants.
+	 * @return Total price in currency units.
+	 */
+	double getTotalPrice() const { return totalPrice; }
+
+	/**
+	 * @brief Gets the average age at death.
+	 * @return Mean ageAtDeath, 0 for an empty archive.
+	 */
+	double getAverageAge() const;
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include "ShardCoordinator.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ShardWorker.h"
+
+namespace
+{
+    template <typename Payload>
+    std::string toBytes(const Payload &payload)
+    {
+        return std::string(reinterpret_cast<const char *>(&payload), sizeof(Payload));
+    }
+
+    template <typename Payload>
+    Payload fromBytes(const std::string &bytes, unsigned int shard)
+    {
+        if (bytes.size() != sizeof(Payload))
+            throw std::runtime_error("Shard " + std::to_string(shard) + " sent a malformed reply");
+        Payload payload;
+        std::memcpy(&payload, bytes.data(), sizeof(Payload));
+        return payload;
+    }
+
+    // Counters add up across shards; a phase lasts as long as its slowest shard
+    void combine(TickRecord &combined, const TickRecord &shard)
+    {
+        for (int phase = 0; phase < TICK_PHASE_COUNT; phase++)
+        {
+            if (shard.phaseNanos[phase] > combined.phaseNanos[phase])
+                combined.phaseNanos[phase] = shard.phaseNanos[phase];
+        }
+        for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+            combined.growCalls[code] += shard.growCalls[code];
+
+        combined.plantsVisited += shard.plantsVisited;
+        combined.waterNotifications += shard.waterNotifications;
+        combined.sunNotifications += shard.sunNotifications;
+        combined.stateNotifications += shard.stateNotifications;
+        combined.commandsApplied += shard.commandsApplied;
+    }
+
+    void combine(ShardCensus &combined, const ShardCensus &shard)
+    {
+        combined.groups += shard.groups;
+        combined.plants += shard.plants;
+        for (int id = 0; id < 4; id++)
+            combined.byState[id] += shard.byState[id];
+        combined.archived += shard.archived;
+    }
+}
+
+ShardCoordinator::ShardCoordinator(unsigned int shardCount)
+    : ticksSinceSeason(0), seasonId(SeasonId::None), autoReap(false), reaped(0)
+{
+    if (shardCount == 0)
+        throw std::runtime_error("A sharded nursery needs at least one shard");
+
+    for (unsigned int shard = 0; shard < shardCount; shard++)
+    {
+        int ends[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0)
+        {
+            shutdown();
+            throw std::runtime_error("Could not create a socket for shard " + std::to_string(shard));
+        }
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(ends[0]);
+            close(ends[1]);
+            shutdown();
+            throw std::runtime_error("Could not start shard " + std::to_string(shard));
+        }
+
+        if (pid == 0)
+        {
+            // Worker: keep only its own end, serve, and leave without running the parent's exit handlers
+            for (std::size_t i = 0; i < sockets.size(); i++)
+                close(sockets[i]);
+            close(ends[0]);
+
+            int status = 0;
+            try
+            {
+                ShardWorker worker(shard);
+                worker.serve(ends[1]);
+            }
+            catch (...)
+            {
+                status = 1;
+            }
+            close(ends[1]);
+            _exit(status);
+        }
+
+        close(ends[1]);
+        sockets.push_back(ends[0]);
+        workers.push_back(pid);
+    }
+
+    for (unsigned int shard = 0; shard < shardCount; shard++)
+    {
+        ShardMessage type;
+        std::string payload;
+        if (!ShardProtocol::receive(sockets[shard], type, payload) || type != ShardMessage::Ready)
+        {
+            shutdown();
+            throw std::runtime_error("Shard " + std::to_string(shard) + " did not start");
+        }
+        // Every worker starts from a fresh inventory, so they all report the same season
+        seasonId = static_cast<SeasonId>(fromBytes<std::uint32_t>(payload, shard));
+    }
+}
+
+ShardCoordinator::~ShardCoordinator()
+{
+    shutdown();
+}
+
+void ShardCoordinator::shutdown()
+{
+    for (std::size_t shard = 0; shard < sockets.size(); shard++)
+    {
+        // A worker that already died just makes these calls fail
+        ShardMessage type;
+        std::string reply;
+        if (ShardProtocol::send(sockets[shard], ShardMessage::Shutdown, std::string()))
+            ShardProtocol::receive(sockets[shard], type, reply);
+        close(sockets[shard]);
+    }
+    for (std::size_t shard = 0; shard < workers.size(); shard++)
+    {
+        int status;
+        while (waitpid(workers[shard], &status, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+    sockets.clear();
+    workers.clear();
+}
+
+void ShardCoordinator::request(unsigned int shard, ShardMessage type, const std::string &payload, std::string &reply)
+{
+    ShardMessage replyType;
+    if (!ShardProtocol::send(sockets[shard], type, payload) ||
+        !ShardProtocol::receive(sockets[shard], replyType, reply))
+        throw std::runtime_error("Shard " + std::to_string(shard) + " stopped responding");
+    if (replyType == ShardMessage::Error)
+        throw std::runtime_error("Shard " + std::to_string(shard) + ": " + reply);
+}
+
+void ShardCoordinator::broadcast(ShardMessage type, const std::string &payload, std::vector<std::string> &replies)
+{
+    // Send everything first so the shards work in parallel
+    for (unsigned int shard = 0; shard < getShardCount(); shard++)
+    {
+        if (!ShardProtocol::send(sockets[shard], type, payload))
+            throw std::runtime_error("Shard " + std::to_string(shard) + " stopped responding");
+    }
+
+    replies.resize(getShardCount());
+    std::string error;
+    for (unsigned int shard = 0; shard < getShardCount(); shard++)
+    {
+        ShardMessage replyType;
+        if (!ShardProtocol::receive(sockets[shard], replyType, replies[shard]))
+            throw std::runtime_error("Shard " + std::to_string(shard) + " stopped responding");
+        // Keep reading the other replies so every socket stays in step
+        if (replyType == ShardMessage::Error && error.empty())
+            error = "Shard " + std::to_string(shard) + ": " + replies[shard];
+    }
+    if (!error.empty())
+        throw std::runtime_error(error);
+}
+
+void ShardCoordinator::configure(unsigned int threads, bool eventDriven)
+{
+    ShardConfigureRequest configure = {threads, eventDriven ? 1u : 0u};
+    std::vector<std::string> replies;
+    broadcast(ShardMessage::Configure, toBytes(configure), replies);
+}
+
+unsigned int ShardCoordinator::createPlants(std::uint32_t group, const std::string &type, unsigned int count)
+{
+    unsigned int shard = getShardFor(group);
+    ShardCreateRequest create = {group, count};
+    std::string reply;
+    request(shard, ShardMessage::CreatePlants, toBytes(create) + type, reply);
+    return fromBytes<std::uint32_t>(reply, shard);
+}
+
+void ShardCoordinator::waterGroup(std::uint32_t group)
+{
+    std::string reply;
+    request(getShardFor(group), ShardMessage::WaterGroup, toBytes(group), reply);
+}
+
+void ShardCoordinator::advanceDay()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Same schedule as Inventory::advanceDay()
+    bool seasonEnds = ticksSinceSeason == 8;
+    ShardTickRequest tick = {seasonEnds ? 1u : 0u, (seasonEnds && autoReap) ? 1u : 0u};
+    std::vector<std::string> replies;
+    broadcast(ShardMessage::Tick, toBytes(tick), replies);
+
+    TickRecord combined = TickRecord();
+    for (unsigned int shard = 0; shard < getShardCount(); shard++)
+    {
+        ShardTickReply reply = fromBytes<ShardTickReply>(replies[shard], shard);
+        combine(combined, reply.tick);
+        reaped += static_cast<unsigned long>(reply.reaped);
+    }
+    stats.record(combined);
+
+    if (seasonEnds)
+    {
+        stats.recordSeasonChange();
+        seasonId = nextSeason(seasonId);
+        ticksSinceSeason = 0;
+    }
+    ticksSinceSeason++;
+
+    dayLatency.record(static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+}
+
+void ShardCoordinator::advanceDays(int days)
+{
+    for (int day = 0; day < days; day++)
+        advanceDay();
+}
+
+ShardCensus ShardCoordinator::getCensus(std::uint32_t group)
+{
+    unsigned int shard = getShardFor(group);
+    std::string reply;
+    request(shard, ShardMessage::Census, toBytes(group), reply);
+    return fromBytes<ShardCensus>(reply, shard);
+}
+
+ShardCensus ShardCoordinator::getCensus()
+{
+    std::vector<std::string> replies;
+    broadcast(ShardMessage::Census, toBytes(SHARD_ALL_GROUPS), replies);
+
+    ShardCensus combined = ShardCensus();
+    for (unsigned int shard = 0; shard < getShardCount(); shard++)
+        combine(combined, fromBytes<ShardCensus>(replies[shard], shard));
+    return combined;
+}
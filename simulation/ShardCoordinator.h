@@ -0,0 +1,174 @@
+#ifndef ShardCoordinator_h
+#define ShardCoordinator_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "ShardProtocol.h"
+#include "TickStats.h"
+#include "../state/Season.h"
+
+/**
+ * @brief Splits one nursery across several worker processes on the same host.
+ *
+ * Each shard is a forked child running a ShardWorker, connected to the
+ * coordinator by a Unix domain socket pair. Plant groups are identified by a
+ * global ID and owned by shard `id % shardCount`; calls that change a group
+ * are routed to its owner only, while advanceDay() sends the day to every
+ * shard at once and waits for all of them, so the shards never drift apart.
+ *
+ * The coordinator owns the shared clock: it counts days exactly as
+ * Inventory::advanceDay() does and tells every worker when to change season
+ * (and reap, if enabled), so a sharded run sees the same seasons on the same
+ * days as a single inventory. Each worker's tick record is combined into one
+ * TickStats: counters are summed, phase times take the slowest shard (the day
+ * is only over when it finishes), and getDayLatency() additionally records the
+ * coordinator's round trip per day.
+ *
+ * Every public call throws std::runtime_error if a worker cannot be started,
+ * has died, or rejects a request.
+ *
+ * **System Role:**
+ * Takes a nursery past one process's memory and core limits. Each worker has
+ * its own NurseryContext, so groups on different shards share nothing; plants
+ * must not be moved between groups on different shards.
+ *
+ * **Threading:**
+ * Not thread-safe; drive a coordinator from one thread.
+ *
+ * @see ShardWorker, NurseryContext
+ */
+class ShardCoordinator
+{
+private:
+	std::vector<int> sockets;
+	std::vector<pid_t> workers;
+	int ticksSinceSeason;
+	SeasonId seasonId;
+	bool autoReap;
+	unsigned long reaped;
+	TickStats stats;
+	LatencyHistogram dayLatency;
+
+	ShardCoordinator(const ShardCoordinator &);
+	ShardCoordinator &operator=(const ShardCoordinator &);
+
+	void request(unsigned int shard, ShardMessage type, const std::string &payload, std::string &reply);
+	void broadcast(ShardMessage type, const std::string &payload, std::vector<std::string> &replies);
+	void shutdown();
+
+public:
+	/**
+	 * @brief Forks the worker processes and waits until each one is ready.
+	 *
+	 * Call before starting any threads of your own: the children are forked
+	 * from the calling process and only run ShardWorker code.
+	 *
+	 * @param shardCount Number of workers, at least one.
+	 */
+	explicit ShardCoordinator(unsigned int shardCount);
+
+	/**
+	 * @brief Stops every worker and waits for it to exit.
+	 */
+	~ShardCoordinator();
+
+	/**
+	 * @brief Gets the number of shards.
+	 * @return Worker count.
+	 */
+	unsigned int getShardCount() const { return static_cast<unsigned int>(sockets.size()); }
+
+	/**
+	 * @brief Gets the shard that owns a group.
+	 * @param group Global group ID.
+	 * @return Index of the owning shard.
+	 */
+	unsigned int getShardFor(std::uint32_t group) const { return group % getShardCount(); }
+
+	/**
+	 * @brief Gets a worker's process ID.
+	 * @param shard Shard index.
+	 * @return PID of the worker.
+	 */
+	pid_t getWorkerPid(unsigned int shard) const { return workers[shard]; }
+
+	/**
+	 * @brief Sets every worker's tick threads and tick mode.
+	 * @param threads Passed to Inventory::setTickThreads() on each worker.
+	 * @param eventDriven Passed to Inventory::setEventDriven() on each worker.
+	 */
+	void configure(unsigned int threads, bool eventDriven);
+
+	/**
+	 * @brief Makes advanceDay() reap dead plants on every shard at each season change.
+	 * @param enabled True to reap at season changes.
+	 */
+	void setAutoReap(bool enabled) { autoReap = enabled; }
+
+	/**
+	 * @brief Builds plants into a group on the shard that owns it.
+	 * @param group Global group ID; the group is created on first use.
+	 * @param type Plant type name, as accepted by NurseryFacade::createPlant().
+	 * @param count Number of plants to build.
+	 * @return Number of plants built.
+	 */
+	unsigned int createPlants(std::uint32_t group, const std::string &type, unsigned int count);
+
+	/**
+	 * @brief Waters every plant in a group on the shard that owns it.
+	 * @param group Global group ID of an existing group.
+	 */
+	void waterGroup(std::uint32_t group);
+
+	/**
+	 * @brief Runs one day on every shard, then changes the season every eighth day.
+	 */
+	void advanceDay();
+
+	/**
+	 * @brief Runs advanceDay() a number of times.
+	 * @param days Days to run.
+	 */
+	void advanceDays(int days);
+
+	/**
+	 * @brief Counts the plants of one group.
+	 * @param group Global group ID.
+	 * @return Census of the group, all zero if it does not exist.
+	 */
+	ShardCensus getCensus(std::uint32_t group);
+
+	/**
+	 * @brief Counts the plants of every shard.
+	 * @return Sum of every worker's census, including archived plants.
+	 */
+	ShardCensus getCensus();
+
+	/**
+	 * @brief Gets the season the next day runs in.
+	 * @return Current shared season.
+	 */
+	SeasonId getSeasonId() const { return seasonId; }
+
+	/**
+	 * @brief Gets the combined tick statistics.
+	 * @return One record per day: counters summed over shards, phase times of the slowest shard.
+	 */
+	const TickStats &getTickStats() const { return stats; }
+
+	/**
+	 * @brief Gets the coordinator's wall time per day, messaging included.
+	 * @return Histogram of advanceDay() durations in nanoseconds.
+	 */
+	const LatencyHistogram &getDayLatency() const { return dayLatency; }
+
+	/**
+	 * @brief Gets the plants reaped across every shard.
+	 * @return Total reaped by advanceDay().
+	 */
+	unsigned long getReapedCount() const { return reaped; }
+};
+
+#endif
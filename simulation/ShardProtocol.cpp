@@ -0,0 +1,71 @@
+#include "ShardProtocol.h"
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    struct ShardHeader
+    {
+        std::uint32_t type;
+        std::uint32_t length;
+    };
+
+    bool writeAll(int fd, const char *data, std::size_t length)
+    {
+        while (length > 0)
+        {
+            // MSG_NOSIGNAL: a dead peer is reported as an error instead of SIGPIPE
+            ssize_t written = ::send(fd, data, length, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+            data += written;
+            length -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    bool readAll(int fd, char *data, std::size_t length)
+    {
+        while (length > 0)
+        {
+            ssize_t got = ::read(fd, data, length);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                return false;
+            data += got;
+            length -= static_cast<std::size_t>(got);
+        }
+        return true;
+    }
+}
+
+bool ShardProtocol::send(int fd, ShardMessage type, const void *payload, std::uint32_t length)
+{
+    ShardHeader header = {static_cast<std::uint32_t>(type), length};
+    if (!writeAll(fd, reinterpret_cast<const char *>(&header), sizeof(header)))
+        return false;
+    return length == 0 || writeAll(fd, static_cast<const char *>(payload), length);
+}
+
+bool ShardProtocol::send(int fd, ShardMessage type, const std::string &payload)
+{
+    return send(fd, type, payload.data(), static_cast<std::uint32_t>(payload.size()));
+}
+
+bool ShardProtocol::receive(int fd, ShardMessage &type, std::string &payload)
+{
+    ShardHeader header;
+    if (!readAll(fd, reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    if (header.length > MAX_PAYLOAD)
+        return false;
+
+    type = static_cast<ShardMessage>(header.type);
+    payload.resize(header.length);
+    return header.length == 0 || readAll(fd, &payload[0], header.length);
+}
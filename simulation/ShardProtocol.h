@@ -0,0 +1,131 @@
+#ifndef ShardProtocol_h
+#define ShardProtocol_h
+
+#include <cstdint>
+#include <string>
+#include "TickStats.h"
+
+/**
+ * @brief Message types exchanged between a ShardCoordinator and its workers.
+ *
+ * A worker first announces itself with Ready. After that every request gets
+ * exactly one Reply or Error back, so the coordinator can send a request to
+ * every shard and then collect the answers in any order.
+ */
+enum class ShardMessage : std::uint32_t
+{
+	Configure = 1, ///< ShardConfigureRequest: tick threads and tick mode
+	Tick,		   ///< ShardTickRequest: run one day; replies ShardTickReply
+	CreatePlants,  ///< ShardCreateRequest then the type name; replies the count created
+	WaterGroup,	   ///< Group ID; waters the group, replies nothing
+	Census,		   ///< Group ID or SHARD_ALL_GROUPS; replies ShardCensus
+	Shutdown,	   ///< Worker replies, then exits its loop
+	Ready,		   ///< Sent once by a new worker with its starting SeasonId as a uint32
+	Reply,		   ///< Success, with a request-specific payload
+	Error		   ///< Failure, with a message as payload
+};
+
+/** Census target meaning every group the worker owns. */
+const std::uint32_t SHARD_ALL_GROUPS = 0xffffffffu;
+
+/**
+ * @brief Payload of ShardMessage::Configure.
+ */
+struct ShardConfigureRequest
+{
+	/** Passed to Inventory::setTickThreads(). */
+	std::uint32_t threads;
+	/** Passed to Inventory::setEventDriven(). */
+	std::uint32_t eventDriven;
+};
+
+/**
+ * @brief Payload of ShardMessage::Tick: one day, split as Inventory::advanceDay() splits it.
+ */
+struct ShardTickRequest
+{
+	/** Change the season after the tick. */
+	std::uint32_t changeSeason;
+	/** Reap dead plants after the season change. */
+	std::uint32_t reap;
+};
+
+/**
+ * @brief Reply to ShardMessage::Tick.
+ */
+struct ShardTickReply
+{
+	/** The worker's record of the tick. */
+	TickRecord tick;
+	/** Plants reaped after the tick. */
+	std::uint64_t reaped;
+};
+
+/**
+ * @brief Header of a ShardMessage::CreatePlants payload; the type name follows.
+ */
+struct ShardCreateRequest
+{
+	/** Group the plants are added to, created on first use. */
+	std::uint32_t group;
+	/** Number of plants to build. */
+	std::uint32_t count;
+};
+
+/**
+ * @brief Plant counts of one group, one worker, or the whole sharded nursery.
+ */
+struct ShardCensus
+{
+	/** Groups counted. */
+	std::uint64_t groups;
+	/** Live plants in those groups. */
+	std::uint64_t plants;
+	/** Plants by maturity state ID: Seed, Vegetative, Mature, Dead. */
+	std::uint64_t byState[4];
+	/** Plants reaped into the worker's archive; only counted for SHARD_ALL_GROUPS. */
+	std::uint64_t archived;
+};
+
+/**
+ * @brief Framing for the shard protocol over a connected Unix domain stream socket.
+ *
+ * A message is a fixed header (type, payload length) followed by the payload.
+ * Payloads are the structs above copied byte for byte: both ends are the same
+ * binary on the same host, so layout and byte order always match.
+ */
+namespace ShardProtocol
+{
+	/** Largest payload accepted; anything bigger means the stream is corrupt. */
+	const std::uint32_t MAX_PAYLOAD = 1u << 20;
+
+	/**
+	 * @brief Writes one message, retrying short writes.
+	 * @param fd Connected socket.
+	 * @param type Message type.
+	 * @param payload Payload bytes, may be nullptr when length is 0.
+	 * @param length Payload size in bytes.
+	 * @return False if the peer went away.
+	 */
+	bool send(int fd, ShardMessage type, const void *payload, std::uint32_t length);
+
+	/**
+	 * @brief Writes one message with a string payload.
+	 * @param fd Connected socket.
+	 * @param type Message type.
+	 * @param payload Payload bytes.
+	 * @return False if the peer went away.
+	 */
+	bool send(int fd, ShardMessage type, const std::string &payload);
+
+	/**
+	 * @brief Reads one whole message.
+	 * @param fd Connected socket.
+	 * @param type Receives the message type.
+	 * @param payload Receives the payload.
+	 * @return False on end of stream, a read error or an oversized payload.
+	 */
+	bool receive(int fd, ShardMessage &type, std::string &payload);
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "ShardWorker.h"
+
+#include <cstring>
+#include "PlantArchive.h"
+#include "../builder/Director.h"
+#include "../builder/RoseBuilder.h"
+#include "../builder/SunflowerBuilder.h"
+#include "../builder/CactusBuilder.h"
+#include "../builder/PineBuilder.h"
+#include "../builder/MapleBuilder.h"
+#include "../builder/JadePlantBuilder.h"
+#include "../builder/LavenderBuilder.h"
+#include "../builder/CherryBlossomBuilder.h"
+#include "../composite/PlantGroup.h"
+#include "../prototype/LivingPlant.h"
+
+namespace
+{
+    // Same plant type names as NurseryFacade::createPlant()
+    Builder *newBuilder(const std::string &type)
+    {
+        if (type == "Sunflower")
+            return new SunflowerBuilder();
+        if (type == "Rose")
+            return new RoseBuilder();
+        if (type == "Jade Plant")
+            return new JadePlantBuilder();
+        if (type == "Maple")
+            return new MapleBuilder();
+        if (type == "Cactus")
+            return new CactusBuilder();
+        if (type == "Cherry Blossom")
+            return new CherryBlossomBuilder();
+        if (type == "Lavender")
+            return new LavenderBuilder();
+        if (type == "Pine")
+            return new PineBuilder();
+        return nullptr;
+    }
+
+    template <typename Payload>
+    bool readPayload(const std::string &request, Payload &payload)
+    {
+        if (request.size() < sizeof(Payload))
+            return false;
+        std::memcpy(&payload, request.data(), sizeof(Payload));
+        return true;
+    }
+
+    template <typename Payload>
+    std::string toBytes(const Payload &payload)
+    {
+        return std::string(reinterpret_cast<const char *>(&payload), sizeof(Payload));
+    }
+}
+
+ShardWorker::ShardWorker(unsigned int shard)
+    : shard(shard)
+{
+    // Nothing reads snapshots inside a worker
+    context.getInventory()->setSnapshotPublishing(false);
+}
+
+PlantGroup *ShardWorker::getGroup(std::uint32_t id, bool create)
+{
+    std::map<std::uint32_t, PlantGroup *>::iterator it = groups.find(id);
+    if (it != groups.end())
+        return it->second;
+    if (!create)
+        return nullptr;
+
+    PlantGroup *group = new PlantGroup("Shard " + std::to_string(shard) + " Group " + std::to_string(id));
+    context.getInventory()->getInventory()->addComponent(group);
+    groups[id] = group;
+    return group;
+}
+
+void ShardWorker::countGroup(PlantGroup *group, ShardCensus &census)
+{
+    Inventory *inventory = context.getInventory();
+    for (PlantComponent *component : group->getChildren())
+    {
+        if (component == nullptr)
+            continue;
+        if (component->getType() == ComponentType::LIVING_PLANT)
+        {
+            Flyweight<MaturityState *> *state = static_cast<LivingPlant *>(component)->getMaturityState();
+            for (int id = 0; id < 4; id++)
+            {
+                if (state == inventory->getStates(id))
+                    census.byState[id]++;
+            }
+            census.plants++;
+        }
+        else if (component->getType() == ComponentType::PLANT_GROUP)
+        {
+            countGroup(static_cast<PlantGroup *>(component), census);
+        }
+    }
+}
+
+bool ShardWorker::handle(ShardMessage type, const std::string &request, std::string &reply)
+{
+    Inventory *inventory = context.getInventory();
+
+    switch (type)
+    {
+    case ShardMessage::Configure:
+    {
+        ShardConfigureRequest configure;
+        if (!readPayload(request, configure))
+            return false;
+        inventory->setTickThreads(configure.threads);
+        inventory->setEventDriven(configure.eventDriven != 0);
+        return true;
+    }
+    case ShardMessage::Tick:
+    {
+        ShardTickRequest tick;
+        if (!readPayload(request, tick))
+            return false;
+
+        inventory->tick();
+        if (tick.changeSeason)
+            inventory->changeSeason();
+        ShardTickReply result = ShardTickReply();
+        if (tick.reap)
+            result.reaped = inventory->reapDeadPlants();
+        result.tick = inventory->getLastTick();
+        reply = toBytes(result);
+        return true;
+    }
+    case ShardMessage::CreatePlants:
+    {
+        ShardCreateRequest create;
+        if (!readPayload(request, create))
+            return false;
+
+        Builder *builder = newBuilder(request.substr(sizeof(create)));
+        if (!builder)
+        {
+            reply = "Unknown plant type: " + request.substr(sizeof(create));
+            return false;
+        }
+
+        PlantGroup *group = getGroup(create.group, true);
+        Director director(builder);
+        director.construct();
+        for (std::uint32_t i = 0; i < create.count; i++)
+            group->addComponent(director.getPlant());
+        delete builder;
+
+        reply = toBytes(create.count);
+        return true;
+    }
+    case ShardMessage::WaterGroup:
+    {
+        std::uint32_t id;
+        if (!readPayload(request, id))
+            return false;
+        PlantGroup *group = getGroup(id, false);
+        if (!group)
+        {
+            reply = "Group " + std::to_string(id) + " is not on shard " + std::to_string(shard);
+            return false;
+        }
+        group->water();
+        return true;
+    }
+    case ShardMessage::Census:
+    {
+        std::uint32_t id;
+        if (!readPayload(request, id))
+            return false;
+
+        ShardCensus census = ShardCensus();
+        if (id == SHARD_ALL_GROUPS)
+        {
+            for (std::map<std::uint32_t, PlantGroup *>::iterator it = groups.begin(); it != groups.end(); ++it)
+                countGroup(it->second, census);
+            census.groups = groups.size();
+            census.archived = inventory->getArchive()->size();
+        }
+        else
+        {
+            PlantGroup *group = getGroup(id, false);
+            if (group)
+            {
+                countGroup(group, census);
+                census.groups = 1;
+            }
+        }
+        reply = toBytes(census);
+        return true;
+    }
+    case ShardMessage::Shutdown:
+        return true;
+    default:
+        reply = "Unknown request";
+        return false;
+    }
+}
+
+void ShardWorker::serve(int fd)
+{
+    NurseryContext::Scope scope(context);
+
+    std::uint32_t season = static_cast<std::uint32_t>(context.getInventory()->getSeasonId());
+    if (!ShardProtocol::send(fd, ShardMessage::Ready, &season, sizeof(season)))
+        return;
+
+    ShardMessage type;
+    std::string request;
+    while (ShardProtocol::receive(fd, type, request))
+    {
+        std::string reply;
+        bool ok = handle(type, request, reply);
+        if (!ok && reply.empty())
+            reply = "Malformed request";
+        if (!ShardProtocol::send(fd, ok ? ShardMessage::Reply : ShardMessage::Error, reply))
+            return;
+        if (type == ShardMessage::Shutdown)
+            return;
+    }
+}
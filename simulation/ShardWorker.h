@@ -0,0 +1,60 @@
+#ifndef ShardWorker_h
+#define ShardWorker_h
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include "ShardProtocol.h"
+#include "../singleton/NurseryContext.h"
+
+class PlantGroup;
+
+/**
+ * @brief One shard of a multi-process nursery: a NurseryContext served over a socket.
+ *
+ * The worker owns the PlantGroups the coordinator routes to it, keyed by
+ * global group ID and created on first use as top-level groups of its own
+ * inventory. It answers one request at a time, so its inventory is only ever
+ * touched by the serving thread (and that inventory's tick pool).
+ *
+ * **System Role:**
+ * Runs in a child process forked by ShardCoordinator, but only needs a
+ * connected Unix domain socket, so it can equally be driven from a thread.
+ *
+ * @see ShardCoordinator
+ */
+class ShardWorker
+{
+private:
+	unsigned int shard;
+	NurseryContext context;
+	std::map<std::uint32_t, PlantGroup *> groups;
+
+	ShardWorker(const ShardWorker &);
+	ShardWorker &operator=(const ShardWorker &);
+
+	PlantGroup *getGroup(std::uint32_t id, bool create);
+	void countGroup(PlantGroup *group, ShardCensus &census);
+	bool handle(ShardMessage type, const std::string &request, std::string &reply);
+
+public:
+	/**
+	 * @brief Creates an empty shard.
+	 * @param shard Index of this shard, used in group names.
+	 */
+	explicit ShardWorker(unsigned int shard);
+
+	/**
+	 * @brief Sends Ready, then answers requests on a socket until Shutdown or end of stream.
+	 * @param fd Connected socket; not closed by this call.
+	 */
+	void serve(int fd);
+
+	/**
+	 * @brief Gets the shard's inventory.
+	 * @return Inventory of this worker's context.
+	 */
+	Inventory *getInventory() { return context.getInventory(); }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock(std::chrono::microseconds period)
+    : period(period), policy(CatchUpPolicy::Delay), maxBurst(5), stopRequested(false),
+      rescheduled(false), running(false), ticks(0), skipped(0)
+{
+}
+
+SimulationClock::~SimulationClock()
+{
+    stop();
+
+    if (worker.joinable())
+    {
+        if (worker.get_id() == std::this_thread::get_id())
+            worker.detach();
+        else
+            worker.join();
+    }
+}
+
+bool SimulationClock::start(const TickFunction &onTick)
+{
+    // A clock stopped from inside its own tick cannot be restarted from that tick
+    if (worker.joinable() && worker.get_id() == std::this_thread::get_id())
+        return false;
+
+    if (running.exchange(true))
+        return false;
+
+    if (worker.joinable())
+        worker.join();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopRequested = false;
+        rescheduled = false;
+    }
+
+    worker = std::thread(&SimulationClock::run, this, onTick);
+    return true;
+}
+
+bool SimulationClock::stop()
+{
+    if (!running.exchange(false))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopRequested = true;
+    }
+    wakeUp.notify_all();
+
+    // Stopping from inside a tick: the loop exits once the tick returns
+    if (worker.get_id() == std::this_thread::get_id())
+        return true;
+
+    if (worker.joinable())
+        worker.join();
+    return true;
+}
+
+void SimulationClock::setPeriod(std::chrono::microseconds newPeriod)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        period = newPeriod.count() < 0 ? std::chrono::microseconds(0) : newPeriod;
+        rescheduled = true;
+    }
+    wakeUp.notify_all();
+}
+
+std::chrono::microseconds SimulationClock::getPeriod()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return period;
+}
+
+void SimulationClock::setCatchUpPolicy(CatchUpPolicy newPolicy, unsigned int newMaxBurst)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    policy = newPolicy;
+    maxBurst = newMaxBurst;
+}
+
+CatchUpPolicy SimulationClock::getCatchUpPolicy()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return policy;
+}
+
+void SimulationClock::run(TickFunction onTick)
+{
+    std::unique_lock<std::mutex> guard(lock);
+
+    Clock::time_point due = Clock::now();
+    Clock::time_point lastStart = due;
+    bool ticked = false;
+    unsigned int burst = 0;
+
+    while (!stopRequested)
+    {
+        if (period.count() > 0)
+        {
+            bool woken = wakeUp.wait_until(guard, due, [this]()
+                                           { return stopRequested || rescheduled; });
+            if (stopRequested)
+                break;
+            if (woken)
+            {
+                // Rate changed mid-wait: measure the new period from the last tick
+                rescheduled = false;
+                if (ticked)
+                    due = lastStart + period;
+                continue;
+            }
+        }
+        rescheduled = false;
+
+        guard.unlock();
+        Clock::time_point started = Clock::now();
+        onTick();
+        ticks.fetch_add(1);
+        Clock::time_point finished = Clock::now();
+        guard.lock();
+
+        lastStart = started;
+        ticked = true;
+        due = nextDeadline(due, started, finished, burst);
+    }
+}
+
+SimulationClock::Clock::time_point SimulationClock::nextDeadline(Clock::time_point due, Clock::time_point started,
+                                                                 Clock::time_point finished, unsigned int &burst)
+{
+    if (period.count() == 0)
+        return finished;
+
+    if (policy == CatchUpPolicy::Delay)
+        return finished + period;
+
+    // Skip and Burst keep to the grid that starts at the first tick
+    if (due > started)
+        due = started;
+    Clock::time_point next = due + period;
+    if (next > finished)
+    {
+        burst = 0;
+        return next;
+    }
+
+    if (policy == CatchUpPolicy::Burst && burst < maxBurst)
+    {
+        burst++;
+        return next;
+    }
+
+    burst = 0;
+    long long missed = std::chrono::duration_cast<std::chrono::microseconds>(finished - due).count() / period.count();
+    skipped.fetch_add(static_cast<unsigned long>(missed));
+    return due + period * (missed + 1);
+}
@@ -0,0 +1,147 @@
+#ifndef SimulationClock_h
+#define SimulationClock_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief What the clock does when a tick finishes after its next slot was due.
+ */
+enum class CatchUpPolicy
+{
+	/** Wait a full period after every tick finishes (the original ticker behaviour). */
+	Delay,
+	/** Drop the missed slots and resume on the original schedule grid. */
+	Skip,
+	/** Run the missed slots back to back, up to the burst limit, then skip the rest. */
+	Burst
+};
+
+/**
+ * @brief Background thread that calls a tick function at a fixed period.
+ *
+ * Periods are kept in microseconds and the thread waits on a condition
+ * variable rather than sleeping, so stop() and setPeriod() take effect
+ * immediately instead of after the current wait. A period of zero runs the
+ * tick function back to back ("as fast as possible"), which headless runs use
+ * to measure raw throughput.
+ *
+ * **System Role:**
+ * Drives Inventory's ticker. Inventory::startTicker() starts the clock with a
+ * callback that advances the simulation by one day.
+ *
+ * **Threading:**
+ * The setters may be called from any thread. start() and stop() belong to
+ * one controlling thread, although stop() may also be called from inside the
+ * tick function; it then only requests the stop and the thread is joined by
+ * the next start() or by the destructor.
+ *
+ * @see Inventory::startTicker()
+ */
+class SimulationClock
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef std::function<void()> TickFunction;
+
+	/**
+	 * @brief Creates a stopped clock.
+	 * @param period Time between the starts of two ticks. Zero ticks as fast as possible.
+	 */
+	explicit SimulationClock(std::chrono::microseconds period);
+
+	/**
+	 * @brief Stops the clock and joins its thread.
+	 */
+	~SimulationClock();
+
+	/**
+	 * @brief Starts calling onTick from a background thread.
+	 *
+	 * The first tick runs immediately.
+	 *
+	 * @param onTick Function called once per tick.
+	 * @return False if the clock was already running.
+	 */
+	bool start(const TickFunction &onTick);
+
+	/**
+	 * @brief Stops the clock without waiting for the current period to elapse.
+	 *
+	 * Blocks only while a tick that is already running finishes.
+	 *
+	 * @return False if the clock was not running.
+	 */
+	bool stop();
+
+	/**
+	 * @brief Checks whether the clock thread is running.
+	 * @return True between start() and stop().
+	 */
+	bool isRunning() const { return running.load(); }
+
+	/**
+	 * @brief Changes the tick period, waking the clock so the new rate applies now.
+	 *
+	 * The next tick is rescheduled one new period after the start of the last one.
+	 *
+	 * @param period New period. Zero ticks as fast as possible.
+	 */
+	void setPeriod(std::chrono::microseconds period);
+
+	/**
+	 * @brief Gets the current tick period.
+	 * @return Period in microseconds; zero means as fast as possible.
+	 */
+	std::chrono::microseconds getPeriod();
+
+	/**
+	 * @brief Sets how overrunning ticks are handled.
+	 * @param policy Catch-up policy for late ticks.
+	 * @param maxBurst Most missed slots a Burst policy runs back to back.
+	 */
+	void setCatchUpPolicy(CatchUpPolicy policy, unsigned int maxBurst = 5);
+
+	/**
+	 * @brief Gets the current catch-up policy.
+	 * @return Policy applied to late ticks.
+	 */
+	CatchUpPolicy getCatchUpPolicy();
+
+	/**
+	 * @brief Gets the number of ticks run since the clock was constructed.
+	 * @return Tick count.
+	 */
+	unsigned long getTickCount() const { return ticks.load(); }
+
+	/**
+	 * @brief Gets the number of schedule slots dropped because ticks overran.
+	 * @return Skipped slot count.
+	 */
+	unsigned long getSkippedTicks() const { return skipped.load(); }
+
+private:
+	std::mutex lock;
+	std::condition_variable wakeUp;
+	std::thread worker;
+
+	std::chrono::microseconds period;
+	CatchUpPolicy policy;
+	unsigned int maxBurst;
+	bool stopRequested;
+	bool rescheduled;
+
+	std::atomic<bool> running;
+	std::atomic<unsigned long> ticks;
+	std::atomic<unsigned long> skipped;
+
+	void run(TickFunction onTick);
+	Clock::time_point nextDeadline(Clock::time_point due, Clock::time_point started,
+								   Clock::time_point finished, unsigned int &burst);
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "TickScheduler.h"
+#include "../composite/PlantGroup.h"
+#include "../prototype/LivingPlant.h"
+#include "../prototype/PlantStateTable.h"
+#include "../state/GrowKernel.h"
+#include <algorithm>
+
+namespace
+{
+    // Levels at or below which PlantGroup::notifyCareNeeds() calls the observers
+    const int CARE_WATER = 50, CARE_SUN = 50;
+
+    // Maturity transition rules of Seed::grow(), Vegetative::grow() and Mature::grow()
+    const int SEED_UP_AGE = 7, SEED_UP_HEALTH = 50;
+    const int VEG_UP_AGE = 30, VEG_UP_HEALTH = 60;
+    const int DEATH_AGE = 120;
+}
+
+TickScheduler::TickScheduler(PlantGroup *root, PlantStateTable *table, Flyweight<MaturityState *> *states[4])
+    : root(root), table(table), structureVersion(0), built(false), maxUsage(1), lastEvaluations(0)
+{
+    for (int code = GrowKernel::SEED; code <= GrowKernel::MATURE; code++)
+    {
+        for (int current = 0; current < SEASON_ID_COUNT; current++)
+        {
+            for (int plant = 0; plant < SEASON_ID_COUNT; plant++)
+                maxUsage = std::max(maxUsage, GrowKernel::waterUsage(code, static_cast<SeasonId>(current), static_cast<SeasonId>(plant)));
+        }
+    }
+
+    table->beginLazy(states);
+}
+
+TickScheduler::~TickScheduler()
+{
+    table->endLazy();
+}
+
+void TickScheduler::tick(SeasonId season)
+{
+    unsigned long today = table->getCurrentDay() + 1;
+
+    if (!built || table->getStructureVersion() != structureVersion)
+    {
+        rebuild();
+    }
+    else
+    {
+        table->takeTouchedRows(touched);
+        for (std::size_t i = 0; i < touched.size(); i++)
+        {
+            unsigned int row = touched[i];
+            if (row < versions.size() && table->isLazyMember(row))
+                schedule(row, table->getCurrentDay());
+        }
+    }
+
+    table->beginDay(season);
+    lastEvaluations = eager.size();
+
+    for (std::size_t i = 0; i < eager.size(); i++)
+    {
+        if (eager[i].group)
+            eager[i].group->notifyCareNeeds(eager[i].component);
+        if (eager[i].grow)
+            eager[i].component->tick();
+    }
+
+    while (!queue.empty() && queue.top().due <= today)
+    {
+        Entry entry = queue.top();
+        queue.pop();
+        if (entry.version != versions[entry.row] || !table->isLazyMember(entry.row))
+            continue;
+
+        table->syncRow(entry.row);
+        if (observerGroups[entry.row])
+            observerGroups[entry.row]->notifyCareNeeds(components[entry.row]);
+        table->growRowToday(entry.row);
+        lastEvaluations++;
+
+        schedule(entry.row, today);
+    }
+
+    table->endDay();
+}
+
+void TickScheduler::rebuild()
+{
+    // Every current member is brought up to today before the set changes
+    for (std::size_t i = 0; i < memberRows.size(); i++)
+    {
+        table->syncRow(memberRows[i]);
+        table->setLazyMember(memberRows[i], false);
+    }
+
+    structureVersion = table->getStructureVersion();
+    built = true;
+
+    memberRows.clear();
+    eager.clear();
+    queue = std::priority_queue<Entry, std::vector<Entry>, Later>();
+    versions.assign(table->size(), 0);
+    components.assign(table->size(), nullptr);
+    observerGroups.assign(table->size(), nullptr);
+    table->takeTouchedRows(touched);
+
+    collect(root);
+
+    for (std::size_t i = 0; i < memberRows.size(); i++)
+        schedule(memberRows[i], table->getCurrentDay());
+}
+
+void TickScheduler::collect(PlantGroup *group)
+{
+    PlantGroup *observing = group->hasObservers() ? group : nullptr;
+
+    for (PlantComponent *component : group->getChildren())
+    {
+        if (component == nullptr)
+            continue;
+        if (component->getType() == ComponentType::PLANT_GROUP)
+        {
+            collect(static_cast<PlantGroup *>(component));
+            continue;
+        }
+
+        if (component->getType() == ComponentType::LIVING_PLANT)
+        {
+            LivingPlant *plant = static_cast<LivingPlant *>(component);
+            PlantHandle handle = plant->getHandle();
+
+            if (table->owner(handle) == plant && !table->isLazyMember(handle.index))
+            {
+                table->setLazyMember(handle.index, true);
+                memberRows.push_back(handle.index);
+                components[handle.index] = component;
+                observerGroups[handle.index] = observing;
+                continue;
+            }
+
+            // A plant listed twice is grown once, but each extra parent still notifies daily
+            if (observing)
+            {
+                EagerEntry entry = {component, observing, false};
+                eager.push_back(entry);
+            }
+            continue;
+        }
+
+        EagerEntry entry = {component, observing, true};
+        eager.push_back(entry);
+    }
+}
+
+void TickScheduler::schedule(unsigned int row, unsigned long now)
+{
+    versions[row]++;
+
+    unsigned long due = predictDue(row, now);
+    if (due != NEVER)
+    {
+        Entry entry = {due, row, versions[row]};
+        queue.push(entry);
+    }
+}
+
+unsigned long TickScheduler::predictDue(unsigned int row, unsigned long now)
+{
+    bool observed = observerGroups[row] != nullptr;
+    if (observed)
+        table->syncRow(row);
+
+    int age, health, water, sun, code;
+    table->peekRow(row, age, health, water, sun, code);
+
+    // Unknown states are grown through their own grow(), which reads the live season
+    if (code < 0)
+        return now + 1;
+    if (!observed)
+        return NEVER;
+    if (water <= CARE_WATER || sun <= CARE_SUN)
+        return now + 1;
+    if (code == GrowKernel::SKIP || code == GrowKernel::DEAD)
+        return NEVER;
+
+    // First day the water level could reach the care threshold
+    long waterDays = 1 + (water - CARE_WATER + maxUsage - 1) / maxUsage;
+
+    // First day a maturity transition could reset water and sun
+    long transitionDays;
+    if (code == GrowKernel::SEED)
+        transitionDays = std::max(SEED_UP_AGE - age, SEED_UP_HEALTH - health);
+    else if (code == GrowKernel::VEGETATIVE)
+        transitionDays = std::max(VEG_UP_AGE - age, VEG_UP_HEALTH - health);
+    else
+        transitionDays = health <= 0 ? 1 : DEATH_AGE - age;
+
+    return now + std::max(1L, std::min(waterDays, transitionDays));
+}
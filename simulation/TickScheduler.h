@@ -0,0 +1,138 @@
+#ifndef TickScheduler_h
+#define TickScheduler_h
+
+#include <cstddef>
+#include <queue>
+#include <vector>
+#include "../state/Season.h"
+
+class PlantComponent;
+class PlantGroup;
+class PlantStateTable;
+class MaturityState;
+
+template <typename T>
+class Flyweight;
+
+/**
+ * @brief Event-driven replacement for the daily sweep over every plant.
+ *
+ * Most plants do nothing interesting on most days: their water level drops by
+ * a few units and their age goes up by one. Those days can be replayed exactly
+ * later, so the scheduler leaves such plants alone and only evaluates a plant
+ * on the day it is next due, taken from a min-heap keyed by day.
+ *
+ * A plant is due when something outside its own row may depend on it:
+ * - its observing group would notify staff (water or sun at or below 50),
+ * - or it could change maturity state, which resets its water and sun.
+ * Both are predicted conservatively from the row's values: water drops by at
+ * most the largest daily usage, health rises by at most one per day and age
+ * by exactly one. Plants whose group has no observers are never due; the days
+ * they miss are replayed by PlantStateTable the next time they are read.
+ * Plants in a state GrowKernel does not know are grown every day.
+ *
+ * Changes made between ticks (watering, setters, setMaturity) are reported
+ * by LivingPlant through PlantStateTable::touch() and re-predicted before the
+ * next day. Adding, removing or re-observing components bumps
+ * PlantStateTable::getStructureVersion() and the plant set is rebuilt.
+ *
+ * **Ordering:**
+ * Due plants are notified and grown one at a time rather than notifying the
+ * whole composite before anything grows. This gives the same results as the
+ * sweep as long as an observer only changes the plant it is notified about,
+ * which is what Staff does.
+ *
+ * **System Role:**
+ * Owned by Inventory while Inventory::setEventDriven(true) is in effect. It
+ * puts the PlantStateTable in lazy mode for its lifetime.
+ *
+ * @see Inventory::setEventDriven()
+ * @see PlantStateTable::beginLazy()
+ */
+class TickScheduler
+{
+private:
+	struct Entry
+	{
+		unsigned long due;
+		unsigned int row;
+		unsigned int version;
+	};
+
+	struct Later
+	{
+		bool operator()(const Entry &a, const Entry &b) const
+		{
+			return a.due > b.due || (a.due == b.due && a.row > b.row);
+		}
+	};
+
+	// Component ticked the old way every day, with the group that notifies for it
+	struct EagerEntry
+	{
+		PlantComponent *component;
+		PlantGroup *group;
+		bool grow;
+	};
+
+	PlantGroup *root;
+	PlantStateTable *table;
+
+	std::priority_queue<Entry, std::vector<Entry>, Later> queue;
+
+	// Per-row bookkeeping, indexed like the table
+	std::vector<unsigned int> versions;
+	std::vector<PlantComponent *> components;
+	std::vector<PlantGroup *> observerGroups;
+
+	std::vector<unsigned int> memberRows;
+	std::vector<EagerEntry> eager;
+	std::vector<unsigned int> touched;
+
+	unsigned long structureVersion;
+	bool built;
+	int maxUsage;
+	std::size_t lastEvaluations;
+
+	void rebuild();
+	void collect(PlantGroup *group);
+	void schedule(unsigned int row, unsigned long now);
+	unsigned long predictDue(unsigned int row, unsigned long now);
+
+public:
+	/** Due day of a plant that needs no evaluation until it is changed. */
+	static const unsigned long NEVER = ~0UL;
+
+	/**
+	 * @brief Starts scheduling the plants under root and puts the table in lazy mode.
+	 * @param root Root of the composite that is ticked.
+	 * @param table Table holding the plants' state.
+	 * @param states Seed, Vegetative, Mature and Dead flyweights, indexed by state ID.
+	 */
+	TickScheduler(PlantGroup *root, PlantStateTable *table, Flyweight<MaturityState *> *states[4]);
+
+	/**
+	 * @brief Brings every plant up to date and takes the table out of lazy mode.
+	 */
+	~TickScheduler();
+
+	/**
+	 * @brief Advances one day, evaluating only the plants that are due.
+	 * @param season Season the day is grown under.
+	 */
+	void tick(SeasonId season);
+
+	/**
+	 * @brief Gets how many plants and components the last tick evaluated.
+	 * @return Due rows plus components ticked every day.
+	 */
+	std::size_t getLastTickEvaluations() const { return lastEvaluations; }
+
+	/**
+	 * @brief Gets how many plants the scheduler grows lazily.
+	 * @return Number of table rows in the ticked composite.
+	 */
+	std::size_t getMemberCount() const { return memberRows.size(); }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "TickStats.h"
+
+namespace
+{
+    // Values below SUB_BUCKETS are exact; each power of two above is split into HALF_BUCKETS
+    const int SUB_BUCKET_BITS = 8;
+    const unsigned long long SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    const unsigned long long HALF_BUCKETS = SUB_BUCKETS / 2;
+    const int MAX_VALUE_BITS = 40;
+
+    int highestBit(unsigned long long value)
+    {
+        int bit = 0;
+        while (value >>= 1)
+            bit++;
+        return bit;
+    }
+
+    TickRecord emptyRecord()
+    {
+        TickRecord record = TickRecord();
+        return record;
+    }
+}
+
+const unsigned long long LatencyHistogram::MAX_VALUE = (1ULL << MAX_VALUE_BITS) - 1;
+
+LatencyHistogram::LatencyHistogram()
+    : counts(indexFor(MAX_VALUE) + 1, 0), count(0), minValue(0), maxValue(0), sum(0.0)
+{
+}
+
+std::size_t LatencyHistogram::indexFor(unsigned long long value)
+{
+    if (value < SUB_BUCKETS)
+        return static_cast<std::size_t>(value);
+
+    int shift = highestBit(value) - (SUB_BUCKET_BITS - 1);
+    unsigned long long sub = value >> shift;
+    return static_cast<std::size_t>(SUB_BUCKETS + (shift - 1) * HALF_BUCKETS + (sub - HALF_BUCKETS));
+}
+
+unsigned long long LatencyHistogram::highestEquivalent(std::size_t index)
+{
+    if (index < SUB_BUCKETS)
+        return index;
+
+    unsigned long long offset = index - SUB_BUCKETS;
+    int shift = static_cast<int>(offset / HALF_BUCKETS) + 1;
+    unsigned long long sub = offset % HALF_BUCKETS + HALF_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(unsigned long long value)
+{
+    if (value > MAX_VALUE)
+        value = MAX_VALUE;
+
+    counts[indexFor(value)]++;
+    if (count == 0 || value < minValue)
+        minValue = value;
+    if (value > maxValue)
+        maxValue = value;
+    sum += static_cast<double>(value);
+    count++;
+}
+
+unsigned long long LatencyHistogram::getValueAtPercentile(double percentile) const
+{
+    if (count == 0)
+        return 0;
+    if (percentile > 100.0)
+        percentile = 100.0;
+
+    // Rank of the value asked for, counting from 1
+    unsigned long long rank = static_cast<unsigned long long>(percentile / 100.0 * count + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    unsigned long long seen = 0;
+    for (std::size_t i = 0; i < counts.size(); i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            unsigned long long value = highestEquivalent(i);
+            return value < maxValue ? value : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::size_t i = 0; i < counts.size(); i++)
+        counts[i] = 0;
+    count = 0;
+    minValue = 0;
+    maxValue = 0;
+    sum = 0.0;
+}
+
+TickStats::TickStats()
+    : last(emptyRecord()), totals(emptyRecord()), ticks(0)
+{
+}
+
+void TickStats::record(const TickRecord &tick)
+{
+    last = tick;
+    last.seasonChanges = 0;
+
+    for (int phase = 0; phase < TICK_PHASE_COUNT; phase++)
+    {
+        totals.phaseNanos[phase] += tick.phaseNanos[phase];
+        latency[phase].record(tick.phaseNanos[phase]);
+    }
+    for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+        totals.growCalls[code] += tick.growCalls[code];
+
+    totals.plantsVisited += tick.plantsVisited;
+    totals.waterNotifications += tick.waterNotifications;
+    totals.sunNotifications += tick.sunNotifications;
+    totals.stateNotifications += tick.stateNotifications;
+    totals.commandsApplied += tick.commandsApplied;
+    ticks++;
+}
+
+void TickStats::recordSeasonChange()
+{
+    last.seasonChanges++;
+    totals.seasonChanges++;
+}
+
+void TickStats::reset()
+{
+    last = emptyRecord();
+    totals = emptyRecord();
+    ticks = 0;
+    for (int phase = 0; phase < TICK_PHASE_COUNT; phase++)
+        latency[phase].reset();
+}
@@ -0,0 +1,189 @@
+#ifndef TickStats_h
+#define TickStats_h
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Latency histogram with log-linear buckets, in the style of HdrHistogram.
+ *
+ * Values below 256 get a bucket each; above that every power-of-two range is
+ * split into 128 equal buckets, so any recorded value is reported to within
+ * 1% (two significant digits) while the whole range from 1 ns to about 17
+ * minutes fits in a few thousand counters. Recording is O(1) and never
+ * allocates.
+ *
+ * **System Role:**
+ * Used by TickStats for per-phase tick latencies, recorded in nanoseconds.
+ */
+class LatencyHistogram
+{
+private:
+	std::vector<unsigned long long> counts;
+	unsigned long long count;
+	unsigned long long minValue;
+	unsigned long long maxValue;
+	double sum;
+
+	static std::size_t indexFor(unsigned long long value);
+	static unsigned long long highestEquivalent(std::size_t index);
+
+public:
+	/** Largest value tracked; larger values are recorded as this. */
+	static const unsigned long long MAX_VALUE;
+
+	/**
+	 * @brief Constructs an empty histogram.
+	 */
+	LatencyHistogram();
+
+	/**
+	 * @brief Adds one value.
+	 * @param value Value to record, normally nanoseconds.
+	 */
+	void record(unsigned long long value);
+
+	/**
+	 * @brief Gets the number of recorded values.
+	 * @return Value count.
+	 */
+	unsigned long long getCount() const { return count; }
+
+	/**
+	 * @brief Gets the smallest recorded value.
+	 * @return Exact minimum, 0 if nothing was recorded.
+	 */
+	unsigned long long getMin() const { return count ? minValue : 0; }
+
+	/**
+	 * @brief Gets the largest recorded value.
+	 * @return Exact maximum, 0 if nothing was recorded.
+	 */
+	unsigned long long getMax() const { return maxValue; }
+
+	/**
+	 * @brief Gets the mean of the recorded values.
+	 * @return Exact mean, 0 if nothing was recorded.
+	 */
+	double getMean() const { return count ? sum / count : 0.0; }
+
+	/**
+	 * @brief Gets the value below which a given share of the recorded values fall.
+	 * @param percentile Percentile between 0 and 100.
+	 * @return Upper edge of the bucket holding that value, capped at getMax();
+	 * 0 if nothing was recorded.
+	 */
+	unsigned long long getValueAtPercentile(double percentile) const;
+
+	/**
+	 * @brief Removes every recorded value.
+	 */
+	void reset();
+};
+
+/**
+ * @brief The parts of Inventory::tick() that are timed separately.
+ */
+enum class TickPhase
+{
+	Commands = 0, ///< Applying queued commands
+	Growth,		  ///< Observer pass and growing the plants
+	Snapshot,	  ///< Publishing the read snapshot
+	Total		  ///< The whole tick
+};
+
+/** Number of TickPhase values. */
+const int TICK_PHASE_COUNT = 4;
+
+/** Number of grow-call counters: one per GrowKernel code, index 0 for other states. */
+const int GROW_COUNTER_COUNT = 5;
+
+/**
+ * @brief What one tick did, or the sum over many ticks.
+ */
+struct TickRecord
+{
+	/** Wall time of each TickPhase in nanoseconds. */
+	unsigned long long phaseNanos[TICK_PHASE_COUNT];
+	/** Plants grown or evaluated by the tick. */
+	unsigned long plantsVisited;
+	/** grow() calls by GrowKernel state code; index 0 counts states outside the kernel. */
+	unsigned long growCalls[GROW_COUNTER_COUNT];
+	/** getWaterUpdate() calls made on observers. */
+	unsigned long waterNotifications;
+	/** getSunUpdate() calls made on observers. */
+	unsigned long sunNotifications;
+	/** getStateUpdate() calls made on observers. */
+	unsigned long stateNotifications;
+	/** Season changes that followed the tick. */
+	unsigned long seasonChanges;
+	/** Queued commands applied at the start of the tick. */
+	unsigned long commandsApplied;
+};
+
+/**
+ * @brief Per-tick instrumentation collected by Inventory.
+ *
+ * Keeps the last tick's record, running totals and one LatencyHistogram per
+ * TickPhase. Inventory fills it under its tick lock and hands out copies
+ * through Inventory::getTickStats().
+ *
+ * @see Inventory::getTickStats()
+ */
+class TickStats
+{
+private:
+	TickRecord last;
+	TickRecord totals;
+	unsigned long ticks;
+	LatencyHistogram latency[TICK_PHASE_COUNT];
+
+public:
+	/**
+	 * @brief Constructs empty statistics.
+	 */
+	TickStats();
+
+	/**
+	 * @brief Adds one tick.
+	 * @param tick What the tick did; seasonChanges is ignored.
+	 */
+	void record(const TickRecord &tick);
+
+	/**
+	 * @brief Counts a season change against the last tick and the totals.
+	 */
+	void recordSeasonChange();
+
+	/**
+	 * @brief Gets the number of ticks recorded.
+	 * @return Tick count.
+	 */
+	unsigned long getTickCount() const { return ticks; }
+
+	/**
+	 * @brief Gets the most recent tick.
+	 * @return Record of the last tick, all zero before the first.
+	 */
+	const TickRecord &getLastTick() const { return last; }
+
+	/**
+	 * @brief Gets the sums over every recorded tick.
+	 * @return Running totals.
+	 */
+	const TickRecord &getTotals() const { return totals; }
+
+	/**
+	 * @brief Gets the latency distribution of one phase.
+	 * @param phase Phase to look up.
+	 * @return Histogram of that phase's wall times in nanoseconds.
+	 */
+	const LatencyHistogram &getLatency(TickPhase phase) const { return latency[static_cast<int>(phase)]; }
+
+	/**
+	 * @brief Clears every record, total and histogram.
+	 */
+	void reset();
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "WorkStealingPool.h"
+
+namespace
+{
+    // Identifies which pool and queue the current thread is working for.
+    thread_local WorkStealingPool *currentPool = nullptr;
+    thread_local unsigned int currentWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int threads, const Task &workerStart)
+    : pending(0), stopping(false), workerStart(workerStart)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    for (unsigned int i = 0; i < threads; i++)
+        queues.push_back(new WorkerQueue());
+
+    for (unsigned int i = 1; i < threads; i++)
+        workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping.store(true);
+    }
+    wakeUp.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        if (workers[i].joinable())
+            workers[i].join();
+    }
+
+    for (size_t i = 0; i < queues.size(); i++)
+        delete queues[i];
+}
+
+void WorkStealingPool::run(const Task &root)
+{
+    WorkStealingPool *previousPool = currentPool;
+    unsigned int previousWorker = currentWorker;
+    currentPool = this;
+    currentWorker = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(errorLock);
+        firstError = nullptr;
+    }
+
+    spawn(root);
+
+    // Worker 0 helps until the barrier is reached
+    while (pending.load() > 0)
+    {
+        if (!runOne(0))
+            std::this_thread::yield();
+    }
+
+    currentPool = previousPool;
+    currentWorker = previousWorker;
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> guard(errorLock);
+        error = firstError;
+        firstError = nullptr;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void WorkStealingPool::spawn(const Task &task)
+{
+    unsigned int index = (currentPool == this) ? currentWorker : 0;
+
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        queues[index]->tasks.push_back(task);
+    }
+
+    if (!workers.empty())
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        wakeUp.notify_one();
+    }
+}
+
+void WorkStealingPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                                   const RangeBody &body)
+{
+    splitRange(begin, end, grain == 0 ? 1 : grain, std::make_shared<const RangeBody>(body));
+}
+
+void WorkStealingPool::splitRange(std::size_t begin, std::size_t end, std::size_t grain,
+                                  const std::shared_ptr<const RangeBody> &body)
+{
+    while (end - begin > grain)
+    {
+        std::size_t middle = begin + (end - begin) / 2;
+        std::size_t upperEnd = end;
+        std::shared_ptr<const RangeBody> shared = body;
+        spawn([this, middle, upperEnd, grain, shared]()
+              { splitRange(middle, upperEnd, grain, shared); });
+        end = middle;
+    }
+
+    if (begin < end)
+        (*body)(begin, end);
+}
+
+void WorkStealingPool::workerLoop(unsigned int index)
+{
+    currentPool = this;
+    currentWorker = index;
+    if (workerStart)
+        workerStart();
+
+    while (!stopping.load())
+    {
+        if (runOne(index))
+            continue;
+
+        if (pending.load() > 0)
+        {
+            // Work is in flight but nothing is stealable yet
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wakeUp.wait(guard, [this]()
+                    { return stopping.load() || pending.load() > 0; });
+    }
+}
+
+bool WorkStealingPool::popLocal(unsigned int index, Task &task)
+{
+    WorkerQueue *queue = queues[index];
+    std::lock_guard<std::mutex> guard(queue->lock);
+    if (queue->tasks.empty())
+        return false;
+
+    task.swap(queue->tasks.back());
+    queue->tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned int thief, Task &task)
+{
+    const unsigned int count = static_cast<unsigned int>(queues.size());
+    for (unsigned int offset = 1; offset < count; offset++)
+    {
+        WorkerQueue *victim = queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if (victim->tasks.empty())
+            continue;
+
+        task.swap(victim->tasks.front());
+        victim->tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::runOne(unsigned int index)
+{
+    Task task;
+    if (!popLocal(index, task) && !steal(index, task))
+        return false;
+
+    execute(task);
+    return true;
+}
+
+void WorkStealingPool::execute(Task &task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(errorLock);
+        if (!firstError)
+            firstError = std::current_exception();
+    }
+    pending.fetch_sub(1);
+}
@@ -0,0 +1,126 @@
+#ifndef WorkStealingPool_h
+#define WorkStealingPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of workers that balance fork-join tasks by stealing.
+ *
+ * Every worker owns a double-ended queue. A worker pushes the tasks it spawns
+ * onto the back of its own queue and pops from the back (newest first), while
+ * idle workers steal from the front of other queues (oldest, and therefore
+ * largest, pieces of work first). This keeps lopsided task trees balanced
+ * without any up-front partitioning: a single huge PlantGroup is split into
+ * ranges that drift to whichever workers run out of work.
+ *
+ * **System Role:**
+ * Execution engine behind Inventory's parallel tick mode. run() is the per-tick
+ * barrier: it returns only when the root task and everything it spawned have
+ * finished, so Inventory can safely change the season afterwards.
+ *
+ * **Threading:**
+ * The thread calling run() takes part as worker 0; the pool starts
+ * (threads - 1) background workers that sleep while there is no work.
+ * run() must not be called concurrently from two threads on the same pool.
+ *
+ * @see Inventory::setTickThreads()
+ */
+class WorkStealingPool
+{
+public:
+	typedef std::function<void()> Task;
+	typedef std::function<void(std::size_t, std::size_t)> RangeBody;
+
+	/**
+	 * @brief Starts a pool with the given total number of workers.
+	 * @param threads Total worker count including the caller of run(). 0 uses
+	 * std::thread::hardware_concurrency().
+	 * @param workerStart Optional task each background worker runs once when it
+	 * starts, e.g. to bind the worker to a NurseryContext.
+	 */
+	explicit WorkStealingPool(unsigned int threads, const Task &workerStart = Task());
+
+	/**
+	 * @brief Stops and joins all background workers.
+	 */
+	~WorkStealingPool();
+
+	/**
+	 * @brief Runs a task and everything it spawns, returning when all are done.
+	 *
+	 * Rethrows the first exception thrown by any task once the barrier is reached.
+	 *
+	 * @param root The first task of this batch.
+	 */
+	void run(const Task &root);
+
+	/**
+	 * @brief Queues a task on the calling worker's deque.
+	 *
+	 * Must be called from inside a task running on this pool.
+	 *
+	 * @param task Task to queue.
+	 */
+	void spawn(const Task &task);
+
+	/**
+	 * @brief Splits [begin, end) in halves until pieces are at most grain long.
+	 *
+	 * The upper halves are spawned so other workers can steal them; the lowest
+	 * piece is run inline. Must be called from inside a task running on this
+	 * pool. The body is shared by all pieces, so it may capture locals of the
+	 * calling task by value only.
+	 *
+	 * @param begin First index.
+	 * @param end One past the last index.
+	 * @param grain Largest range handed to body in one call.
+	 * @param body Function invoked as body(rangeBegin, rangeEnd).
+	 */
+	void parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+					 const RangeBody &body);
+
+	/**
+	 * @brief Gets the total number of workers including the caller of run().
+	 * @return Worker count.
+	 */
+	unsigned int getThreadCount() const { return static_cast<unsigned int>(queues.size()); }
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex lock;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<WorkerQueue *> queues;
+	std::vector<std::thread> workers;
+
+	std::atomic<long> pending;
+	std::atomic<bool> stopping;
+	Task workerStart;
+
+	std::mutex sleepLock;
+	std::condition_variable wakeUp;
+
+	std::mutex errorLock;
+	std::exception_ptr firstError;
+
+	void splitRange(std::size_t begin, std::size_t end, std::size_t grain,
+					const std::shared_ptr<const RangeBody> &body);
+	void workerLoop(unsigned int index);
+	bool popLocal(unsigned int index, Task &task);
+	bool steal(unsigned int thief, Task &task);
+	bool runOne(unsigned int index);
+	void execute(Task &task);
+};
+
+#endif
@@ -0,0 +1,26 @@
+#include "NurseryContext.h"
+
+NurseryContext::Scope::Scope(NurseryContext &context)
+    : binding(context.inventory)
+{
+}
+
+NurseryContext::Scope::~Scope()
+{
+}
+
+NurseryContext::NurseryContext()
+    : inventory(new Inventory())
+{
+}
+
+NurseryContext::~NurseryContext()
+{
+    delete inventory;
+}
+
+void NurseryContext::run(const std::function<void()> &action)
+{
+    Scope scope(*this);
+    action();
+}
@@ -0,0 +1,98 @@
+#ifndef NurseryContext_h
+#define NurseryContext_h
+
+#include <functional>
+#include "Singleton.h"
+
+/**
+ * @brief One independent nursery: an Inventory that is not the global singleton.
+ *
+ * Everything that used to be process-wide lives in the Inventory, so each
+ * context has its own plant composite, PlantStateTable, strategy and state
+ * registries, staff and customer lists, command queue and ticker. Interned
+ * strings (plant names, seasons) are the exception: every context shares
+ * StringInterner::shared(), so equal names are stored once per process.
+ *
+ * Code throughout the system (plants, decorators, states, mediators, the
+ * facade) reaches the inventory through Inventory::getInstance(), which
+ * returns the context bound to the calling thread and falls back to the
+ * default singleton otherwise.
+ *
+ * A context can be used in two ways:
+ * - passed explicitly: getInventory() gives the Inventory, whose tick(),
+ *   advanceDay(), advanceDays(), reapDeadPlants(), applyCommands() and ticker
+ *   bind the context for the calling or ticking thread by themselves;
+ * - bound to a thread with a Scope (or run()), after which builders, the
+ *   facade and new plants on that thread all work on this context.
+ *
+ * Plants, groups and staff must only be used with the context they were
+ * created in, and each context should be driven by one thread at a time, like
+ * the default instance.
+ *
+ * **System Role:**
+ * Lets one process simulate many greenhouses, e.g. one per core, each with its
+ * own ticker. Inventory::getInstance() remains the default context.
+ *
+ * **Pattern Role:** Context object alongside the Singleton default
+ *
+ * @see Inventory::getInstance()
+ */
+class NurseryContext
+{
+private:
+	Inventory *inventory;
+
+	NurseryContext(const NurseryContext &);
+	NurseryContext &operator=(const NurseryContext &);
+
+public:
+	/**
+	 * @brief Binds a context to the current thread until the scope ends.
+	 *
+	 * Scopes nest: the previous binding, if any, is restored on destruction.
+	 */
+	class Scope
+	{
+	private:
+		Inventory::Binding binding;
+
+		Scope(const Scope &);
+		Scope &operator=(const Scope &);
+
+	public:
+		/**
+		 * @brief Binds a context.
+		 * @param context Context that Inventory::getInstance() returns on this thread.
+		 */
+		explicit Scope(NurseryContext &context);
+
+		/**
+		 * @brief Restores the binding that was active before this scope.
+		 */
+		~Scope();
+	};
+
+	/**
+	 * @brief Creates a new, empty nursery with its own inventory.
+	 */
+	NurseryContext();
+
+	/**
+	 * @brief Stops the context's ticker and deletes its inventory and everything in it.
+	 */
+	~NurseryContext();
+
+	/**
+	 * @brief Gets this context's inventory.
+	 * @return The Inventory owned by this context.
+	 */
+	Inventory *getInventory() { return inventory; }
+
+	/**
+	 * @brief Runs a function with this context bound to the calling thread.
+	 * @param action Function to run.
+	 */
+	void run(const std::function<void()> &action);
+};
+
+#endif
@@ -6,54 +6,140 @@
 #include "../composite/PlantGroup.h"
 #include "../mediator/Customer.h"
 #include "../mediator/Staff.h"
+#include "../prototype/PlantStateTable.h"
+#include "../simulation/WorkStealingPool.h"
+#include "../simulation/TickScheduler.h"
+#include "../simulation/PlantArchive.h"
+#include "../simulation/InventorySnapshot.h"
+#include "../flyweight/StringInterner.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include "../state/GrowKernel.h"
+namespace
+{
+    // Rows grown by one task in the parallel table sweep
+    const std::size_t PARALLEL_SWEEP_GRAIN = 2048;
+
+    unsigned long long elapsedNanos(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+    {
+        return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+
+    // A plant fast-forwarded by advanceDays(), or a component it has to tick day by day
+    struct ForwardEntry
+    {
+        PlantComponent *component;
+        bool observed;
+        bool grow;
+    };
+
+    void collectForward(PlantGroup *group, PlantStateTable *table, std::vector<unsigned char> &seen,
+                        std::vector<ForwardEntry> &rows, std::vector<ForwardEntry> &daily)
+    {
+        bool observed = group->hasObservers();
+
+        for (PlantComponent *component : group->getChildren())
+        {
+            if (component == nullptr)
+                continue;
+            if (component->getType() == ComponentType::PLANT_GROUP)
+            {
+                collectForward(static_cast<PlantGroup *>(component), table, seen, rows, daily);
+                continue;
+            }
+
+            ForwardEntry entry = {component, observed, true};
+            if (component->getType() == ComponentType::LIVING_PLANT)
+            {
+                LivingPlant *plant = static_cast<LivingPlant *>(component);
+                PlantHandle handle = plant->getHandle();
+
+                // Like the sweep, a plant is grown once however often it is listed
+                if (table->owner(handle) == plant && !seen[handle.index])
+                {
+                    seen[handle.index] = 1;
+                    rows.push_back(entry);
+                    continue;
+                }
+                entry.grow = false;
+            }
+            daily.push_back(entry);
+        }
+    }
+}
+
 Inventory *Inventory::instance = nullptr;
-thread *Inventory::TickerThread = nullptr;
-std::atomic<bool> Inventory::on(false);
-int Inventory::timeBetweenTicks = 2;
+thread_local Inventory *Inventory::bound = nullptr;
 
 Inventory::Inventory()
 {
-    on.store(false);
-    inventory = new PlantGroup();
+    ticksSinceSeason = 0;
+    ticker = new SimulationClock(std::chrono::seconds(2));
+    plantStates = new PlantStateTable(this);
+    tickPool = nullptr;
+    scheduler = nullptr;
+    archive = new PlantArchive();
+    autoReap = false;
+    snapshots = new SnapshotBuffer();
+    snapshotPublishing = true;
+    commands = new CommandQueue();
+    tickStats = new TickStats();
+    inventory = new PlantGroup(plantStates);
 
-    stringFactory = new FlyweightFactory<string, string *>();
-    waterStrategies = new FlyweightFactory<int, WaterStrategy *>();
-    sunStrategies = new FlyweightFactory<int, SunStrategy *>();
-    states = new FlyweightFactory<int, MaturityState *>();
+    strings = &StringInterner::shared();
+    waterStrategies = new FlyweightRegistry<WaterStrategy *, STRATEGY_SLOTS>();
+    sunStrategies = new FlyweightRegistry<SunStrategy *, STRATEGY_SLOTS>();
+    states = new FlyweightRegistry<MaturityState *, STATE_SLOTS>();
     staffList = new vector<Staff *>();
     customerList = new vector<Customer *>();
 
-    // Adding the water strategies
-    waterStrategies->getFlyweight(LowWater::getID(), new LowWater());
-    waterStrategies->getFlyweight(MidWater::getID(), new MidWater());
-    waterStrategies->getFlyweight(HighWater::getID(), new HighWater());
-    waterStrategies->getFlyweight(AlternatingWater::getID(), new AlternatingWater());
+    // Adding the water strategies; a new strategy only needs its line here
+    waterStrategies->add<LowWater>();
+    waterStrategies->add<MidWater>();
+    waterStrategies->add<HighWater>();
+    waterStrategies->add<AlternatingWater>();
 
     // adding the Sun strategies
-    sunStrategies->getFlyweight(LowSun::getID(), new LowSun());
-    sunStrategies->getFlyweight(MidSun::getID(), new MidSun());
-    sunStrategies->getFlyweight(HighSun::getID(), new HighSun());
-    sunStrategies->getFlyweight(AlternatingSun::getID(), new AlternatingSun());
+    sunStrategies->add<LowSun>();
+    sunStrategies->add<MidSun>();
+    sunStrategies->add<HighSun>();
+    sunStrategies->add<AlternatingSun>();
 
-    states->getFlyweight(Seed::getID(), new Seed());
-    states->getFlyweight(Vegetative::getID(), new Vegetative());
-    states->getFlyweight(Mature::getID(), new Mature());
-    states->getFlyweight(Dead::getID(), new Dead());
+    states->add<Seed>();
+    states->add<Vegetative>();
+    states->add<Mature>();
+    states->add<Dead>();
 
-    getString("Winter Season");
-    this->currentSeason = getString("Summer Season");
-    getString("Spring Season");
-    getString("Autumn Season");
+    for (int id = 0; id < SEASON_ID_COUNT; id++)
+        seasonStrings[id] = nullptr;
+    seasonStrings[static_cast<int>(SeasonId::Winter)] = getString("Winter Season");
+    seasonStrings[static_cast<int>(SeasonId::Summer)] = getString("Summer Season");
+    seasonStrings[static_cast<int>(SeasonId::Spring)] = getString("Spring Season");
+    seasonStrings[static_cast<int>(SeasonId::Autumn)] = getString("Autumn Season");
+    this->currentSeasonId = SeasonId::Summer;
+    this->currentSeason = seasonStrings[static_cast<int>(SeasonId::Summer)];
 }
 Inventory::~Inventory()
 {
+    // Plants and decorators look the inventory up while they are deleted
+    Inventory *previous = bindToThread(this);
 
-    stopTicker();
+    ticker->stop();
+    delete ticker;
+    // Unapplied commands are dropped; their futures report broken_promise
+    delete commands;
+    delete tickPool;
+    // Catches every lazily ticked plant up while the composite still exists
+    delete scheduler;
 
     if (inventory)
         delete inventory;
+    plantStates->retire();
+    delete archive;
+    delete snapshots;
+    delete tickStats;
 
-    delete stringFactory;
     delete waterStrategies;
     delete sunStrategies;
     delete states;
@@ -79,11 +165,14 @@ Inventory::~Inventory()
     }
     delete staffList;
     delete customerList;
-    TickerThread = NULL;
-    instance = NULL;
+    if (instance == this)
+        instance = NULL;
+    bindToThread(previous == this ? nullptr : previous);
 }
 Inventory *Inventory::getInstance()
 {
+    if (bound)
+        return bound;
     if (!instance)
     {
         instance = new Inventory();
@@ -92,55 +181,280 @@ Inventory *Inventory::getInstance()
     return instance;
 }
 
-Flyweight<std::string *> *Inventory::getString(std::string str)
+Flyweight<std::string *> *Inventory::getString(const std::string &str)
 {
-    string *flyweightData = new string(str);
-    Flyweight<std::string *> *fly = stringFactory->getFlyweight(*flyweightData, flyweightData);
-    if (fly->getState() != flyweightData)
-    {
-        delete flyweightData;
-    }
-    return fly;
+    return strings->intern(str.data(), str.size());
+}
+
+Flyweight<std::string *> *Inventory::getString(const char *text, std::size_t length)
+{
+    return strings->intern(text, length);
+}
+
+Flyweight<std::string *> *Inventory::getString(const char *text)
+{
+    return strings->intern(text, std::strlen(text));
 }
 Flyweight<WaterStrategy *> *Inventory::getWaterFly(int id)
 {
+    Flyweight<WaterStrategy *> *strategy = waterStrategies->find(id);
+    if (strategy)
+        return strategy;
+
+    std::cerr << "Unknown water strategy ID " << id << '\n';
+    return waterStrategies->find(LowWater::getID());
+}
+Flyweight<MaturityState *> *Inventory::getStates(int id)
+{
+    Flyweight<MaturityState *> *state = states->find(id);
+    if (state)
+        return state;
+
+    std::cerr << "Unknown maturity state ID " << id << '\n';
+    return states->find(Seed::getID());
+}
+
+Flyweight<SunStrategy *> *Inventory::getSunFly(int id)
+{
+    Flyweight<SunStrategy *> *strategy = sunStrategies->find(id);
+    if (strategy)
+        return strategy;
 
-    try
+    std::cerr << "Unknown sun strategy ID " << id << '\n';
+    return sunStrategies->find(LowSun::getID());
+}
+
+WaterHandle Inventory::shareWaterFly(int id)
+{
+    Flyweight<WaterStrategy *> *strategy = waterStrategies->share(id);
+    return WaterHandle::of(strategy ? strategy : getWaterFly(id));
+}
+
+SunHandle Inventory::shareSunFly(int id)
+{
+    Flyweight<SunStrategy *> *strategy = sunStrategies->share(id);
+    return SunHandle::of(strategy ? strategy : getSunFly(id));
+}
+
+Flyweight<MaturityState *> *Inventory::shareState(int id)
+{
+    Flyweight<MaturityState *> *state = states->share(id);
+    return state ? state : getStates(id);
+}
+
+PlantStateTable *Inventory::getPlantStates()
+{
+    return plantStates;
+}
+
+void Inventory::tick()
+{
+    Binding binding(this);
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    TickRecord record = TickRecord();
+    unsigned long growBefore[GROW_COUNTER_COUNT];
+    unsigned long waterBefore, sunBefore, stateBefore;
+    plantStates->getGrowCounts(growBefore);
+    plantStates->getNotificationCounts(waterBefore, sunBefore, stateBefore);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    record.commandsApplied = commands->drain();
+    std::chrono::steady_clock::time_point grown = std::chrono::steady_clock::now();
+
+    if (scheduler)
     {
-        return waterStrategies->getFlyweight(id);
+        scheduler->tick(currentSeasonId);
     }
-    catch (const char *e)
+    else if (!tickPool)
     {
-        std::cerr << e << '\n';
-        return waterStrategies->getFlyweight(LowWater::getID());
+        inventory->prepareTick();
+        plantStates->sweep();
     }
+    else
+    {
+        PlantGroup *root = inventory;
+        PlantStateTable *table = plantStates;
+        WorkStealingPool *pool = tickPool;
+
+        // Every observer notification lands before any plant grows, as in the serial pass
+        pool->run([root, pool]()
+                  { root->prepareTick(pool); });
+        pool->run([table, pool]()
+                  { pool->parallelFor(0, table->size(), PARALLEL_SWEEP_GRAIN,
+                                      [table](std::size_t begin, std::size_t end)
+                                      { table->sweepRange(begin, end); }); });
+    }
+
+    std::chrono::steady_clock::time_point published = std::chrono::steady_clock::now();
+
+    if (snapshotPublishing)
+        snapshots->publish(inventory);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    record.phaseNanos[static_cast<int>(TickPhase::Commands)] = elapsedNanos(start, grown);
+    record.phaseNanos[static_cast<int>(TickPhase::Growth)] = elapsedNanos(grown, published);
+    record.phaseNanos[static_cast<int>(TickPhase::Snapshot)] = elapsedNanos(published, end);
+    record.phaseNanos[static_cast<int>(TickPhase::Total)] = elapsedNanos(start, end);
+
+    unsigned long growAfter[GROW_COUNTER_COUNT];
+    plantStates->getGrowCounts(growAfter);
+    for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+    {
+        record.growCalls[code] = growAfter[code] - growBefore[code];
+        record.plantsVisited += record.growCalls[code];
+    }
+    if (scheduler)
+        record.plantsVisited = scheduler->getLastTickEvaluations();
+
+    plantStates->getNotificationCounts(record.waterNotifications, record.sunNotifications, record.stateNotifications);
+    record.waterNotifications -= waterBefore;
+    record.sunNotifications -= sunBefore;
+    record.stateNotifications -= stateBefore;
+    tickStats->record(record);
 }
-Flyweight<MaturityState *> *Inventory::getStates(int id)
+
+TickStats Inventory::getTickStats()
 {
-    try
+    std::lock_guard<std::mutex> guard(tickLock);
+    return *tickStats;
+}
+
+TickRecord Inventory::getLastTick()
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+    return tickStats->getLastTick();
+}
+
+void Inventory::resetTickStats()
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+    tickStats->reset();
+}
+
+FlyweightReport Inventory::getFlyweightReport()
+{
+    FlyweightReport report;
+    report.setPool(FlyweightPool::Strings, strings->getStats(), sizeof(StringHandle), true);
+    report.setPool(FlyweightPool::Water, waterStrategies->getStats(), sizeof(WaterHandle));
+    report.setPool(FlyweightPool::Sun, sunStrategies->getStats(), sizeof(SunHandle));
+    report.setPool(FlyweightPool::States, states->getStats(), sizeof(Flyweight<MaturityState *> *));
+
+    // Commands change the customers and their baskets, and they run under this lock too
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    // The plants of the composite and the baskets, each counted once however often it is listed
+    std::vector<PlantGroup *> groups(1, inventory);
+    for (std::size_t i = 0; i < customerList->size(); i++)
     {
-        return states->getFlyweight(id);
+        if ((*customerList)[i]->getBasket())
+            groups.push_back((*customerList)[i]->getBasket());
     }
-    catch (const char *e)
+    std::vector<unsigned char> seen(plantStates->size(), 0);
+    for (std::size_t next = 0; next < groups.size(); next++)
     {
-        std::cerr << e << '\n';
-        return states->getFlyweight(Seed::getID());
+        for (PlantComponent *component : groups[next]->getChildren())
+        {
+            if (component == nullptr)
+                continue;
+            if (component->getType() == ComponentType::PLANT_GROUP)
+            {
+                groups.push_back(static_cast<PlantGroup *>(component));
+                continue;
+            }
+            if (component->getType() != ComponentType::LIVING_PLANT)
+                continue;
+
+            LivingPlant *plant = static_cast<LivingPlant *>(component);
+            PlantHandle handle = plant->getHandle();
+            if (plantStates->owner(handle) != plant || seen[handle.index])
+                continue;
+            seen[handle.index] = 1;
+
+            report.addPlant();
+            report.addReferences(FlyweightPool::Strings, (plant->getNameHandle().isNone() ? 0 : 1) + (plant->getSeasonHandle().isNone() ? 0 : 1));
+            report.addReferences(FlyweightPool::Water, plant->getWaterHandle().isNone() ? 0 : 1);
+            report.addReferences(FlyweightPool::Sun, plant->getSunHandle().isNone() ? 0 : 1);
+            report.addReferences(FlyweightPool::States, plantStates->peekMaturityState(handle.index) ? 1 : 0);
+        }
     }
+    report.setPlantBytes(sizeof(LivingPlant) + plantStates->getRowBytes());
+    return report;
 }
 
-Flyweight<SunStrategy *> *Inventory::getSunFly(int id)
+void Inventory::publishSnapshot()
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+    snapshots->publish(inventory);
+}
+
+std::size_t Inventory::applyCommands()
+{
+    Binding binding(this);
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    std::size_t applied = commands->drain();
+    if (applied > 0)
+        snapshots->publish(inventory);
+    return applied;
+}
+
+void Inventory::setSnapshotPublishing(bool enabled)
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+    snapshotPublishing = enabled;
+}
+
+void Inventory::setTickThreads(unsigned int threads)
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    delete tickPool;
+    tickPool = nullptr;
+
+    if (threads != 1)
+    {
+        Inventory *inv = this;
+        tickPool = new WorkStealingPool(threads, [inv]()
+                                        { bindToThread(inv); });
+        if (tickPool->getThreadCount() <= 1)
+        {
+            delete tickPool;
+            tickPool = nullptr;
+        }
+    }
+}
+
+void Inventory::setEventDriven(bool enabled)
 {
-    try
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    if (enabled && !scheduler)
     {
-        return sunStrategies->getFlyweight(id);
+        Flyweight<MaturityState *> *growStates[4];
+        for (int id = 0; id < 4; id++)
+            growStates[id] = states->find(id);
+        scheduler = new TickScheduler(inventory, plantStates, growStates);
     }
-    catch (const char *e)
+    else if (!enabled && scheduler)
     {
-        std::cerr << e << '\n';
-        return sunStrategies->getFlyweight(LowSun::getID());
+        delete scheduler;
+        scheduler = nullptr;
     }
 }
 
+bool Inventory::isEventDriven()
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+    return scheduler != nullptr;
+}
+
+unsigned int Inventory::getTickThreads()
+{
+    std::lock_guard<std::mutex> guard(tickLock);
+    return tickPool ? tickPool->getThreadCount() : 1;
+}
+
 PlantGroup *Inventory::getInventory()
 {
     return inventory;
@@ -163,70 +477,174 @@ void Inventory::addCustomer(Customer *customer)
 {
     customerList->push_back(customer);
 }
+Inventory *Inventory::bindToThread(Inventory *inventory)
+{
+    Inventory *previous = bound;
+    bound = inventory;
+    return previous;
+}
+
 bool Inventory::startTicker()
-{  
-    Inventory *inv = getInstance();
+{
+    return getInstance()->startTicking();
+}
+bool Inventory::stopTicker()
+{
+    return getInstance()->stopTicking();
+}
 
-    if (!on.load())
-    {
-        on.store(true);
+bool Inventory::startTicking()
+{
+    if (ticker->isRunning())
+        return false;
 
-        if (!TickerThread)
-            TickerThread = new thread(&Inventory::TickInventory, inv);
+    ticksSinceSeason = 0;
+    Inventory *inv = this;
+    return ticker->start([inv]()
+                         { inv->advanceDay(); });
+}
 
-        return true;
+bool Inventory::stopTicking()
+{
+    return ticker->stop();
+}
+
+void Inventory::advanceDay()
+{
+    Binding binding(this);
+    this->tick();
+    if (ticksSinceSeason == 8)
+    {
+        changeSeason();
+        ticksSinceSeason = 0;
+        if (autoReap)
+            reapDeadPlants();
     }
-    else
-        return false;
+    ticksSinceSeason++;
 }
-bool Inventory::stopTicker()
+
+std::size_t Inventory::reapDeadPlants()
 {
-  getInstance();
+    Binding binding(this);
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    std::vector<LivingPlant *> dead;
+    inventory->removePlantsInState(states->find(Dead::getID()), dead);
 
-    if (on.load())
+    // A plant listed in two groups is unlinked from both but archived and deleted once
+    std::set<LivingPlant *> reaped;
+    for (std::size_t i = 0; i < dead.size(); i++)
     {
-        on.store(false);
+        if (!reaped.insert(dead[i]).second)
+            continue;
 
-        if(!TickerThread)
-        return true;
+        PlantComponent *decorated = dead[i]->getDecorator();
+        archive->add(dead[i], decorated ? decorated->getPrice() : dead[i]->getPrice());
 
-    if (TickerThread->get_id() == std::this_thread::get_id()) {
-        if (TickerThread->joinable())
-            TickerThread->detach();
-        delete TickerThread;
-        TickerThread = nullptr;
-        return true;
+        if (decorated)
+            delete decorated;
+        else
+            delete dead[i];
     }
 
-    if (TickerThread->joinable()) {
-        TickerThread->join();
-    }
+    // The last snapshot still lists the deleted plants
+    if (!reaped.empty())
+        snapshots->publish(inventory);
+    return reaped.size();
+}
+
+AdvanceSummary Inventory::advanceDays(int days)
+{
+    Binding binding(this);
+    AdvanceSummary summary = {0, 0, 0, 0, 0};
 
-    delete TickerThread;
-    TickerThread = nullptr;
+    while (days > 0)
+    {
+        // Days left before (and including) the tick after which advanceDay() changes season
+        int stretch = std::min(days, 9 - ticksSinceSeason);
+        fastForward(stretch, summary);
+        days -= stretch;
 
-    return true;
+        ticksSinceSeason += stretch - 1;
+        if (ticksSinceSeason == 8)
+        {
+            changeSeason();
+            ticksSinceSeason = 0;
+            if (autoReap)
+                reapDeadPlants();
+        }
+        ticksSinceSeason++;
     }
-    else
-        return false;
+
+    if (snapshotPublishing)
+        publishSnapshot();
+    return summary;
 }
 
-void Inventory::TickInventory()
+void Inventory::fastForward(long days, AdvanceSummary &summary)
 {
-    int count = 0;
-    
-    while (on.load())
+    std::lock_guard<std::mutex> guard(tickLock);
+
+    std::vector<unsigned char> seen(plantStates->size(), 0);
+    std::vector<ForwardEntry> rows;
+    std::vector<ForwardEntry> daily;
+    collectForward(inventory, plantStates, seen, rows, daily);
+
+    Flyweight<MaturityState *> *growStates[4];
+    for (int id = 0; id < 4; id++)
+        growStates[id] = states->find(id);
+
+    for (std::size_t i = 0; i < rows.size(); i++)
     {
-        
-        this->inventory->tick();
-        std::this_thread::sleep_for(std::chrono::seconds(timeBetweenTicks));
-        if (count == 8)
+        LivingPlant *plant = static_cast<LivingPlant *>(rows[i].component);
+        PlantHandle handle = plant->getHandle();
+
+        Flyweight<MaturityState *> *&state = plantStates->maturityState(handle);
+        int code = GrowKernel::SKIP;
+        if (state)
         {
-            changeSeason();
-            count = 0;
-       
-        }     count++;
+            code = -1;
+            for (int id = 0; id < 4; id++)
+            {
+                if (state == growStates[id])
+                    code = id + 1;
+            }
+        }
+
+        // A state the kernel does not know is grown through its own grow()
+        if (code < 0)
+        {
+            rows[i].grow = true;
+            daily.push_back(rows[i]);
+            continue;
+        }
+
+        FastForward::advance(plantStates->age(handle), plantStates->health(handle),
+                             plantStates->waterLevel(handle), plantStates->sunExposure(handle), code,
+                             currentSeasonId, plantStates->season(handle), days, rows[i].observed, summary);
+        if (code != GrowKernel::SKIP)
+            state = growStates[code - 1];
+        plantStates->touch(handle);
     }
+
+    for (long day = 0; day < days; day++)
+    {
+        for (std::size_t i = 0; i < daily.size(); i++)
+        {
+            PlantComponent *component = daily[i].component;
+            if (daily[i].observed)
+            {
+                if (component->getWaterValue() <= 50)
+                    summary.waterNotifications++;
+                if (component->getSunlightValue() <= 50)
+                    summary.sunNotifications++;
+            }
+            if (daily[i].grow)
+                component->tick();
+        }
+    }
+    plantStates->markAllLevelsDirty();
+    summary.days += days;
 }
 
 Flyweight<string *> *Inventory::getSeason()
@@ -234,23 +652,33 @@ Flyweight<string *> *Inventory::getSeason()
     return this->currentSeason;
 }
 
-void Inventory::changeSeason()
+Flyweight<string *> *Inventory::getSeasonString(SeasonId id)
 {
-    if (currentSeason == getString("Winter Season"))
-    {
-        currentSeason = getString("Spring Season");
-    }
-    else if (currentSeason == getString("Summer Season"))
-    {
-        currentSeason = getString("Autumn Season");
-    }
-    else if (currentSeason == getString("Autumn Season"))
+    return seasonStrings[static_cast<int>(id)];
+}
+
+SeasonId Inventory::getSeasonId(Flyweight<string *> *season)
+{
+    if (season == nullptr)
+        return SeasonId::None;
+
+    for (int id = 0; id < SEASON_ID_COUNT; id++)
     {
-        currentSeason = getString("Winter Season");
+        if (seasonStrings[id] == season)
+            return static_cast<SeasonId>(id);
     }
-    else if (currentSeason == getString("Spring Season"))
+
+    string *name = season->getState();
+    return name ? seasonIdFromName(*name) : SeasonId::None;
+}
+
+void Inventory::changeSeason()
+{
     {
-        currentSeason = getString("Summer Season");
+        std::lock_guard<std::mutex> guard(tickLock);
+        tickStats->recordSeasonChange();
     }
-    return;
-}
\ No newline at end of file
+
+    currentSeasonId = nextSeason(currentSeasonId);
+    currentSeason = seasonStrings[static_cast<int>(currentSeasonId)];
+}
@@ -6,6 +6,8 @@ using namespace std;
 #include <vector>
 
 #include "../flyweight/FlyweightFactory.h"
+#include "../flyweight/FlyweightHandle.h"
+#include "../flyweight/FlyweightRegistry.h"
 
 #include "../strategy/LowSun.h"
 #include "../strategy/MidSun.h"
@@ -16,7 +18,14 @@ using namespace std;
 #include "../strategy/HighWater.h"
 #include "../strategy/AlternatingWater.h"
 #include <thread>
+#include "../simulation/SimulationClock.h"
+#include "../simulation/FastForward.h"
+#include "../simulation/CommandQueue.h"
+#include "../simulation/TickStats.h"
+#include "../simulation/FlyweightReport.h"
+#include "../state/Season.h"
 #include <atomic>
+#include <mutex>
 
 /**
  * @class Inventory
@@ -47,9 +56,18 @@ using namespace std;
  * - **Iterator**: Inventory provides iterable plant collections
  *
  * ### Multithreading:
- * - Background thread (`TickerThread`) periodically invokes `TickInventory()`
+ * - A `SimulationClock` (`ticker`) periodically invokes `advanceDay()` on its own thread
  * - Controlled via `startTicker()` and `stopTicker()` methods
- * - Thread-safe flag `on` governs lifecycle
+ * - Period set with `updateTickerRate()` (seconds) or `updateTickerPeriod()` (microseconds)
+ *
+ * ### Several nurseries:
+ * - `getInstance()` returns the inventory bound to the calling thread, or the
+ *   default singleton when none is bound
+ * - A NurseryContext owns an independent inventory (own ticker, flyweight
+ *   factories and plant table) and binds it to a thread
+ * - tick(), advanceDay(), advanceDays(), reapDeadPlants() and applyCommands()
+ *   bind their inventory while they run, so they can be called through a plain
+ *   pointer from any thread
  *
  * ### Related Components:
  * @see PlantGroup
@@ -63,19 +81,65 @@ class WaterStrategy;
 class SunStrategy;
 class MaturityState;
 class PlantGroup;
+class PlantStateTable;
+class StringInterner;
+class WorkStealingPool;
+class TickScheduler;
+class PlantArchive;
+class SnapshotBuffer;
 class Staff;
 class Inventory
 
 {
+	friend class NurseryContext;
+	friend class InventoryImage;
+
+public:
+	/** Number of water and of sun strategy IDs; every strategy's getID() must be below it. */
+	static const std::size_t STRATEGY_SLOTS = 8;
+	/** Number of maturity state IDs; every state's getID() must be below it. */
+	static const std::size_t STATE_SLOTS = 8;
+
 private:
 	static Inventory *instance;
+	// Inventory the calling thread works on instead of instance, set by NurseryContext
+	static thread_local Inventory *bound;
 	PlantGroup *inventory;
-	FlyweightFactory<std::string, string *> *stringFactory;
-	FlyweightFactory<int, WaterStrategy *> *waterStrategies;
-	FlyweightFactory<int, SunStrategy *> *sunStrategies;
-	FlyweightFactory<int, MaturityState *> *states;
+	// Season and plant name strings: StringInterner::shared(), not owned
+	StringInterner *strings;
+	// Strategies and states indexed by getID(), registered in the constructor
+	FlyweightRegistry<WaterStrategy *, STRATEGY_SLOTS> *waterStrategies;
+	FlyweightRegistry<SunStrategy *, STRATEGY_SLOTS> *sunStrategies;
+	FlyweightRegistry<MaturityState *, STATE_SLOTS> *states;
+
+	// Struct-of-arrays storage behind every LivingPlant created by this inventory
+	PlantStateTable *plantStates;
+
+	// Parallel tick mode: nullptr means ticks run serially on the calling thread
+	WorkStealingPool *tickPool;
+	std::mutex tickLock;
+
+	// Event-driven tick mode: nullptr means every plant is grown every tick
+	TickScheduler *scheduler;
+
+	// Records of dead plants removed from the composite
+	PlantArchive *archive;
+	bool autoReap;
+
+	// Read-only copies of the composite for facade readers, refreshed after every tick
+	SnapshotBuffer *snapshots;
+	bool snapshotPublishing;
+
+	// Changes submitted from other threads, applied at the start of each tick
+	CommandQueue *commands;
+
+	// Timings and counters of every tick, guarded by tickLock
+	TickStats *tickStats;
 
 	Flyweight<string *> *currentSeason;
+	SeasonId currentSeasonId;
+	// Flyweights of the four named seasons, indexed by SeasonId
+	Flyweight<string *> *seasonStrings[SEASON_ID_COUNT];
 
 	vector<Staff *> *staffList;
 	vector<Customer *> *customerList;
@@ -84,48 +148,384 @@ private:
 	 */
 	Inventory();
 	// Multithreading components
-	void TickInventory();
-	static thread *TickerThread;
-	static atomic<bool> on;
-	static int timeBetweenTicks;
+	SimulationClock *ticker;
+	int ticksSinceSeason;
 	// Multithreading components
 
+	/**
+	 * @brief Applies a number of days under the current season in closed form.
+	 */
+	void fastForward(long days, AdvanceSummary &summary);
+
 public:
 	/**
-	 * @brief Retrieves the singleton instance of Inventory.
-	 * @return Pointer to the single Inventory instance.
+	 * @brief Retrieves the inventory the calling thread works on.
+	 * @return The inventory bound to this thread by a NurseryContext, otherwise
+	 * the default singleton instance (created on first use).
 	 */
 	static Inventory *getInstance();
 
+	/**
+	 * @brief Makes getInstance() return a given inventory on the calling thread.
+	 *
+	 * Prefer NurseryContext::Scope or Binding, which restore the previous binding.
+	 *
+	 * @param inventory Inventory to bind, or nullptr for the default instance.
+	 * @return The previous binding, nullptr if there was none.
+	 */
+	static Inventory *bindToThread(Inventory *inventory);
+
+	/**
+	 * @brief Binds an inventory to the calling thread for one scope.
+	 *
+	 * Restores the previous binding on destruction, so calls that work on a
+	 * given inventory (ticks, image loads) can bind it around themselves.
+	 */
+	class Binding
+	{
+	private:
+		Inventory *previous;
+
+		Binding(const Binding &);
+		Binding &operator=(const Binding &);
+
+	public:
+		/**
+		 * @param inventory Inventory that getInstance() returns on this thread.
+		 */
+		explicit Binding(Inventory *inventory) : previous(bindToThread(inventory)) {}
+		~Binding() { bindToThread(previous); }
+	};
+
 	/**
 	 * @brief Retrieves a flyweight for a season name.
+	 *
+	 * Safe to call from any thread, including tick workers; a string that is
+	 * already interned is returned without allocating.
+	 *
 	 * @param season Season name string.
 	 * @return Flyweight wrapping the season string.
 	 */
-	Flyweight<std::string *> *getString(std::string season);
+	Flyweight<std::string *> *getString(const std::string &season);
+
+	/**
+	 * @brief Retrieves a flyweight for a string given as characters, without building a std::string.
+	 * @param text First character; need not be null-terminated.
+	 * @param length Number of characters.
+	 * @return Flyweight wrapping a copy of the characters.
+	 */
+	Flyweight<std::string *> *getString(const char *text, std::size_t length);
+
+	/**
+	 * @brief Retrieves a flyweight for a null-terminated string, such as a literal.
+	 * @param text String to intern.
+	 * @return Flyweight wrapping a copy of the string.
+	 */
+	Flyweight<std::string *> *getString(const char *text);
 
 	/**
 	 * @brief Retrieves a flyweight for a water strategy level.
 	 * @param level Integer identifier for water strategy.
-	 * @return Flyweight wrapping the WaterStrategy instance.
+	 * @return Flyweight wrapping the WaterStrategy instance; LowWater's for an unknown level.
 	 */
 	Flyweight<WaterStrategy *> *getWaterFly(int level);
 
 	/**
 	 * @brief Retrieves a flyweight for a sun strategy level.
 	 * @param level Integer identifier for sun strategy.
-	 * @return Flyweight wrapping the SunStrategy instance.
+	 * @return Flyweight wrapping the SunStrategy instance; LowSun's for an unknown level.
 	 */
 	Flyweight<SunStrategy *> *getSunFly(int level);
 
+	/**
+	 * @brief Gives a plant a handle to a water strategy.
+	 *
+	 * Like getWaterFly(int), but counted as a hit (or a miss for an unknown
+	 * level) in getFlyweightReport(); the plain getters are not counted.
+	 *
+	 * @param level Integer identifier for water strategy.
+	 * @return Handle of the flyweight; LowWater's for an unknown level.
+	 */
+	WaterHandle shareWaterFly(int level);
+
+	/**
+	 * @brief Gives a plant a handle to a sun strategy, counted like shareWaterFly().
+	 * @param level Integer identifier for sun strategy.
+	 * @return Handle of the flyweight; LowSun's for an unknown level.
+	 */
+	SunHandle shareSunFly(int level);
+
+	/**
+	 * @brief Resolves a water strategy handle, as held by LivingPlant.
+	 * @param handle Handle of one of this inventory's water flyweights.
+	 * @return The flyweight, or nullptr for WaterHandle::none().
+	 */
+	Flyweight<WaterStrategy *> *getWaterFly(WaterHandle handle) const
+	{
+		return handle.isNone() ? nullptr : waterStrategies->at(handle.index);
+	}
+
+	/**
+	 * @brief Resolves a sun strategy handle, as held by LivingPlant.
+	 * @param handle Handle of one of this inventory's sun flyweights.
+	 * @return The flyweight, or nullptr for SunHandle::none().
+	 */
+	Flyweight<SunStrategy *> *getSunFly(SunHandle handle) const
+	{
+		return handle.isNone() ? nullptr : sunStrategies->at(handle.index);
+	}
+
 	/**
 	 * @brief Retrieves a flyweight for a maturity state.
 	 * @param id Integer identifier for maturity state.
-	 * @return Flyweight wrapping the MaturityState instance.
-	 * @throws std::runtime_error if id is invalid or not cached.
+	 * @return Flyweight wrapping the MaturityState instance; Seed's for an unknown id.
 	 */
 	Flyweight<MaturityState *> *getStates(int id);
 
+	/**
+	 * @brief Gives a plant a maturity state, counted like shareWaterFly().
+	 * @param id Integer identifier for maturity state.
+	 * @return Flyweight wrapping the MaturityState instance; Seed's for an unknown id.
+	 */
+	Flyweight<MaturityState *> *shareState(int id);
+
+	/**
+	 * @brief Gets the table holding the mutable state of every plant.
+	 * @return Pointer to the PlantStateTable owned by this inventory.
+	 */
+	PlantStateTable *getPlantStates();
+
+	/**
+	 * @brief Advances the inventory by one simulated day.
+	 *
+	 * Runs the observer pass over the composite (PlantGroup::prepareTick()),
+	 * which also marks every plant in the inventory, and then grows the marked
+	 * plants with one linear sweep over the PlantStateTable. Starts by applying
+	 * queued commands and ends by publishing a snapshot of the inventory unless
+	 * that has been turned off.
+	 */
+	void tick();
+
+	/**
+	 * @brief Advances one simulated day the way the background ticker does.
+	 *
+	 * Calls tick() and changes the season after every eighth day, keeping the
+	 * same cadence whether days are driven by the ticker or by a batch run.
+	 */
+	void advanceDay();
+
+	/**
+	 * @brief Advances many days at once without ticking day by day.
+	 *
+	 * Days are split into stretches that share a season, using the same
+	 * every-eighth-day cadence as advanceDay(), and each plant is grown over a
+	 * stretch in closed form (FastForward). Plants end up exactly where the
+	 * same number of advanceDay() calls would leave them, provided nothing acts
+	 * on the notifications.
+	 *
+	 * Observers are not called: this is a what-if projection, so care the staff
+	 * would have given is not applied. The notifications that would have been
+	 * sent are counted in the returned summary instead.
+	 *
+	 * @param days Number of days to advance; values below 1 do nothing.
+	 * @return Notification, transition and death counts for the whole run.
+	 */
+	AdvanceSummary advanceDays(int days);
+
+	/**
+	 * @brief Moves every dead plant out of the inventory into the archive.
+	 *
+	 * Dead plants are unlinked from their groups, recorded in the PlantArchive
+	 * (name, age at death, decorated price, species) and deleted, so ticks and
+	 * staff no longer visit them. Pointers to reaped plants become invalid.
+	 *
+	 * @return Number of plants reaped.
+	 */
+	std::size_t reapDeadPlants();
+
+	/**
+	 * @brief Makes advanceDay() and advanceDays() run the reaper whenever the season changes.
+	 * @param enabled True to reap every eighth day; off by default.
+	 */
+	void setAutoReap(bool enabled) { autoReap = enabled; }
+
+	/**
+	 * @brief Checks whether advanceDay() reaps dead plants.
+	 * @return True after setAutoReap(true).
+	 */
+	bool isAutoReap() const { return autoReap; }
+
+	/**
+	 * @brief Gets the archive of reaped plants, for reporting.
+	 * @return Pointer to the archive owned by this inventory.
+	 */
+	PlantArchive *getArchive() { return archive; }
+
+	/**
+	 * @brief Publishes a snapshot of the inventory as it is now.
+	 *
+	 * tick() does this on its own; code that changes the composite outside a
+	 * tick (such as NurseryFacade) calls it so readers see the change at once.
+	 * Must not be called while the calling thread holds a SnapshotReader.
+	 */
+	void publishSnapshot();
+
+	/**
+	 * @brief Gets the snapshots readers use instead of the live composite.
+	 *
+	 * Read through a SnapshotReader, which never blocks and never sees a
+	 * half-finished tick.
+	 *
+	 * @return Pointer to the buffer owned by this inventory.
+	 */
+	SnapshotBuffer *getSnapshots() { return snapshots; }
+
+	/**
+	 * @brief Turns the snapshot at the end of each tick on or off.
+	 *
+	 * Each snapshot copies every plant, and in event-driven mode reading every
+	 * plant catches all of them up, so batch runs without readers turn it off.
+	 * publishSnapshot() still works while it is off.
+	 *
+	 * @param enabled True to publish after every tick (the default).
+	 */
+	void setSnapshotPublishing(bool enabled);
+
+	/**
+	 * @brief Queues a change to the inventory without taking any lock.
+	 *
+	 * The action runs later on whichever thread next applies commands: the
+	 * next tick() (between ticks, never during one) or applyCommands(). Actions
+	 * run one at a time in submission order, and must not call tick(),
+	 * applyCommands() or anything else that takes the tick lock.
+	 *
+	 * @tparam Result Type the action returns; give it explicitly, e.g. submit<PlantComponent *>(...).
+	 * @param action Change to make.
+	 * @return Future for the action's result or exception; may be ignored.
+	 */
+	template <typename Result>
+	std::future<Result> submit(const std::function<Result()> &action)
+	{
+		FunctionCommand<Result> *command = new FunctionCommand<Result>(action);
+		std::future<Result> result = command->getFuture();
+		commands->push(command);
+		return result;
+	}
+
+	/**
+	 * @brief Applies every queued command now, on the calling thread.
+	 *
+	 * Waits for a tick in progress to finish first. Publishes a snapshot if any
+	 * command was applied.
+	 *
+	 * @return Number of commands applied.
+	 */
+	std::size_t applyCommands();
+
+	/**
+	 * @brief Gets a copy of the tick instrumentation.
+	 *
+	 * Covers every tick() since start-up or the last resetTickStats(): wall time
+	 * per phase with latency histograms, plants visited, grow() calls per
+	 * state, observer notifications, season changes and commands applied.
+	 *
+	 * @return Statistics as of the last finished tick.
+	 */
+	TickStats getTickStats();
+
+	/**
+	 * @brief Gets what the most recent tick did, without copying the histograms.
+	 * @return Record of the last tick, all zero before the first.
+	 */
+	TickRecord getLastTick();
+
+	/**
+	 * @brief Clears the tick instrumentation.
+	 */
+	void resetTickStats();
+
+	/**
+	 * @brief Reports how well the flyweights are shared.
+	 *
+	 * Gives the counters of the string, water, sun and state pools with the
+	 * references the plants hold into each (names, seasons, strategy handles
+	 * and maturity states) and the bytes per plant. Only plants reachable
+	 * from the inventory's composite or a customer's basket count, each once;
+	 * prototypes and plants outside the composite do not. The string pool is
+	 * process-wide and reported as such. Waits for a tick in progress to
+	 * finish and walks the customers' baskets under the tick lock, so those
+	 * may only change in commands, as the facade's do, or while nothing
+	 * ticks. Lazy rows are read as they are, not caught up.
+	 *
+	 * @return Report as of now; see FlyweightReport::toJson() for the export.
+	 */
+	FlyweightReport getFlyweightReport();
+
+	/**
+	 * @brief Waits for a submitted command and returns its result.
+	 *
+	 * Applies queued commands itself rather than waiting for the ticker, so it
+	 * also works while the ticker is stopped.
+	 *
+	 * @tparam Result Type the command returns.
+	 * @param result Future from submit().
+	 * @return The command's result; its exception, if it threw, is rethrown.
+	 */
+	template <typename Result>
+	Result waitForCommand(std::future<Result> result)
+	{
+		while (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			// Nothing applied means another producer is still linking its command
+			if (applyCommands() == 0)
+				std::this_thread::yield();
+		}
+		return result.get();
+	}
+
+	/**
+	 * @brief Sets how many threads tick() uses.
+	 *
+	 * With more than one thread the composite is split into tasks that run on a
+	 * work-stealing pool, and tick() returns only once every task has finished.
+	 * Observers are then notified from several threads, so staff callbacks must
+	 * be safe to run concurrently. Takes effect from the next tick.
+	 *
+	 * @param threads 1 for the serial tick (the default), 0 for one thread per
+	 * hardware core, or an explicit thread count.
+	 */
+	void setTickThreads(unsigned int threads);
+
+	/**
+	 * @brief Gets the number of threads tick() uses.
+	 * @return 1 in serial mode, otherwise the size of the worker pool.
+	 */
+	unsigned int getTickThreads();
+
+	/**
+	 * @brief Switches between the full daily sweep and event-driven ticks.
+	 *
+	 * In event-driven mode tick() only evaluates the plants that are due (see
+	 * TickScheduler); the rest are caught up exactly when next read. It runs on
+	 * the calling thread and takes precedence over setTickThreads(). Observers
+	 * are assumed to change only the plant they are notified about.
+	 *
+	 * @param enabled True to schedule ticks by event, false for the sweep.
+	 */
+	void setEventDriven(bool enabled);
+
+	/**
+	 * @brief Checks whether ticks are event-driven.
+	 * @return True after setEventDriven(true).
+	 */
+	bool isEventDriven();
+
+	/**
+	 * @brief Gets the event-driven scheduler, for tick statistics.
+	 * @return The scheduler, or nullptr while ticks are not event-driven.
+	 */
+	TickScheduler *getTickScheduler() { return scheduler; }
+
 	/**
 	 * @brief Gets the root plant inventory group.
 	 * @return Pointer to the root PlantGroup.
@@ -146,38 +546,108 @@ public:
 
 	/**
 	 * @brief Adds a staff member to the system.
+	 *
+	 * While the ticker runs, call it from a submitted command, as
+	 * NurseryFacade::addStaff() does.
+	 *
 	 * @param staff Pointer to Staff instance.
 	 */
 	void addStaff(Staff *staff);
 
 	/**
 	 * @brief Adds a customer to the system.
+	 *
+	 * While the ticker runs, call it from a submitted command, as
+	 * NurseryFacade::addCustomer() does; getFlyweightReport() walks the
+	 * customers between ticks.
+	 *
 	 * @param customer Pointer to Customer instance.
 	 */
 	void addCustomer(Customer *customer);
 
 	/**
-	 * @brief Starts the background ticker thread.
+	 * @brief Starts the background ticker thread of getInstance().
 	 * @return True if on was false false if otherwise
 	 * @note Creates the thread if it does not yet exist
 	 */
 	static bool startTicker();
 
 	/**
-	 * @brief Stops the background ticker thread.
+	 * @brief Stops the background ticker thread of getInstance().
 	 * @return True if it on was true, false if otherwise
-	 * @note deletes the thread pointer
+	 * @note Returns as soon as a tick in progress finishes, without waiting out the period
 	 */
 	static bool stopTicker();
 
+	/**
+	 * @brief Gets the clock that drives the background ticker of getInstance().
+	 * @return Pointer to the ticker's SimulationClock, for catch-up policy and tick counts.
+	 */
+	static SimulationClock *getTicker() { return getInstance()->ticker; }
+
+	/**
+	 * @brief Starts this inventory's ticker, which calls advanceDay() with this inventory bound.
+	 * @return False if it was already running.
+	 */
+	bool startTicking();
+
+	/**
+	 * @brief Stops this inventory's ticker.
+	 * @return False if it was not running.
+	 */
+	bool stopTicking();
+
+	/**
+	 * @brief Gets the clock that drives this inventory's ticker.
+	 * @return Pointer to the SimulationClock owned by this inventory.
+	 */
+	SimulationClock *getClock() { return ticker; }
+
 	/**
 	 * @brief Destructor. Cleans up all managed resources.
 	 */
 	~Inventory();
 
+	/**
+	 * @brief Gets the current season as a flyweight string.
+	 * @return Flyweight of the current season's name (compatibility view of getSeasonId()).
+	 */
 	Flyweight<string *> *getSeason();
 
+	/**
+	 * @brief Gets the current season.
+	 * @return ID of the current season.
+	 */
+	SeasonId getSeasonId() const { return currentSeasonId; }
+
+	/**
+	 * @brief Gets the shared flyweight for a season ID.
+	 * @param id Season to look up.
+	 * @return Flyweight of the season's name, or nullptr for None and Other.
+	 */
+	Flyweight<string *> *getSeasonString(SeasonId id);
+
+	/**
+	 * @brief Maps a season flyweight to its ID.
+	 *
+	 * Flyweights from this inventory are matched by pointer; anything else is
+	 * compared by name.
+	 *
+	 * @param season Season flyweight, may be nullptr.
+	 * @return None for nullptr, the matching season, or Other.
+	 */
+	SeasonId getSeasonId(Flyweight<string *> *season);
+
+	/**
+	 * @brief Advances to the next season (Spring, Summer, Autumn, Winter).
+	 */
 	void changeSeason();
-	static void updateTickerRate(int time) { timeBetweenTicks = time; }
+	static void updateTickerRate(int time) { getTicker()->setPeriod(std::chrono::seconds(time)); }
+
+	/**
+	 * @brief Sets the ticker period with sub-second resolution.
+	 * @param period Time between ticks; zero ticks as fast as possible.
+	 */
+	static void updateTickerPeriod(std::chrono::microseconds period) { getTicker()->setPeriod(period); }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "GrowKernel.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GROW_KERNEL_X86 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define GROW_KERNEL_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+    // Thresholds shared by every backend, named after the grow() rules they mirror
+    const int SEED_HEALTH_WATER = 40, SEED_HEALTH_SUN = 20;
+    const int GROWN_HEALTH_WATER = 30, GROWN_HEALTH_SUN = 40;
+    const int SEED_UP_AGE = 7, SEED_UP_HEALTH = 50, SEED_UP_WATER = 50, SEED_UP_SUN = 30;
+    const int SEED_UP_SET_WATER = 25, SEED_UP_SET_SUN = 50;
+    const int VEG_UP_AGE = 30, VEG_UP_HEALTH = 60, VEG_UP_WATER = 40, VEG_UP_SUN = 50;
+    const int VEG_UP_SET_WATER = 40, VEG_UP_SET_SUN = 60;
+    const int DEATH_AGE = 120;
+
+    inline int clampLevel(int value)
+    {
+        return std::max(0, std::min(100, value));
+    }
+
+    void growScalar(int *ages, int *healths, int *waterLevels, int *sunExposures,
+                    int *codes, const int *usages, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            int code = codes[i];
+            if (code == GrowKernel::SKIP)
+                continue;
+
+            int age = ++ages[i];
+            if (code == GrowKernel::DEAD)
+            {
+                healths[i] = clampLevel(healths[i]);
+                waterLevels[i] = clampLevel(waterLevels[i]);
+                sunExposures[i] = clampLevel(sunExposures[i]);
+                continue;
+            }
+
+            int health = healths[i];
+            int sun = sunExposures[i];
+            int water = clampLevel(waterLevels[i] - usages[i]);
+
+            bool seed = code == GrowKernel::SEED;
+            if (water >= (seed ? SEED_HEALTH_WATER : GROWN_HEALTH_WATER) &&
+                sun >= (seed ? SEED_HEALTH_SUN : GROWN_HEALTH_SUN))
+                health = clampLevel(health + 1);
+
+            if (seed && age >= SEED_UP_AGE && health >= SEED_UP_HEALTH &&
+                water >= SEED_UP_WATER && sun >= SEED_UP_SUN)
+            {
+                water = SEED_UP_SET_WATER;
+                health = std::max(health, SEED_UP_HEALTH);
+                sun = SEED_UP_SET_SUN;
+                code = GrowKernel::VEGETATIVE;
+            }
+            else if (code == GrowKernel::VEGETATIVE && age >= VEG_UP_AGE && health >= VEG_UP_HEALTH &&
+                     water >= VEG_UP_WATER && sun >= VEG_UP_SUN)
+            {
+                water = VEG_UP_SET_WATER;
+                health = std::max(health, VEG_UP_HEALTH);
+                sun = VEG_UP_SET_SUN;
+                code = GrowKernel::MATURE;
+            }
+            else if (code == GrowKernel::MATURE && (age >= DEATH_AGE || health <= 0))
+            {
+                water = 0;
+                health = 0;
+                sun = 0;
+                code = GrowKernel::DEAD;
+            }
+
+            healths[i] = clampLevel(health);
+            waterLevels[i] = clampLevel(water);
+            sunExposures[i] = clampLevel(sun);
+            codes[i] = code;
+        }
+    }
+
+#ifdef GROW_KERNEL_X86
+    // SSE2 has no 32-bit min/max or blend, so they are built from compares
+    inline __m128i select128(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    inline __m128i clamp128(__m128i value, __m128i low, __m128i high)
+    {
+        value = select128(_mm_cmplt_epi32(value, low), low, value);
+        return select128(_mm_cmpgt_epi32(value, high), high, value);
+    }
+
+    inline __m128i atLeast128(__m128i value, int threshold)
+    {
+        return _mm_cmpgt_epi32(value, _mm_set1_epi32(threshold - 1));
+    }
+
+    std::size_t growSse2(int *ages, int *healths, int *waterLevels, int *sunExposures,
+                         int *codes, const int *usages, std::size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i hundred = _mm_set1_epi32(100);
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i code = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codes + i));
+            __m128i active = _mm_cmpgt_epi32(code, zero);
+            if (_mm_movemask_epi8(active) == 0)
+                continue;
+
+            __m128i age = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ages + i));
+            __m128i health = _mm_loadu_si128(reinterpret_cast<const __m128i *>(healths + i));
+            __m128i water = _mm_loadu_si128(reinterpret_cast<const __m128i *>(waterLevels + i));
+            __m128i sun = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sunExposures + i));
+            __m128i usage = _mm_loadu_si128(reinterpret_cast<const __m128i *>(usages + i));
+
+            __m128i isSeed = _mm_cmpeq_epi32(code, _mm_set1_epi32(GrowKernel::SEED));
+            __m128i isVeg = _mm_cmpeq_epi32(code, _mm_set1_epi32(GrowKernel::VEGETATIVE));
+            __m128i isMature = _mm_cmpeq_epi32(code, _mm_set1_epi32(GrowKernel::MATURE));
+            __m128i alive = _mm_or_si128(isSeed, _mm_or_si128(isVeg, isMature));
+
+            age = _mm_add_epi32(age, _mm_and_si128(active, one));
+            water = select128(alive, clamp128(_mm_sub_epi32(water, usage), zero, hundred), water);
+
+            __m128i healthWater = select128(isSeed, _mm_set1_epi32(SEED_HEALTH_WATER - 1), _mm_set1_epi32(GROWN_HEALTH_WATER - 1));
+            __m128i healthSun = select128(isSeed, _mm_set1_epi32(SEED_HEALTH_SUN - 1), _mm_set1_epi32(GROWN_HEALTH_SUN - 1));
+            __m128i gain = _mm_and_si128(alive, _mm_and_si128(_mm_cmpgt_epi32(water, healthWater),
+                                                              _mm_cmpgt_epi32(sun, healthSun)));
+            health = select128(gain, clamp128(_mm_add_epi32(health, one), zero, hundred), health);
+
+            __m128i seedUp = _mm_and_si128(_mm_and_si128(isSeed, atLeast128(age, SEED_UP_AGE)),
+                                           _mm_and_si128(atLeast128(health, SEED_UP_HEALTH),
+                                                         _mm_and_si128(atLeast128(water, SEED_UP_WATER), atLeast128(sun, SEED_UP_SUN))));
+            __m128i vegUp = _mm_and_si128(_mm_and_si128(isVeg, atLeast128(age, VEG_UP_AGE)),
+                                          _mm_and_si128(atLeast128(health, VEG_UP_HEALTH),
+                                                        _mm_and_si128(atLeast128(water, VEG_UP_WATER), atLeast128(sun, VEG_UP_SUN))));
+            __m128i dies = _mm_and_si128(isMature, _mm_or_si128(atLeast128(age, DEATH_AGE), _mm_cmplt_epi32(health, one)));
+
+            __m128i seedHealth = _mm_set1_epi32(SEED_UP_HEALTH);
+            __m128i vegHealth = _mm_set1_epi32(VEG_UP_HEALTH);
+            water = select128(seedUp, _mm_set1_epi32(SEED_UP_SET_WATER), water);
+            health = select128(seedUp, select128(_mm_cmpgt_epi32(seedHealth, health), seedHealth, health), health);
+            sun = select128(seedUp, _mm_set1_epi32(SEED_UP_SET_SUN), sun);
+            code = select128(seedUp, _mm_set1_epi32(GrowKernel::VEGETATIVE), code);
+
+            water = select128(vegUp, _mm_set1_epi32(VEG_UP_SET_WATER), water);
+            health = select128(vegUp, select128(_mm_cmpgt_epi32(vegHealth, health), vegHealth, health), health);
+            sun = select128(vegUp, _mm_set1_epi32(VEG_UP_SET_SUN), sun);
+            code = select128(vegUp, _mm_set1_epi32(GrowKernel::MATURE), code);
+
+            water = _mm_andnot_si128(dies, water);
+            health = _mm_andnot_si128(dies, health);
+            sun = _mm_andnot_si128(dies, sun);
+            code = select128(dies, _mm_set1_epi32(GrowKernel::DEAD), code);
+
+            health = select128(active, clamp128(health, zero, hundred), health);
+            water = select128(active, clamp128(water, zero, hundred), water);
+            sun = select128(active, clamp128(sun, zero, hundred), sun);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(ages + i), age);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(healths + i), health);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(waterLevels + i), water);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sunExposures + i), sun);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(codes + i), code);
+        }
+        return i;
+    }
+#endif
+
+#ifdef GROW_KERNEL_AVX2
+    __attribute__((target("avx2"))) inline __m256i atLeast256(__m256i value, int threshold)
+    {
+        return _mm256_cmpgt_epi32(value, _mm256_set1_epi32(threshold - 1));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i clamp256(__m256i value, __m256i low, __m256i high)
+    {
+        return _mm256_min_epi32(_mm256_max_epi32(value, low), high);
+    }
+
+    __attribute__((target("avx2"))) std::size_t growAvx2(int *ages, int *healths, int *waterLevels, int *sunExposures,
+                                                         int *codes, const int *usages, std::size_t count)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i hundred = _mm256_set1_epi32(100);
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i code = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes + i));
+            __m256i active = _mm256_cmpgt_epi32(code, zero);
+            if (_mm256_movemask_epi8(active) == 0)
+                continue;
+
+            __m256i age = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ages + i));
+            __m256i health = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(healths + i));
+            __m256i water = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(waterLevels + i));
+            __m256i sun = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sunExposures + i));
+            __m256i usage = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(usages + i));
+
+            __m256i isSeed = _mm256_cmpeq_epi32(code, _mm256_set1_epi32(GrowKernel::SEED));
+            __m256i isVeg = _mm256_cmpeq_epi32(code, _mm256_set1_epi32(GrowKernel::VEGETATIVE));
+            __m256i isMature = _mm256_cmpeq_epi32(code, _mm256_set1_epi32(GrowKernel::MATURE));
+            __m256i alive = _mm256_or_si256(isSeed, _mm256_or_si256(isVeg, isMature));
+
+            age = _mm256_add_epi32(age, _mm256_and_si256(active, one));
+            water = _mm256_blendv_epi8(water, clamp256(_mm256_sub_epi32(water, usage), zero, hundred), alive);
+
+            __m256i healthWater = _mm256_blendv_epi8(_mm256_set1_epi32(GROWN_HEALTH_WATER - 1), _mm256_set1_epi32(SEED_HEALTH_WATER - 1), isSeed);
+            __m256i healthSun = _mm256_blendv_epi8(_mm256_set1_epi32(GROWN_HEALTH_SUN - 1), _mm256_set1_epi32(SEED_HEALTH_SUN - 1), isSeed);
+            __m256i gain = _mm256_and_si256(alive, _mm256_and_si256(_mm256_cmpgt_epi32(water, healthWater),
+                                                                    _mm256_cmpgt_epi32(sun, healthSun)));
+            health = _mm256_blendv_epi8(health, clamp256(_mm256_add_epi32(health, one), zero, hundred), gain);
+
+            __m256i seedUp = _mm256_and_si256(_mm256_and_si256(isSeed, atLeast256(age, SEED_UP_AGE)),
+                                              _mm256_and_si256(atLeast256(health, SEED_UP_HEALTH),
+                                                               _mm256_and_si256(atLeast256(water, SEED_UP_WATER), atLeast256(sun, SEED_UP_SUN))));
+            __m256i vegUp = _mm256_and_si256(_mm256_and_si256(isVeg, atLeast256(age, VEG_UP_AGE)),
+                                             _mm256_and_si256(atLeast256(health, VEG_UP_HEALTH),
+                                                              _mm256_and_si256(atLeast256(water, VEG_UP_WATER), atLeast256(sun, VEG_UP_SUN))));
+            __m256i dies = _mm256_and_si256(isMature, _mm256_or_si256(atLeast256(age, DEATH_AGE), _mm256_cmpgt_epi32(one, health)));
+
+            water = _mm256_blendv_epi8(water, _mm256_set1_epi32(SEED_UP_SET_WATER), seedUp);
+            health = _mm256_blendv_epi8(health, _mm256_max_epi32(health, _mm256_set1_epi32(SEED_UP_HEALTH)), seedUp);
+            sun = _mm256_blendv_epi8(sun, _mm256_set1_epi32(SEED_UP_SET_SUN), seedUp);
+            code = _mm256_blendv_epi8(code, _mm256_set1_epi32(GrowKernel::VEGETATIVE), seedUp);
+
+            water = _mm256_blendv_epi8(water, _mm256_set1_epi32(VEG_UP_SET_WATER), vegUp);
+            health = _mm256_blendv_epi8(health, _mm256_max_epi32(health, _mm256_set1_epi32(VEG_UP_HEALTH)), vegUp);
+            sun = _mm256_blendv_epi8(sun, _mm256_set1_epi32(VEG_UP_SET_SUN), vegUp);
+            code = _mm256_blendv_epi8(code, _mm256_set1_epi32(GrowKernel::MATURE), vegUp);
+
+            water = _mm256_andnot_si256(dies, water);
+            health = _mm256_andnot_si256(dies, health);
+            sun = _mm256_andnot_si256(dies, sun);
+            code = _mm256_blendv_epi8(code, _mm256_set1_epi32(GrowKernel::DEAD), dies);
+
+            health = _mm256_blendv_epi8(health, clamp256(health, zero, hundred), active);
+            water = _mm256_blendv_epi8(water, clamp256(water, zero, hundred), active);
+            sun = _mm256_blendv_epi8(sun, clamp256(sun, zero, hundred), active);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(ages + i), age);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(healths + i), health);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(waterLevels + i), water);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(sunExposures + i), sun);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(codes + i), code);
+        }
+        return i;
+    }
+#endif
+
+    GrowKernel::Backend widestBackend()
+    {
+        if (GrowKernel::isSupported(GrowKernel::Backend::Avx2))
+            return GrowKernel::Backend::Avx2;
+        if (GrowKernel::isSupported(GrowKernel::Backend::Sse2))
+            return GrowKernel::Backend::Sse2;
+        return GrowKernel::Backend::Scalar;
+    }
+
+    std::atomic<int> &selectedBackend()
+    {
+        static std::atomic<int> backend(static_cast<int>(widestBackend()));
+        return backend;
+    }
+}
+
+void GrowKernel::grow(int *ages, int *healths, int *waterLevels, int *sunExposures,
+                      int *codes, const int *usages, std::size_t count)
+{
+    std::size_t done = 0;
+
+    switch (getBackend())
+    {
+#ifdef GROW_KERNEL_AVX2
+    case Backend::Avx2:
+        done = growAvx2(ages, healths, waterLevels, sunExposures, codes, usages, count);
+        break;
+#endif
+#ifdef GROW_KERNEL_X86
+    case Backend::Sse2:
+        done = growSse2(ages, healths, waterLevels, sunExposures, codes, usages, count);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    // Remainder lanes, or everything without SIMD
+    growScalar(ages, healths, waterLevels, sunExposures, codes, usages, done, count);
+}
+
+int GrowKernel::waterUsage(int code, SeasonId currentSeason, SeasonId plantSeason)
+{
+    if (code != SEED && code != VEGETATIVE && code != MATURE)
+        return 0;
+
+    // Lane codes are the maturity state IDs shifted up by one
+    double waterusage = seasonalWaterUsage(code - 1, currentSeason, plantSeason);
+
+    // grow() stores int(water - usage); after clamping that equals water minus this for any integer water
+    return 100 - static_cast<int>(100 - waterusage);
+}
+
+bool GrowKernel::isSupported(Backend backend)
+{
+    switch (backend)
+    {
+    case Backend::Scalar:
+        return true;
+    case Backend::Sse2:
+#ifdef GROW_KERNEL_X86
+        return true;
+#else
+        return false;
+#endif
+    case Backend::Avx2:
+#ifdef GROW_KERNEL_AVX2
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+void GrowKernel::setBackend(Backend backend)
+{
+    selectedBackend().store(static_cast<int>(isSupported(backend) ? backend : Backend::Scalar));
+}
+
+GrowKernel::Backend GrowKernel::getBackend()
+{
+    return static_cast<Backend>(selectedBackend().load());
+}
@@ -0,0 +1,96 @@
+#ifndef GrowKernel_h
+#define GrowKernel_h
+
+#include <cstddef>
+#include "Season.h"
+
+/**
+ * @brief Vectorised daily growth for rows of the PlantStateTable.
+ *
+ * Applies the Seed, Vegetative, Mature and Dead grow() rules to contiguous
+ * per-field arrays several plants at a time. Each lane carries a state code
+ * and its plant's integer water usage for the day; lanes in different states
+ * are handled in the same pass with masks, so a block of mixed plants never
+ * branches per plant.
+ *
+ * Results are bit-identical to calling MaturityState::grow() on each plant
+ * followed by the table's clamp. The only floating-point step in grow() is
+ * `setWaterLevel(water - usage)`, which truncates; for an integer water level
+ * that equals `water - ceil(usage)` once clamped, so the kernel works on
+ * integers throughout (see waterUsage()).
+ *
+ * **System Role:**
+ * Called by PlantStateTable::sweepRange(). Picks AVX2 or SSE2 at runtime on
+ * x86 and falls back to a scalar loop elsewhere.
+ *
+ * **Pattern Role:** Batched implementation of the State pattern's grow()
+ *
+ * @see Seed::grow(), Vegetative::grow(), Mature::grow(), Dead::grow()
+ */
+class GrowKernel
+{
+public:
+	/** Lane state codes: the maturity state ID plus one. SKIP lanes are left untouched. */
+	static const int SKIP = 0;
+	static const int SEED = 1;
+	static const int VEGETATIVE = 2;
+	static const int MATURE = 3;
+	static const int DEAD = 4;
+
+	enum class Backend
+	{
+		Scalar,
+		Sse2,
+		Avx2
+	};
+
+	/**
+	 * @brief Grows count lanes in place with the selected backend.
+	 *
+	 * codes is updated with each lane's state after the day, so callers can
+	 * apply maturity transitions afterwards.
+	 *
+	 * @param ages Plant ages.
+	 * @param healths Plant health values.
+	 * @param waterLevels Plant water levels.
+	 * @param sunExposures Plant sun exposure values.
+	 * @param codes State code per lane, updated in place.
+	 * @param usages Integer water usage per lane for this day.
+	 * @param count Number of lanes.
+	 */
+	static void grow(int *ages, int *healths, int *waterLevels, int *sunExposures,
+					 int *codes, const int *usages, std::size_t count);
+
+	/**
+	 * @brief Computes the integer water a plant in a state uses today.
+	 *
+	 * Reads the same SEASONAL_WATER_USAGE entry as the states' grow().
+	 *
+	 * @param code State code of the plant.
+	 * @param currentSeason The inventory's current season.
+	 * @param plantSeason The plant's own season.
+	 * @return Units of water removed, 0 for DEAD and SKIP.
+	 */
+	static int waterUsage(int code, SeasonId currentSeason, SeasonId plantSeason);
+
+	/**
+	 * @brief Checks whether a backend can run on this machine.
+	 * @param backend Backend to check.
+	 * @return True if the instructions it needs are available.
+	 */
+	static bool isSupported(Backend backend);
+
+	/**
+	 * @brief Forces a backend, for tests and benchmarks.
+	 * @param backend Backend to use; unsupported backends fall back to Scalar.
+	 */
+	static void setBackend(Backend backend);
+
+	/**
+	 * @brief Gets the backend grow() currently uses.
+	 * @return Active backend; defaults to the widest supported one.
+	 */
+	static Backend getBackend();
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef Season_h
+#define Season_h
+
+#include <string>
+
+/**
+ * @brief Small integer identifier for a growing season.
+ *
+ * Seasons used to be compared as "Spring Season"/"Summer Season" strings on
+ * every grow(). Inventory and LivingPlant now carry one of these IDs next to
+ * their season flyweight, so the hot path indexes a table instead.
+ *
+ * None is a plant without a season. Other is a season name that is not one
+ * of the four known ones; it never matches the current season.
+ */
+enum class SeasonId : unsigned char
+{
+	None = 0,
+	Spring,
+	Summer,
+	Autumn,
+	Winter,
+	Other
+};
+
+/** Number of SeasonId values, for sizing tables indexed by season. */
+const int SEASON_ID_COUNT = 6;
+
+/**
+ * @brief Water used per day, indexed by [maturity state ID][current season][plant season].
+ *
+ * Each entry is the state's base usage (Seed 1, Vegetative 2, Mature 3,
+ * Dead 0) times the current season's multiplier when the plant's season does
+ * not match: Spring 0.9, Summer 1.3, Autumn 1.0, Winter 0.8. Entries are the
+ * same products grow() used to compute at runtime, so results are unchanged.
+ *
+ * Columns: None, Spring, Summer, Autumn, Winter, Other.
+ */
+constexpr double SEASONAL_WATER_USAGE[4][SEASON_ID_COUNT][SEASON_ID_COUNT] = {
+	// Seed
+	{{1.0, 1.0, 1.0, 1.0, 1.0, 1.0},
+	 {1.0, 1.0, 1 * 0.9, 1 * 0.9, 1 * 0.9, 1 * 0.9},
+	 {1.0, 1 * 1.3, 1.0, 1 * 1.3, 1 * 1.3, 1 * 1.3},
+	 {1.0, 1 * 1.0, 1 * 1.0, 1.0, 1 * 1.0, 1 * 1.0},
+	 {1.0, 1 * 0.8, 1 * 0.8, 1 * 0.8, 1.0, 1 * 0.8},
+	 {1.0, 1.0, 1.0, 1.0, 1.0, 1.0}},
+	// Vegetative
+	{{2.0, 2.0, 2.0, 2.0, 2.0, 2.0},
+	 {2.0, 2.0, 2 * 0.9, 2 * 0.9, 2 * 0.9, 2 * 0.9},
+	 {2.0, 2 * 1.3, 2.0, 2 * 1.3, 2 * 1.3, 2 * 1.3},
+	 {2.0, 2 * 1.0, 2 * 1.0, 2.0, 2 * 1.0, 2 * 1.0},
+	 {2.0, 2 * 0.8, 2 * 0.8, 2 * 0.8, 2.0, 2 * 0.8},
+	 {2.0, 2.0, 2.0, 2.0, 2.0, 2.0}},
+	// Mature
+	{{3.0, 3.0, 3.0, 3.0, 3.0, 3.0},
+	 {3.0, 3.0, 3 * 0.9, 3 * 0.9, 3 * 0.9, 3 * 0.9},
+	 {3.0, 3 * 1.3, 3.0, 3 * 1.3, 3 * 1.3, 3 * 1.3},
+	 {3.0, 3 * 1.0, 3 * 1.0, 3.0, 3 * 1.0, 3 * 1.0},
+	 {3.0, 3 * 0.8, 3 * 0.8, 3 * 0.8, 3.0, 3 * 0.8},
+	 {3.0, 3.0, 3.0, 3.0, 3.0, 3.0}},
+	// Dead
+	{{0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+	 {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+	 {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+	 {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+	 {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+	 {0.0, 0.0, 0.0, 0.0, 0.0, 0.0}}};
+
+/**
+ * @brief Looks up a day's water usage.
+ * @param stateId Maturity state ID (Seed::getID() ... Dead::getID()).
+ * @param current The inventory's current season.
+ * @param plant The plant's season.
+ * @return Units of water used, before truncation to the plant's integer level.
+ */
+inline double seasonalWaterUsage(int stateId, SeasonId current, SeasonId plant)
+{
+	return SEASONAL_WATER_USAGE[stateId][static_cast<int>(current)][static_cast<int>(plant)];
+}
+
+/**
+ * @brief Gets the season that follows another one.
+ * @param season Current season.
+ * @return Spring -> Summer -> Autumn -> Winter -> Spring; None and Other are unchanged.
+ */
+inline SeasonId nextSeason(SeasonId season)
+{
+	switch (season)
+	{
+	case SeasonId::Spring:
+		return SeasonId::Summer;
+	case SeasonId::Summer:
+		return SeasonId::Autumn;
+	case SeasonId::Autumn:
+		return SeasonId::Winter;
+	case SeasonId::Winter:
+		return SeasonId::Spring;
+	default:
+		return season;
+	}
+}
+
+/**
+ * @brief Gets the display name used by the season flyweights and decorators.
+ * @param season Season to name.
+ * @return "Spring Season" etc., or an empty string for None and Other.
+ */
+inline const char *seasonName(SeasonId season)
+{
+	switch (season)
+	{
+	case SeasonId::Spring:
+		return "Spring Season";
+	case SeasonId::Summer:
+		return "Summer Season";
+	case SeasonId::Autumn:
+		return "Autumn Season";
+	case SeasonId::Winter:
+		return "Winter Season";
+	default:
+		return "";
+	}
+}
+
+/**
+ * @brief Maps a season name back to its ID.
+ * @param name Season name such as "Winter Season".
+ * @return The matching ID, or Other for any other name.
+ */
+inline SeasonId seasonIdFromName(const std::string &name)
+{
+	for (int id = static_cast<int>(SeasonId::Spring); id <= static_cast<int>(SeasonId::Winter); id++)
+	{
+		if (name == seasonName(static_cast<SeasonId>(id)))
+			return static_cast<SeasonId>(id);
+	}
+	return SeasonId::Other;
+}
+
+#endif
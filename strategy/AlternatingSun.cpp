@@ -1,11 +1,13 @@
 #include "AlternatingSun.h"
 #include "../prototype/LivingPlant.h"
 
-int AlternatingSun::addSun(LivingPlant* plant) {
-    intensity= intensity == 4 ? 6 : 4;
-    hoursNeeded = hoursNeeded == 4 ? 6 : 4;
+int AlternatingSun::addSun(LivingPlant* plant) const {
+    // Slot 1 is the strong half: two more hours at two more intensity
+    unsigned strong = plant->getSunSlot() ? 0 : 1;
+    plant->setSunSlot(strong);
 
-    int applied = intensity * hoursNeeded;
+    int extra = strong ? 2 : 0;
+    int applied = (intensity + extra) * (hoursNeeded + extra);
          plant->setSunExposure(plant->getSunExposure() + applied);
     return applied;
 }
@@ -7,6 +7,7 @@
  * @brief Concrete strategy for alternating sun exposure.
  *
  * Implements a sun exposure strategy that alternates between high and low intensity.
+ * Each plant alternates on its own; which half it is on is kept in its sun slot.
  */
 class AlternatingSun : public SunStrategy
 {
@@ -16,7 +17,7 @@ class AlternatingSun : public SunStrategy
 		 * @param plant Pointer to the LivingPlant receiving sunlight.
 		 * @return Integer representing the sun exposure applied.
 		 */
-		int addSun(LivingPlant* plant);
+		int addSun(LivingPlant* plant) const;
 
 		/**
 		 * @brief Gets the unique identifier for the AlternatingSun strategy.
@@ -1,17 +1,23 @@
 #include "AlternatingWater.h"
 #include "../prototype/LivingPlant.h"
-#include <ctime>
 
-int AlternatingWater::water(LivingPlant* plant) {
-    
-   if (waterAmount < 40) {
-      waterAmount+=5;
-    } else {
-        waterAmount = 20; 
+namespace
+{
+    // Steps of 5 above waterAmount; step 0 is the low point the cycle starts from
+    const unsigned CYCLE_STEPS = 5;
+}
+
+int AlternatingWater::water(LivingPlant* plant) const {
+
+    unsigned step = plant->getWaterSlot() + 1;
+    if (step >= CYCLE_STEPS) {
+        step = 0;
     }
-    
-    plant->setWaterLevel(plant->getWaterLevel() + waterAmount);
-    return waterAmount;
+    plant->setWaterSlot(step);
+
+    int amount = waterAmount + 5 * static_cast<int>(step);
+    plant->setWaterLevel(plant->getWaterLevel() + amount);
+    return amount;
 }
 
 int AlternatingWater::getID() {
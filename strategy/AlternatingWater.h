@@ -27,7 +27,7 @@
  * - Builder assigns to specialized/premium plant species
  * - water() applies cyclic watering pattern directly to plant object
  * - getID() returns consistent identifier for caching
- * - Requires stateful tracking between executions
+ * - Tracks its place in the cycle per plant, in the plant's water slot
  *
  * @see WaterStrategy (abstract interface)
  * @see LivingPlant (context)
@@ -37,10 +37,14 @@ class AlternatingWater : public WaterStrategy
     public:
         /**
          * @brief Applies alternating watering pattern to the plant.
+         *
+         * Each plant steps through 25, 30, 35, 40, 20 and round again on its
+         * own; the step it is on is kept in its water slot.
+         *
          * @param plant Pointer to the plant to be watered.
          * @return Integer representing the water amount for current cycle.
          */
-        int water(LivingPlant* plant);
+        int water(LivingPlant* plant) const;
 
         /**
          * @brief Gets the unique identifier for the AlternatingWater strategy.
@@ -1,7 +1,7 @@
 #include "HighSun.h"
 #include "../prototype/LivingPlant.h"
 
-int HighSun::addSun(LivingPlant* plant) {
+int HighSun::addSun(LivingPlant* plant) const {
     int applied = intensity * hoursNeeded;
        plant->setSunExposure(plant->getSunExposure() + applied);
     return applied;
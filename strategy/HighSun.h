@@ -39,7 +39,7 @@ class HighSun : public SunStrategy
 		 * @param plant Pointer to the LivingPlant receiving sunlight.
 		 * @return Integer representing the abundant sun exposure applied.
 		 */
-		int addSun(LivingPlant* plant);
+		int addSun(LivingPlant* plant) const;
 
 		/**
 		 * @brief Gets the unique identifier for the HighSun strategy.
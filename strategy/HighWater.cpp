@@ -1,7 +1,7 @@
 #include "HighWater.h"
 #include "../prototype/LivingPlant.h"
 
-int HighWater::water(LivingPlant* plant) {
+int HighWater::water(LivingPlant* plant) const {
    
   
        plant->setWaterLevel(plant->getWaterLevel() + waterAmount);
@@ -1,7 +1,7 @@
 #include "LowSun.h"
 #include "../prototype/LivingPlant.h"
 
-int LowSun::addSun(LivingPlant* plant) {
+int LowSun::addSun(LivingPlant* plant) const {
     int applied = intensity * hoursNeeded;
      plant->setSunExposure(plant->getSunExposure() + applied);
     return applied;
@@ -39,7 +39,7 @@ class LowSun : public SunStrategy
 		 * @param plant Pointer to the LivingPlant receiving sunlight.
 		 * @return Integer representing the minimal sun exposure applied.
 		 */
-		int addSun(LivingPlant* plant);
+		int addSun(LivingPlant* plant) const;
 
 		/**
 		 * @brief Gets the unique identifier for the LowSun strategy.
@@ -1,7 +1,7 @@
 #include "LowWater.h"
 #include "../prototype/LivingPlant.h"
 
-int LowWater::water(LivingPlant *plant)
+int LowWater::water(LivingPlant *plant) const
 {
 
 
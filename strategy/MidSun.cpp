@@ -1,7 +1,7 @@
 #include "MidSun.h"
 #include "../prototype/LivingPlant.h"
 
-int MidSun::addSun(LivingPlant* plant) {
+int MidSun::addSun(LivingPlant* plant) const {
     int applied = intensity * hoursNeeded;
        plant->setSunExposure(plant->getSunExposure() + applied);
     return applied;
@@ -17,7 +17,7 @@ class MidSun : public SunStrategy
 		 * @param plant Pointer to the LivingPlant receiving sunlight.
 		 * @return Integer representing the medium sun exposure applied.
 		 */
-		int addSun(LivingPlant* plant);
+		int addSun(LivingPlant* plant) const;
 
 		/**
 		 * @brief Gets the unique identifier for the MidSun strategy.
@@ -1,7 +1,7 @@
 #include "MidWater.h"
 #include "../prototype/LivingPlant.h"
 
-int MidWater::water(LivingPlant* plant) {
+int MidWater::water(LivingPlant* plant) const {
  
   
     plant->setWaterLevel(plant->getWaterLevel() + waterAmount);
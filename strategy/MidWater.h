@@ -39,7 +39,7 @@ class MidWater : public WaterStrategy
          * @param plant Pointer to the plant to be watered.
          * @return Integer representing the medium water amount applied.
          */
-        int water(LivingPlant* plant);
+        int water(LivingPlant* plant) const;
 
         /**
          * @brief Gets the unique identifier for the MidWater strategy.
@@ -46,10 +46,14 @@ class SunStrategy
 	public:
 		/**
 		 * @brief Applies sunlight exposure to the plant.
+		 *
+		 * Must not change the shared strategy; state kept between calls goes
+		 * in the plant's sun slot (LivingPlant::getSunSlot()).
+		 *
 		 * @param plant Pointer to the LivingPlant receiving sunlight.
 		 * @return Integer representing the amount of sunlight applied.
 		 */
-		virtual int addSun(LivingPlant* plant) = 0;
+		virtual int addSun(LivingPlant* plant) const = 0;
 
 		/**
 		 * @brief Gets the unique identifier for this sun strategy type.
@@ -46,10 +46,16 @@ protected:
 public:
     /**
      * @brief Executes the watering algorithm on the specified plant.
+     *
+     * One instance is shared by every plant and may run on several tick
+     * workers at once, so it must not change the strategy. A strategy that
+     * needs to remember something between waterings keeps it in the plant's
+     * water slot (LivingPlant::getWaterSlot()).
+     *
      * @param plant Pointer to the plant to be watered.
      * @return Integer representing the amount of water applied.
      */
-    virtual int water(LivingPlant *plant) = 0;
+    virtual int water(LivingPlant *plant) const = 0;
 
     /**
      * @brief Virtual destructor for proper cleanup of derived classes.
@@ -10,6 +10,8 @@
 #include "decorator/plantDecorator/Spring.h"
 #include "mediator/Staff.h"
 #include "singleton/Singleton.h"
+#include "state/Seed.h"
+#include <cmath>
 #include <vector>
 
 TEST_CASE("Testing Composite Pattern - Basic PlantGroup Operations")
@@ -759,3 +761,240 @@ TEST_CASE("Testing Composite Pattern - Complex Scenarios")
     }
     delete Inventory::getInstance();
 }
+
+TEST_CASE("Testing Composite Pattern - Contiguous Child Storage")
+{
+    SUBCASE("Children point back at their group")
+    {
+        PlantGroup *root = new PlantGroup();
+        PlantGroup *bed = new PlantGroup();
+        LivingPlant *tree = new Tree();
+        root->addComponent(bed);
+        bed->addComponent(tree);
+
+        CHECK(tree->getParent() == bed);
+        CHECK(bed->getParent() == root);
+        CHECK(root->getParent() == nullptr);
+
+        // Removing through the root follows the back-pointer into the subgroup
+        CHECK(root->removeComponent(tree));
+        CHECK(tree->getParent() == nullptr);
+        CHECK(bed->getChildCount() == 0);
+        CHECK_FALSE(root->removeComponent(tree));
+
+        PlantComponent *copy = root->clone();
+        CHECK(copy->getParent() == nullptr);
+
+        delete tree;
+        delete copy;
+        delete root;
+    }
+
+    SUBCASE("Removal keeps the order of the remaining children")
+    {
+        PlantGroup *group = new PlantGroup();
+        std::vector<LivingPlant *> plants;
+        for (int i = 0; i < 100; i++)
+        {
+            plants.push_back(new Shrub());
+            group->addComponent(plants.back());
+        }
+
+        // Enough removals to compact the group along the way
+        for (int i = 0; i < 100; i += 2)
+        {
+            CHECK(group->removeComponent(plants[i]));
+            delete plants[i];
+        }
+        CHECK(group->getChildCount() == 50);
+        CHECK(group->getChildren().size() == 50);
+
+        bool ordered = true;
+        int next = 1;
+        for (PlantComponent *child : group->getChildren())
+        {
+            if (child == nullptr)
+                continue;
+            ordered = ordered && child == plants[next] && child->getParent() == group;
+            next += 2;
+        }
+        CHECK(ordered);
+        CHECK(next == 101);
+
+        // Slots stay right after compaction
+        CHECK(group->removeComponent(plants[99]));
+        CHECK(group->removeComponent(plants[1]));
+        CHECK(group->getChildCount() == 48);
+        delete plants[99];
+        delete plants[1];
+        delete group;
+    }
+
+    SUBCASE("getPlants() stays in step with the group")
+    {
+        PlantGroup *group = new PlantGroup();
+        LivingPlant *tree = new Tree();
+        LivingPlant *shrub = new Shrub();
+        LivingPlant *herb = new Herb();
+        group->addComponent(tree);
+        group->addComponent(shrub);
+
+        std::list<PlantComponent *> *view = group->getPlants();
+        std::list<PlantComponent *>::iterator first = view->begin();
+        group->addComponent(herb);
+        group->removeComponent(shrub);
+
+        CHECK(view->size() == 2);
+        CHECK(*first == tree);
+        CHECK(view->back() == herb);
+        CHECK(group->getPlants() == view);
+
+        delete shrub;
+        delete group;
+    }
+
+    SUBCASE("A component moved to another group is still found")
+    {
+        PlantGroup *first = new PlantGroup();
+        PlantGroup *second = new PlantGroup();
+        LivingPlant *tree = new Tree();
+        first->addComponent(tree);
+        second->addComponent(tree);
+        CHECK(tree->getParent() == second);
+
+        CHECK(first->removeComponent(tree));
+        CHECK(first->getChildCount() == 0);
+        CHECK(tree->getParent() == second);
+        CHECK(second->removeComponent(tree));
+
+        first->addComponent(nullptr);
+        CHECK(first->getChildCount() == 0);
+
+        delete tree;
+        delete first;
+        delete second;
+    }
+    delete Inventory::getInstance();
+}
+
+namespace
+{
+    // Tree that counts how often a group asks for its price
+    class CountingTree : public Tree
+    {
+    public:
+        int priceReads = 0;
+
+        double getPrice() override
+        {
+            priceReads++;
+            return Tree::getPrice();
+        }
+    };
+}
+
+TEST_CASE("Testing Composite Pattern - Cached Aggregates")
+{
+    SUBCASE("Unchanged totals are served from the cache")
+    {
+        PlantGroup *root = new PlantGroup();
+        PlantGroup *bed = new PlantGroup();
+        CountingTree *tree = new CountingTree();
+        root->addComponent(bed);
+        bed->addComponent(tree);
+
+        double price = root->getPrice();
+        CHECK(std::fabs(price - (tree->Tree::getPrice())) < 1e-9);
+        CHECK(tree->priceReads == 1);
+
+        root->getPrice();
+        root->affectWater();
+        bed->getPrice();
+        CHECK(tree->priceReads == 1);
+
+        // Adding next to the tree resums the bed but not the tree's own price again
+        LivingPlant *shrub = new Shrub();
+        bed->addComponent(shrub);
+        CHECK(std::fabs(root->getPrice() - (price + shrub->getPrice())) < 1e-9);
+        CHECK(tree->priceReads == 2);
+
+        CHECK(root->removeComponent(shrub));
+        CHECK(std::fabs(root->getPrice() - (price)) < 1e-9);
+        delete shrub;
+        delete root;
+    }
+
+    SUBCASE("Decorating a plant updates its groups' totals")
+    {
+        PlantGroup *root = new PlantGroup();
+        PlantGroup *bed = new PlantGroup();
+        LivingPlant *tree = new Tree();
+        LivingPlant *herb = new Herb();
+        tree->addAttribute(new Autumn());
+        root->addComponent(bed);
+        bed->addComponent(tree->getDecorator());
+        bed->addComponent(herb);
+
+        double before = root->getPrice();
+        int waterBefore = root->affectWater();
+        double treeBefore = tree->getDecorator()->getPrice();
+        int treeWaterBefore = tree->getDecorator()->affectWater();
+
+        // The group holds the outermost decorator, which stays outermost
+        tree->addAttribute(new Spring());
+        CHECK(std::fabs(root->getPrice() - (before - treeBefore + tree->getDecorator()->getPrice())) < 1e-9);
+        CHECK(root->affectWater() == waterBefore - treeWaterBefore + tree->getDecorator()->affectWater());
+        delete root;
+    }
+
+    SUBCASE("Water and sun sums follow care and growth")
+    {
+        Inventory *inv = Inventory::getInstance();
+        PlantGroup *bed = new PlantGroup();
+        std::vector<LivingPlant *> plants;
+        for (int i = 0; i < 40; i++)
+        {
+            LivingPlant *plant = (i % 2) ? (LivingPlant *)new Herb() : (LivingPlant *)new Tree();
+            plant->setMaturity(Seed::getID());
+            plant->setWaterLevel(50 + i);
+            plants.push_back(plant);
+            bed->addComponent(plant);
+        }
+        inv->getInventory()->addComponent(bed);
+
+        PlantGroup *root = inv->getInventory();
+        int water = root->getWaterValue();
+        plants[3]->setWaterLevel(0);
+        CHECK(root->getWaterValue() == water - (50 + 3));
+
+        plants[5]->water();
+        plants[7]->setSunExposure(90);
+        plants[9]->setOutside();
+
+        bool matches = true;
+        auto sums = [&](int &waterSum, int &sunSum)
+        {
+            waterSum = 0;
+            sunSum = 0;
+            for (LivingPlant *plant : plants)
+            {
+                waterSum += plant->getWaterValue();
+                sunSum += plant->getSunlightValue();
+            }
+        };
+        int waterSum, sunSum;
+        sums(waterSum, sunSum);
+        matches = matches && bed->getWaterValue() == waterSum && bed->getSunlightValue() == sunSum;
+
+        inv->advanceDay();
+        sums(waterSum, sunSum);
+        matches = matches && bed->getWaterValue() == waterSum && bed->getSunlightValue() == sunSum;
+
+        inv->advanceDays(20);
+        sums(waterSum, sunSum);
+        matches = matches && bed->getWaterValue() == waterSum && bed->getSunlightValue() == sunSum;
+        CHECK(matches);
+        CHECK(root->getWaterValue() == bed->getWaterValue());
+    }
+    delete Inventory::getInstance();
+}
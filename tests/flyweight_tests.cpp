@@ -1,12 +1,25 @@
 #include "doctest.h"
 #include "flyweight/Flyweight.h"
 #include "flyweight/FlyweightFactory.h"
+#include "flyweight/StringInterner.h"
+#include "flyweight/FlyweightRegistry.h"
+#include "simulation/FlyweightReport.h"
+#include "state/Dead.h"
+#include "state/Seed.h"
 #include "strategy/WaterStrategy.h"
 #include "strategy/LowWater.h"
 #include "strategy/MidWater.h"
 #include "prototype/LivingPlant.h"
 #include "prototype/Tree.h"
+#include "composite/PlantGroup.h"
+#include "mediator/Customer.h"
+#include "mediator/Staff.h"
+#include "facade/NurseryFacade.h"
+#include "singleton/Singleton.h"
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Testing Flyweight Pattern - String Flyweight Storage")
 {
@@ -331,3 +344,377 @@ TEST_CASE("Testing Flyweight Pattern - Factory Method Pattern")
     }
     delete Inventory::getInstance();
 }
+
+TEST_CASE("Testing Flyweight Pattern - Concurrent Factory")
+{
+    SUBCASE("Threads interning the same keys all get the same flyweights")
+    {
+        FlyweightFactory<std::string, std::string *> factory;
+        const int threads = 8;
+        const int keys = 2000;
+        std::vector<std::vector<Flyweight<std::string *> *>> seen(threads);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.push_back(std::thread([&factory, &seen, t]()
+                                          {
+                                              for (int i = 0; i < keys; i++)
+                                              {
+                                                  // Each thread walks the keys in a different order
+                                                  std::string key = "key" + std::to_string((i * 7 + t * 131) % keys);
+                                                  std::string *data = new std::string(key);
+                                                  Flyweight<std::string *> *fly = factory.getFlyweight(key, data);
+                                                  if (fly->getState() != data)
+                                                      delete data;
+                                                  seen[t].push_back(fly);
+                                              } }));
+        }
+        for (std::size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+
+        CHECK(factory.getSize() == static_cast<std::size_t>(keys));
+        bool agree = true;
+        for (int t = 0; t < threads; t++)
+        {
+            for (int i = 0; i < keys; i++)
+            {
+                std::string key = "key" + std::to_string((i * 7 + t * 131) % keys);
+                agree = agree && factory.find(key) == seen[t][i] && *seen[t][i]->getState() == key;
+            }
+        }
+        CHECK(agree);
+    }
+
+    SUBCASE("Flyweights keep their address as the factory grows")
+    {
+        FlyweightFactory<int, std::string *> factory;
+        Flyweight<std::string *> *first = factory.getFlyweight(0, new std::string("first"));
+        CHECK(factory.find(1) == nullptr);
+
+        for (int i = 1; i < 5000; i++)
+            factory.getFlyweight(i, new std::string(std::to_string(i)));
+
+        CHECK(factory.getSize() == 5000u);
+        CHECK(factory.find(0) == first);
+        CHECK(factory.getFlyweight(0) == first);
+        CHECK(*factory.find(4999)->getState() == "4999");
+    }
+}
+
+TEST_CASE("Testing Flyweight Pattern - String Interner")
+{
+    SUBCASE("Equal characters share one flyweight wherever they come from")
+    {
+        StringInterner interner;
+        const char buffer[] = "Summer Seasonal";
+        Flyweight<std::string *> *fromLiteral = interner.intern(std::string("Summer Season"));
+        Flyweight<std::string *> *fromSlice = interner.intern(buffer, 13);
+
+        CHECK(fromLiteral == fromSlice);
+        CHECK(*fromSlice->getState() == "Summer Season");
+        CHECK(interner.find(buffer, 6) == nullptr);
+        CHECK(interner.find("Summer Season", 13) == fromLiteral);
+        CHECK(interner.intern("", 0) != fromLiteral);
+        CHECK(interner.getSize() == 2u);
+        CHECK(interner.getArenaBytes() == 13u);
+    }
+
+    SUBCASE("Strings longer than a block are stored whole")
+    {
+        StringInterner interner;
+        std::string longName(StringInterner::BLOCK_SIZE * 2, 'x');
+        Flyweight<std::string *> *fly = interner.intern(longName);
+        for (int i = 0; i < 1000; i++)
+            interner.intern("name " + std::to_string(i));
+
+        CHECK(interner.intern(longName) == fly);
+        CHECK(*fly->getState() == longName);
+        CHECK(*interner.find("name 999", 8)->getState() == "name 999");
+    }
+
+    SUBCASE("Threads interning the same names agree")
+    {
+        StringInterner interner;
+        const int threads = 6;
+        const int names = 500;
+        std::vector<std::vector<Flyweight<std::string *> *>> seen(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.push_back(std::thread([&interner, &seen, t]()
+                                          {
+                                              for (int i = 0; i < names; i++)
+                                                  seen[t].push_back(interner.intern("plant " + std::to_string(i))); }));
+        }
+        for (std::size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+
+        CHECK(interner.getSize() == static_cast<std::size_t>(names));
+        bool agree = true;
+        for (int t = 1; t < threads; t++)
+            agree = agree && seen[t] == seen[0];
+        CHECK(agree);
+    }
+
+    SUBCASE("Inventory::getString overloads intern into the same table")
+    {
+        Inventory *inventory = Inventory::getInstance();
+        Flyweight<std::string *> *season = inventory->getString("Winter Season");
+        CHECK(inventory->getString(std::string("Winter Season")) == season);
+        CHECK(inventory->getString("Winter Seasons", 13) == season);
+        CHECK(inventory->getSeasonString(SeasonId::Winter) == season);
+    }
+}
+
+TEST_CASE("Testing Flyweight Pattern - Compact Handles")
+{
+    SUBCASE("Factories number flyweights densely and resolve the numbers")
+    {
+        FlyweightFactory<int, std::string *> factory;
+        std::vector<Flyweight<std::string *> *> created;
+        for (int i = 0; i < 3000; i++)
+            created.push_back(factory.getFlyweight(i * 31, new std::string(std::to_string(i))));
+
+        bool dense = true;
+        for (std::size_t i = 0; i < created.size(); i++)
+            dense = dense && created[i]->getIndex() == i && factory.at(static_cast<std::uint32_t>(i)) == created[i];
+        CHECK(dense);
+        CHECK(factory.at(3000) == nullptr);
+        CHECK(factory.at(Flyweight<std::string *>::UNINDEXED) == nullptr);
+    }
+
+    SUBCASE("Handles are small and round-trip through their factory")
+    {
+        CHECK(sizeof(StringHandle) == 4);
+        CHECK(sizeof(WaterHandle) == 1);
+        CHECK(sizeof(SunHandle) == 1);
+
+        Inventory *inventory = Inventory::getInstance();
+        Flyweight<WaterStrategy *> *mid = inventory->getWaterFly(MidWater::getID());
+        WaterHandle handle = WaterHandle::of(mid);
+        CHECK_FALSE(handle.isNone());
+        CHECK(inventory->getWaterFly(handle) == mid);
+        CHECK(WaterHandle::of(nullptr).isNone());
+        CHECK(inventory->getWaterFly(WaterHandle::none()) == nullptr);
+
+        // A flyweight made outside the interner is interned by content
+        StringInterner &strings = StringInterner::shared();
+        Flyweight<std::string *> outside(new std::string("Monsoon Season"));
+        StringHandle season = strings.handleOf(&outside);
+        CHECK(strings.at(season) == inventory->getString("Monsoon Season"));
+        CHECK(strings.handleOf(nullptr).isNone());
+    }
+
+    SUBCASE("Plants hold handles instead of flyweight pointers")
+    {
+        Inventory *inventory = Inventory::getInstance();
+        LivingPlant *tree = new Tree();
+        tree->setWaterStrategy(MidWater::getID());
+        tree->setSeason(SeasonId::Spring);
+        LivingPlant *copy = static_cast<LivingPlant *>(tree->clone());
+
+        CHECK(copy->getNameHandle() == tree->getNameHandle());
+        CHECK(copy->getWaterHandle() == tree->getWaterHandle());
+        CHECK(copy->getSunHandle().isNone());
+        CHECK(copy->getNameFlyweight() == inventory->getString(tree->getName()));
+        CHECK(copy->getSeason() == inventory->getSeasonString(SeasonId::Spring));
+
+        copy->setWaterLevel(0);
+        copy->water();
+        CHECK(copy->getWaterLevel() > 0);
+
+        // Five flyweight pointers became 4 + 4 + 1 + 1 bytes of handles
+        CHECK(sizeof(LivingPlant) < sizeof(PlantComponent) + 7 * sizeof(void *));
+
+        delete copy;
+        delete tree;
+    }
+    delete Inventory::getInstance();
+}
+
+namespace
+{
+    struct RegistryEntry
+    {
+        virtual ~RegistryEntry() {}
+    };
+
+    struct FirstEntry : RegistryEntry
+    {
+        static int getID() { return 0; }
+    };
+
+    struct LastEntry : RegistryEntry
+    {
+        static int getID() { return 3; }
+    };
+
+    struct OutOfRangeEntry : RegistryEntry
+    {
+        static int getID() { return 4; }
+    };
+}
+
+TEST_CASE("Testing Flyweight Pattern - Dense Registry")
+{
+    SUBCASE("Types are stored and found by their ID")
+    {
+        FlyweightRegistry<RegistryEntry *, 4> registry;
+        CHECK(registry.add<FirstEntry>());
+        CHECK(registry.add<LastEntry>());
+        CHECK_FALSE(registry.add<LastEntry>());
+        CHECK_FALSE(registry.add<OutOfRangeEntry>());
+
+        CHECK(registry.find(0) != nullptr);
+        CHECK(registry.find(3)->getIndex() == 3u);
+        CHECK(registry.find(1) == nullptr);
+        CHECK(registry.find(-1) == nullptr);
+        CHECK(registry.find(4) == nullptr);
+        CHECK(registry.at(3) == registry.find(3));
+        CHECK(registry.at(WaterHandle::NONE) == nullptr);
+    }
+
+    SUBCASE("Inventory lookups are by ID, with the old fallbacks")
+    {
+        Inventory *inventory = Inventory::getInstance();
+        CHECK(inventory->getWaterFly(HighWater::getID())->getIndex() == static_cast<std::uint32_t>(HighWater::getID()));
+        CHECK(WaterHandle::of(inventory->getWaterFly(MidWater::getID())).index == MidWater::getID());
+        CHECK(inventory->getStates(Dead::getID())->getIndex() == static_cast<std::uint32_t>(Dead::getID()));
+        CHECK(inventory->getWaterFly(-3) == inventory->getWaterFly(LowWater::getID()));
+        CHECK(inventory->getSunFly(static_cast<int>(Inventory::STRATEGY_SLOTS)) == inventory->getSunFly(LowSun::getID()));
+        CHECK(inventory->getStates(42) == inventory->getStates(Seed::getID()));
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Flyweight Pattern - Sharing Statistics")
+{
+    SUBCASE("Factories count hits, misses, entries and bytes")
+    {
+        FlyweightFactory<int, std::string *> factory;
+        factory.getFlyweight(1, new std::string("a"));
+        factory.getFlyweight(2, new std::string("b"));
+        factory.getFlyweight(1);
+        factory.find(2);
+        factory.find(3);
+
+        FlyweightStats stats = factory.getStats();
+        CHECK(stats.hits == 2);
+        CHECK(stats.misses == 2);
+        CHECK(stats.entries == 2);
+        CHECK(stats.entryBytes >= 2 * (sizeof(Flyweight<std::string *>) + sizeof(std::string)));
+
+        // Two entries shared by 100 holders instead of 100 copies
+        CHECK(stats.bytesSaved(100, 4) > 0);
+        CHECK(stats.bytesSaved(0, 4) < 0);
+        CHECK(FlyweightStats().bytesSaved(100, 4) == 0);
+    }
+
+    SUBCASE("Registries count hits and misses of share() only")
+    {
+        FlyweightRegistry<RegistryEntry *, 4> registry;
+        registry.add<FirstEntry>();
+        registry.share(0);
+        registry.share(1);
+        registry.find(0);
+        registry.find(1);
+        registry.at(0);
+
+        FlyweightStats stats = registry.getStats();
+        CHECK(stats.hits == 1);
+        CHECK(stats.misses == 1);
+        CHECK(stats.entries == 1);
+        CHECK(stats.entryBytes == sizeof(Flyweight<RegistryEntry *>) + sizeof(FirstEntry));
+    }
+
+    SUBCASE("Inventory reports every pool with the plants' references")
+    {
+        Inventory *inventory = Inventory::getInstance();
+        FlyweightStats waterBefore = inventory->getFlyweightReport().getPool(FlyweightPool::Water).stats;
+        PlantGroup *bed = new PlantGroup();
+        inventory->getInventory()->addComponent(bed);
+        Customer *casey = new Customer("Casey");
+        inventory->addCustomer(casey);
+        for (int i = 0; i < 50; i++)
+        {
+            LivingPlant *tree = new Tree();
+            tree->setWaterStrategy(MidWater::getID());
+            tree->setSeason(SeasonId::Spring);
+            if (i % 2 == 0)
+                tree->setMaturity(Seed::getID());
+            if (i < 40)
+                bed->addComponent(tree);
+            else
+                casey->addPlant(tree);
+        }
+
+        // Neither in the composite nor in a basket, like a builder's prototype
+        LivingPlant *loose = new Tree();
+        loose->setWaterStrategy(MidWater::getID());
+
+        FlyweightReport report = inventory->getFlyweightReport();
+        CHECK(report.getPlantCount() == 50);
+        CHECK(report.getPool(FlyweightPool::Strings).references == 100);
+        CHECK(report.getPool(FlyweightPool::Strings).processWide);
+        CHECK_FALSE(report.getPool(FlyweightPool::Water).processWide);
+        CHECK(report.getPool(FlyweightPool::Water).references == 50);
+        CHECK(report.getPool(FlyweightPool::Water).handleBytes == 1);
+        CHECK(report.getPool(FlyweightPool::Water).stats.entries == 4);
+        CHECK(report.getPool(FlyweightPool::Sun).stats.entries == 4);
+        CHECK(report.getPool(FlyweightPool::States).references == 25);
+
+        // Hits are the handles given out, not the strategy lookups of watering
+        CHECK(report.getPool(FlyweightPool::Water).stats.hits - waterBefore.hits == 51);
+        inventory->getInventory()->water();
+        CHECK(inventory->getFlyweightReport().getPool(FlyweightPool::Water).stats.hits - waterBefore.hits == 51);
+        CHECK(report.getBytesSaved(FlyweightPool::Water) > 0);
+        CHECK(report.getPlantBytes() >= sizeof(LivingPlant));
+        CHECK(report.getBytesPerPlant() > report.getPlantBytes());
+
+        std::string json = report.toJson();
+        CHECK(json.find("\"plants\": 50,") != std::string::npos);
+        CHECK(json.find("\"strings\": {") != std::string::npos);
+        CHECK(json.find("\"states\": {") != std::string::npos);
+        CHECK(json.find("\"bytesPerPlant\": ") != std::string::npos);
+        CHECK(json.find("\"processWide\": true") != std::string::npos);
+        CHECK(report.toText().find("water") != std::string::npos);
+        CHECK(report.toText().find("(process-wide)") != std::string::npos);
+
+        delete loose;
+        inventory->getInventory()->removeComponent(bed);
+        delete bed;
+        CHECK(inventory->getFlyweightReport().getPlantCount() == 10);
+    }
+
+    SUBCASE("Reports taken during sales see each plant in stock or in a basket")
+    {
+        Inventory *inventory = Inventory::getInstance();
+        NurseryFacade facade;
+        facade.addStaff("Till");
+
+        std::atomic<bool> done(false);
+        std::atomic<bool> consistent(true);
+        std::thread reporter([inventory, &done, &consistent]()
+                             {
+                                 while (!done.load())
+                                 {
+                                     unsigned long long plants = inventory->getFlyweightReport().getPlantCount();
+                                     if (plants > 1)
+                                         consistent.store(false);
+                                 } });
+        for (int i = 0; i < 20; i++)
+        {
+            Customer *customer = facade.addCustomer("Buyer " + std::to_string(i));
+            facade.addToCustomerBasket(customer, facade.createPlant("Rose"));
+            facade.customerPurchase(customer);
+        }
+        done.store(true);
+        reporter.join();
+
+        CHECK(consistent.load());
+        CHECK(inventory->getCustomers()->size() == 20);
+        CHECK(inventory->getFlyweightReport().getPlantCount() == 0);
+    }
+    delete Inventory::getInstance();
+}
@@ -4,6 +4,8 @@
 #include "prototype/Shrub.h"
 #include "prototype/Succulent.h"
 #include "prototype/Herb.h"
+#include "prototype/PlantStateTable.h"
+#include "singleton/Singleton.h"
 
 TEST_CASE("Testing Prototype Pattern - Plant Type Creation")
 {
@@ -278,3 +280,76 @@ TEST_CASE("Testing Prototype Pattern - Plant Type Operations")
     }
     delete Inventory::getInstance();
 }
+
+TEST_CASE("Testing Prototype Pattern - Plant State Table Storage")
+{
+    Inventory *inv = Inventory::getInstance();
+    PlantStateTable *table = inv->getPlantStates();
+
+    SUBCASE("Each plant owns a live row in the inventory's table")
+    {
+        size_t before = table->getLiveCount();
+        LivingPlant *tree = new Tree();
+        LivingPlant *herb = new Herb();
+
+        CHECK(table->getLiveCount() == before + 2);
+        CHECK(table->isValid(tree->getHandle()));
+        CHECK(table->isValid(herb->getHandle()));
+        CHECK(tree->getHandle().index != herb->getHandle().index);
+
+        tree->setWaterLevel(42);
+        CHECK(table->waterLevel(tree->getHandle()) == 42);
+
+        delete tree;
+        delete herb;
+        CHECK(table->getLiveCount() == before);
+    }
+
+    SUBCASE("Released rows are reused with a new generation")
+    {
+        LivingPlant *first = new Tree();
+        PlantHandle stale = first->getHandle();
+        delete first;
+
+        CHECK_FALSE(table->isValid(stale));
+
+        LivingPlant *second = new Tree();
+        CHECK(second->getHandle().index == stale.index);
+        CHECK(second->getHandle().generation != stale.generation);
+        CHECK(second->getAge() == 0);
+        CHECK(second->getWaterLevel() == 0);
+
+        delete second;
+    }
+
+    SUBCASE("Clones get their own row")
+    {
+        LivingPlant *original = new Shrub();
+        original->setAge(12);
+        original->setHealth(80);
+
+        LivingPlant *copy = static_cast<LivingPlant *>(original->clone());
+        CHECK(copy->getHandle().index != original->getHandle().index);
+        CHECK(copy->getAge() == 12);
+        CHECK(copy->getHealth() == 80);
+
+        copy->setHealth(10);
+        CHECK(original->getHealth() == 80);
+
+        delete original;
+        delete copy;
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Prototype Pattern - Plants outliving the Inventory")
+{
+    LivingPlant *plant = new Tree();
+    plant->setHealth(70);
+
+    delete Inventory::getInstance();
+
+    // The retired table stays alive until its last row is released
+    CHECK(plant->getHealth() == 70);
+    delete plant;
+}
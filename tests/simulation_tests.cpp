@@ -0,0 +1,1818 @@
+#include "doctest.h"
+#include "simulation/WorkStealingPool.h"
+#include "simulation/SimulationClock.h"
+#include "simulation/TickScheduler.h"
+#include "simulation/PlantArchive.h"
+#include "simulation/InventorySnapshot.h"
+#include "simulation/CommandQueue.h"
+#include "simulation/TickStats.h"
+#include "simulation/ShardCoordinator.h"
+#include "simulation/InventoryImage.h"
+#include "simulation/InventoryJournal.h"
+#include "simulation/FastRandom.h"
+#include "state/GrowKernel.h"
+#include "singleton/Singleton.h"
+#include "singleton/NurseryContext.h"
+#include "facade/NurseryFacade.h"
+#include "builder/Director.h"
+#include "builder/RoseBuilder.h"
+#include "builder/CactusBuilder.h"
+#include "builder/SunflowerBuilder.h"
+#include "builder/MapleBuilder.h"
+#include "composite/PlantGroup.h"
+#include "prototype/LivingPlant.h"
+#include "prototype/Tree.h"
+#include "prototype/Herb.h"
+#include "prototype/Shrub.h"
+#include "prototype/Succulent.h"
+#include "decorator/customerDecorator/RedPot.h"
+#include "state/Seed.h"
+#include "state/Vegetative.h"
+#include "state/Mature.h"
+#include "state/Dead.h"
+#include "strategy/LowWater.h"
+#include "strategy/MidWater.h"
+#include "strategy/HighWater.h"
+#include "strategy/LowSun.h"
+#include "strategy/MidSun.h"
+#include "strategy/HighSun.h"
+#include "mediator/Staff.h"
+#include "mediator/Customer.h"
+#include "mediator/SuggestionFloor.h"
+#include "observer/Observer.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // Observer that only counts notifications, so it never changes the plants
+    class CountingObserver : public Observer
+    {
+    public:
+        long water = 0;
+        long sun = 0;
+        void getWaterUpdate(PlantComponent *) { water++; }
+        void getSunUpdate(PlantComponent *) { sun++; }
+        void getStateUpdate(PlantComponent *) {}
+        std::string getNameObserver() { return "Counter"; }
+    };
+
+    // Everything a plant or group shows, recursively, for comparing two inventories
+    std::string describeGroup(PlantGroup *group)
+    {
+        std::string description = "[" + group->getGroupName();
+        for (Observer *observer : group->getObservers())
+            description += " watched by " + observer->getNameObserver();
+        description += "]\n";
+
+        for (PlantComponent *component : *group->getPlants())
+        {
+            if (component->getType() == ComponentType::PLANT_GROUP)
+            {
+                description += describeGroup(static_cast<PlantGroup *>(component));
+                continue;
+            }
+            LivingPlant *plant = static_cast<LivingPlant *>(component);
+            description += plant->getDecorator() ? plant->getDecorator()->getInfo() : plant->getInfo();
+            description += "season " + std::to_string(static_cast<int>(plant->getSeasonId())) +
+                           " water " + std::to_string(plant->affectWater()) +
+                           " sun " + std::to_string(plant->affectSunlight()) + "\n";
+        }
+        return description + "[end " + group->getGroupName() + "]\n";
+    }
+
+    // Everything a journal replay has to bring back: the composite, staff and baskets
+    std::string describeNursery(Inventory *inventory)
+    {
+        std::string description = describeGroup(inventory->getInventory());
+        for (Staff *staff : *inventory->getStaff())
+            description += "staff " + staff->getName() + "\n";
+        for (Customer *customer : *inventory->getCustomers())
+        {
+            description += "customer " + customer->getName() + "\n";
+            if (customer->getBasket())
+                description += describeGroup(customer->getBasket());
+        }
+        return description;
+    }
+
+    std::vector<std::string> listDirectory(const std::string &directory)
+    {
+        std::vector<std::string> names;
+        DIR *dir = opendir(directory.c_str());
+        if (!dir)
+            return names;
+        while (struct dirent *entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..")
+                names.push_back(name);
+        }
+        closedir(dir);
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    void removeDirectory(const std::string &directory)
+    {
+        std::vector<std::string> names = listDirectory(directory);
+        for (std::size_t i = 0; i < names.size(); i++)
+            std::remove((directory + "/" + names[i]).c_str());
+        rmdir(directory.c_str());
+    }
+}
+
+TEST_CASE("Testing Simulation - Work-stealing pool")
+{
+    SUBCASE("Recursively spawned tasks all finish before run returns")
+    {
+        WorkStealingPool pool(4);
+        std::atomic<int> visited(0);
+
+        std::function<void(int)> fanOut;
+        fanOut = [&](int depth)
+        {
+            visited.fetch_add(1);
+            if (depth == 0)
+                return;
+            for (int i = 0; i < 3; i++)
+                pool.spawn([&fanOut, depth]() { fanOut(depth - 1); });
+        };
+
+        pool.run([&fanOut]() { fanOut(5); });
+
+        // 1 + 3 + 9 + 27 + 81 + 243
+        CHECK(visited.load() == 364);
+        CHECK(pool.getThreadCount() == 4);
+    }
+
+    SUBCASE("parallelFor covers every index exactly once")
+    {
+        WorkStealingPool pool(3);
+        std::vector<int> hits(10007, 0);
+
+        pool.run([&pool, &hits]()
+                 { pool.parallelFor(0, hits.size(), 64, [&hits](std::size_t begin, std::size_t end)
+                                    {
+                                        for (std::size_t i = begin; i < end; i++)
+                                            hits[i]++;
+                                    }); });
+
+        bool allOnce = true;
+        for (size_t i = 0; i < hits.size(); i++)
+            allOnce = allOnce && hits[i] == 1;
+        CHECK(allOnce);
+    }
+
+    SUBCASE("Exceptions thrown by tasks surface from run")
+    {
+        WorkStealingPool pool(2);
+        bool caught = false;
+        try
+        {
+            pool.run([&pool]() { pool.spawn([]() { throw std::runtime_error("task failed"); }); });
+        }
+        catch (const std::runtime_error &)
+        {
+            caught = true;
+        }
+        CHECK(caught);
+
+        // The pool is still usable afterwards
+        std::atomic<int> ran(0);
+        pool.run([&ran]() { ran.fetch_add(1); });
+        CHECK(ran.load() == 1);
+    }
+}
+
+TEST_CASE("Testing Simulation - Parallel inventory tick")
+{
+    Inventory *inv = Inventory::getInstance();
+
+    SUBCASE("Thread count is configurable with a serial default")
+    {
+        CHECK(inv->getTickThreads() == 1);
+        inv->setTickThreads(4);
+        CHECK(inv->getTickThreads() == 4);
+        inv->setTickThreads(1);
+        CHECK(inv->getTickThreads() == 1);
+    }
+
+    SUBCASE("Parallel tick over a lopsided tree matches the serial composite tick")
+    {
+        PlantGroup *reference = new PlantGroup();
+        PlantGroup *small = new PlantGroup();
+        PlantGroup *smaller = new PlantGroup();
+        inv->getInventory()->addComponent(small);
+        small->addComponent(smaller);
+
+        std::vector<LivingPlant *> parallel;
+        std::vector<LivingPlant *> serial;
+        int states[] = {Seed::getID(), Vegetative::getID(), Mature::getID()};
+
+        for (int i = 0; i < 3000; i++)
+        {
+            LivingPlant *plant = (i % 2) ? (LivingPlant *)new Herb() : (LivingPlant *)new Tree();
+            plant->setMaturity(states[i % 3]);
+            plant->setAge(i % 130);
+            plant->setHealth(40 + i % 60);
+            plant->setWaterLevel(30 + i % 70);
+            plant->setSunExposure(20 + i % 80);
+            plant->setSeason(inv->getString(i % 4 == 0 ? "Winter Season" : "Summer Season"));
+
+            LivingPlant *copy = static_cast<LivingPlant *>(plant->clone());
+            PlantGroup *target = (i < 2950) ? inv->getInventory() : (i < 2980 ? small : smaller);
+            target->addComponent(plant);
+            reference->addComponent(copy);
+            parallel.push_back(plant);
+            serial.push_back(copy);
+        }
+
+        inv->setTickThreads(4);
+        for (int day = 0; day < 20; day++)
+        {
+            inv->tick();
+            reference->tick();
+        }
+
+        bool same = true;
+        for (size_t i = 0; i < parallel.size(); i++)
+        {
+            same = same && parallel[i]->getAge() == serial[i]->getAge() &&
+                   parallel[i]->getHealth() == serial[i]->getHealth() &&
+                   parallel[i]->getWaterLevel() == serial[i]->getWaterLevel() &&
+                   parallel[i]->getMaturityState() == serial[i]->getMaturityState();
+        }
+        CHECK(same);
+
+        delete reference;
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Simulation - Event-driven inventory tick")
+{
+    Inventory *inv = Inventory::getInstance();
+
+    SUBCASE("Event-driven mode is opt-in")
+    {
+        CHECK_FALSE(inv->isEventDriven());
+        CHECK(inv->getTickScheduler() == nullptr);
+        inv->setEventDriven(true);
+        CHECK(inv->isEventDriven());
+        CHECK(inv->getTickScheduler() != nullptr);
+        inv->setEventDriven(false);
+        CHECK_FALSE(inv->isEventDriven());
+    }
+
+    SUBCASE("Observed and unobserved plants match the composite tick over many days")
+    {
+        Staff *staff = new Staff("Scheduler Staff");
+        PlantGroup *watched = new PlantGroup();
+        PlantGroup *reference = new PlantGroup();
+        PlantGroup *referenceWatched = new PlantGroup();
+        watched->attach(staff);
+        referenceWatched->attach(staff);
+        inv->getInventory()->addComponent(watched);
+        reference->addComponent(referenceWatched);
+
+        std::vector<LivingPlant *> lazy;
+        std::vector<LivingPlant *> eager;
+        int states[] = {Seed::getID(), Vegetative::getID(), Mature::getID(), Dead::getID()};
+        int waters[] = {LowWater::getID(), MidWater::getID(), HighWater::getID()};
+        int suns[] = {LowSun::getID(), MidSun::getID(), HighSun::getID()};
+
+        for (int i = 0; i < 600; i++)
+        {
+            LivingPlant *plant = (i % 2) ? (LivingPlant *)new Herb() : (LivingPlant *)new Tree();
+            plant->setMaturity(states[i % 4]);
+            plant->setAge(i % 125);
+            plant->setHealth(i % 101);
+            plant->setWaterLevel(20 + i % 80);
+            plant->setSunExposure(10 + i % 90);
+            plant->setWaterStrategy(waters[i % 3]);
+            plant->setSunStrategy(suns[(i / 3) % 3]);
+            plant->setSeason(static_cast<SeasonId>(i % SEASON_ID_COUNT));
+
+            LivingPlant *copy = static_cast<LivingPlant *>(plant->clone());
+            bool observed = i % 5 == 0;
+            (observed ? watched : inv->getInventory())->addComponent(plant);
+            (observed ? referenceWatched : reference)->addComponent(copy);
+            lazy.push_back(plant);
+            eager.push_back(copy);
+        }
+
+        // Everything ends up dead and settled, so compare along the way as well
+        bool same = true;
+        auto compare = [&]()
+        {
+            for (size_t i = 0; i < lazy.size(); i++)
+            {
+                same = same && lazy[i]->getAge() == eager[i]->getAge() &&
+                       lazy[i]->getHealth() == eager[i]->getHealth() &&
+                       lazy[i]->getWaterLevel() == eager[i]->getWaterLevel() &&
+                       lazy[i]->getSunExposure() == eager[i]->getSunExposure() &&
+                       lazy[i]->getMaturityState() == eager[i]->getMaturityState();
+            }
+        };
+
+        inv->setEventDriven(true);
+        std::size_t fewest = lazy.size();
+        for (int day = 0; day < 200; day++)
+        {
+            reference->tick();
+            inv->advanceDay();
+            if (inv->isEventDriven())
+                fewest = std::min(fewest, inv->getTickScheduler()->getLastTickEvaluations());
+
+            // Changes between ticks reach lazily grown plants too
+            if (day == 40)
+            {
+                for (size_t i = 0; i < lazy.size(); i += 7)
+                {
+                    lazy[i]->water();
+                    eager[i]->water();
+                    lazy[i]->setMaturity(Seed::getID());
+                    eager[i]->setMaturity(Seed::getID());
+                }
+            }
+            if (day == 90)
+            {
+                LivingPlant *plant = new Herb();
+                plant->setMaturity(Seed::getID());
+                plant->setWaterLevel(90);
+                plant->setSunExposure(90);
+                LivingPlant *copy = static_cast<LivingPlant *>(plant->clone());
+                watched->addComponent(plant);
+                referenceWatched->addComponent(copy);
+                lazy.push_back(plant);
+                eager.push_back(copy);
+            }
+            if (day % 25 == 12)
+                compare();
+            if (day == 150)
+                inv->setEventDriven(false);
+            if (day == 160)
+                inv->setEventDriven(true);
+        }
+
+        compare();
+        CHECK(same);
+        CHECK(fewest < lazy.size() / 2);
+
+        inv->setEventDriven(false);
+        delete reference;
+        delete staff;
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Simulation - Fast-forwarding many days")
+{
+    Inventory *inv = Inventory::getInstance();
+
+    SUBCASE("Nothing happens for zero days")
+    {
+        AdvanceSummary summary = inv->advanceDays(0);
+        CHECK(summary.days == 0);
+        CHECK(summary.waterNotifications == 0);
+    }
+
+    SUBCASE("advanceDays matches advanceDay one day at a time")
+    {
+        CountingObserver fastCounter;
+        CountingObserver stepCounter;
+        PlantGroup *watched = new PlantGroup();
+        PlantGroup *reference = new PlantGroup();
+        PlantGroup *referenceWatched = new PlantGroup();
+        watched->attach(&fastCounter);
+        referenceWatched->attach(&stepCounter);
+        inv->getInventory()->addComponent(watched);
+        reference->addComponent(referenceWatched);
+
+        std::vector<LivingPlant *> fast;
+        std::vector<LivingPlant *> stepped;
+        int states[] = {Seed::getID(), Vegetative::getID(), Mature::getID(), Dead::getID()};
+
+        for (int i = 0; i < 800; i++)
+        {
+            LivingPlant *plant = (i % 2) ? (LivingPlant *)new Herb() : (LivingPlant *)new Tree();
+            plant->setMaturity(states[i % 4]);
+            plant->setAge(i % 131);
+            plant->setHealth((i * 7) % 101);
+            plant->setWaterLevel((i * 13) % 101);
+            plant->setSunExposure((i * 11) % 101);
+            plant->setSeason(static_cast<SeasonId>(i % SEASON_ID_COUNT));
+
+            LivingPlant *copy = static_cast<LivingPlant *>(plant->clone());
+            bool observed = i % 3 == 0;
+            (observed ? watched : inv->getInventory())->addComponent(plant);
+            (observed ? referenceWatched : reference)->addComponent(copy);
+            fast.push_back(plant);
+            stepped.push_back(copy);
+        }
+
+        // The reference follows advanceDay()'s season cadence on the same inventory
+        SeasonId start = inv->getSeasonId();
+        int ticksSinceSeason = 0;
+        for (int day = 0; day < 150; day++)
+        {
+            reference->tick();
+            if (ticksSinceSeason == 8)
+            {
+                inv->changeSeason();
+                ticksSinceSeason = 0;
+            }
+            ticksSinceSeason++;
+        }
+        SeasonId end = inv->getSeasonId();
+        while (inv->getSeasonId() != start)
+            inv->changeSeason();
+
+        AdvanceSummary first = inv->advanceDays(37);
+        AdvanceSummary second = inv->advanceDays(113);
+        CHECK(first.days + second.days == 150);
+        CHECK(inv->getSeasonId() == end);
+
+        bool same = true;
+        for (size_t i = 0; i < fast.size(); i++)
+        {
+            same = same && fast[i]->getAge() == stepped[i]->getAge() &&
+                   fast[i]->getHealth() == stepped[i]->getHealth() &&
+                   fast[i]->getWaterLevel() == stepped[i]->getWaterLevel() &&
+                   fast[i]->getSunExposure() == stepped[i]->getSunExposure() &&
+                   fast[i]->getMaturityState() == stepped[i]->getMaturityState();
+        }
+        CHECK(same);
+
+        // Observers hear nothing; the summary counts what they would have heard
+        CHECK(fastCounter.water == 0);
+        CHECK(first.waterNotifications + second.waterNotifications == stepCounter.water);
+        CHECK(first.sunNotifications + second.sunNotifications == stepCounter.sun);
+        CHECK(first.deaths + second.deaths > 0);
+        CHECK(first.transitions + second.transitions > 0);
+
+        watched->detach(&fastCounter);
+        delete reference;
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Simulation - Dead-plant reaper")
+{
+    Inventory *inv = Inventory::getInstance();
+    PlantGroup *root = inv->getInventory();
+
+    SUBCASE("Dead plants move to the archive and stop being visited")
+    {
+        CountingObserver counter;
+        PlantGroup *bed = new PlantGroup();
+        bed->attach(&counter);
+        root->addComponent(bed);
+
+        LivingPlant *deadTree = new Tree();
+        deadTree->setMaturity(Dead::getID());
+        deadTree->setAge(121);
+        LivingPlant *deadHerb = new Herb();
+        deadHerb->setMaturity(Dead::getID());
+        deadHerb->setAge(80);
+        LivingPlant *deadShrub = new Shrub();
+        deadShrub->setMaturity(Dead::getID());
+        deadShrub->addAttribute(new RedPot());
+        LivingPlant *alive = new Herb();
+        alive->setMaturity(Mature::getID());
+        alive->setWaterLevel(100);
+        alive->setSunExposure(100);
+
+        bed->addComponent(deadTree);
+        bed->addComponent(deadHerb);
+        bed->addComponent(alive);
+        root->addComponent(deadShrub);
+
+        inv->tick();
+        CHECK(counter.water == 2);
+
+        double shrubPrice = deadShrub->getDecorator()->getPrice();
+        CHECK(inv->reapDeadPlants() == 3);
+        CHECK(bed->getPlants()->size() == 1);
+        CHECK(root->getPlants()->size() == 1);
+
+        PlantArchive *archive = inv->getArchive();
+        CHECK(archive->size() == 3);
+        CHECK(archive->countSpecies(PlantSpecies::Tree) == 1);
+        CHECK(archive->countSpecies(PlantSpecies::Herb) == 1);
+        CHECK(archive->countSpecies(PlantSpecies::Succulent) == 0);
+        CHECK(archive->countName("Herb") == 1);
+        CHECK(archive->countName("Rose") == 0);
+        CHECK(std::fabs(archive->getTotalPrice() - (150.0 + 30.0 + shrubPrice)) < 1e-9);
+
+        bool foundTree = false;
+        for (size_t i = 0; i < archive->size(); i++)
+        {
+            const ArchivedPlant &record = archive->get(i);
+            if (record.species == PlantSpecies::Tree)
+                foundTree = record.ageAtDeath == 122 && archive->getName(record.nameId) == "Tree";
+        }
+        CHECK(foundTree);
+
+        counter.water = 0;
+        inv->tick();
+        CHECK(counter.water == 0);
+        CHECK(inv->reapDeadPlants() == 0);
+        bed->detach(&counter);
+    }
+
+    SUBCASE("Auto-reap runs when the season changes")
+    {
+        CHECK_FALSE(inv->isAutoReap());
+        inv->setAutoReap(true);
+
+        LivingPlant *old = new Tree();
+        old->setMaturity(Mature::getID());
+        old->setAge(119);
+        root->addComponent(old);
+
+        for (int day = 0; day < 9; day++)
+            inv->advanceDay();
+
+        CHECK(root->getPlants()->empty());
+        CHECK(inv->getArchive()->size() == 1);
+        CHECK(inv->getArchive()->get(0).ageAtDeath == 128);
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Simulation - Inventory snapshots")
+{
+    Inventory *inv = Inventory::getInstance();
+    PlantGroup *root = inv->getInventory();
+
+    SUBCASE("Each tick publishes the plants as they are after it")
+    {
+        LivingPlant *loose = new Herb();
+        loose->setMaturity(Seed::getID());
+        loose->setWaterLevel(80);
+        PlantGroup *bed = new PlantGroup();
+        PlantGroup *tray = new PlantGroup();
+        LivingPlant *inBed = new Tree();
+        LivingPlant *inTray = new Shrub();
+        LivingPlant *afterTray = new Herb();
+        bed->addComponent(inBed);
+        tray->addComponent(inTray);
+        bed->addComponent(tray);
+        bed->addComponent(afterTray);
+        root->addComponent(loose);
+        root->addComponent(bed);
+
+        unsigned long before = inv->getSnapshots()->getPublishCount();
+        inv->tick();
+        CHECK(inv->getSnapshots()->getPublishCount() == before + 1);
+
+        SnapshotReader snapshot(inv->getSnapshots());
+        CHECK(snapshot->getVersion() == before + 1);
+        REQUIRE(snapshot->getPlantCount() == 4);
+        CHECK(snapshot->getPlant(0).plant == loose);
+        CHECK(snapshot->getPlant(1).plant == inBed);
+        CHECK(snapshot->getPlant(2).plant == inTray);
+        CHECK(snapshot->getPlant(3).plant == afterTray);
+        CHECK(snapshot->getPlant(0).values.age == 1);
+        CHECK(snapshot->getPlant(0).values.waterLevel == loose->getWaterLevel());
+        CHECK(*snapshot->getPlant(1).values.name == "Tree");
+
+        const GroupSnapshotEntry *bedEntry = snapshot->findGroup(bed);
+        const GroupSnapshotEntry *trayEntry = snapshot->findGroup(tray);
+        REQUIRE(bedEntry != nullptr);
+        REQUIRE(trayEntry != nullptr);
+        CHECK(bedEntry->topLevel);
+        CHECK_FALSE(trayEntry->topLevel);
+        CHECK(bedEntry->begin == 1);
+        CHECK(bedEntry->end == 4);
+        CHECK(trayEntry->begin == 2);
+        CHECK(trayEntry->end == 3);
+
+        CHECK(LivingPlant::formatInfo(snapshot->findPlant(inTray)->values) == inTray->getInfo());
+    }
+
+    SUBCASE("A pinned snapshot does not change under its reader")
+    {
+        LivingPlant *plant = new Herb();
+        plant->setMaturity(Seed::getID());
+        root->addComponent(plant);
+        inv->publishSnapshot();
+
+        SnapshotReader pinned(inv->getSnapshots());
+        REQUIRE(pinned->getPlantCount() == 1);
+        CHECK(pinned->getPlant(0).values.age == 0);
+
+        inv->tick();
+        CHECK(pinned->getPlant(0).values.age == 0);
+        {
+            SnapshotReader latest(inv->getSnapshots());
+            CHECK(latest->getPlant(0).values.age == 1);
+            CHECK(latest->getVersion() == pinned->getVersion() + 1);
+        }
+    }
+
+    SUBCASE("Turning publishing off leaves the last snapshot in place")
+    {
+        root->addComponent(new Herb());
+        inv->setSnapshotPublishing(false);
+        unsigned long before = inv->getSnapshots()->getPublishCount();
+        inv->tick();
+        CHECK(inv->getSnapshots()->getPublishCount() == before);
+        inv->publishSnapshot();
+        CHECK(inv->getSnapshots()->getPublishCount() == before + 1);
+        inv->setSnapshotPublishing(true);
+    }
+
+    SUBCASE("Facade reads come from the snapshot")
+    {
+        NurseryFacade facade;
+        PlantComponent *rose = facade.createPlant("Rose");
+        PlantComponent *pine = facade.createPlant("Pine");
+        PlantGroup *group = facade.createPlantGroup();
+        LivingPlant *grouped = new Succulent();
+        group->addComponent(grouped);
+        facade.addComponentToGroup(root, group);
+
+        std::vector<std::string> names = facade.getMenuString();
+        REQUIRE(names.size() == 3);
+        CHECK(names[0] == rose->getName());
+        CHECK(names[1] == pine->getName());
+        CHECK(names[2] == grouped->getName());
+        CHECK(facade.findPlant(2) == grouped);
+        CHECK(facade.findPlant(3) == nullptr);
+        CHECK(facade.findPlant(-1) == nullptr);
+        CHECK(facade.getAllPlantGroups().size() == 1);
+        CHECK(facade.findPlantGroup(0) == group);
+        CHECK(facade.findPlantGroup(1) == nullptr);
+        REQUIRE(facade.getPlantGroupContents(group).size() == 1);
+        CHECK(facade.getPlantGroupContents(group)[0] == grouped->getName());
+
+        inv->tick();
+        CHECK(facade.getPlantInfo(facade.findPlant(0)) == facade.findPlant(0)->getInfo());
+        facade.waterPlant(facade.findPlant(1));
+        CHECK(facade.getPlantInfo(facade.findPlant(1)) == facade.findPlant(1)->getInfo());
+
+        // Changed behind the facade's back: readers keep the last published values
+        grouped->setAge(50);
+        CHECK(facade.getPlantInfo(grouped) != grouped->getInfo());
+        inv->publishSnapshot();
+        CHECK(facade.getPlantInfo(grouped) == grouped->getInfo());
+
+        facade.removeComponentFromInventory(group);
+        CHECK(facade.getMenuString().size() == 2);
+        CHECK(facade.getPlantGroupContents(group).size() == 1);
+        delete group;
+    }
+
+    SUBCASE("Readers on another thread never see a half-finished tick")
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            LivingPlant *plant = new Herb();
+            plant->setMaturity(Seed::getID());
+            plant->setWaterLevel(100);
+            plant->setSunExposure(100);
+            root->addComponent(plant);
+        }
+        inv->publishSnapshot();
+
+        std::atomic<bool> done(false);
+        std::atomic<int> mixed(0);
+        std::atomic<int> reads(0);
+        std::thread reader([inv, &done, &mixed, &reads]()
+                           {
+                               while (!done.load())
+                               {
+                                   SnapshotReader snapshot(inv->getSnapshots());
+                                   for (size_t i = 1; i < snapshot->getPlantCount(); i++)
+                                   {
+                                       if (snapshot->getPlant(i).values.age != snapshot->getPlant(0).values.age)
+                                           mixed.fetch_add(1);
+                                   }
+                                   reads.fetch_add(1);
+                               } });
+
+        for (int day = 0; day < 200; day++)
+            inv->tick();
+        while (reads.load() < 10)
+            std::this_thread::yield();
+        done.store(true);
+        reader.join();
+        CHECK(mixed.load() == 0);
+
+        SnapshotReader snapshot(inv->getSnapshots());
+        CHECK(snapshot->getPlant(0).values.age == 200);
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Simulation - Command queue")
+{
+    SUBCASE("Commands from many producers are applied once each, in order per producer")
+    {
+        CommandQueue queue;
+        const int producers = 4;
+        const int perProducer = 2000;
+        std::vector<int> last(producers, -1);
+        std::atomic<int> outOfOrder(0);
+        std::atomic<int> started(0);
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < producers; p++)
+        {
+            threads.push_back(std::thread([&queue, &last, &outOfOrder, &started, p, perProducer]()
+                                          {
+                                              started.fetch_add(1);
+                                              for (int i = 0; i < perProducer; i++)
+                                              {
+                                                  queue.push(new FunctionCommand<void>([&last, &outOfOrder, p, i]()
+                                                                                       {
+                                                                                           if (last[p] != i - 1)
+                                                                                               outOfOrder.fetch_add(1);
+                                                                                           last[p] = i; }));
+                                              } }));
+        }
+
+        std::size_t applied = 0;
+        while (applied < (std::size_t)(producers * perProducer))
+            applied += queue.drain();
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+
+        CHECK(applied == (std::size_t)(producers * perProducer));
+        CHECK(queue.drain() == 0);
+        CHECK(outOfOrder.load() == 0);
+        for (int p = 0; p < producers; p++)
+            CHECK(last[p] == perProducer - 1);
+    }
+
+    SUBCASE("Queued changes wait for the next tick and run before it grows anything")
+    {
+        Inventory *inv = Inventory::getInstance();
+        LivingPlant *plant = new Herb();
+        plant->setMaturity(Seed::getID());
+        PlantGroup *root = inv->getInventory();
+
+        std::future<void> added = inv->submit<void>([root, plant]()
+                                                    { root->addComponent(plant); });
+        std::future<int> count = inv->submit<int>([root]()
+                                                  { return (int)root->getPlants()->size(); });
+        std::future<int> failed = inv->submit<int>([]() -> int
+                                                   { throw std::runtime_error("no such plant"); });
+        CHECK(root->getPlants()->empty());
+        CHECK(count.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+
+        inv->tick();
+        CHECK(added.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        CHECK(count.get() == 1);
+        CHECK_THROWS_AS(failed.get(), std::runtime_error);
+        CHECK(plant->getAge() == 1);
+        {
+            SnapshotReader snapshot(inv->getSnapshots());
+            CHECK(snapshot->getPlantCount() == 1);
+        }
+
+        CHECK(inv->applyCommands() == 0);
+        CHECK(inv->waitForCommand(inv->submit<int>([plant]()
+                                                   { return plant->getAge(); })) == 1);
+
+        // Commands still queued when the inventory goes away are dropped
+        std::future<void> dropped = inv->submit<void>([]() {});
+        delete Inventory::getInstance();
+        CHECK_THROWS_AS(dropped.get(), std::future_error);
+    }
+
+    SUBCASE("Facade threads submit while the ticker runs")
+    {
+        Inventory *inv = Inventory::getInstance();
+        Inventory::updateTickerPeriod(std::chrono::microseconds(100));
+        CHECK(Inventory::startTicker());
+
+        NurseryFacade facade;
+        std::vector<std::thread> threads;
+        std::atomic<int> created(0);
+        for (int t = 0; t < 4; t++)
+        {
+            threads.push_back(std::thread([&facade, &created]()
+                                          {
+                                              std::vector<std::future<PlantComponent *>> pending;
+                                              for (int i = 0; i < 25; i++)
+                                                  pending.push_back(facade.createPlantAsync("Cactus"));
+                                              for (size_t i = 0; i < pending.size(); i++)
+                                              {
+                                                  if (pending[i].get() != nullptr)
+                                                      created.fetch_add(1);
+                                              } }));
+        }
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+        CHECK(created.load() == 100);
+
+        PlantComponent *extra = facade.createPlant("Rose");
+        CHECK(extra != nullptr);
+        CHECK(facade.createPlant("Orchid") == nullptr);
+        CHECK(Inventory::stopTicker());
+        CHECK(inv->getInventory()->getPlants()->size() == 101);
+        CHECK(facade.getMenuString().size() == 101);
+
+        Inventory::updateTickerRate(2);
+        delete Inventory::getInstance();
+    }
+
+    SUBCASE("Observers, staff, customers and sales change between ticks")
+    {
+        Inventory *inv = Inventory::getInstance();
+        PlantGroup *root = inv->getInventory();
+        NurseryFacade facade;
+        for (int i = 0; i < 50; i++)
+            facade.createPlant(i % 2 == 0 ? "Rose" : "Cactus");
+        // The sales floor hands every purchase to a staff member
+        Staff *staff = facade.addStaff("Watcher");
+
+        Inventory::updateTickerPeriod(std::chrono::microseconds(100));
+        CHECK(Inventory::startTicker());
+
+        // Notifications walk the root's observer list while these threads change it
+        std::thread watcher([&facade, root, staff]()
+                            {
+                                for (int i = 0; i < 50; i++)
+                                {
+                                    facade.setAsObserver(staff, root);
+                                    facade.RemoveObserver(staff, root);
+                                } });
+        std::thread shopper([&facade]()
+                            {
+                                for (int i = 0; i < 10; i++)
+                                {
+                                    Customer *customer = facade.addCustomer("Shopper " + std::to_string(i));
+                                    facade.addToCustomerBasket(customer, facade.createPlant("Sunflower"));
+                                    facade.customerPurchaseAsync(customer).get();
+                                } });
+        watcher.join();
+        shopper.join();
+        CHECK(Inventory::stopTicker());
+
+        CHECK(inv->getCustomers()->size() == 10);
+        bool emptied = true;
+        for (size_t i = 0; i < inv->getCustomers()->size(); i++)
+            emptied = emptied && (*inv->getCustomers())[i]->getBasket() == nullptr;
+        CHECK(emptied);
+        CHECK(root->getObservers().empty());
+        CHECK(root->getPlants()->size() == 50);
+
+        Inventory::updateTickerRate(2);
+        delete Inventory::getInstance();
+    }
+}
+
+TEST_CASE("Testing Simulation - Tick statistics")
+{
+    SUBCASE("Latency histogram reports values to two significant digits")
+    {
+        LatencyHistogram histogram;
+        CHECK(histogram.getCount() == 0);
+        CHECK(histogram.getValueAtPercentile(50.0) == 0);
+
+        for (unsigned long long value = 1; value <= 1000; value++)
+            histogram.record(value * 1000);
+        CHECK(histogram.getCount() == 1000);
+        CHECK(histogram.getMin() == 1000);
+        CHECK(histogram.getMax() == 1000000);
+        CHECK(std::fabs(histogram.getMean() - 500500.0) < 1e-6);
+
+        unsigned long long median = histogram.getValueAtPercentile(50.0);
+        unsigned long long p99 = histogram.getValueAtPercentile(99.0);
+        CHECK(median >= 500000);
+        CHECK(median <= 505000);
+        CHECK(p99 >= 990000);
+        CHECK(p99 <= 1000000);
+        CHECK(histogram.getValueAtPercentile(100.0) == 1000000);
+
+        histogram.record(7);
+        CHECK(histogram.getMin() == 7);
+        CHECK(histogram.getValueAtPercentile(0.0) == 7);
+        histogram.record(LatencyHistogram::MAX_VALUE + 5);
+        CHECK(histogram.getMax() == LatencyHistogram::MAX_VALUE);
+
+        histogram.reset();
+        CHECK(histogram.getCount() == 0);
+        CHECK(histogram.getMax() == 0);
+    }
+
+    SUBCASE("Each tick records its work")
+    {
+        Inventory *inv = Inventory::getInstance();
+        inv->resetTickStats();
+        CountingObserver counter;
+        PlantGroup *bed = new PlantGroup();
+        bed->attach(&counter);
+        inv->getInventory()->addComponent(bed);
+
+        LivingPlant *seedling = new Herb();
+        seedling->setMaturity(Seed::getID());
+        seedling->setWaterLevel(30);
+        seedling->setSunExposure(80);
+        LivingPlant *mature = new Tree();
+        mature->setMaturity(Mature::getID());
+        mature->setWaterLevel(90);
+        mature->setSunExposure(30);
+        LivingPlant *dead = new Shrub();
+        dead->setMaturity(Dead::getID());
+        bed->addComponent(seedling);
+        bed->addComponent(mature);
+        bed->addComponent(dead);
+
+        inv->submit<void>([]() {});
+        inv->tick();
+
+        TickStats stats = inv->getTickStats();
+        CHECK(stats.getTickCount() == 1);
+        const TickRecord &last = stats.getLastTick();
+        CHECK(last.plantsVisited == 3);
+        CHECK(last.growCalls[GrowKernel::SEED] == 1);
+        CHECK(last.growCalls[GrowKernel::VEGETATIVE] == 0);
+        CHECK(last.growCalls[GrowKernel::MATURE] == 1);
+        CHECK(last.growCalls[GrowKernel::DEAD] == 1);
+        CHECK(last.waterNotifications == (unsigned long)counter.water);
+        CHECK(last.sunNotifications == (unsigned long)counter.sun);
+        CHECK(last.waterNotifications == 2);
+        CHECK(last.sunNotifications == 2);
+        CHECK(last.commandsApplied == 1);
+        CHECK(last.phaseNanos[static_cast<int>(TickPhase::Total)] >= last.phaseNanos[static_cast<int>(TickPhase::Growth)]);
+        CHECK(stats.getLatency(TickPhase::Total).getCount() == 1);
+
+        for (int day = 0; day < 9; day++)
+            inv->advanceDay();
+        stats = inv->getTickStats();
+        CHECK(stats.getTickCount() == 10);
+        CHECK(stats.getTotals().seasonChanges == 1);
+        CHECK(stats.getTotals().plantsVisited == 30);
+        CHECK(stats.getTotals().commandsApplied == 1);
+        CHECK(stats.getLatency(TickPhase::Commands).getCount() == 10);
+
+        inv->setEventDriven(true);
+        inv->resetTickStats();
+        inv->tick();
+        stats = inv->getTickStats();
+        CHECK(stats.getTickCount() == 1);
+        CHECK(stats.getLastTick().plantsVisited == inv->getTickScheduler()->getLastTickEvaluations());
+        inv->setEventDriven(false);
+
+        bed->detach(&counter);
+        delete Inventory::getInstance();
+    }
+}
+
+TEST_CASE("Testing Simulation - Nursery contexts")
+{
+    Inventory *defaultInventory = Inventory::getInstance();
+
+    SUBCASE("A bound context replaces the default instance on its thread only")
+    {
+        NurseryContext greenhouse;
+        Inventory *own = greenhouse.getInventory();
+        CHECK(own != defaultInventory);
+        CHECK(own->getStates(Seed::getID()) != defaultInventory->getStates(Seed::getID()));
+        CHECK(own->getPlantStates() != defaultInventory->getPlantStates());
+
+        {
+            NurseryContext::Scope scope(greenhouse);
+            CHECK(Inventory::getInstance() == own);
+
+            Inventory *seenElsewhere = nullptr;
+            std::thread other([&seenElsewhere]()
+                              { seenElsewhere = Inventory::getInstance(); });
+            other.join();
+            CHECK(seenElsewhere == defaultInventory);
+
+            NurseryContext nested;
+            {
+                NurseryContext::Scope inner(nested);
+                CHECK(Inventory::getInstance() == nested.getInventory());
+            }
+            CHECK(Inventory::getInstance() == own);
+        }
+        CHECK(Inventory::getInstance() == defaultInventory);
+    }
+
+    SUBCASE("Plants built in a context live and grow there")
+    {
+        NurseryContext greenhouse;
+        Inventory *own = greenhouse.getInventory();
+        LivingPlant *plant = nullptr;
+        greenhouse.run([&plant]()
+                       {
+                           plant = new Herb();
+                           plant->setMaturity(Seed::getID());
+                           plant->setWaterLevel(100);
+                           plant->setSunExposure(100);
+                           plant->setHealth(100);
+                           Inventory::getInstance()->getInventory()->addComponent(plant); });
+        CHECK(plant->getMaturityState() == own->getStates(Seed::getID()));
+        CHECK(defaultInventory->getInventory()->getPlants()->empty());
+
+        // Called through the pointer from an unbound thread, and on two tick threads
+        own->setTickThreads(2);
+        for (int day = 0; day < 8; day++)
+            own->advanceDay();
+        CHECK(plant->getAge() == 8);
+        CHECK(plant->getMaturityState() == own->getStates(Vegetative::getID()));
+        CHECK(own->getTickStats().getTickCount() == 8);
+        CHECK(defaultInventory->getTickStats().getTickCount() == 0);
+    }
+
+    SUBCASE("Composite counters stay with their own nursery")
+    {
+        NurseryContext greenhouse;
+        NurseryContext orchard;
+        Inventory *watched = greenhouse.getInventory();
+        Inventory *busy = orchard.getInventory();
+        CountingObserver counter;
+        PlantGroup *bed = nullptr;
+        greenhouse.run([&bed]()
+                       {
+                           bed = new PlantGroup();
+                           Inventory::getInstance()->getInventory()->addComponent(bed); });
+        orchard.run([&counter]()
+                    {
+                        PlantGroup *rows = new PlantGroup();
+                        rows->attach(&counter);
+                        Inventory::getInstance()->getInventory()->addComponent(rows);
+                        for (int i = 0; i < 10; i++)
+                        {
+                            LivingPlant *plant = new Tree();
+                            plant->setMaturity(Mature::getID());
+                            plant->setWaterLevel(10);
+                            rows->addComponent(plant);
+                        } });
+        CHECK(bed->getStateTable() == watched->getPlantStates());
+
+        watched->tick();
+        unsigned long version = watched->getPlantStates()->getStructureVersion();
+        unsigned long epoch = watched->getPlantStates()->getLevelsEpoch();
+        bed->getWaterValue();
+
+        // The orchard's notifications, edits and fast-forward leave the greenhouse alone
+        busy->tick();
+        busy->advanceDays(20);
+        orchard.run([]()
+                    { Inventory::getInstance()->getInventory()->addComponent(new PlantGroup()); });
+        CHECK(counter.water > 0);
+        CHECK(busy->getLastTick().waterNotifications > 0);
+        CHECK(watched->getPlantStates()->getStructureVersion() == version);
+        CHECK(watched->getPlantStates()->getLevelsEpoch() == epoch);
+
+        unsigned long water, sun, state;
+        watched->getPlantStates()->getNotificationCounts(water, sun, state);
+        CHECK(water == 0);
+        busy->getPlantStates()->getNotificationCounts(water, sun, state);
+        CHECK(water == (unsigned long)counter.water);
+
+        orchard.run([&counter]()
+                    {
+                        PlantGroup *rows = static_cast<PlantGroup *>(Inventory::getInstance()->getInventory()->getChildren()[0]);
+                        rows->detach(&counter); });
+    }
+
+    SUBCASE("Many nurseries run side by side, each on its own thread and ticker")
+    {
+        const int nurseries = 4;
+        std::vector<NurseryContext *> contexts;
+        for (int i = 0; i < nurseries; i++)
+            contexts.push_back(new NurseryContext());
+
+        std::vector<std::thread> threads;
+        std::vector<int> ages(nurseries, 0);
+        std::vector<size_t> menus(nurseries, 0);
+        for (int i = 0; i < nurseries; i++)
+        {
+            NurseryContext *context = contexts[i];
+            threads.push_back(std::thread([context, i, &ages, &menus]()
+                                          {
+                                              NurseryContext::Scope scope(*context);
+                                              NurseryFacade facade;
+                                              for (int p = 0; p < 20 + i; p++)
+                                                  facade.createPlant(p % 2 ? "Rose" : "Cactus");
+                                              for (int day = 0; day < 30; day++)
+                                                  Inventory::getInstance()->advanceDay();
+                                              ages[i] = static_cast<LivingPlant *>(facade.findPlant(0))->getAge();
+                                              menus[i] = facade.getMenuString().size(); }));
+        }
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+
+        for (int i = 0; i < nurseries; i++)
+        {
+            CHECK(ages[i] == 30);
+            CHECK(menus[i] == (size_t)(20 + i));
+            CHECK(contexts[i]->getInventory()->getInventory()->getPlants()->size() == (size_t)(20 + i));
+        }
+        CHECK(defaultInventory->getInventory()->getPlants()->empty());
+
+        // Each context's ticker binds that context on its own thread
+        for (int i = 0; i < 2; i++)
+        {
+            contexts[i]->getInventory()->getClock()->setPeriod(std::chrono::microseconds(0));
+            CHECK(contexts[i]->getInventory()->startTicking());
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            while (contexts[i]->getInventory()->getClock()->getTickCount() < 5)
+                std::this_thread::yield();
+        }
+        for (int i = 0; i < 2; i++)
+            CHECK(contexts[i]->getInventory()->stopTicking());
+        CHECK_FALSE(Inventory::getTicker()->isRunning());
+        CHECK(defaultInventory->getTickStats().getTickCount() == 0);
+
+        for (int i = 0; i < nurseries; i++)
+            delete contexts[i];
+    }
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing Simulation - Sharded nursery")
+{
+    SUBCASE("Groups are routed to the shard that owns them")
+    {
+        ShardCoordinator coordinator(2);
+        CHECK(coordinator.getShardCount() == 2);
+        CHECK(coordinator.getWorkerPid(0) != coordinator.getWorkerPid(1));
+        CHECK(coordinator.getWorkerPid(0) != getpid());
+        CHECK(coordinator.getShardFor(0) == 0);
+        CHECK(coordinator.getShardFor(3) == 1);
+
+        CHECK(coordinator.createPlants(0, "Rose", 10) == 10);
+        CHECK(coordinator.createPlants(1, "Cactus", 6) == 6);
+        CHECK(coordinator.createPlants(2, "Pine", 4) == 4);
+        CHECK(coordinator.createPlants(0, "Lavender", 2) == 2);
+
+        CHECK(coordinator.getCensus(0).plants == 12);
+        CHECK(coordinator.getCensus(1).plants == 6);
+        CHECK(coordinator.getCensus(3).groups == 0);
+
+        ShardCensus total = coordinator.getCensus();
+        CHECK(total.groups == 3);
+        CHECK(total.plants == 22);
+
+        // Nothing was built in this process
+        CHECK(Inventory::getInstance()->getInventory()->getPlants()->empty());
+
+        CHECK_THROWS_AS(coordinator.createPlants(1, "Triffid", 1), std::runtime_error);
+        CHECK_THROWS_AS(coordinator.waterGroup(5), std::runtime_error);
+        coordinator.waterGroup(1);
+        CHECK(coordinator.getCensus().plants == 22);
+    }
+
+    SUBCASE("A sharded run matches the same nursery in one inventory")
+    {
+        const char *types[] = {"Rose", "Cactus", "Sunflower", "Maple"};
+        const int days = 40;
+
+        ShardCoordinator coordinator(3);
+        coordinator.setAutoReap(true);
+        for (std::uint32_t group = 0; group < 4; group++)
+            coordinator.createPlants(group, types[group], 15);
+
+        NurseryContext reference;
+        Inventory *single = reference.getInventory();
+        reference.run([&types, single]()
+                      {
+                          for (int group = 0; group < 4; group++)
+                          {
+                              Builder *builder = nullptr;
+                              if (group == 0)
+                                  builder = new RoseBuilder();
+                              else if (group == 1)
+                                  builder = new CactusBuilder();
+                              else if (group == 2)
+                                  builder = new SunflowerBuilder();
+                              else
+                                  builder = new MapleBuilder();
+                              PlantGroup *plants = new PlantGroup(types[group]);
+                              single->getInventory()->addComponent(plants);
+                              Director director(builder);
+                              director.construct();
+                              for (int i = 0; i < 15; i++)
+                                  plants->addComponent(director.getPlant());
+                              delete builder;
+                          } });
+        single->setAutoReap(true);
+
+        CHECK(coordinator.getSeasonId() == single->getSeasonId());
+        for (int day = 0; day < days; day++)
+            single->advanceDay();
+        coordinator.advanceDays(days);
+        CHECK(coordinator.getSeasonId() == single->getSeasonId());
+
+        ShardCensus total = coordinator.getCensus();
+        CHECK(total.plants + total.archived == 60);
+        CHECK(total.archived == single->getArchive()->size());
+        CHECK(coordinator.getReapedCount() == single->getArchive()->size());
+        for (int id = 0; id < 4; id++)
+        {
+            unsigned long expected = 0;
+            for (PlantComponent *group : *single->getInventory()->getPlants())
+            {
+                for (PlantComponent *plant : *static_cast<PlantGroup *>(group)->getPlants())
+                {
+                    if (static_cast<LivingPlant *>(plant)->getMaturityState() == single->getStates(id))
+                        expected++;
+                }
+            }
+            CHECK(total.byState[id] == expected);
+        }
+
+        // Counters add up to what one inventory did; the clock is shared
+        TickStats combined = coordinator.getTickStats();
+        TickStats alone = single->getTickStats();
+        CHECK(combined.getTickCount() == static_cast<unsigned long>(days));
+        CHECK(combined.getTotals().seasonChanges == alone.getTotals().seasonChanges);
+        CHECK(combined.getTotals().plantsVisited == alone.getTotals().plantsVisited);
+        for (int code = 0; code < GROW_COUNTER_COUNT; code++)
+            CHECK(combined.getTotals().growCalls[code] == alone.getTotals().growCalls[code]);
+        CHECK(coordinator.getDayLatency().getCount() == static_cast<unsigned long long>(days));
+        CHECK(coordinator.getDayLatency().getMin() >= combined.getLatency(TickPhase::Total).getMin());
+    }
+}
+
+TEST_CASE("Testing Simulation - Inventory images")
+{
+    const std::string path = "inventory_image_test.bin";
+
+    NurseryContext original;
+    Inventory *source = original.getInventory();
+    source->setSnapshotPublishing(false);
+    original.run([source]()
+                 {
+                     PlantGroup *roses = new PlantGroup("Roses");
+                     PlantGroup *cacti = new PlantGroup("Cacti");
+                     source->getInventory()->addComponent(roses);
+                     roses->addComponent(cacti);
+
+                     RoseBuilder roseBuilder;
+                     Director roseDirector(&roseBuilder);
+                     roseDirector.construct();
+                     for (int i = 0; i < 3; i++)
+                         roses->addComponent(roseDirector.getPlant());
+
+                     CactusBuilder cactusBuilder;
+                     Director cactusDirector(&cactusBuilder);
+                     cactusDirector.construct();
+                     for (int i = 0; i < 2; i++)
+                         cacti->addComponent(cactusDirector.getPlant());
+
+                     LivingPlant *aloe = new Succulent("Aloe");
+                     aloe->setMaturity(Mature::getID());
+                     aloe->setWaterStrategy(LowWater::getID());
+                     aloe->setSunStrategy(HighSun::getID());
+                     aloe->setSeason(SeasonId::Winter);
+                     aloe->setAge(40);
+                     aloe->setHealth(70);
+                     aloe->setWaterLevel(55);
+                     aloe->setSunExposure(65);
+                     aloe->addAttribute(new RedPot());
+                     source->getInventory()->addComponent(aloe);
+
+                     CountingObserver *outsider = new CountingObserver();
+                     Staff *sam = new Staff("Sam");
+                     source->addStaff(sam);
+                     cacti->attach(sam);
+                     cacti->attach(outsider);
+                     cacti->detach(outsider);
+                     delete outsider;
+
+                     Customer *casey = new Customer("Casey");
+                     source->addCustomer(casey);
+                     casey->addPlant(roseDirector.getPlant());
+                     source->addCustomer(new Customer("Browsing")); });
+    for (int day = 0; day < 11; day++)
+        source->advanceDay();
+
+    std::string error;
+    REQUIRE(InventoryImage::save(source, path, error));
+    CHECK(error.empty());
+
+    SUBCASE("Loading restores plants, decorators, groups, people and the season")
+    {
+        NurseryContext restored;
+        Inventory *target = restored.getInventory();
+        target->setSnapshotPublishing(false);
+        REQUIRE(InventoryImage::load(target, path, error));
+
+        CHECK(describeGroup(target->getInventory()) == describeGroup(source->getInventory()));
+        CHECK(target->getSeasonId() == source->getSeasonId());
+        REQUIRE(target->getStaff()->size() == 1);
+        CHECK(target->getStaff()->at(0)->getName() == "Sam");
+        REQUIRE(target->getCustomers()->size() == 2);
+        CHECK(target->getCustomers()->at(0)->getName() == "Casey");
+        REQUIRE(target->getCustomers()->at(0)->getBasket() != nullptr);
+        CHECK(describeGroup(target->getCustomers()->at(0)->getBasket()) == describeGroup(source->getCustomers()->at(0)->getBasket()));
+        CHECK(target->getCustomers()->at(1)->getBasket() == nullptr);
+
+        // Restored plants live in the target context, and both nurseries keep the same schedule
+        PlantComponent *first = target->getInventory()->getPlants()->front();
+        PlantGroup *roses = static_cast<PlantGroup *>(first);
+        REQUIRE(roses->getObservers().size() == 0);
+        PlantGroup *cacti = static_cast<PlantGroup *>(roses->getPlants()->front());
+        REQUIRE(cacti->getObservers().size() == 1);
+        CHECK(cacti->getObservers().front() == target->getStaff()->at(0));
+
+        for (int day = 0; day < 10; day++)
+        {
+            source->advanceDay();
+            target->advanceDay();
+        }
+        CHECK(target->getSeasonId() == source->getSeasonId());
+        CHECK(describeGroup(target->getInventory()) == describeGroup(source->getInventory()));
+    }
+
+    SUBCASE("Bad files are rejected before anything is built")
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+
+        const std::string badPath = "inventory_image_bad.bin";
+        std::string truncated = bytes.substr(0, bytes.size() - 16);
+        std::string wrongVersion = bytes;
+        wrongVersion[8] = static_cast<char>(InventoryImage::VERSION + 1);
+        std::string wrongMagic = bytes;
+        wrongMagic[0] = 'X';
+        std::string badChild = bytes;
+        // Point the last stored child reference past the end of the plant table
+        std::uint64_t childOffset, childCount;
+        std::memcpy(&childOffset, &bytes[32 + 5 * 16], sizeof(childOffset));
+        std::memcpy(&childCount, &bytes[32 + 5 * 16 + 8], sizeof(childCount));
+        REQUIRE(childCount > 0);
+        std::uint32_t missingPlant = 100000;
+        std::memcpy(&badChild[childOffset + (childCount - 1) * 4], &missingPlant, sizeof(missingPlant));
+
+        // Header fields after magic, version, header size and file size: season, then days into it
+        std::string noSeason = bytes;
+        std::uint32_t none = static_cast<std::uint32_t>(SeasonId::None);
+        std::memcpy(&noSeason[24], &none, sizeof(none));
+        std::string otherSeason = bytes;
+        std::uint32_t other = static_cast<std::uint32_t>(SeasonId::Other);
+        std::memcpy(&otherSeason[24], &other, sizeof(other));
+        std::string longSeason = bytes;
+        std::int32_t ticks = 100;
+        std::memcpy(&longSeason[28], &ticks, sizeof(ticks));
+        std::string negativeSeason = bytes;
+        ticks = -1;
+        std::memcpy(&negativeSeason[28], &ticks, sizeof(ticks));
+
+        std::vector<std::string> variants = {truncated, wrongVersion, wrongMagic, badChild,
+                                             noSeason, otherSeason, longSeason, negativeSeason};
+        for (std::size_t i = 0; i < variants.size(); i++)
+        {
+            std::ofstream out(badPath.c_str(), std::ios::binary);
+            out.write(variants[i].data(), variants[i].size());
+            out.close();
+
+            NurseryContext target;
+            error.clear();
+            CHECK_FALSE(InventoryImage::load(target.getInventory(), badPath, error));
+            CHECK_FALSE(error.empty());
+            CHECK(target.getInventory()->getInventory()->getPlants()->empty());
+            CHECK(target.getInventory()->getStaff()->empty());
+        }
+        std::remove(badPath.c_str());
+
+        NurseryContext target;
+        CHECK_FALSE(InventoryImage::load(target.getInventory(), "no_such_inventory_image.bin", error));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Testing Simulation - Inventory journal")
+{
+    const std::string directory = "inventory_journal_test";
+    removeDirectory(directory);
+    std::string error;
+
+    SUBCASE("Reopening replays every facade change on top of the base image")
+    {
+        std::string before;
+        {
+            NurseryContext context;
+            NurseryContext::Scope scope(context);
+            NurseryFacade facade;
+            REQUIRE(facade.openJournal(directory, error));
+            CHECK(facade.getJournal()->getGeneration() == 1);
+
+            PlantGroup *beds = facade.createPlantGroup("Beds");
+            facade.addComponentToGroup(facade.getInventoryRoot(), beds);
+            PlantComponent *rose = facade.createPlant("Rose");
+            PlantComponent *cactus = facade.createPlant("Cactus");
+            PlantComponent *pine = facade.createPlant("Pine");
+            facade.createPlant("Lavender");
+
+            // Moving a plant between groups is a removal followed by an add
+            facade.removeComponentFromInventory(cactus);
+            facade.addComponentToGroup(beds, cactus);
+
+            Staff *sam = facade.addStaff("Sam");
+            Staff *alex = facade.addStaff("Alex");
+            facade.setAsObserver(sam, beds);
+            facade.setAsObserver(alex, beds);
+            facade.RemoveObserver(alex, beds);
+
+            Customer *casey = facade.addCustomer("Casey");
+            Customer *drew = facade.addCustomer("Drew");
+            facade.addToCustomerBasket(casey, rose);
+            facade.addToCustomerBasket(drew, pine);
+            facade.customerPurchase(drew);
+
+            REQUIRE(facade.compactJournal(error));
+            CHECK(facade.getJournal()->getGeneration() == 2);
+
+            // Changes after the compaction land in the new journal
+            PlantComponent *maple = facade.createPlant("Maple");
+            PlantComponent *sunflower = facade.createPlant("Sunflower");
+            facade.removeComponentFromInventory(sunflower);
+            facade.addComponentToGroup(beds, sunflower);
+            facade.addToCustomerBasket(casey, maple);
+            facade.removeFromCustomer(casey, 0);
+
+            before = describeNursery(context.getInventory());
+        }
+
+        CHECK(listDirectory(directory) == std::vector<std::string>({"base-2.img", "journal-2.log"}));
+
+        for (int restart = 0; restart < 2; restart++)
+        {
+            NurseryContext context;
+            NurseryContext::Scope scope(context);
+            NurseryFacade facade;
+            REQUIRE(facade.openJournal(directory, error));
+            CHECK(facade.getJournal()->getGeneration() == static_cast<unsigned int>(3 + restart));
+            CHECK(describeNursery(context.getInventory()) == before);
+
+            // Recovered customers can still buy through the new facade
+            Customer *casey = facade.addCustomer("Casey");
+            REQUIRE(casey->getBasket() != nullptr);
+            CHECK(facade.getCustomerBasketString(casey) == std::vector<std::string>({"Maple Tree"}));
+        }
+        CHECK(listDirectory(directory) == std::vector<std::string>({"base-4.img", "journal-4.log"}));
+    }
+
+    SUBCASE("Bursts of changes share a few syncs")
+    {
+        NurseryContext context;
+        NurseryContext::Scope scope(context);
+        Inventory *inventory = context.getInventory();
+        inventory->setSnapshotPublishing(false);
+        NurseryFacade facade;
+        REQUIRE(facade.openJournal(directory, error));
+        InventoryJournal *journal = facade.getJournal();
+        journal->setFlushInterval(std::chrono::milliseconds(50));
+
+        const int burst = 2000;
+        for (int i = 0; i < burst; i++)
+            facade.createPlantAsync("Cactus");
+        inventory->applyCommands();
+        REQUIRE(journal->sync());
+        CHECK(journal->getAppendedCount() == static_cast<std::uint64_t>(burst));
+        CHECK(journal->getSyncCount() < 20);
+
+        // Waiting callers on several threads are committed together
+        std::uint64_t syncsBefore = journal->getSyncCount();
+        const int threads = 4;
+        const int perThread = 50;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            workers.push_back(std::thread([&context, &facade]()
+                                          {
+                                              NurseryContext::Scope workerScope(context);
+                                              for (int i = 0; i < perThread; i++)
+                                                  facade.createPlant("Rose"); }));
+        }
+        for (std::size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+
+        CHECK(journal->getAppendedCount() == static_cast<std::uint64_t>(burst + threads * perThread));
+        CHECK(journal->getSyncCount() - syncsBefore < static_cast<std::uint64_t>(threads * perThread));
+        CHECK(inventory->getInventory()->getPlants()->size() == static_cast<std::size_t>(burst + threads * perThread));
+    }
+
+    SUBCASE("A record torn by a crash is dropped with everything after it")
+    {
+        {
+            NurseryContext context;
+            NurseryContext::Scope scope(context);
+            NurseryFacade facade;
+            REQUIRE(facade.openJournal(directory, error));
+            facade.createPlant("Rose");
+            facade.createPlant("Pine");
+            facade.createPlant("Cactus");
+        }
+
+        // Cut the last record short, as a crash in the middle of a write would
+        const std::string path = directory + "/journal-1.log";
+        std::ifstream in(path.c_str(), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), bytes.size() - 3);
+        out.close();
+
+        InventoryJournal reader;
+        REQUIRE(reader.open(directory, error));
+        REQUIRE(reader.getRecovered().size() == 2);
+        CHECK(reader.getRecovered()[0].op == JournalOp::CreatePlant);
+        CHECK(reader.getRecovered()[1].text == "Pine");
+        reader.close();
+
+        NurseryContext context;
+        NurseryContext::Scope scope(context);
+        NurseryFacade facade;
+        REQUIRE(facade.openJournal(directory, error));
+        CHECK(facade.getMenuString() == std::vector<std::string>({"Rose", "Pine Tree"}));
+    }
+
+    SUBCASE("A failed write is reported until the journal is compacted")
+    {
+        NurseryContext context;
+        NurseryContext::Scope scope(context);
+        NurseryFacade facade;
+        REQUIRE(facade.openJournal(directory, error));
+        facade.createPlant("Rose");
+        CHECK_FALSE(facade.getJournal()->isFailed());
+
+        // Cap file sizes at what is already written, so the next batch cannot be written even as root
+        struct stat info;
+        REQUIRE(stat((directory + "/journal-1.log").c_str(), &info) == 0);
+        struct rlimit limit, capped;
+        REQUIRE(getrlimit(RLIMIT_FSIZE, &limit) == 0);
+        capped = limit;
+        capped.rlim_cur = static_cast<rlim_t>(info.st_size);
+        void (*previous)(int) = signal(SIGXFSZ, SIG_IGN);
+        REQUIRE(setrlimit(RLIMIT_FSIZE, &capped) == 0);
+
+        CHECK_THROWS_AS(facade.createPlant("Pine"), std::runtime_error);
+        CHECK(facade.getJournal()->isFailed());
+        CHECK_FALSE(facade.getJournal()->getFailure().empty());
+        // Later changes are made in memory but still reported as not journaled
+        CHECK_THROWS_AS(facade.addStaff("Sam"), std::runtime_error);
+        CHECK(context.getInventory()->getStaff()->size() == 1);
+
+        setrlimit(RLIMIT_FSIZE, &limit);
+        signal(SIGXFSZ, previous);
+
+        // A new base image holds everything the failed journal lost
+        REQUIRE(facade.compactJournal(error));
+        CHECK_FALSE(facade.getJournal()->isFailed());
+        CHECK(facade.getJournal()->getFailure().empty());
+        facade.createPlant("Cactus");
+        facade.closeJournal();
+
+        NurseryContext reopened;
+        NurseryContext::Scope reopenedScope(reopened);
+        NurseryFacade recovered;
+        REQUIRE(recovered.openJournal(directory, error));
+        CHECK(recovered.getMenuString() == std::vector<std::string>({"Rose", "Pine Tree", "Cactus"}));
+        CHECK(reopened.getInventory()->getStaff()->size() == 1);
+    }
+
+    SUBCASE("A directory that is not a journal is rejected")
+    {
+        REQUIRE(mkdir(directory.c_str(), 0755) == 0);
+        std::ofstream out((directory + "/journal-1.log").c_str());
+        out << "not a journal";
+        out.close();
+
+        NurseryContext context;
+        NurseryContext::Scope scope(context);
+        NurseryFacade facade;
+        CHECK_FALSE(facade.openJournal(directory, error));
+        CHECK_FALSE(error.empty());
+        CHECK(facade.getJournal() == nullptr);
+    }
+
+    removeDirectory(directory);
+}
+
+TEST_CASE("Testing Simulation - Fast random")
+{
+    SUBCASE("A seed fixes the sequence")
+    {
+        FastRandom first(42);
+        FastRandom second(42);
+        FastRandom other(43);
+        bool differs = false;
+        for (int i = 0; i < 100; i++)
+        {
+            std::uint64_t value = first.next();
+            CHECK(value == second.next());
+            differs = differs || value != other.next();
+        }
+        CHECK(differs);
+
+        first.seed(7);
+        second.seed(7);
+        CHECK(first.next() == second.next());
+    }
+
+    SUBCASE("Bounded draws stay in range and cover it evenly")
+    {
+        FastRandom random(1);
+        const std::uint32_t bound = 6;
+        const int draws = 60000;
+        int counts[bound] = {};
+        bool inRange = true;
+        for (int i = 0; i < draws; i++)
+        {
+            std::uint32_t value = random.below(bound);
+            inRange = inRange && value < bound;
+            if (value < bound)
+                counts[value]++;
+        }
+        CHECK(inRange);
+        for (std::uint32_t value = 0; value < bound; value++)
+        {
+            CHECK(counts[value] > draws / 6 - 500);
+            CHECK(counts[value] < draws / 6 + 500);
+        }
+        CHECK(random.below(1) == 0);
+    }
+
+    SUBCASE("Each thread has its own generator")
+    {
+        FastRandom::seedThread(5);
+        std::uint64_t expected = FastRandom(5).next();
+
+        // Another thread drawing, or reseeding its own generator, does not touch this one
+        std::uint64_t fromThread = 0;
+        std::thread other([&fromThread]()
+                          {
+                              FastRandom::seedThread(5);
+                              fromThread = FastRandom::local().next();
+                              FastRandom::seedThread(99); });
+        other.join();
+
+        CHECK(fromThread == expected);
+        CHECK(FastRandom::local().next() == expected);
+    }
+
+    SUBCASE("Seeded staff picks and suggestions repeat")
+    {
+        NurseryContext context;
+        NurseryContext::Scope scope(context);
+        Inventory *inventory = context.getInventory();
+        inventory->setSnapshotPublishing(false);
+        for (int i = 0; i < 4; i++)
+            inventory->addStaff(new Staff("Staff " + std::to_string(i)));
+
+        RoseBuilder roseBuilder;
+        Director roseDirector(&roseBuilder);
+        CactusBuilder cactusBuilder;
+        Director cactusDirector(&cactusBuilder);
+        roseDirector.construct();
+        cactusDirector.construct();
+        for (int i = 0; i < 5; i++)
+        {
+            inventory->getInventory()->addComponent(roseDirector.getPlant());
+            inventory->getInventory()->addComponent(cactusDirector.getPlant());
+        }
+
+        SuggestionFloor floor;
+        std::vector<std::string> first;
+        FastRandom::seedThread(2024);
+        for (int i = 0; i < 10; i++)
+            first.push_back(floor.getAssistance(nullptr));
+
+        std::vector<std::string> second;
+        FastRandom::seedThread(2024);
+        for (int i = 0; i < 10; i++)
+            second.push_back(floor.getAssistance(nullptr));
+
+        CHECK(first == second);
+        // Within one second std::srand(time) used to make every suggestion the same
+        CHECK(std::count(first.begin(), first.end(), first[0]) < 10);
+    }
+}
+
+TEST_CASE("Testing Simulation - Simulation clock")
+{
+    SUBCASE("As-fast-as-possible mode ticks back to back")
+    {
+        SimulationClock clock(std::chrono::microseconds(0));
+        std::atomic<int> ticks(0);
+
+        CHECK(clock.start([&ticks]()
+                          { ticks.fetch_add(1); }));
+        CHECK_FALSE(clock.start([]() {}));
+        while (ticks.load() < 1000)
+            std::this_thread::yield();
+        CHECK(clock.stop());
+        CHECK_FALSE(clock.stop());
+        CHECK(clock.getTickCount() == (unsigned long)ticks.load());
+    }
+
+    SUBCASE("Stopping does not wait out a long period")
+    {
+        SimulationClock clock(std::chrono::seconds(30));
+        std::atomic<int> ticks(0);
+        clock.start([&ticks]()
+                    { ticks.fetch_add(1); });
+        while (ticks.load() < 1)
+            std::this_thread::yield();
+
+        SimulationClock::Clock::time_point before = SimulationClock::Clock::now();
+        clock.stop();
+        CHECK(SimulationClock::Clock::now() - before < std::chrono::seconds(1));
+        CHECK(ticks.load() == 1);
+    }
+
+    SUBCASE("A rate change wakes a waiting clock")
+    {
+        SimulationClock clock(std::chrono::seconds(30));
+        std::atomic<int> ticks(0);
+        clock.start([&ticks]()
+                    { ticks.fetch_add(1); });
+        while (ticks.load() < 1)
+            std::this_thread::yield();
+
+        clock.setPeriod(std::chrono::microseconds(500));
+        CHECK(clock.getPeriod() == std::chrono::microseconds(500));
+        SimulationClock::Clock::time_point limit = SimulationClock::Clock::now() + std::chrono::seconds(5);
+        while (ticks.load() < 20 && SimulationClock::Clock::now() < limit)
+            std::this_thread::yield();
+        clock.stop();
+        CHECK(ticks.load() >= 20);
+    }
+
+    SUBCASE("Skip drops the slots an overrunning tick missed")
+    {
+        SimulationClock clock(std::chrono::milliseconds(1));
+        clock.setCatchUpPolicy(CatchUpPolicy::Skip);
+        CHECK(clock.getCatchUpPolicy() == CatchUpPolicy::Skip);
+
+        std::atomic<int> ticks(0);
+        clock.start([&ticks]()
+                    {
+                        if (ticks.fetch_add(1) == 0)
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20)); });
+        while (ticks.load() < 3)
+            std::this_thread::yield();
+        clock.stop();
+        CHECK(clock.getSkippedTicks() >= 10);
+    }
+
+    SUBCASE("A tick may stop its own clock")
+    {
+        SimulationClock clock(std::chrono::microseconds(0));
+        std::atomic<int> ticks(0);
+        clock.start([&clock, &ticks]()
+                    {
+                        ticks.fetch_add(1);
+                        clock.stop(); });
+        while (clock.isRunning())
+            std::this_thread::yield();
+        CHECK(ticks.load() == 1);
+
+        // Restarting joins the finished thread first
+        CHECK(clock.start([]() {}));
+        clock.stop();
+    }
+}
+
+TEST_CASE("Testing Simulation - Inventory ticker")
+{
+    Inventory *inv = Inventory::getInstance();
+    LivingPlant *plant = new Herb();
+    plant->setMaturity(Dead::getID());
+    inv->getInventory()->addComponent(plant);
+    unsigned long before = Inventory::getTicker()->getTickCount();
+
+    Inventory::updateTickerPeriod(std::chrono::microseconds(0));
+    CHECK(Inventory::startTicker());
+    CHECK_FALSE(Inventory::startTicker());
+    while (Inventory::getTicker()->getTickCount() < 20)
+        std::this_thread::yield();
+    CHECK(Inventory::stopTicker());
+    CHECK_FALSE(Inventory::stopTicker());
+    CHECK((unsigned long)plant->getAge() == Inventory::getTicker()->getTickCount() - before);
+
+    Inventory::updateTickerRate(2);
+    CHECK(Inventory::getTicker()->getPeriod() == std::chrono::seconds(2));
+    delete Inventory::getInstance();
+}
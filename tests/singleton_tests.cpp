@@ -11,6 +11,9 @@
 #include "strategy/MidSun.h"
 #include "state/Seed.h"
 #include "state/Vegetative.h"
+#include "state/Mature.h"
+#include "composite/PlantGroup.h"
+#include <vector>
 
 TEST_CASE("Testing Singleton Pattern - Basic Instance")
 {
@@ -345,3 +348,68 @@ TEST_CASE("Testing Singleton Pattern - Memory Efficiency Verification")
     delete Inventory::getInstance();
 }
 
+
+TEST_CASE("Testing Singleton Pattern - Table sweep tick")
+{
+    SUBCASE("Inventory tick matches ticking the composite plant by plant")
+    {
+        Inventory *inv = Inventory::getInstance();
+        PlantGroup *reference = new PlantGroup();
+        PlantGroup *nested = new PlantGroup();
+        inv->getInventory()->addComponent(nested);
+
+        int ids[] = {Seed::getID(), Seed::getID(), Vegetative::getID(), Mature::getID()};
+        std::vector<LivingPlant *> swept;
+        std::vector<LivingPlant *> stepped;
+        for (int i = 0; i < 4; i++)
+        {
+            LivingPlant *plant = (i % 2 == 0) ? (LivingPlant *)new Tree() : (LivingPlant *)new Shrub();
+            plant->setMaturity(ids[i]);
+            plant->setAge(i * 10 + 5);
+            plant->setHealth(55 + i * 5);
+            plant->setWaterLevel(90 - i * 10);
+            plant->setSunExposure(70);
+            plant->setSeason(inv->getString(i % 2 == 0 ? "Summer Season" : "Winter Season"));
+
+            LivingPlant *copy = static_cast<LivingPlant *>(plant->clone());
+            (i < 2 ? inv->getInventory() : nested)->addComponent(plant);
+            reference->addComponent(copy);
+            swept.push_back(plant);
+            stepped.push_back(copy);
+        }
+
+        for (int day = 0; day < 40; day++)
+        {
+            inv->tick();
+            reference->tick();
+            if (day % 8 == 7)
+                inv->changeSeason();
+        }
+
+        for (size_t i = 0; i < swept.size(); i++)
+        {
+            CHECK(swept[i]->getAge() == stepped[i]->getAge());
+            CHECK(swept[i]->getHealth() == stepped[i]->getHealth());
+            CHECK(swept[i]->getWaterLevel() == stepped[i]->getWaterLevel());
+            CHECK(swept[i]->getSunExposure() == stepped[i]->getSunExposure());
+            CHECK(swept[i]->getMaturityState() == stepped[i]->getMaturityState());
+        }
+
+        delete reference;
+        delete Inventory::getInstance();
+    }
+
+    SUBCASE("Plants outside the inventory are not grown")
+    {
+        Inventory *inv = Inventory::getInstance();
+        LivingPlant *loose = new Tree();
+        loose->setMaturity(Seed::getID());
+        loose->setAge(3);
+
+        inv->tick();
+        CHECK(loose->getAge() == 3);
+
+        delete loose;
+        delete Inventory::getInstance();
+    }
+}
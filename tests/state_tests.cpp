@@ -10,6 +10,7 @@
 #include "state/Mature.h"
 #include "state/Dead.h"
 #include "state/MaturityState.h"
+#include "state/GrowKernel.h"
 #include "observer/Subject.h"
 #include "observer/Observer.h"
 #include <vector>
@@ -560,6 +561,182 @@ TEST_CASE("Testing State Transitions - Large Scale")
     delete Inventory::getInstance();
 }
 
+TEST_CASE("Testing State Transitions - Grow Kernel Matches grow()")
+{
+    Inventory *inv = Inventory::getInstance();
+    LivingPlant *reference = new Tree();
+
+    const int ages[] = {0, 6, 7, 29, 30, 119, 120};
+    const int healths[] = {0, 1, 49, 50, 59, 60, 100};
+    const int waters[] = {0, 1, 3, 30, 31, 40, 42, 50, 52, 100};
+    const int suns[] = {0, 19, 20, 30, 40, 50, 100};
+    const int stateIds[] = {Seed::getID(), Vegetative::getID(), Mature::getID(), Dead::getID()};
+    const int codeFor[] = {GrowKernel::SEED, GrowKernel::VEGETATIVE, GrowKernel::MATURE, GrowKernel::DEAD};
+
+    Flyweight<std::string *> *plantSeasons[] = {nullptr, inv->getString("Spring Season"), inv->getString("Summer Season"),
+                                                inv->getString("Autumn Season"), inv->getString("Winter Season")};
+    GrowKernel::Backend backends[] = {GrowKernel::Backend::Scalar, GrowKernel::Backend::Sse2, GrowKernel::Backend::Avx2};
+    GrowKernel::Backend original = GrowKernel::getBackend();
+
+    bool identical = true;
+    for (int seasonChange = 0; seasonChange < 4; seasonChange++)
+    {
+        for (int p = 0; p < 5; p++)
+        {
+            reference->setSeason(plantSeasons[p]);
+
+            std::vector<int> age, health, water, sun, code, usage;
+            std::vector<int> expectAge, expectHealth, expectWater, expectSun, expectCode;
+
+            for (int s = 0; s < 4; s++)
+                for (int a = 0; a < 7; a++)
+                    for (int h = 0; h < 7; h++)
+                        for (int w = 0; w < 10; w++)
+                            for (int u = 0; u < 7; u++)
+                            {
+                                age.push_back(ages[a]);
+                                health.push_back(healths[h]);
+                                water.push_back(waters[w]);
+                                sun.push_back(suns[u]);
+                                code.push_back(codeFor[s]);
+                                usage.push_back(GrowKernel::waterUsage(codeFor[s], inv->getSeasonId(), reference->getSeasonId()));
+
+                                reference->setAge(ages[a]);
+                                reference->setHealth(healths[h]);
+                                reference->setWaterLevel(waters[w]);
+                                reference->setSunExposure(suns[u]);
+                                reference->setMaturity(stateIds[s]);
+                                reference->getMaturityState()->getState()->grow(reference);
+
+                                expectAge.push_back(reference->getAge());
+                                expectHealth.push_back(reference->getHealth());
+                                expectWater.push_back(reference->getWaterLevel());
+                                expectSun.push_back(reference->getSunExposure());
+                                int after = GrowKernel::SKIP;
+                                for (int k = 0; k < 4; k++)
+                                    if (reference->getMaturityState() == inv->getStates(stateIds[k]))
+                                        after = codeFor[k];
+                                expectCode.push_back(after);
+                            }
+
+            for (int b = 0; b < 3; b++)
+            {
+                if (!GrowKernel::isSupported(backends[b]))
+                    continue;
+                GrowKernel::setBackend(backends[b]);
+
+                std::vector<int> a2(age), h2(health), w2(water), s2(sun), c2(code);
+                GrowKernel::grow(&a2[0], &h2[0], &w2[0], &s2[0], &c2[0], &usage[0], a2.size());
+                identical = identical && a2 == expectAge && h2 == expectHealth && w2 == expectWater &&
+                            s2 == expectSun && c2 == expectCode;
+            }
+        }
+        inv->changeSeason();
+    }
+    CHECK(identical);
+
+    SUBCASE("Skipped lanes are left untouched")
+    {
+        int a[9] = {5, 5, 5, 5, 5, 5, 5, 5, 5};
+        int h[9] = {50, 50, 50, 50, 50, 50, 50, 50, 50};
+        int w[9] = {60, 60, 60, 60, 60, 60, 60, 60, 60};
+        int s[9] = {60, 60, 60, 60, 60, 60, 60, 60, 60};
+        int c[9] = {GrowKernel::SKIP, GrowKernel::SEED, GrowKernel::SKIP, GrowKernel::SKIP, GrowKernel::SKIP,
+                    GrowKernel::SKIP, GrowKernel::SKIP, GrowKernel::SKIP, GrowKernel::SEED};
+        int usage[9] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+        GrowKernel::grow(a, h, w, s, c, usage, 9);
+
+        CHECK(a[0] == 5);
+        CHECK(w[0] == 60);
+        CHECK(a[1] == 6);
+        CHECK(w[1] == 59);
+        CHECK(h[1] == 51);
+        CHECK(a[8] == 6);
+    }
+
+    GrowKernel::setBackend(original);
+    delete reference;
+    delete Inventory::getInstance();
+}
+
+TEST_CASE("Testing State Transitions - Season IDs")
+{
+    Inventory *inv = Inventory::getInstance();
+
+    SUBCASE("Usage table holds the season multipliers grow() applied to strings")
+    {
+        const double base[] = {1.0, 2.0, 3.0, 0.0};
+        const char *names[] = {nullptr, "Spring Season", "Summer Season", "Autumn Season", "Winter Season", "Monsoon"};
+
+        bool matches = true;
+        for (int state = 0; state < 4; state++)
+            for (int current = 1; current < SEASON_ID_COUNT; current++)
+                for (int plant = 0; plant < SEASON_ID_COUNT; plant++)
+                {
+                    double usage = base[state];
+                    if (names[plant] != nullptr && std::string(names[current]) != names[plant])
+                    {
+                        std::string season = names[current];
+                        if (season == "Spring Season")
+                            usage *= 0.9;
+                        else if (season == "Summer Season")
+                            usage *= 1.3;
+                        else if (season == "Autumn Season")
+                            usage *= 1.0;
+                        else if (season == "Winter Season")
+                            usage *= 0.8;
+                    }
+                    matches = matches && usage == seasonalWaterUsage(state, static_cast<SeasonId>(current), static_cast<SeasonId>(plant));
+                }
+        CHECK(matches);
+    }
+
+    SUBCASE("Inventory season ID and flyweight stay in step")
+    {
+        CHECK(inv->getSeasonId() == SeasonId::Summer);
+        CHECK(inv->getSeason() == inv->getString("Summer Season"));
+
+        SeasonId expected[] = {SeasonId::Autumn, SeasonId::Winter, SeasonId::Spring, SeasonId::Summer};
+        for (int i = 0; i < 4; i++)
+        {
+            inv->changeSeason();
+            CHECK(inv->getSeasonId() == expected[i]);
+            CHECK(*inv->getSeason()->getState() == seasonName(expected[i]));
+        }
+    }
+
+    SUBCASE("Plant season flyweights map to IDs")
+    {
+        LivingPlant *plant = new Herb();
+        CHECK(plant->getSeasonId() == SeasonId::None);
+
+        plant->setSeason(inv->getString("Winter Season"));
+        CHECK(plant->getSeasonId() == SeasonId::Winter);
+
+        Flyweight<std::string *> *outside = new Flyweight<std::string *>(new std::string("Spring Season"));
+        plant->setSeason(outside);
+        CHECK(plant->getSeasonId() == SeasonId::Spring);
+
+        plant->setSeason(inv->getString("Monsoon"));
+        CHECK(plant->getSeasonId() == SeasonId::Other);
+
+        plant->setSeason(SeasonId::Autumn);
+        CHECK(plant->getSeason() == inv->getString("Autumn Season"));
+
+        LivingPlant *copy = static_cast<LivingPlant *>(plant->clone());
+        CHECK(copy->getSeasonId() == SeasonId::Autumn);
+
+        plant->setSeason(nullptr);
+        CHECK(plant->getSeasonId() == SeasonId::None);
+
+        delete copy;
+        delete plant;
+        delete outside;
+    }
+
+    delete Inventory::getInstance();
+}
+
 // TEST_CASE("Testing State Transitions - Continuous Aging")
 // {
 //     Inventory *inv = Inventory::getInstance();
@@ -11,6 +11,8 @@
 #include "strategy/AlternatingSun.h"
 #include "strategy/WaterStrategy.h"
 #include "strategy/SunStrategy.h"
+#include <thread>
+#include <vector>
 
 TEST_CASE("Testing WaterStrategy implementations")
 {
@@ -135,4 +137,108 @@ TEST_CASE("Testing strategy switching in LivingPlant")
 
     delete plant;
     delete Inventory::getInstance();
-}
\ No newline at end of file
+}
+TEST_CASE("Testing stateless strategies with per-plant slots")
+{
+    Inventory *inv = Inventory::getInstance();
+
+    SUBCASE("Each plant keeps its own place in the alternating cycles")
+    {
+        LivingPlant *first = new Tree();
+        LivingPlant *second = new Tree();
+        first->setWaterStrategy(AlternatingWater::getID());
+        second->setWaterStrategy(AlternatingWater::getID());
+        first->setSunStrategy(AlternatingSun::getID());
+        second->setSunStrategy(AlternatingSun::getID());
+
+        const int expected[] = {25, 30, 35, 40, 20, 25};
+        bool cycle = true;
+        for (int i = 0; i < 6; i++)
+        {
+            first->setWaterLevel(0);
+            first->water();
+            cycle = cycle && first->getWaterLevel() == expected[i];
+        }
+        CHECK(cycle);
+
+        // Watering the first plant did not move the second one along
+        second->setWaterLevel(0);
+        second->water();
+        CHECK(second->getWaterLevel() == 25);
+
+        first->setSunExposure(0);
+        first->setOutside();
+        second->setSunExposure(0);
+        second->setOutside();
+        CHECK(first->getSunExposure() == 36);
+        CHECK(second->getSunExposure() == 36);
+        first->setSunExposure(0);
+        first->setOutside();
+        CHECK(first->getSunExposure() == 16);
+
+        // Clones continue from where the original is; a new strategy starts afresh
+        LivingPlant *copy = static_cast<LivingPlant *>(first->clone());
+        CHECK(copy->getWaterSlot() == first->getWaterSlot());
+        CHECK(copy->getSunSlot() == 0u);
+        copy->setWaterStrategy(AlternatingWater::getID());
+        CHECK(copy->getWaterSlot() == 0u);
+
+        delete copy;
+        delete first;
+        delete second;
+    }
+
+    SUBCASE("Watering different plants on several threads matches watering them in turn")
+    {
+        const int plants = 64;
+        const int rounds = 7;
+        std::vector<LivingPlant *> parallel;
+        std::vector<LivingPlant *> serial;
+        for (int i = 0; i < plants; i++)
+        {
+            parallel.push_back(new Tree());
+            serial.push_back(new Tree());
+            parallel[i]->setWaterStrategy(AlternatingWater::getID());
+            serial[i]->setWaterStrategy(AlternatingWater::getID());
+        }
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++)
+        {
+            workers.push_back(std::thread([&parallel, t]()
+                                          {
+                                              for (int r = 0; r < rounds; r++)
+                                              {
+                                                  for (int i = t; i < plants; i += 4)
+                                                  {
+                                                      parallel[i]->setWaterLevel(0);
+                                                      parallel[i]->water();
+                                                  }
+                                              } }));
+        }
+        for (std::size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+
+        for (int r = 0; r < rounds; r++)
+        {
+            for (int i = 0; i < plants; i++)
+            {
+                serial[i]->setWaterLevel(0);
+                serial[i]->water();
+            }
+        }
+
+        bool same = true;
+        for (int i = 0; i < plants; i++)
+            same = same && parallel[i]->getWaterLevel() == serial[i]->getWaterLevel() && parallel[i]->getWaterSlot() == serial[i]->getWaterSlot();
+        CHECK(same);
+        CHECK(serial[0]->getWaterLevel() == 30);
+
+        for (int i = 0; i < plants; i++)
+        {
+            delete parallel[i];
+            delete serial[i];
+        }
+    }
+    delete inv;
+}
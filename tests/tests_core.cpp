@@ -17,6 +17,7 @@
 #include "singleton_tests.cpp" //Passing
 #include "strategy_tests.cpp"  //Passing
 #include "state_tests.cpp"     //Passing
+#include "simulation_tests.cpp"
 
 TEST_CASE("Testing nursery function")
 {